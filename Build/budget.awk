@@ -0,0 +1,251 @@
+###############################################################################
+#
+# MODULE:       budget.awk
+#
+# DESCRIPTION:  RAM and flash budget report, run by "make budget"
+#
+###############################################################################
+#
+# This software is owned by NXP B.V. and/or its supplier and is protected
+# under applicable copyright laws. All rights are reserved. We grant You,
+# and any third parties, a license to use this software solely and
+# exclusively on NXP products [NXP Microcontrollers such as JN5168, JN5179].
+# You, and any third parties must reproduce the copyright and warranty notice
+# and any other legend of ownership on each copy or partial copy of the
+# software.
+#
+# THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+# AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+# IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE
+# ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE
+# LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR
+# CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF
+# SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS
+# INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN
+# CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE)
+# ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+# POSSIBILITY OF SUCH DAMAGE.
+#
+# Copyright NXP B.V. 2021. All rights reserved
+#
+#
+# Reads the linker map given as the input file and prints:
+#  - RAM and flash totals, checked against ram_budget and flash_budget
+#  - per-object RAM and flash use, with the change against the baseline,
+#    checked against the per-object limits
+#  - the largest RAM and flash symbols, as listed by the nm command
+#  - the largest stack frames, from the -fstack-usage .su files
+#
+# Variables (-v):
+#  ram_budget, flash_budget  limits in bytes, 0 disables the check. The RAM
+#                            total is static data only: the stack and heap
+#                            are listed but budgeted for separately.
+#  limits                    space separated object:flash:RAM limits
+#  nm                        command listing symbols with their sizes
+#  su                        space separated list of .su files
+#  baseline                  per-object table of an accepted build, or empty
+#  objects                   file the per-object table is written to
+#  top                       number of symbols and stack frames listed
+#
+# Exits with status 1 when a budget or an object limit is exceeded.
+#
+###############################################################################
+
+function hex(s,    i, c, n)
+{
+    n = 0
+    s = tolower(s)
+    sub(/^0x/, "", s)
+    for (i = 1; i <= length(s); i++) {
+        c = index("0123456789abcdef", substr(s, i, 1))
+        if (c == 0)
+            break
+        n = n * 16 + c - 1
+    }
+    return n
+}
+
+# Where an output section ends up: "flash", "ram" or "both" for initialised
+# data, which is stored in flash and copied to RAM at start up
+function region(sec)
+{
+    if (sec ~ /^\.(text|rodata|version|bir|flashheader|vsr_table|vsr_handlers)/)
+        return "flash"
+    if (sec ~ /^\.data/)
+        return "both"
+    if (sec ~ /^\.(bss|noinit|heap|stack)/)
+        return "ram"
+    return ""
+}
+
+function account(obj, size,    r)
+{
+    r = region(out)
+    if (r == "" || size == 0)
+        return
+    sub(/.*\//, "", obj)
+    seen[obj] = 1
+    current[obj] = 1
+    if (r != "ram") {
+        flash[obj] += size
+        total_flash += size
+    }
+    if (r != "flash") {
+        ram[obj] += size
+        if (obj !~ /^\(/)
+            total_ram += size
+    }
+}
+
+BEGIN {
+    if (top == "")
+        top = 20
+}
+
+/^Linker script and memory map/ {
+    inmap = 1
+    next
+}
+
+!inmap {
+    next
+}
+
+# Output section, with its address and size on the same or the next line.
+# The heap and stack have no input sections and are counted as a whole.
+/^\.[A-Za-z_]/ {
+    out = $1
+    pending = ""
+    if (out ~ /^\.(heap|stack)$/) {
+        if (NF >= 3)
+            account("(" substr(out, 2) ")", hex($3))
+        else
+            pending = "(" substr(out, 2) ")"
+    }
+    next
+}
+
+pending != "" {
+    if ($1 ~ /^0x/)
+        account(pending, hex($2))
+    pending = ""
+    next
+}
+
+# Input section, either on one line or with the name wrapped onto its own line
+/^ (\.|COMMON)/ {
+    if (NF >= 4)
+        account($4, hex($3))
+    else if (NF == 1)
+        wrapped = 1
+    next
+}
+
+wrapped {
+    wrapped = 0
+    if ($1 ~ /^0x/ && NF >= 3)
+        account($3, hex($2))
+    next
+}
+
+END {
+    printf "%-40s %10s %10s\n", "", "flash", "RAM"
+    printf "%-40s %10d %10d\n", "Total", total_flash, total_ram
+    printf "%-40s %10d %10d\n", "Budget", flash_budget, ram_budget
+    printf "\n"
+
+    if (baseline != "") {
+        while ((getline line < baseline) > 0) {
+            split(line, f, " ")
+            base_flash[f[1]] = f[2]
+            base_ram[f[1]] = f[3]
+            seen[f[1]] = 1
+        }
+        close(baseline)
+    }
+
+    # Per object, largest RAM user first
+    printf "%-40s %10s %10s %10s %10s\n", "Object", "flash", "RAM", "+flash", "+RAM"
+    cmd = "sort -k3,3nr -k2,2nr"
+    for (obj in seen) {
+        line = sprintf("%-40s %10d %10d", obj, flash[obj], ram[obj])
+        if (baseline != "")
+            line = line sprintf(" %+10d %+10d", flash[obj] - base_flash[obj], ram[obj] - base_ram[obj])
+        print line | cmd
+    }
+    close(cmd)
+    printf "\n"
+
+    if (objects != "") {
+        cmd = "sort > " objects
+        for (obj in current)
+            printf "%s %d %d\n", obj, flash[obj], ram[obj] | cmd
+        close(cmd)
+    }
+
+    # Largest symbols, from "nm -S": address, size, type, name
+    if (nm != "") {
+        n = 0
+        while ((nm | getline line) > 0) {
+            split(line, f, " ")
+            if (f[4] == "")
+                continue
+            t = tolower(f[3])
+            if (t == "b" || t == "d")
+                sym_ram[++n_ram] = sprintf("%10d %s", hex(f[2]), f[4])
+            if (t == "t" || t == "r" || t == "d")
+                sym_flash[++n_flash] = sprintf("%10d %s", hex(f[2]), f[4])
+        }
+        close(nm)
+
+        printf "Largest RAM symbols\n"
+        cmd = "sort -k1,1nr | head -n " top
+        for (i = 1; i <= n_ram; i++)
+            print sym_ram[i] | cmd
+        close(cmd)
+        printf "\nLargest flash symbols\n"
+        for (i = 1; i <= n_flash; i++)
+            print sym_flash[i] | cmd
+        close(cmd)
+        printf "\n"
+    }
+
+    # Largest stack frames, from "file:line:column:function<tab>bytes<tab>kind"
+    if (su != "") {
+        printf "Largest stack frames\n"
+        cmd = "sort -k1,1nr | head -n " top
+        n = split(su, files, " ")
+        for (i = 1; i <= n; i++) {
+            while ((getline line < files[i]) > 0) {
+                split(line, f, "\t")
+                printf "%10d %-40s %s\n", f[2], f[1], f[3] | cmd
+            }
+            close(files[i])
+        }
+        close(cmd)
+        printf "\n"
+    }
+
+    status = 0
+    n = split(limits, lim, " ")
+    for (i = 1; i <= n; i++) {
+        split(lim[i], f, ":")
+        if (f[2] > 0 && flash[f[1]] > f[2]) {
+            printf "%s flash limit exceeded by %d bytes\n", f[1], flash[f[1]] - f[2]
+            status = 1
+        }
+        if (f[3] > 0 && ram[f[1]] > f[3]) {
+            printf "%s RAM limit exceeded by %d bytes\n", f[1], ram[f[1]] - f[3]
+            status = 1
+        }
+    }
+    if (ram_budget > 0 && total_ram > ram_budget) {
+        printf "RAM budget exceeded by %d bytes\n", total_ram - ram_budget
+        status = 1
+    }
+    if (flash_budget > 0 && total_flash > flash_budget) {
+        printf "Flash budget exceeded by %d bytes\n", total_flash - flash_budget
+        status = 1
+    }
+    exit status
+}
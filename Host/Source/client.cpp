@@ -0,0 +1,221 @@
+/****************************************************************************
+ *
+ * MODULE:              Lumi Router
+ *
+ * COMPONENT:           client.cpp
+ *
+ * DESCRIPTION:         Blocking client of the daemon socket
+ *
+ ****************************************************************************
+ *
+ * This software is owned by NXP B.V. and/or its supplier and is protected
+ * under applicable copyright laws. All rights are reserved. We grant You,
+ * and any third parties, a license to use this software solely and
+ * exclusively on NXP products [NXP Microcontrollers such as JN5168, JN5179].
+ * You, and any third parties must reproduce the copyright and warranty notice
+ * and any other legend of ownership on each copy or partial copy of the
+ * software.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+ * AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+ * IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE
+ * ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE
+ * LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR
+ * CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF
+ * SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS
+ * INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN
+ * CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE)
+ * ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+ * POSSIBILITY OF SUCH DAMAGE.
+ *
+ * Copyright NXP B.V. 2016. All rights reserved
+ *
+ ****************************************************************************/
+/****************************************************************************/
+/***        Include Files                                                 ***/
+/****************************************************************************/
+
+#include "client.h"
+
+#include <poll.h>
+#include <sys/socket.h>
+#include <sys/un.h>
+#include <unistd.h>
+
+#include <cerrno>
+#include <cstring>
+#include <system_error>
+
+namespace lumi {
+
+/****************************************************************************/
+/***        Local Functions                                               ***/
+/****************************************************************************/
+
+namespace {
+
+[[noreturn]] void throwErrno(const char *what)
+{
+    throw std::system_error(errno, std::generic_category(), what);
+}
+
+} // namespace
+
+/****************************************************************************/
+/***        Exported Functions                                            ***/
+/****************************************************************************/
+
+Client::Client(const std::string &socketPath)
+{
+    sockaddr_un address = {};
+    address.sun_family = AF_UNIX;
+    if (socketPath.size() >= sizeof(address.sun_path)) {
+        throw std::system_error(ENAMETOOLONG, std::generic_category(), socketPath);
+    }
+    std::strcpy(address.sun_path, socketPath.c_str());
+
+    fd_ = socket(AF_UNIX, SOCK_SEQPACKET | SOCK_CLOEXEC, 0);
+    if (fd_ < 0) {
+        throwErrno("socket");
+    }
+    if (connect(fd_, reinterpret_cast<sockaddr *>(&address), sizeof(address)) < 0) {
+        int error = errno;
+        close(fd_);
+        throw std::system_error(error, std::generic_category(), socketPath);
+    }
+}
+
+Client::~Client()
+{
+    close(fd_);
+}
+
+uint32_t Client::send(uint16_t type, const std::vector<uint8_t> &data)
+{
+    uint32_t tag = nextTag_++;
+    std::vector<uint8_t> message = {
+        CLIENT_REQUEST,
+        static_cast<uint8_t>(tag >> 24),
+        static_cast<uint8_t>(tag >> 16),
+        static_cast<uint8_t>(tag >> 8),
+        static_cast<uint8_t>(tag),
+        static_cast<uint8_t>(type >> 8),
+        static_cast<uint8_t>(type),
+    };
+
+    message.insert(message.end(), data.begin(), data.end());
+    write(message);
+    return tag;
+}
+
+void Client::subscribe(uint8_t channelMask)
+{
+    write({CLIENT_SUBSCRIBE, channelMask});
+}
+
+bool Client::receive(ClientEvent &event, std::chrono::milliseconds timeout)
+{
+    if (!pending_.empty()) {
+        event = std::move(pending_.front());
+        pending_.pop_front();
+        return true;
+    }
+    return read(event, static_cast<int>(timeout.count()));
+}
+
+Response Client::request(uint16_t type, const std::vector<uint8_t> &data, std::chrono::milliseconds timeout)
+{
+    uint32_t tag = send(type, data);
+    auto deadline = std::chrono::steady_clock::now() + timeout;
+    Response response;
+    ClientEvent event;
+
+    for (;;) {
+        auto remaining = std::chrono::ceil<std::chrono::milliseconds>(deadline - std::chrono::steady_clock::now());
+        if (remaining.count() <= 0 || !read(event, static_cast<int>(remaining.count()))) {
+            return response;
+        }
+        if (event.kind == DAEMON_REPLY && event.tag == tag) {
+            response.status = event.status;
+            response.data = std::move(event.data);
+            return response;
+        }
+        pending_.push_back(std::move(event));
+    }
+}
+
+/****************************************************************************/
+/***        Local Functions                                               ***/
+/****************************************************************************/
+
+bool Client::read(ClientEvent &event, int timeoutMs)
+{
+    uint8_t message[MAX_CLIENT_MESSAGE];
+    pollfd poller = {fd_, POLLIN, 0};
+
+    for (;;) {
+        int ready = poll(&poller, 1, timeoutMs);
+        if (ready < 0 && errno == EINTR) {
+            continue;
+        }
+        if (ready < 0) {
+            throwErrno("poll");
+        }
+        if (ready == 0) {
+            return false;
+        }
+
+        ssize_t length = recv(fd_, message, sizeof(message), 0);
+        if (length < 0) {
+            throwErrno("recv");
+        }
+        if (length == 0) {
+            throw std::system_error(ECONNRESET, std::generic_category(), "daemon closed the connection");
+        }
+
+        uint8_t *end = message + length;
+        event = ClientEvent{};
+        event.kind = static_cast<ClientMessage>(message[0]);
+        switch (event.kind) {
+        case DAEMON_REPLY:
+            if (length < 6) {
+                continue;
+            }
+            event.tag = (static_cast<uint32_t>(message[1]) << 24) | (static_cast<uint32_t>(message[2]) << 16) |
+                        (static_cast<uint32_t>(message[3]) << 8) | message[4];
+            event.status = message[5];
+            event.data.assign(message + 6, end);
+            return true;
+
+        case DAEMON_FRAME:
+            if (length < 3) {
+                continue;
+            }
+            event.type = static_cast<uint16_t>((message[1] << 8) | message[2]);
+            event.data.assign(message + 3, end);
+            return true;
+
+        case DAEMON_TEXT:
+            event.data.assign(message + 1, end);
+            return true;
+
+        default:
+            continue;
+        }
+    }
+}
+
+void Client::write(const std::vector<uint8_t> &message)
+{
+    while (::send(fd_, message.data(), message.size(), MSG_NOSIGNAL) < 0) {
+        if (errno != EINTR) {
+            throwErrno("send");
+        }
+    }
+}
+
+} // namespace lumi
+
+/****************************************************************************/
+/***        END OF FILE                                                   ***/
+/****************************************************************************/
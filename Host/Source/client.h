@@ -0,0 +1,99 @@
+/****************************************************************************
+ *
+ * MODULE:              Lumi Router
+ *
+ * COMPONENT:           client.h
+ *
+ * DESCRIPTION:         Blocking client of the daemon socket
+ *
+ ****************************************************************************
+ *
+ * This software is owned by NXP B.V. and/or its supplier and is protected
+ * under applicable copyright laws. All rights are reserved. We grant You,
+ * and any third parties, a license to use this software solely and
+ * exclusively on NXP products [NXP Microcontrollers such as JN5168, JN5179].
+ * You, and any third parties must reproduce the copyright and warranty notice
+ * and any other legend of ownership on each copy or partial copy of the
+ * software.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+ * AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+ * IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE
+ * ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE
+ * LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR
+ * CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF
+ * SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS
+ * INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN
+ * CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE)
+ * ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+ * POSSIBILITY OF SUCH DAMAGE.
+ *
+ * Copyright NXP B.V. 2016. All rights reserved
+ *
+ ****************************************************************************/
+/****************************************************************************/
+/***        Include Files                                                 ***/
+/****************************************************************************/
+
+#ifndef LUMI_CLIENT_H
+#define LUMI_CLIENT_H
+
+#include <chrono>
+#include <cstdint>
+#include <deque>
+#include <string>
+#include <vector>
+
+#include "client_protocol.h"
+
+namespace lumi {
+
+/****************************************************************************/
+/***        Type Definitions                                              ***/
+/****************************************************************************/
+
+struct ClientEvent {
+    ClientMessage kind = DAEMON_FRAME;
+    /* DAEMON_REPLY only */
+    uint32_t tag = 0;
+    uint8_t status = 0;
+    /* DAEMON_FRAME only */
+    uint16_t type = 0;
+    std::vector<uint8_t> data;
+};
+
+/* For tools that send a few requests and wait for each; throws std::system_error if the daemon goes away */
+class Client {
+public:
+    explicit Client(const std::string &socketPath = DEFAULT_SOCKET_PATH);
+    ~Client();
+    Client(const Client &) = delete;
+    Client &operator=(const Client &) = delete;
+
+    /* Returns the tag of the reply to wait for */
+    uint32_t send(uint16_t type, const std::vector<uint8_t> &data);
+    void subscribe(uint8_t channelMask);
+
+    /* Next message from the daemon, or false after the timeout */
+    bool receive(ClientEvent &event, std::chrono::milliseconds timeout);
+
+    /* Sends a request and waits for its reply. Other messages that arrive meanwhile are kept for receive(). */
+    Response request(uint16_t type, const std::vector<uint8_t> &data,
+                     std::chrono::milliseconds timeout = std::chrono::seconds(10));
+
+private:
+    bool read(ClientEvent &event, int timeoutMs);
+    void write(const std::vector<uint8_t> &message);
+
+    int fd_;
+    uint32_t nextTag_ = 1;
+    std::deque<ClientEvent> pending_;
+};
+
+} // namespace lumi
+
+#endif /* LUMI_CLIENT_H */
+
+/****************************************************************************/
+/***        END OF FILE                                                   ***/
+/****************************************************************************/
@@ -0,0 +1,88 @@
+/****************************************************************************
+ *
+ * MODULE:              Lumi Router
+ *
+ * COMPONENT:           client_protocol.h
+ *
+ * DESCRIPTION:         Messages on the daemon socket
+ *
+ ****************************************************************************
+ *
+ * This software is owned by NXP B.V. and/or its supplier and is protected
+ * under applicable copyright laws. All rights are reserved. We grant You,
+ * and any third parties, a license to use this software solely and
+ * exclusively on NXP products [NXP Microcontrollers such as JN5168, JN5179].
+ * You, and any third parties must reproduce the copyright and warranty notice
+ * and any other legend of ownership on each copy or partial copy of the
+ * software.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+ * AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+ * IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE
+ * ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE
+ * LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR
+ * CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF
+ * SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS
+ * INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN
+ * CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE)
+ * ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+ * POSSIBILITY OF SUCH DAMAGE.
+ *
+ * Copyright NXP B.V. 2016. All rights reserved
+ *
+ ****************************************************************************/
+/****************************************************************************/
+/***        Include Files                                                 ***/
+/****************************************************************************/
+
+#ifndef LUMI_CLIENT_PROTOCOL_H
+#define LUMI_CLIENT_PROTOCOL_H
+
+#include <cstddef>
+#include <cstdint>
+
+#include "frame.h"
+
+namespace lumi {
+
+/****************************************************************************/
+/***        Macro Definitions                                             ***/
+/****************************************************************************/
+
+constexpr const char *DEFAULT_SOCKET_PATH = "/var/run/lumid.sock";
+
+/* Kind byte, tag (4) and type (2) or status (1) ahead of the frame data */
+constexpr size_t CLIENT_HEADER_SIZE = 7;
+constexpr size_t MAX_CLIENT_MESSAGE = CLIENT_HEADER_SIZE + MAX_FRAME_DATA;
+
+/****************************************************************************/
+/***        Type Definitions                                              ***/
+/****************************************************************************/
+
+/*
+ * The daemon listens on a SOCK_SEQPACKET Unix socket, so each message is
+ * one packet. Every message starts with its kind; multi-byte fields are big
+ * endian. Requests carry a tag of the client's choosing, returned in the
+ * reply, so a client may have many requests outstanding.
+ */
+enum ClientMessage : uint8_t {
+    /* tag (4) | type (2) | data */
+    CLIENT_REQUEST = 0x01,
+    /* channel mask (1), bit n set to receive frames on channel n. Text outside frames counts as channel 1. */
+    CLIENT_SUBSCRIBE = 0x02,
+
+    /* tag (4) | status (1) | data */
+    DAEMON_REPLY = 0x81,
+    /* type (2) | data */
+    DAEMON_FRAME = 0x82,
+    /* text */
+    DAEMON_TEXT = 0x83,
+};
+
+} // namespace lumi
+
+#endif /* LUMI_CLIENT_PROTOCOL_H */
+
+/****************************************************************************/
+/***        END OF FILE                                                   ***/
+/****************************************************************************/
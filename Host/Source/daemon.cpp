@@ -0,0 +1,277 @@
+/****************************************************************************
+ *
+ * MODULE:              Lumi Router
+ *
+ * COMPONENT:           daemon.cpp
+ *
+ * DESCRIPTION:         Unix socket API shared by host tools
+ *
+ ****************************************************************************
+ *
+ * This software is owned by NXP B.V. and/or its supplier and is protected
+ * under applicable copyright laws. All rights are reserved. We grant You,
+ * and any third parties, a license to use this software solely and
+ * exclusively on NXP products [NXP Microcontrollers such as JN5168, JN5179].
+ * You, and any third parties must reproduce the copyright and warranty notice
+ * and any other legend of ownership on each copy or partial copy of the
+ * software.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+ * AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+ * IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE
+ * ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE
+ * LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR
+ * CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF
+ * SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS
+ * INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN
+ * CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE)
+ * ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+ * POSSIBILITY OF SUCH DAMAGE.
+ *
+ * Copyright NXP B.V. 2016. All rights reserved
+ *
+ ****************************************************************************/
+/****************************************************************************/
+/***        Include Files                                                 ***/
+/****************************************************************************/
+
+#include "daemon.h"
+
+#include <sys/epoll.h>
+#include <sys/socket.h>
+#include <sys/un.h>
+#include <unistd.h>
+
+#include <cerrno>
+#include <cstring>
+#include <system_error>
+
+#include "client_protocol.h"
+
+namespace lumi {
+
+/****************************************************************************/
+/***        Macro Definitions                                             ***/
+/****************************************************************************/
+
+namespace {
+
+constexpr int LISTEN_BACKLOG = 8;
+
+/* Frames and text queued for a client beyond this are dropped; replies never are */
+constexpr size_t MAX_CLIENT_QUEUE = 256;
+
+void appendBigEndian(std::vector<uint8_t> &out, uint32_t value, int bytes)
+{
+    while (bytes-- > 0) {
+        out.push_back(static_cast<uint8_t>(value >> (8 * bytes)));
+    }
+}
+
+} // namespace
+
+/****************************************************************************/
+/***        Exported Functions                                            ***/
+/****************************************************************************/
+
+Daemon::Daemon(EventLoop &loop, Link &link, const std::string &socketPath)
+    : loop_(loop), link_(link), socketPath_(socketPath)
+{
+    sockaddr_un address = {};
+    address.sun_family = AF_UNIX;
+    if (socketPath.size() >= sizeof(address.sun_path)) {
+        throw std::system_error(ENAMETOOLONG, std::generic_category(), socketPath);
+    }
+    std::strcpy(address.sun_path, socketPath.c_str());
+
+    listenFd_ = socket(AF_UNIX, SOCK_SEQPACKET | SOCK_NONBLOCK | SOCK_CLOEXEC, 0);
+    if (listenFd_ < 0) {
+        throw std::system_error(errno, std::generic_category(), "socket");
+    }
+    /* A socket left by a daemon that did not exit cleanly */
+    unlink(socketPath.c_str());
+    if (bind(listenFd_, reinterpret_cast<sockaddr *>(&address), sizeof(address)) < 0 ||
+        listen(listenFd_, LISTEN_BACKLOG) < 0) {
+        int error = errno;
+        close(listenFd_);
+        throw std::system_error(error, std::generic_category(), socketPath);
+    }
+    loop_.add(listenFd_, EPOLLIN, [this](uint32_t) { acceptClients(); });
+
+    link_.onFrame([this](const Frame &frame) {
+        std::vector<uint8_t> message;
+        message.reserve(3 + frame.data.size());
+        message.push_back(DAEMON_FRAME);
+        appendBigEndian(message, frame.type, 2);
+        message.insert(message.end(), frame.data.begin(), frame.data.end());
+        broadcast(channelOf(frame.type), message);
+    });
+    link_.onText([this](const uint8_t *text, size_t length) {
+        std::vector<uint8_t> message;
+        message.reserve(1 + length);
+        message.push_back(DAEMON_TEXT);
+        message.insert(message.end(), text, text + length);
+        broadcast(CHANNEL_EVENT, message);
+    });
+}
+
+Daemon::~Daemon()
+{
+    link_.onFrame(nullptr);
+    link_.onText(nullptr);
+    while (!clients_.empty()) {
+        closeClient(clients_.begin()->first);
+    }
+    loop_.remove(listenFd_);
+    close(listenFd_);
+    unlink(socketPath_.c_str());
+}
+
+/****************************************************************************/
+/***        Local Functions                                               ***/
+/****************************************************************************/
+
+void Daemon::acceptClients()
+{
+    for (;;) {
+        int fd = accept4(listenFd_, nullptr, nullptr, SOCK_NONBLOCK | SOCK_CLOEXEC);
+        if (fd < 0) {
+            return;
+        }
+
+        uint64_t id = nextClient_++;
+        clients_.emplace(id, Client{fd, 0, {}});
+        loop_.add(fd, EPOLLIN, [this, id](uint32_t events) { handleClient(id, events); });
+    }
+}
+
+void Daemon::handleClient(uint64_t id, uint32_t events)
+{
+    if (events & EPOLLOUT) {
+        flush(id);
+    }
+
+    if (events & (EPOLLIN | EPOLLERR | EPOLLHUP)) {
+        uint8_t message[MAX_CLIENT_MESSAGE];
+
+        for (;;) {
+            auto it = clients_.find(id);
+            if (it == clients_.end()) {
+                return;
+            }
+
+            ssize_t length = recv(it->second.fd, message, sizeof(message), MSG_TRUNC);
+            if (length < 0 && (errno == EAGAIN || errno == EINTR)) {
+                return;
+            }
+            if (length <= 0) {
+                closeClient(id);
+                return;
+            }
+            if (static_cast<size_t>(length) <= sizeof(message)) {
+                handleMessage(id, message, static_cast<size_t>(length));
+            }
+        }
+    }
+}
+
+void Daemon::handleMessage(uint64_t id, const uint8_t *message, size_t length)
+{
+    switch (message[0]) {
+    case CLIENT_REQUEST: {
+        if (length < CLIENT_HEADER_SIZE) {
+            return;
+        }
+        std::vector<uint8_t> tag(message + 1, message + 5);
+        uint16_t type = static_cast<uint16_t>((message[5] << 8) | message[6]);
+        std::vector<uint8_t> data(message + CLIENT_HEADER_SIZE, message + length);
+
+        link_.request(type, std::move(data), [this, id, tag](const Response &response) {
+            std::vector<uint8_t> reply;
+            reply.reserve(6 + response.data.size());
+            reply.push_back(DAEMON_REPLY);
+            reply.insert(reply.end(), tag.begin(), tag.end());
+            reply.push_back(response.status);
+            reply.insert(reply.end(), response.data.begin(), response.data.end());
+            send(id, std::move(reply));
+        });
+        break;
+    }
+
+    case CLIENT_SUBSCRIBE:
+        if (length >= 2) {
+            clients_.at(id).channels = message[1];
+        }
+        break;
+
+    default:
+        break;
+    }
+}
+
+void Daemon::broadcast(unsigned channel, const std::vector<uint8_t> &message)
+{
+    for (auto &entry : clients_) {
+        if ((entry.second.channels & (1u << channel)) == 0) {
+            continue;
+        }
+        if (entry.second.out.size() >= MAX_CLIENT_QUEUE) {
+            dropped_++;
+            continue;
+        }
+        send(entry.first, message);
+    }
+}
+
+/* Queued in order, so a client sees frames and replies in the order the firmware sent them */
+void Daemon::send(uint64_t id, std::vector<uint8_t> message)
+{
+    auto it = clients_.find(id);
+    if (it == clients_.end()) {
+        /* The client left before its reply came */
+        return;
+    }
+
+    it->second.out.push_back(std::move(message));
+    if (it->second.out.size() == 1) {
+        flush(id);
+    }
+}
+
+void Daemon::flush(uint64_t id)
+{
+    Client &client = clients_.at(id);
+
+    while (!client.out.empty()) {
+        const std::vector<uint8_t> &message = client.out.front();
+        if (::send(client.fd, message.data(), message.size(), MSG_NOSIGNAL) < 0) {
+            if (errno == EINTR) {
+                continue;
+            }
+            if (errno == EAGAIN) {
+                loop_.modify(client.fd, EPOLLIN | EPOLLOUT);
+                return;
+            }
+            closeClient(id);
+            return;
+        }
+        client.out.pop_front();
+    }
+    loop_.modify(client.fd, EPOLLIN);
+}
+
+void Daemon::closeClient(uint64_t id)
+{
+    auto it = clients_.find(id);
+    if (it != clients_.end()) {
+        loop_.remove(it->second.fd);
+        close(it->second.fd);
+        clients_.erase(it);
+    }
+}
+
+} // namespace lumi
+
+/****************************************************************************/
+/***        END OF FILE                                                   ***/
+/****************************************************************************/
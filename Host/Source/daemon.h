@@ -0,0 +1,102 @@
+/****************************************************************************
+ *
+ * MODULE:              Lumi Router
+ *
+ * COMPONENT:           daemon.h
+ *
+ * DESCRIPTION:         Unix socket API shared by host tools
+ *
+ ****************************************************************************
+ *
+ * This software is owned by NXP B.V. and/or its supplier and is protected
+ * under applicable copyright laws. All rights are reserved. We grant You,
+ * and any third parties, a license to use this software solely and
+ * exclusively on NXP products [NXP Microcontrollers such as JN5168, JN5179].
+ * You, and any third parties must reproduce the copyright and warranty notice
+ * and any other legend of ownership on each copy or partial copy of the
+ * software.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+ * AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+ * IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE
+ * ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE
+ * LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR
+ * CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF
+ * SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS
+ * INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN
+ * CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE)
+ * ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+ * POSSIBILITY OF SUCH DAMAGE.
+ *
+ * Copyright NXP B.V. 2016. All rights reserved
+ *
+ ****************************************************************************/
+/****************************************************************************/
+/***        Include Files                                                 ***/
+/****************************************************************************/
+
+#ifndef LUMI_DAEMON_H
+#define LUMI_DAEMON_H
+
+#include <cstdint>
+#include <deque>
+#include <map>
+#include <string>
+#include <vector>
+
+#include "event_loop.h"
+#include "link.h"
+
+namespace lumi {
+
+/****************************************************************************/
+/***        Type Definitions                                              ***/
+/****************************************************************************/
+
+/*
+ * Serves the messages of client_protocol.h on a Unix socket, passing
+ * requests from every client to one link and routing each reply back to the
+ * client that asked.
+ */
+class Daemon {
+public:
+    Daemon(EventLoop &loop, Link &link, const std::string &socketPath);
+    ~Daemon();
+    Daemon(const Daemon &) = delete;
+    Daemon &operator=(const Daemon &) = delete;
+
+    size_t clientCount() const { return clients_.size(); }
+    /* Frames and text not delivered because a client fell behind */
+    uint64_t dropped() const { return dropped_; }
+
+private:
+    struct Client {
+        int fd;
+        uint8_t channels = 0;
+        std::deque<std::vector<uint8_t>> out;
+    };
+
+    void acceptClients();
+    void handleClient(uint64_t id, uint32_t events);
+    void handleMessage(uint64_t id, const uint8_t *message, size_t length);
+    void broadcast(unsigned channel, const std::vector<uint8_t> &message);
+    void send(uint64_t id, std::vector<uint8_t> message);
+    void flush(uint64_t id);
+    void closeClient(uint64_t id);
+
+    EventLoop &loop_;
+    Link &link_;
+    std::string socketPath_;
+    int listenFd_;
+    std::map<uint64_t, Client> clients_;
+    uint64_t nextClient_ = 1;
+    uint64_t dropped_ = 0;
+};
+
+} // namespace lumi
+
+#endif /* LUMI_DAEMON_H */
+
+/****************************************************************************/
+/***        END OF FILE                                                   ***/
+/****************************************************************************/
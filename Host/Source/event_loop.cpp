@@ -0,0 +1,208 @@
+/****************************************************************************
+ *
+ * MODULE:              Lumi Router
+ *
+ * COMPONENT:           event_loop.cpp
+ *
+ * DESCRIPTION:         Single threaded epoll event loop
+ *
+ ****************************************************************************
+ *
+ * This software is owned by NXP B.V. and/or its supplier and is protected
+ * under applicable copyright laws. All rights are reserved. We grant You,
+ * and any third parties, a license to use this software solely and
+ * exclusively on NXP products [NXP Microcontrollers such as JN5168, JN5179].
+ * You, and any third parties must reproduce the copyright and warranty notice
+ * and any other legend of ownership on each copy or partial copy of the
+ * software.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+ * AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+ * IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE
+ * ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE
+ * LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR
+ * CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF
+ * SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS
+ * INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN
+ * CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE)
+ * ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+ * POSSIBILITY OF SUCH DAMAGE.
+ *
+ * Copyright NXP B.V. 2016. All rights reserved
+ *
+ ****************************************************************************/
+/****************************************************************************/
+/***        Include Files                                                 ***/
+/****************************************************************************/
+
+#include "event_loop.h"
+
+#include <sys/epoll.h>
+#include <sys/eventfd.h>
+#include <unistd.h>
+
+#include <cerrno>
+#include <system_error>
+
+namespace lumi {
+
+/****************************************************************************/
+/***        Macro Definitions                                             ***/
+/****************************************************************************/
+
+namespace {
+
+constexpr int MAX_EVENTS = 16;
+
+[[noreturn]] void throwErrno(const char *what)
+{
+    throw std::system_error(errno, std::generic_category(), what);
+}
+
+} // namespace
+
+/****************************************************************************/
+/***        Exported Functions                                            ***/
+/****************************************************************************/
+
+EventLoop::EventLoop()
+{
+    epollFd_ = epoll_create1(EPOLL_CLOEXEC);
+    if (epollFd_ < 0) {
+        throwErrno("epoll_create1");
+    }
+    wakeFd_ = eventfd(0, EFD_CLOEXEC | EFD_NONBLOCK);
+    if (wakeFd_ < 0) {
+        close(epollFd_);
+        throwErrno("eventfd");
+    }
+    add(wakeFd_, EPOLLIN, [this](uint32_t) {
+        uint64_t count;
+        if (read(wakeFd_, &count, sizeof(count)) == sizeof(count)) {
+            stopping_ = true;
+        }
+    });
+}
+
+EventLoop::~EventLoop()
+{
+    close(wakeFd_);
+    close(epollFd_);
+}
+
+void EventLoop::add(int fd, uint32_t events, Handler handler)
+{
+    epoll_event event = {};
+    event.events = events;
+    event.data.fd = fd;
+    if (epoll_ctl(epollFd_, EPOLL_CTL_ADD, fd, &event) < 0) {
+        throwErrno("epoll_ctl add");
+    }
+    handlers_[fd] = std::make_shared<Handler>(std::move(handler));
+}
+
+void EventLoop::modify(int fd, uint32_t events)
+{
+    epoll_event event = {};
+    event.events = events;
+    event.data.fd = fd;
+    if (epoll_ctl(epollFd_, EPOLL_CTL_MOD, fd, &event) < 0) {
+        throwErrno("epoll_ctl mod");
+    }
+}
+
+void EventLoop::remove(int fd)
+{
+    epoll_ctl(epollFd_, EPOLL_CTL_DEL, fd, nullptr);
+    handlers_.erase(fd);
+}
+
+EventLoop::TimerId EventLoop::callAfter(std::chrono::milliseconds delay, std::function<void()> callback)
+{
+    TimerId id = nextTimer_++;
+    Clock::time_point deadline = Clock::now() + delay;
+
+    timers_.emplace(std::make_pair(deadline, id), std::move(callback));
+    timerDeadlines_.emplace(id, deadline);
+    return id;
+}
+
+void EventLoop::cancel(TimerId id)
+{
+    auto it = timerDeadlines_.find(id);
+    if (it != timerDeadlines_.end()) {
+        timers_.erase(std::make_pair(it->second, id));
+        timerDeadlines_.erase(it);
+    }
+}
+
+void EventLoop::run()
+{
+    epoll_event events[MAX_EVENTS];
+
+    stopping_ = false;
+    while (!stopping_) {
+        int count = epoll_wait(epollFd_, events, MAX_EVENTS, nextTimeout());
+        if (count < 0) {
+            if (errno == EINTR) {
+                continue;
+            }
+            throwErrno("epoll_wait");
+        }
+        for (int i = 0; i < count; i++) {
+            /* A handler may have removed a later descriptor, so look each one up again */
+            auto it = handlers_.find(events[i].data.fd);
+            if (it != handlers_.end()) {
+                std::shared_ptr<Handler> handler = it->second;
+                (*handler)(events[i].events);
+            }
+        }
+        runTimers();
+    }
+}
+
+void EventLoop::stop()
+{
+    uint64_t one = 1;
+    if (write(wakeFd_, &one, sizeof(one)) != sizeof(one)) {
+        /* The counter is already non-zero, so the loop will still wake */
+    }
+}
+
+/****************************************************************************/
+/***        Local Functions                                               ***/
+/****************************************************************************/
+
+void EventLoop::runTimers()
+{
+    Clock::time_point now = Clock::now();
+
+    /* Only timers already due run, so a callback that restarts itself waits for the next pass */
+    while (!timers_.empty() && timers_.begin()->first.first <= now) {
+        auto it = timers_.begin();
+        std::function<void()> callback = std::move(it->second);
+        timerDeadlines_.erase(it->first.second);
+        timers_.erase(it);
+        callback();
+    }
+}
+
+int EventLoop::nextTimeout() const
+{
+    if (timers_.empty()) {
+        return -1;
+    }
+
+    auto remaining = timers_.begin()->first.first - Clock::now();
+    if (remaining <= Clock::duration::zero()) {
+        return 0;
+    }
+    /* Round up, or the loop wakes just before the timer is due */
+    return static_cast<int>(std::chrono::ceil<std::chrono::milliseconds>(remaining).count());
+}
+
+} // namespace lumi
+
+/****************************************************************************/
+/***        END OF FILE                                                   ***/
+/****************************************************************************/
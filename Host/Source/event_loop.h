@@ -0,0 +1,102 @@
+/****************************************************************************
+ *
+ * MODULE:              Lumi Router
+ *
+ * COMPONENT:           event_loop.h
+ *
+ * DESCRIPTION:         Single threaded epoll event loop
+ *
+ ****************************************************************************
+ *
+ * This software is owned by NXP B.V. and/or its supplier and is protected
+ * under applicable copyright laws. All rights are reserved. We grant You,
+ * and any third parties, a license to use this software solely and
+ * exclusively on NXP products [NXP Microcontrollers such as JN5168, JN5179].
+ * You, and any third parties must reproduce the copyright and warranty notice
+ * and any other legend of ownership on each copy or partial copy of the
+ * software.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+ * AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+ * IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE
+ * ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE
+ * LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR
+ * CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF
+ * SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS
+ * INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN
+ * CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE)
+ * ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+ * POSSIBILITY OF SUCH DAMAGE.
+ *
+ * Copyright NXP B.V. 2016. All rights reserved
+ *
+ ****************************************************************************/
+/****************************************************************************/
+/***        Include Files                                                 ***/
+/****************************************************************************/
+
+#ifndef LUMI_EVENT_LOOP_H
+#define LUMI_EVENT_LOOP_H
+
+#include <chrono>
+#include <cstdint>
+#include <functional>
+#include <map>
+#include <memory>
+#include <utility>
+
+namespace lumi {
+
+/****************************************************************************/
+/***        Type Definitions                                              ***/
+/****************************************************************************/
+
+/*
+ * Calls handlers for ready file descriptors and expired timers. Everything
+ * runs on the thread that calls run(); only stop() may be called from another
+ * thread.
+ */
+class EventLoop {
+public:
+    using Handler = std::function<void(uint32_t events)>;
+    using TimerId = uint64_t;
+    using Clock = std::chrono::steady_clock;
+
+    EventLoop();
+    ~EventLoop();
+    EventLoop(const EventLoop &) = delete;
+    EventLoop &operator=(const EventLoop &) = delete;
+
+    /* events are EPOLLIN, EPOLLOUT and so on */
+    void add(int fd, uint32_t events, Handler handler);
+    void modify(int fd, uint32_t events);
+    void remove(int fd);
+
+    TimerId callAfter(std::chrono::milliseconds delay, std::function<void()> callback);
+    /* Cancelling a timer that has run or was never started does nothing */
+    void cancel(TimerId id);
+
+    /* Runs until stop() */
+    void run();
+    void stop();
+
+private:
+    void runTimers();
+    int nextTimeout() const;
+
+    int epollFd_;
+    int wakeFd_;
+    bool stopping_ = false;
+    std::map<int, std::shared_ptr<Handler>> handlers_;
+    std::map<std::pair<Clock::time_point, TimerId>, std::function<void()>> timers_;
+    std::map<TimerId, Clock::time_point> timerDeadlines_;
+    TimerId nextTimer_ = 1;
+};
+
+} // namespace lumi
+
+#endif /* LUMI_EVENT_LOOP_H */
+
+/****************************************************************************/
+/***        END OF FILE                                                   ***/
+/****************************************************************************/
@@ -0,0 +1,235 @@
+/****************************************************************************
+ *
+ * MODULE:              Lumi Router
+ *
+ * COMPONENT:           frame.cpp
+ *
+ * DESCRIPTION:         Serial frame codec
+ *
+ ****************************************************************************
+ *
+ * This software is owned by NXP B.V. and/or its supplier and is protected
+ * under applicable copyright laws. All rights are reserved. We grant You,
+ * and any third parties, a license to use this software solely and
+ * exclusively on NXP products [NXP Microcontrollers such as JN5168, JN5179].
+ * You, and any third parties must reproduce the copyright and warranty notice
+ * and any other legend of ownership on each copy or partial copy of the
+ * software.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+ * AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+ * IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE
+ * ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE
+ * LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR
+ * CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF
+ * SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS
+ * INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN
+ * CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE)
+ * ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+ * POSSIBILITY OF SUCH DAMAGE.
+ *
+ * Copyright NXP B.V. 2016. All rights reserved
+ *
+ ****************************************************************************/
+/****************************************************************************/
+/***        Include Files                                                 ***/
+/****************************************************************************/
+
+#include "frame.h"
+
+namespace lumi {
+
+/****************************************************************************/
+/***        Macro Definitions                                             ***/
+/****************************************************************************/
+
+namespace {
+
+constexpr uint16_t CRC16_INIT = 0xFFFF;
+constexpr uint16_t CRC16_POLYNOMIAL = 0x1021;
+
+/* type (2), length (2) */
+constexpr size_t HEADER_FIELDS_SIZE = 4;
+
+size_t headerSize(int version)
+{
+    return HEADER_FIELDS_SIZE + (version >= 2 ? 2 : 1);
+}
+
+uint8_t xorCheck(const uint8_t *data, size_t length, uint8_t check)
+{
+    for (size_t i = 0; i < length; i++) {
+        check ^= data[i];
+    }
+    return check;
+}
+
+void appendEscaped(uint8_t byte, std::vector<uint8_t> &out)
+{
+    if (byte >= SL_START_CHAR && byte <= SL_END_CHAR) {
+        out.push_back(SL_ESC_CHAR);
+        out.push_back(byte ^ 0x10);
+    }
+    else {
+        out.push_back(byte);
+    }
+}
+
+} // namespace
+
+/****************************************************************************/
+/***        Exported Functions                                            ***/
+/****************************************************************************/
+
+uint16_t crc16(uint16_t crc, const uint8_t *data, size_t length)
+{
+    for (size_t i = 0; i < length; i++) {
+        crc ^= static_cast<uint16_t>(data[i] << 8);
+        for (int bit = 0; bit < 8; bit++) {
+            crc = (crc & 0x8000) ? static_cast<uint16_t>((crc << 1) ^ CRC16_POLYNOMIAL) : static_cast<uint16_t>(crc << 1);
+        }
+    }
+    return crc;
+}
+
+void encodeFrame(int version, uint16_t type, const uint8_t *data, size_t length, std::vector<uint8_t> &out)
+{
+    const uint8_t header[HEADER_FIELDS_SIZE] = {
+        static_cast<uint8_t>(type >> 8),
+        static_cast<uint8_t>(type),
+        static_cast<uint8_t>(length >> 8),
+        static_cast<uint8_t>(length),
+    };
+
+    out.push_back(SL_START_CHAR);
+    for (uint8_t byte : header) {
+        appendEscaped(byte, out);
+    }
+    if (version >= 2) {
+        uint16_t crc = crc16(crc16(CRC16_INIT, header, sizeof(header)), data, length);
+        appendEscaped(static_cast<uint8_t>(crc >> 8), out);
+        appendEscaped(static_cast<uint8_t>(crc), out);
+    }
+    else {
+        appendEscaped(xorCheck(data, length, xorCheck(header, sizeof(header), 0)), out);
+    }
+    for (size_t i = 0; i < length; i++) {
+        appendEscaped(data[i], out);
+    }
+    out.push_back(SL_END_CHAR);
+}
+
+FrameDecoder::FrameDecoder(FrameHandler onFrame, TextHandler onText)
+    : onFrame_(std::move(onFrame)), onText_(std::move(onText))
+{
+    buffer_.reserve(headerSize(PROTOCOL_VERSION) + MAX_FRAME_DATA);
+}
+
+void FrameDecoder::setVersion(int version)
+{
+    version_ = version;
+}
+
+void FrameDecoder::feed(const uint8_t *data, size_t length)
+{
+    size_t textStart = 0;
+
+    for (size_t i = 0; i < length; i++) {
+        uint8_t byte = data[i];
+
+        if (!inFrame_) {
+            if (byte == SL_START_CHAR) {
+                if (i > textStart && onText_) {
+                    onText_(data + textStart, i - textStart);
+                }
+                /* The header length is fixed by the version in use when the frame starts */
+                inFrame_ = true;
+                inEscape_ = false;
+                overflow_ = false;
+                frameVersion_ = version_;
+                buffer_.clear();
+            }
+            continue;
+        }
+
+        if (byte == SL_START_CHAR) {
+            /* A start inside a frame abandons the partial frame, as the firmware does */
+            badFrames_++;
+            inEscape_ = false;
+            overflow_ = false;
+            frameVersion_ = version_;
+            buffer_.clear();
+        }
+        else if (byte == SL_END_CHAR) {
+            endFrame();
+            inFrame_ = false;
+            textStart = i + 1;
+        }
+        else if (byte == SL_ESC_CHAR) {
+            inEscape_ = true;
+        }
+        else {
+            if (inEscape_) {
+                byte ^= 0x10;
+                inEscape_ = false;
+            }
+            if (buffer_.size() < headerSize(frameVersion_) + MAX_FRAME_DATA) {
+                buffer_.push_back(byte);
+            }
+            else {
+                overflow_ = true;
+            }
+        }
+    }
+
+    if (!inFrame_ && length > textStart && onText_) {
+        onText_(data + textStart, length - textStart);
+    }
+}
+
+/****************************************************************************/
+/***        Local Functions                                               ***/
+/****************************************************************************/
+
+void FrameDecoder::endFrame()
+{
+    size_t header = headerSize(frameVersion_);
+
+    if (overflow_ || buffer_.size() < header) {
+        badFrames_++;
+        return;
+    }
+
+    const uint8_t *bytes = buffer_.data();
+    size_t length = (static_cast<size_t>(bytes[2]) << 8) | bytes[3];
+    if (length != buffer_.size() - header) {
+        badFrames_++;
+        return;
+    }
+
+    bool checkOk;
+    if (frameVersion_ >= 2) {
+        uint16_t crc = crc16(crc16(CRC16_INIT, bytes, HEADER_FIELDS_SIZE), bytes + header, length);
+        checkOk = bytes[4] == static_cast<uint8_t>(crc >> 8) && bytes[5] == static_cast<uint8_t>(crc);
+    }
+    else {
+        checkOk = bytes[4] == xorCheck(bytes + header, length, xorCheck(bytes, HEADER_FIELDS_SIZE, 0));
+    }
+    if (!checkOk) {
+        badFrames_++;
+        return;
+    }
+
+    Frame frame;
+    frame.type = static_cast<uint16_t>((bytes[0] << 8) | bytes[1]);
+    frame.data.assign(bytes + header, bytes + header + length);
+    if (onFrame_) {
+        onFrame_(frame);
+    }
+}
+
+} // namespace lumi
+
+/****************************************************************************/
+/***        END OF FILE                                                   ***/
+/****************************************************************************/
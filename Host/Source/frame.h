@@ -0,0 +1,163 @@
+/****************************************************************************
+ *
+ * MODULE:              Lumi Router
+ *
+ * COMPONENT:           frame.h
+ *
+ * DESCRIPTION:         Serial frame codec
+ *
+ ****************************************************************************
+ *
+ * This software is owned by NXP B.V. and/or its supplier and is protected
+ * under applicable copyright laws. All rights are reserved. We grant You,
+ * and any third parties, a license to use this software solely and
+ * exclusively on NXP products [NXP Microcontrollers such as JN5168, JN5179].
+ * You, and any third parties must reproduce the copyright and warranty notice
+ * and any other legend of ownership on each copy or partial copy of the
+ * software.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+ * AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+ * IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE
+ * ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE
+ * LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR
+ * CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF
+ * SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS
+ * INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN
+ * CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE)
+ * ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+ * POSSIBILITY OF SUCH DAMAGE.
+ *
+ * Copyright NXP B.V. 2016. All rights reserved
+ *
+ ****************************************************************************/
+/****************************************************************************/
+/***        Include Files                                                 ***/
+/****************************************************************************/
+
+#ifndef LUMI_FRAME_H
+#define LUMI_FRAME_H
+
+#include <cstddef>
+#include <cstdint>
+#include <functional>
+#include <vector>
+
+namespace lumi {
+
+/****************************************************************************/
+/***        Macro Definitions                                             ***/
+/****************************************************************************/
+
+constexpr uint8_t SL_START_CHAR = 0x01;
+constexpr uint8_t SL_ESC_CHAR = 0x02;
+constexpr uint8_t SL_END_CHAR = 0x03;
+
+/* Largest data length the firmware accepts or sends */
+constexpr size_t MAX_FRAME_DATA = 256;
+
+/* Set in the type of a version 3 reply */
+constexpr uint16_t RESPONSE_FLAG = 0x8000;
+
+/* Highest protocol version this library speaks */
+constexpr int PROTOCOL_VERSION = 3;
+
+/* Reply status set by the host when it refused to send a request */
+constexpr uint8_t STATUS_REFUSED = 0xFE;
+/* Reply status set by the host when the firmware never answered */
+constexpr uint8_t STATUS_NO_REPLY = 0xFF;
+
+/****************************************************************************/
+/***        Type Definitions                                              ***/
+/****************************************************************************/
+
+/* Commands, see "Commands" in README.md */
+enum MessageType : uint16_t {
+    MSG_RESET = 0x0011,
+    MSG_ERASE_PERSISTENT_DATA = 0x0012,
+    MSG_SET_BAUD_RATE = 0x0013,
+    MSG_SET_PROTOCOL_VERSION = 0x0014,
+    MSG_GET_POOL_STATS = 0x0015,
+    MSG_BENCHMARK = 0x0016,
+    MSG_BENCHMARK_DATA = 0x0017,
+    MSG_GET_LINK_STATS = 0x0018,
+    MSG_SET_LOG_LEVEL = 0x0019,
+    MSG_CAPTURE = 0x001B,
+    MSG_GET_TASK_STATS = 0x001C,
+    MSG_GET_QUEUE_STATS = 0x001D,
+    MSG_GET_STACK_STATS = 0x001E,
+    MSG_GET_CPU_STATS = 0x001F,
+};
+
+/* Channels, see "Channels" in README.md */
+enum Channel : unsigned {
+    CHANNEL_RESPONSE = 0,
+    CHANNEL_EVENT = 1,
+    CHANNEL_TELEMETRY = 2,
+    CHANNEL_LOG = 3,
+};
+
+struct Frame {
+    uint16_t type = 0;
+    std::vector<uint8_t> data;
+};
+
+/* Reply to a version 3 request, without the sequence number */
+struct Response {
+    uint8_t status = STATUS_NO_REPLY;
+    std::vector<uint8_t> data;
+};
+
+/* Splits a byte stream into frames and the text sent outside frames */
+class FrameDecoder {
+public:
+    using FrameHandler = std::function<void(const Frame &)>;
+    using TextHandler = std::function<void(const uint8_t *, size_t)>;
+
+    FrameDecoder(FrameHandler onFrame, TextHandler onText);
+
+    /* Framing used for the frames that start after this call */
+    void setVersion(int version);
+    int version() const { return version_; }
+
+    void feed(const uint8_t *data, size_t length);
+
+    /* Frames dropped for a bad check, a wrong length or an overflow */
+    uint64_t badFrames() const { return badFrames_; }
+
+private:
+    void endFrame();
+
+    FrameHandler onFrame_;
+    TextHandler onText_;
+    int version_ = 1;
+    int frameVersion_ = 1;
+    bool inFrame_ = false;
+    bool inEscape_ = false;
+    bool overflow_ = false;
+    std::vector<uint8_t> buffer_;
+    uint64_t badFrames_ = 0;
+};
+
+/****************************************************************************/
+/***        Exported Functions                                            ***/
+/****************************************************************************/
+
+inline unsigned channelOf(uint16_t type)
+{
+    return (type >> 8) & 0x0F;
+}
+
+/* CRC-16/CCITT as used by protocol versions 2 and 3 */
+uint16_t crc16(uint16_t crc, const uint8_t *data, size_t length);
+
+/* Appends one escaped frame to out. In version 3 the caller puts the sequence number in data. */
+void encodeFrame(int version, uint16_t type, const uint8_t *data, size_t length, std::vector<uint8_t> &out);
+
+} // namespace lumi
+
+#endif /* LUMI_FRAME_H */
+
+/****************************************************************************/
+/***        END OF FILE                                                   ***/
+/****************************************************************************/
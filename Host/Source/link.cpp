@@ -0,0 +1,456 @@
+/****************************************************************************
+ *
+ * MODULE:              Lumi Router
+ *
+ * COMPONENT:           link.cpp
+ *
+ * DESCRIPTION:         Serial link to the router firmware
+ *
+ ****************************************************************************
+ *
+ * This software is owned by NXP B.V. and/or its supplier and is protected
+ * under applicable copyright laws. All rights are reserved. We grant You,
+ * and any third parties, a license to use this software solely and
+ * exclusively on NXP products [NXP Microcontrollers such as JN5168, JN5179].
+ * You, and any third parties must reproduce the copyright and warranty notice
+ * and any other legend of ownership on each copy or partial copy of the
+ * software.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+ * AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+ * IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE
+ * ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE
+ * LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR
+ * CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF
+ * SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS
+ * INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN
+ * CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE)
+ * ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+ * POSSIBILITY OF SUCH DAMAGE.
+ *
+ * Copyright NXP B.V. 2016. All rights reserved
+ *
+ ****************************************************************************/
+/****************************************************************************/
+/***        Include Files                                                 ***/
+/****************************************************************************/
+
+#include "link.h"
+
+#include <sys/epoll.h>
+#include <unistd.h>
+
+#include <algorithm>
+#include <cerrno>
+
+#include "serial_port.h"
+
+namespace lumi {
+
+/****************************************************************************/
+/***        Local Functions                                               ***/
+/****************************************************************************/
+
+namespace {
+
+constexpr size_t READ_SIZE = 512;
+
+/* Requests after which the firmware resets or changes rate, so nothing else may be in flight */
+bool isBarrier(uint16_t type)
+{
+    return type == MSG_RESET || type == MSG_ERASE_PERSISTENT_DATA || type == MSG_SET_BAUD_RATE;
+}
+
+uint32_t readBigEndian32(const std::vector<uint8_t> &data)
+{
+    return (static_cast<uint32_t>(data[0]) << 24) | (static_cast<uint32_t>(data[1]) << 16) |
+           (static_cast<uint32_t>(data[2]) << 8) | data[3];
+}
+
+} // namespace
+
+/****************************************************************************/
+/***        Exported Functions                                            ***/
+/****************************************************************************/
+
+Link::Link(EventLoop &loop, int fd, LinkOptions options)
+    : loop_(loop),
+      fd_(fd),
+      options_(options),
+      decoder_([this](const Frame &frame) { handleFrame(frame); },
+               [this](const uint8_t *text, size_t length) {
+                   if (textHandler_) {
+                       textHandler_(text, length);
+                   }
+               })
+{
+    loop_.add(fd_, EPOLLIN, [this](uint32_t events) { handleEvents(events); });
+}
+
+Link::~Link()
+{
+    loop_.cancel(probeTimer_);
+    loop_.cancel(restartTimer_);
+    for (Request &request : inFlight_) {
+        loop_.cancel(request.timer);
+    }
+    if (state_ != LinkState::LOST) {
+        loop_.remove(fd_);
+    }
+    close(fd_);
+}
+
+void Link::start()
+{
+    if (state_ == LinkState::LOST) {
+        return;
+    }
+
+    /* An end character drops any partial frame the firmware holds from before */
+    out_.push_back(SL_END_CHAR);
+    probeVersion_ = 1;
+    negotiate();
+}
+
+void Link::request(uint16_t type, std::vector<uint8_t> data, ReplyHandler done)
+{
+    if (type == MSG_SET_PROTOCOL_VERSION || state_ == LinkState::LOST) {
+        Response response;
+        response.status = (state_ == LinkState::LOST) ? STATUS_NO_REPLY : STATUS_REFUSED;
+        loop_.callAfter(std::chrono::milliseconds(0), [done, response] { done(response); });
+        return;
+    }
+
+    stats_.requests++;
+    queue_.push_back(Request{type, std::move(data), std::move(done)});
+    pump();
+}
+
+LinkStats Link::stats() const
+{
+    LinkStats stats = stats_;
+    stats.badFrames = decoder_.badFrames();
+    return stats;
+}
+
+/****************************************************************************/
+/***        Local Functions                                               ***/
+/****************************************************************************/
+
+/* The firmware may be in any version after a restart of the host, so each framing is tried in turn */
+void Link::negotiate()
+{
+    std::vector<uint8_t> data;
+
+    if (probeVersion_ >= 3) {
+        probeSeq_ = nextSeq_++;
+        data.push_back(probeSeq_);
+    }
+    data.push_back(PROTOCOL_VERSION);
+
+    /* The reply comes back in the framing the firmware was using */
+    decoder_.setVersion(probeVersion_);
+    write(MSG_SET_PROTOCOL_VERSION, data, probeVersion_);
+
+    probeTimer_ = loop_.callAfter(options_.replyTimeout, [this] {
+        probeTimer_ = 0;
+        probeVersion_ = (probeVersion_ % PROTOCOL_VERSION) + 1;
+        negotiate();
+    });
+}
+
+void Link::handleFrame(const Frame &frame)
+{
+    if (state_ == LinkState::STARTING && handleVersionReply(frame)) {
+        return;
+    }
+
+    if ((frame.type & RESPONSE_FLAG) != 0) {
+        if (state_ == LinkState::READY) {
+            handleReply(frame);
+        }
+        return;
+    }
+
+    if (frameHandler_) {
+        frameHandler_(frame);
+    }
+}
+
+bool Link::handleVersionReply(const Frame &frame)
+{
+    const uint8_t *reply;
+
+    if (probeVersion_ >= 3) {
+        if (frame.type != (MSG_SET_PROTOCOL_VERSION | RESPONSE_FLAG) || frame.data.size() < 4 ||
+            frame.data[0] != probeSeq_ || frame.data[1] != 0) {
+            return false;
+        }
+        reply = &frame.data[2];
+    }
+    else {
+        if (frame.type != MSG_SET_PROTOCOL_VERSION || frame.data.size() < 2) {
+            return false;
+        }
+        reply = &frame.data[0];
+    }
+
+    if (reply[0] != PROTOCOL_VERSION) {
+        /* Firmware without version 3 stays where it is; the next probe asks again */
+        return true;
+    }
+
+    loop_.cancel(probeTimer_);
+    probeTimer_ = 0;
+    decoder_.setVersion(PROTOCOL_VERSION);
+    window_ = std::max<unsigned>(reply[1], 1);
+    setState(LinkState::READY);
+    pump();
+    return true;
+}
+
+void Link::handleReply(const Frame &frame)
+{
+    if (frame.data.size() < 2) {
+        stats_.staleReplies++;
+        return;
+    }
+
+    uint16_t type = frame.type & ~RESPONSE_FLAG;
+    auto it = std::find_if(inFlight_.begin(), inFlight_.end(), [&](const Request &request) {
+        return request.seq == frame.data[0] && request.type == type;
+    });
+    if (it == inFlight_.end()) {
+        stats_.staleReplies++;
+        return;
+    }
+
+    Request request = std::move(*it);
+    inFlight_.erase(it);
+    loop_.cancel(request.timer);
+
+    Response response;
+    response.status = frame.data[1];
+    response.data.assign(frame.data.begin() + 2, frame.data.end());
+
+    if (isBarrier(type)) {
+        barrierInFlight_ = false;
+        if (response.status == 0) {
+            if (type == MSG_SET_BAUD_RATE) {
+                /* The reply came at the old rate; a valid frame at the new rate must follow within 2 seconds */
+                setSerialBaudRate(fd_, readBigEndian32(request.data));
+                queue_.push_front(Request{MSG_GET_POOL_STATS, {}, [](const Response &) {}});
+            }
+            else {
+                restart(options_.restartDelay);
+            }
+        }
+    }
+
+    request.done(response);
+    pump();
+}
+
+void Link::pump()
+{
+    while (state_ == LinkState::READY && !queue_.empty() && !barrierInFlight_) {
+        Request &next = queue_.front();
+
+        if (next.type == MSG_BENCHMARK_DATA) {
+            /* No sequence number and no reply */
+            write(next.type, next.data, PROTOCOL_VERSION);
+            loop_.callAfter(std::chrono::milliseconds(0), [done = std::move(next.done)] { done(Response{0, {}}); });
+            queue_.pop_front();
+            continue;
+        }
+
+        if (inFlight_.size() >= window_ || (isBarrier(next.type) && !inFlight_.empty())) {
+            break;
+        }
+
+        next.seq = nextSeq_++;
+        barrierInFlight_ = isBarrier(next.type);
+        inFlight_.push_back(std::move(next));
+        queue_.pop_front();
+        transmit(inFlight_.back());
+    }
+}
+
+void Link::transmit(Request &request)
+{
+    std::vector<uint8_t> data;
+
+    data.reserve(request.data.size() + 1);
+    data.push_back(request.seq);
+    data.insert(data.end(), request.data.begin(), request.data.end());
+
+    request.attempts++;
+    write(request.type, data, PROTOCOL_VERSION);
+    if (state_ == LinkState::LOST) {
+        /* lose() has already failed the request */
+        return;
+    }
+
+    uint8_t seq = request.seq;
+    request.timer = loop_.callAfter(options_.replyTimeout, [this, seq] { expire(seq); });
+}
+
+void Link::expire(uint8_t seq)
+{
+    auto it = std::find_if(inFlight_.begin(), inFlight_.end(), [seq](const Request &request) {
+        return request.seq == seq;
+    });
+    if (it == inFlight_.end()) {
+        return;
+    }
+
+    if (it->attempts <= options_.retries) {
+        /* Same sequence number, so the firmware answers from its cache if it already ran it */
+        stats_.retransmits++;
+        transmit(*it);
+        return;
+    }
+
+    /* The firmware stopped answering; it may have reset and gone back to version 1 */
+    stats_.failures++;
+    restart(std::chrono::milliseconds(0));
+}
+
+/* Fails everything in flight, as the firmware may have reset and lost its reply cache */
+void Link::restart(std::chrono::milliseconds delay)
+{
+    std::list<Request> failed;
+
+    stats_.restarts++;
+    failed.swap(inFlight_);
+    barrierInFlight_ = false;
+    loop_.cancel(probeTimer_);
+    probeTimer_ = 0;
+    setState(LinkState::STARTING);
+
+    for (Request &request : failed) {
+        loop_.cancel(request.timer);
+    }
+    for (Request &request : failed) {
+        request.done(Response{});
+    }
+
+    loop_.cancel(restartTimer_);
+    restartTimer_ = loop_.callAfter(delay, [this] {
+        restartTimer_ = 0;
+        start();
+    });
+}
+
+void Link::setState(LinkState state)
+{
+    if (state != state_) {
+        state_ = state;
+        if (stateHandler_) {
+            stateHandler_(state);
+        }
+    }
+}
+
+void Link::write(uint16_t type, const std::vector<uint8_t> &data, int version)
+{
+    encodeFrame(version, type, data.data(), data.size(), out_);
+    flush();
+}
+
+void Link::flush()
+{
+    size_t written = 0;
+
+    while (written < out_.size()) {
+        ssize_t count = ::write(fd_, out_.data() + written, out_.size() - written);
+        if (count > 0) {
+            written += static_cast<size_t>(count);
+        }
+        else if (count < 0 && errno == EINTR) {
+            continue;
+        }
+        else if (count < 0 && errno == EAGAIN) {
+            break;
+        }
+        else {
+            lose();
+            return;
+        }
+    }
+    out_.erase(out_.begin(), out_.begin() + static_cast<std::ptrdiff_t>(written));
+
+    bool waiting = !out_.empty();
+    if (waiting != waitingToWrite_ && state_ != LinkState::LOST) {
+        waitingToWrite_ = waiting;
+        loop_.modify(fd_, waiting ? (EPOLLIN | EPOLLOUT) : EPOLLIN);
+    }
+}
+
+void Link::handleEvents(uint32_t events)
+{
+    if (events & EPOLLIN) {
+        uint8_t buffer[READ_SIZE];
+
+        for (;;) {
+            ssize_t count = read(fd_, buffer, sizeof(buffer));
+            if (count > 0) {
+                decoder_.feed(buffer, static_cast<size_t>(count));
+                if (state_ == LinkState::LOST) {
+                    return;
+                }
+            }
+            else if (count < 0 && errno == EINTR) {
+                continue;
+            }
+            else if (count < 0 && errno == EAGAIN) {
+                break;
+            }
+            else {
+                lose();
+                return;
+            }
+        }
+    }
+    else if (events & (EPOLLERR | EPOLLHUP)) {
+        lose();
+        return;
+    }
+
+    if (events & EPOLLOUT) {
+        flush();
+    }
+}
+
+void Link::lose()
+{
+    std::list<Request> failed;
+    std::deque<Request> queued;
+
+    if (state_ == LinkState::LOST) {
+        return;
+    }
+
+    loop_.remove(fd_);
+    loop_.cancel(probeTimer_);
+    loop_.cancel(restartTimer_);
+    probeTimer_ = restartTimer_ = 0;
+    out_.clear();
+    failed.swap(inFlight_);
+    queued.swap(queue_);
+    setState(LinkState::LOST);
+
+    for (Request &request : failed) {
+        loop_.cancel(request.timer);
+        request.done(Response{});
+    }
+    for (Request &request : queued) {
+        request.done(Response{});
+    }
+}
+
+} // namespace lumi
+
+/****************************************************************************/
+/***        END OF FILE                                                   ***/
+/****************************************************************************/
@@ -0,0 +1,178 @@
+/****************************************************************************
+ *
+ * MODULE:              Lumi Router
+ *
+ * COMPONENT:           link.h
+ *
+ * DESCRIPTION:         Serial link to the router firmware
+ *
+ ****************************************************************************
+ *
+ * This software is owned by NXP B.V. and/or its supplier and is protected
+ * under applicable copyright laws. All rights are reserved. We grant You,
+ * and any third parties, a license to use this software solely and
+ * exclusively on NXP products [NXP Microcontrollers such as JN5168, JN5179].
+ * You, and any third parties must reproduce the copyright and warranty notice
+ * and any other legend of ownership on each copy or partial copy of the
+ * software.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+ * AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+ * IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE
+ * ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE
+ * LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR
+ * CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF
+ * SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS
+ * INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN
+ * CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE)
+ * ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+ * POSSIBILITY OF SUCH DAMAGE.
+ *
+ * Copyright NXP B.V. 2016. All rights reserved
+ *
+ ****************************************************************************/
+/****************************************************************************/
+/***        Include Files                                                 ***/
+/****************************************************************************/
+
+#ifndef LUMI_LINK_H
+#define LUMI_LINK_H
+
+#include <chrono>
+#include <cstdint>
+#include <deque>
+#include <functional>
+#include <list>
+#include <vector>
+
+#include "event_loop.h"
+#include "frame.h"
+
+namespace lumi {
+
+/****************************************************************************/
+/***        Type Definitions                                              ***/
+/****************************************************************************/
+
+struct LinkOptions {
+    /* Time to wait for a reply before sending a request again */
+    std::chrono::milliseconds replyTimeout{500};
+    /* Repeats of an unanswered request before it fails and the link restarts */
+    unsigned retries = 3;
+    /* Time the firmware takes to boot after a reset or an erase */
+    std::chrono::milliseconds restartDelay{2000};
+};
+
+enum class LinkState {
+    /* Finding the framing in use and switching to version 3 */
+    STARTING,
+    READY,
+    /* The port went away; nothing more will be sent */
+    LOST,
+};
+
+struct LinkStats {
+    uint64_t requests = 0;
+    uint64_t retransmits = 0;
+    uint64_t failures = 0;
+    uint64_t restarts = 0;
+    /* Replies that matched no request, such as a second reply to a repeat */
+    uint64_t staleReplies = 0;
+    uint64_t badFrames = 0;
+};
+
+/*
+ * Keeps a tty to the firmware in protocol version 3 and pipelines requests
+ * over it, up to the window size the firmware reports. Requests that reset
+ * the chip or change the baud rate are sent on their own. Frames that are
+ * not replies, and text sent outside frames, go to the frame and text
+ * handlers.
+ */
+class Link {
+public:
+    using ReplyHandler = std::function<void(const Response &)>;
+    using FrameHandler = std::function<void(const Frame &)>;
+    using TextHandler = FrameDecoder::TextHandler;
+    using StateHandler = std::function<void(LinkState)>;
+
+    /* Takes ownership of fd, which must be non-blocking */
+    Link(EventLoop &loop, int fd, LinkOptions options = {});
+    ~Link();
+    Link(const Link &) = delete;
+    Link &operator=(const Link &) = delete;
+
+    void start();
+
+    /*
+     * Queues a request. done is called exactly once, from the event loop, with
+     * the reply, STATUS_NO_REPLY if every attempt went unanswered or the link
+     * restarted, or STATUS_REFUSED for a version change, which the link owns.
+     */
+    void request(uint16_t type, std::vector<uint8_t> data, ReplyHandler done);
+
+    void onFrame(FrameHandler handler) { frameHandler_ = std::move(handler); }
+    void onText(TextHandler handler) { textHandler_ = std::move(handler); }
+    void onState(StateHandler handler) { stateHandler_ = std::move(handler); }
+
+    LinkState state() const { return state_; }
+    unsigned window() const { return window_; }
+    LinkStats stats() const;
+
+private:
+    struct Request {
+        uint16_t type;
+        std::vector<uint8_t> data;
+        ReplyHandler done;
+        uint8_t seq = 0;
+        unsigned attempts = 0;
+        EventLoop::TimerId timer = 0;
+    };
+
+    void negotiate();
+    void handleFrame(const Frame &frame);
+    bool handleVersionReply(const Frame &frame);
+    void handleReply(const Frame &frame);
+    void pump();
+    void transmit(Request &request);
+    void expire(uint8_t seq);
+    void restart(std::chrono::milliseconds delay);
+    void setState(LinkState state);
+    void write(uint16_t type, const std::vector<uint8_t> &data, int version);
+    void flush();
+    void handleEvents(uint32_t events);
+    void lose();
+
+    EventLoop &loop_;
+    int fd_;
+    LinkOptions options_;
+    FrameDecoder decoder_;
+    LinkState state_ = LinkState::STARTING;
+    LinkStats stats_;
+
+    /* Framing of the current version request, tried from 1 upwards */
+    int probeVersion_ = 1;
+    uint8_t probeSeq_ = 0;
+    EventLoop::TimerId probeTimer_ = 0;
+    EventLoop::TimerId restartTimer_ = 0;
+
+    unsigned window_ = 1;
+    uint8_t nextSeq_ = 0;
+    bool barrierInFlight_ = false;
+    std::deque<Request> queue_;
+    std::list<Request> inFlight_;
+
+    std::vector<uint8_t> out_;
+    bool waitingToWrite_ = false;
+
+    FrameHandler frameHandler_;
+    TextHandler textHandler_;
+    StateHandler stateHandler_;
+};
+
+} // namespace lumi
+
+#endif /* LUMI_LINK_H */
+
+/****************************************************************************/
+/***        END OF FILE                                                   ***/
+/****************************************************************************/
@@ -0,0 +1,250 @@
+/****************************************************************************
+ *
+ * MODULE:              Lumi Router
+ *
+ * COMPONENT:           log.cpp
+ *
+ * DESCRIPTION:         Decoder for the firmware's tokenized log
+ *
+ ****************************************************************************
+ *
+ * This software is owned by NXP B.V. and/or its supplier and is protected
+ * under applicable copyright laws. All rights are reserved. We grant You,
+ * and any third parties, a license to use this software solely and
+ * exclusively on NXP products [NXP Microcontrollers such as JN5168, JN5179].
+ * You, and any third parties must reproduce the copyright and warranty notice
+ * and any other legend of ownership on each copy or partial copy of the
+ * software.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+ * AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+ * IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE
+ * ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE
+ * LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR
+ * CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF
+ * SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS
+ * INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN
+ * CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE)
+ * ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+ * POSSIBILITY OF SUCH DAMAGE.
+ *
+ * Copyright NXP B.V. 2016. All rights reserved
+ *
+ ****************************************************************************/
+/****************************************************************************/
+/***        Include Files                                                 ***/
+/****************************************************************************/
+
+#include "log.h"
+
+#include <cctype>
+#include <cstdio>
+#include <cstring>
+#include <fstream>
+#include <sstream>
+#include <stdexcept>
+
+namespace lumi {
+
+/****************************************************************************/
+/***        Macro Definitions                                             ***/
+/****************************************************************************/
+
+namespace {
+
+/* length (1), id (2), ticks (4) */
+constexpr size_t RECORD_HEADER_SIZE = 7;
+
+uint32_t getU32(const uint8_t *data)
+{
+    return (uint32_t(data[0]) << 24) | (uint32_t(data[1]) << 16) | (uint32_t(data[2]) << 8) | data[3];
+}
+
+/* The format as the preprocessor left it: a C string literal */
+bool unquote(const std::string &text, std::string &out)
+{
+    if (text.size() < 2 || text.front() != '"' || text.back() != '"') {
+        return false;
+    }
+    out.clear();
+    for (size_t i = 1; i + 1 < text.size(); i++) {
+        char c = text[i];
+        if (c == '\\' && i + 2 < text.size()) {
+            c = text[++i];
+            if (c == 'n') {
+                c = '\n';
+            }
+            else if (c == 't') {
+                c = '\t';
+            }
+        }
+        out.push_back(c);
+    }
+    return true;
+}
+
+/* One conversion with a width taken from the table, so no fixed buffer */
+template <typename T> void appendFormatted(std::string &text, const std::string &spec, T value)
+{
+    int size = std::snprintf(nullptr, 0, spec.c_str(), value);
+
+    if (size > 0) {
+        std::vector<char> buffer(size + 1);
+        std::snprintf(buffer.data(), buffer.size(), spec.c_str(), value);
+        text.append(buffer.data(), size);
+    }
+}
+
+} // namespace
+
+/****************************************************************************/
+/***        Exported Functions                                            ***/
+/****************************************************************************/
+
+void LogTable::load(std::istream &in)
+{
+    std::string line;
+    unsigned number = 0;
+
+    messages_.clear();
+    while (std::getline(in, line)) {
+        number++;
+        if (!line.empty() && line.back() == '\r') {
+            line.pop_back();
+        }
+        if (line.empty()) {
+            continue;
+        }
+
+        std::istringstream fields(line);
+        unsigned id;
+        LogMessage message;
+        std::string rest;
+        fields >> id >> message.name >> message.module >> message.level >> std::ws;
+        std::getline(fields, rest);
+        if (fields.fail() || id != messages_.size() || !unquote(rest, message.format)) {
+            throw std::runtime_error("log table line " + std::to_string(number) + " does not parse");
+        }
+        messages_.push_back(message);
+    }
+}
+
+void LogTable::load(const std::string &path)
+{
+    std::ifstream in(path);
+
+    if (!in) {
+        throw std::runtime_error("cannot open " + path);
+    }
+    load(in);
+}
+
+const LogMessage *LogTable::find(uint16_t id) const
+{
+    return id < messages_.size() ? &messages_[id] : nullptr;
+}
+
+std::string LogTable::format(const LogRecord &record) const
+{
+    const LogMessage *message = find(record.id);
+
+    if (message == nullptr) {
+        std::string text = "unknown message " + std::to_string(record.id);
+        for (uint32_t arg : record.args) {
+            char hex[12];
+            std::snprintf(hex, sizeof(hex), " %08x", arg);
+            text += hex;
+        }
+        return text;
+    }
+    return formatLog(message->format, record.args);
+}
+
+bool parseLogRecords(const uint8_t *data, size_t length, std::vector<LogRecord> &records)
+{
+    size_t offset = 0;
+
+    while (offset < length) {
+        size_t size = data[offset];
+        if (size < RECORD_HEADER_SIZE || (size - RECORD_HEADER_SIZE) % 4 != 0 || size > length - offset) {
+            return false;
+        }
+
+        const uint8_t *record = &data[offset];
+        LogRecord parsed;
+        parsed.id = static_cast<uint16_t>((record[1] << 8) | record[2]);
+        parsed.ticks = getU32(&record[3]);
+        for (size_t i = RECORD_HEADER_SIZE; i < size; i += 4) {
+            parsed.args.push_back(getU32(&record[i]));
+        }
+        records.push_back(parsed);
+        offset += size;
+    }
+    return true;
+}
+
+std::string formatLog(const std::string &format, const std::vector<uint32_t> &args)
+{
+    std::string text;
+    size_t next = 0;
+    size_t i = 0;
+
+    while (i < format.size()) {
+        if (format[i] != '%') {
+            text.push_back(format[i++]);
+            continue;
+        }
+
+        /* Flags, width and precision are passed on; length modifiers are
+         * dropped, as every argument is 32 bits */
+        std::string spec = "%";
+        size_t start = i++;
+        while (i < format.size() && std::strchr("-+ #0", format[i]) != nullptr) {
+            spec.push_back(format[i++]);
+        }
+        while (i < format.size() && (std::isdigit(static_cast<unsigned char>(format[i])) || format[i] == '.')) {
+            spec.push_back(format[i++]);
+        }
+        while (i < format.size() && std::strchr("hlzjt", format[i]) != nullptr) {
+            i++;
+        }
+        if (i >= format.size()) {
+            text.append(format, start, std::string::npos);
+            break;
+        }
+
+        char conversion = format[i++];
+        if (conversion == '%') {
+            text.push_back('%');
+            continue;
+        }
+        if (std::strchr("diuxXoc", conversion) == nullptr) {
+            /* Not something a 32-bit argument can stand for */
+            text.append(format, start, i - start);
+            continue;
+        }
+        if (next >= args.size()) {
+            text.push_back('?');
+            continue;
+        }
+
+        uint32_t arg = args[next++];
+        spec.push_back(conversion);
+        if (conversion == 'd' || conversion == 'i') {
+            appendFormatted(text, spec, static_cast<int32_t>(arg));
+        }
+        else if (conversion == 'c') {
+            appendFormatted(text, spec, static_cast<int>(arg & 0xFF));
+        }
+        else {
+            appendFormatted(text, spec, static_cast<unsigned>(arg));
+        }
+    }
+    return text;
+}
+
+} // namespace lumi
+
+/****************************************************************************/
+/***        END OF FILE                                                   ***/
+/****************************************************************************/
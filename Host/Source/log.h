@@ -0,0 +1,113 @@
+/****************************************************************************
+ *
+ * MODULE:              Lumi Router
+ *
+ * COMPONENT:           log.h
+ *
+ * DESCRIPTION:         Decoder for the firmware's tokenized log
+ *
+ ****************************************************************************
+ *
+ * This software is owned by NXP B.V. and/or its supplier and is protected
+ * under applicable copyright laws. All rights are reserved. We grant You,
+ * and any third parties, a license to use this software solely and
+ * exclusively on NXP products [NXP Microcontrollers such as JN5168, JN5179].
+ * You, and any third parties must reproduce the copyright and warranty notice
+ * and any other legend of ownership on each copy or partial copy of the
+ * software.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+ * AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+ * IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE
+ * ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE
+ * LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR
+ * CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF
+ * SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS
+ * INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN
+ * CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE)
+ * ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+ * POSSIBILITY OF SUCH DAMAGE.
+ *
+ * Copyright NXP B.V. 2016. All rights reserved
+ *
+ ****************************************************************************/
+/****************************************************************************/
+/***        Include Files                                                 ***/
+/****************************************************************************/
+
+#ifndef LUMI_LOG_H
+#define LUMI_LOG_H
+
+#include <cstddef>
+#include <cstdint>
+#include <istream>
+#include <string>
+#include <vector>
+
+namespace lumi {
+
+/****************************************************************************/
+/***        Macro Definitions                                             ***/
+/****************************************************************************/
+
+/* Unsolicited frame carrying log records, see "Log" in README.md */
+constexpr uint16_t MSG_LOG_RECORDS = 0x031A;
+
+/* The firmware clock the record timestamps count */
+constexpr uint32_t LOG_TICKS_PER_SECOND = 16000000;
+
+/****************************************************************************/
+/***        Type Definitions                                              ***/
+/****************************************************************************/
+
+/* One line of the <firmware>_log.txt table */
+struct LogMessage {
+    std::string name;
+    std::string module;
+    std::string level;
+    std::string format;
+};
+
+struct LogRecord {
+    uint16_t id = 0;
+    uint32_t ticks = 0;
+    std::vector<uint32_t> args;
+};
+
+/* Message table written by the firmware build. Ids are line numbers, so
+ * the table must come from the build that made the firmware. */
+class LogTable {
+public:
+    /* Throws std::runtime_error naming the line that does not parse */
+    void load(std::istream &in);
+    void load(const std::string &path);
+
+    /* nullptr for an id the table does not have */
+    const LogMessage *find(uint16_t id) const;
+
+    /* The record's message with its arguments filled in */
+    std::string format(const LogRecord &record) const;
+
+private:
+    std::vector<LogMessage> messages_;
+};
+
+/****************************************************************************/
+/***        Exported Functions                                            ***/
+/****************************************************************************/
+
+/* Appends the records in the data of a log frame. Returns false if the data
+ * ends in a malformed record; the records before it are kept. */
+bool parseLogRecords(const uint8_t *data, size_t length, std::vector<LogRecord> &records);
+
+/* printf on 32-bit arguments, for the integer conversions the firmware
+ * uses. A conversion with no argument left prints as "?". */
+std::string formatLog(const std::string &format, const std::vector<uint32_t> &args);
+
+} // namespace lumi
+
+#endif /* LUMI_LOG_H */
+
+/****************************************************************************/
+/***        END OF FILE                                                   ***/
+/****************************************************************************/
@@ -0,0 +1,228 @@
+/****************************************************************************
+ *
+ * MODULE:              Lumi Router
+ *
+ * COMPONENT:           lumictl.cpp
+ *
+ * DESCRIPTION:         Command line client of the daemon
+ *
+ ****************************************************************************
+ *
+ * This software is owned by NXP B.V. and/or its supplier and is protected
+ * under applicable copyright laws. All rights are reserved. We grant You,
+ * and any third parties, a license to use this software solely and
+ * exclusively on NXP products [NXP Microcontrollers such as JN5168, JN5179].
+ * You, and any third parties must reproduce the copyright and warranty notice
+ * and any other legend of ownership on each copy or partial copy of the
+ * software.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+ * AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+ * IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE
+ * ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE
+ * LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR
+ * CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF
+ * SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS
+ * INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN
+ * CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE)
+ * ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+ * POSSIBILITY OF SUCH DAMAGE.
+ *
+ * Copyright NXP B.V. 2016. All rights reserved
+ *
+ ****************************************************************************/
+/****************************************************************************/
+/***        Include Files                                                 ***/
+/****************************************************************************/
+
+#include <unistd.h>
+
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <exception>
+#include <string>
+#include <vector>
+
+#include "client.h"
+#include "log.h"
+
+/****************************************************************************/
+/***        Local Functions                                               ***/
+/****************************************************************************/
+
+namespace {
+
+void usage(const char *program)
+{
+    std::fprintf(stderr,
+                 "Usage: %s [-s socket] command\n"
+                 "  reset                  restart the chip\n"
+                 "  erase-pdm              erase persistent data and restart the chip\n"
+                 "  raw type [hex data]    send any request and print the reply\n"
+                 "  monitor [channel mask] print frames and text from the chip (default mask 0xE)\n"
+                 "  log table              print the log, decoded with the build's _log.txt table\n",
+                 program);
+}
+
+bool parseHex(const char *text, std::vector<uint8_t> &data)
+{
+    size_t length = std::strlen(text);
+
+    if (length % 2 != 0) {
+        return false;
+    }
+    for (size_t i = 0; i < length; i += 2) {
+        char byte[3] = {text[i], text[i + 1], '\0'};
+        char *end;
+        data.push_back(static_cast<uint8_t>(std::strtoul(byte, &end, 16)));
+        if (*end != '\0') {
+            return false;
+        }
+    }
+    return true;
+}
+
+void printHex(const std::vector<uint8_t> &data)
+{
+    for (uint8_t byte : data) {
+        std::printf("%02x", byte);
+    }
+    std::printf("\n");
+}
+
+int printResponse(const lumi::Response &response)
+{
+    switch (response.status) {
+    case 0:
+        printHex(response.data);
+        return 0;
+    case lumi::STATUS_NO_REPLY:
+        std::fprintf(stderr, "no reply from the chip\n");
+        return 1;
+    case lumi::STATUS_REFUSED:
+        std::fprintf(stderr, "refused by the daemon\n");
+        return 1;
+    default:
+        std::fprintf(stderr, "status %u\n", response.status);
+        return 1;
+    }
+}
+
+int monitor(lumi::Client &client, uint8_t channels)
+{
+    lumi::ClientEvent event;
+
+    client.subscribe(channels);
+    for (;;) {
+        if (!client.receive(event, std::chrono::hours(1))) {
+            continue;
+        }
+        if (event.kind == lumi::DAEMON_TEXT) {
+            std::fwrite(event.data.data(), 1, event.data.size(), stdout);
+            std::fflush(stdout);
+        }
+        else if (event.kind == lumi::DAEMON_FRAME) {
+            std::printf("%04x ", event.type);
+            printHex(event.data);
+            std::fflush(stdout);
+        }
+    }
+}
+
+int printLog(lumi::Client &client, const lumi::LogTable &table)
+{
+    lumi::ClientEvent event;
+    std::vector<lumi::LogRecord> records;
+
+    client.subscribe(1 << lumi::CHANNEL_LOG);
+    for (;;) {
+        if (!client.receive(event, std::chrono::hours(1)) || event.kind != lumi::DAEMON_FRAME ||
+            event.type != lumi::MSG_LOG_RECORDS) {
+            continue;
+        }
+        records.clear();
+        if (!lumi::parseLogRecords(event.data.data(), event.data.size(), records)) {
+            std::fprintf(stderr, "malformed log frame\n");
+        }
+        for (const lumi::LogRecord &record : records) {
+            const lumi::LogMessage *message = table.find(record.id);
+            std::printf("%11.6f %-18s %-5s %s\n",
+                        static_cast<double>(record.ticks) / lumi::LOG_TICKS_PER_SECOND,
+                        message != nullptr ? message->module.c_str() : "?",
+                        message != nullptr ? message->level.c_str() : "?",
+                        table.format(record).c_str());
+        }
+        std::fflush(stdout);
+    }
+}
+
+} // namespace
+
+/****************************************************************************/
+/***        Exported Functions                                            ***/
+/****************************************************************************/
+
+int main(int argc, char *argv[])
+{
+    std::string socketPath = lumi::DEFAULT_SOCKET_PATH;
+    int option;
+
+    while ((option = getopt(argc, argv, "s:h")) != -1) {
+        if (option == 's') {
+            socketPath = optarg;
+        }
+        else {
+            usage(argv[0]);
+            return 2;
+        }
+    }
+    if (optind >= argc) {
+        usage(argv[0]);
+        return 2;
+    }
+
+    std::string command = argv[optind];
+    int args = argc - optind - 1;
+    char **arg = &argv[optind + 1];
+
+    try {
+        lumi::Client client(socketPath);
+
+        if (command == "reset" && args == 0) {
+            return printResponse(client.request(lumi::MSG_RESET, {}));
+        }
+        if (command == "erase-pdm" && args == 0) {
+            return printResponse(client.request(lumi::MSG_ERASE_PERSISTENT_DATA, {}));
+        }
+        if (command == "raw" && (args == 1 || args == 2)) {
+            std::vector<uint8_t> data;
+            char *end;
+            unsigned long type = std::strtoul(arg[0], &end, 0);
+            if (*end != '\0' || type > 0xFFFF || (args == 2 && !parseHex(arg[1], data))) {
+                usage(argv[0]);
+                return 2;
+            }
+            return printResponse(client.request(static_cast<uint16_t>(type), data));
+        }
+        if (command == "log" && args == 1) {
+            lumi::LogTable table;
+            table.load(std::string(arg[0]));
+            return printLog(client, table);
+        }
+        if (command == "monitor" && args <= 1) {
+            return monitor(client, static_cast<uint8_t>(args == 1 ? std::strtoul(arg[0], nullptr, 0) : 0x0E));
+        }
+    }
+    catch (const std::exception &error) {
+        std::fprintf(stderr, "lumictl: %s\n", error.what());
+        return 1;
+    }
+
+    usage(argv[0]);
+    return 2;
+}
+
+/****************************************************************************/
+/***        END OF FILE                                                   ***/
+/****************************************************************************/
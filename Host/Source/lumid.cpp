@@ -0,0 +1,159 @@
+/****************************************************************************
+ *
+ * MODULE:              Lumi Router
+ *
+ * COMPONENT:           lumid.cpp
+ *
+ * DESCRIPTION:         Daemon keeping the router serial port open
+ *
+ ****************************************************************************
+ *
+ * This software is owned by NXP B.V. and/or its supplier and is protected
+ * under applicable copyright laws. All rights are reserved. We grant You,
+ * and any third parties, a license to use this software solely and
+ * exclusively on NXP products [NXP Microcontrollers such as JN5168, JN5179].
+ * You, and any third parties must reproduce the copyright and warranty notice
+ * and any other legend of ownership on each copy or partial copy of the
+ * software.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+ * AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+ * IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE
+ * ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE
+ * LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR
+ * CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF
+ * SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS
+ * INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN
+ * CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE)
+ * ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+ * POSSIBILITY OF SUCH DAMAGE.
+ *
+ * Copyright NXP B.V. 2016. All rights reserved
+ *
+ ****************************************************************************/
+/****************************************************************************/
+/***        Include Files                                                 ***/
+/****************************************************************************/
+
+#include <signal.h>
+#include <sys/epoll.h>
+#include <sys/signalfd.h>
+#include <unistd.h>
+
+#include <cstdio>
+#include <cstdlib>
+#include <exception>
+#include <string>
+
+#include "client_protocol.h"
+#include "daemon.h"
+#include "event_loop.h"
+#include "link.h"
+#include "serial_port.h"
+
+/****************************************************************************/
+/***        Local Functions                                               ***/
+/****************************************************************************/
+
+namespace {
+
+void usage(const char *program)
+{
+    std::fprintf(stderr,
+                 "Usage: %s -d device [-b baud] [-f] [-s socket]\n"
+                 "  -d device  serial port of the router chip\n"
+                 "  -b baud    rate the firmware is running at (default 115200)\n"
+                 "  -f         use RTS/CTS flow control\n"
+                 "  -s socket  path of the client socket (default %s)\n",
+                 program, lumi::DEFAULT_SOCKET_PATH);
+}
+
+const char *stateName(lumi::LinkState state)
+{
+    switch (state) {
+    case lumi::LinkState::STARTING:
+        return "starting";
+    case lumi::LinkState::READY:
+        return "ready";
+    default:
+        return "lost";
+    }
+}
+
+} // namespace
+
+/****************************************************************************/
+/***        Exported Functions                                            ***/
+/****************************************************************************/
+
+int main(int argc, char *argv[])
+{
+    std::string device;
+    std::string socketPath = lumi::DEFAULT_SOCKET_PATH;
+    unsigned baudRate = 115200;
+    bool flowControl = false;
+    int option;
+
+    while ((option = getopt(argc, argv, "d:b:fs:h")) != -1) {
+        switch (option) {
+        case 'd':
+            device = optarg;
+            break;
+        case 'b':
+            baudRate = static_cast<unsigned>(std::strtoul(optarg, nullptr, 10));
+            break;
+        case 'f':
+            flowControl = true;
+            break;
+        case 's':
+            socketPath = optarg;
+            break;
+        default:
+            usage(argv[0]);
+            return 2;
+        }
+    }
+    if (device.empty() || optind != argc) {
+        usage(argv[0]);
+        return 2;
+    }
+
+    try {
+        lumi::EventLoop loop;
+        int exitCode = 0;
+
+        sigset_t signals;
+        sigemptyset(&signals);
+        sigaddset(&signals, SIGINT);
+        sigaddset(&signals, SIGTERM);
+        sigprocmask(SIG_BLOCK, &signals, nullptr);
+        int signalFd = signalfd(-1, &signals, SFD_NONBLOCK | SFD_CLOEXEC);
+        loop.add(signalFd, EPOLLIN, [&loop](uint32_t) { loop.stop(); });
+
+        lumi::Link link(loop, lumi::openSerialPort(device, baudRate, flowControl));
+        lumi::Daemon daemon(loop, link, socketPath);
+
+        link.onState([&](lumi::LinkState state) {
+            std::fprintf(stderr, "lumid: link %s\n", stateName(state));
+            if (state == lumi::LinkState::LOST) {
+                /* The port has gone, so exit and let the init system start us again */
+                exitCode = 1;
+                loop.stop();
+            }
+        });
+        link.start();
+        loop.run();
+
+        loop.remove(signalFd);
+        close(signalFd);
+        return exitCode;
+    }
+    catch (const std::exception &error) {
+        std::fprintf(stderr, "lumid: %s\n", error.what());
+        return 1;
+    }
+}
+
+/****************************************************************************/
+/***        END OF FILE                                                   ***/
+/****************************************************************************/
@@ -0,0 +1,274 @@
+/****************************************************************************
+ *
+ * MODULE:              Lumi Router
+ *
+ * COMPONENT:           fake_firmware.cpp
+ *
+ * DESCRIPTION:         Router firmware stand-in on a pseudo-terminal
+ *
+ ****************************************************************************
+ *
+ * This software is owned by NXP B.V. and/or its supplier and is protected
+ * under applicable copyright laws. All rights are reserved. We grant You,
+ * and any third parties, a license to use this software solely and
+ * exclusively on NXP products [NXP Microcontrollers such as JN5168, JN5179].
+ * You, and any third parties must reproduce the copyright and warranty notice
+ * and any other legend of ownership on each copy or partial copy of the
+ * software.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+ * AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+ * IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE
+ * ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE
+ * LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR
+ * CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF
+ * SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS
+ * INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN
+ * CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE)
+ * ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+ * POSSIBILITY OF SUCH DAMAGE.
+ *
+ * Copyright NXP B.V. 2016. All rights reserved
+ *
+ ****************************************************************************/
+/****************************************************************************/
+/***        Include Files                                                 ***/
+/****************************************************************************/
+
+#include "fake_firmware.h"
+
+#include <fcntl.h>
+#include <poll.h>
+#include <sys/eventfd.h>
+#include <termios.h>
+#include <unistd.h>
+
+#include <algorithm>
+#include <cerrno>
+#include <cstdlib>
+#include <stdexcept>
+
+/****************************************************************************/
+/***        Macro Definitions                                             ***/
+/****************************************************************************/
+
+namespace {
+
+constexpr uint8_t WINDOW = 4;
+/* Quiet time on the line before held requests are answered */
+constexpr int QUIET_MS = 20;
+const std::string BOOT_TEXT = "Router started..";
+
+} // namespace
+
+/****************************************************************************/
+/***        Exported Functions                                            ***/
+/****************************************************************************/
+
+FakeFirmware::FakeFirmware(int version)
+    : decoder_([this](const lumi::Frame &frame) { handleFrame(frame); }, nullptr), version_(version)
+{
+    masterFd_ = posix_openpt(O_RDWR | O_NOCTTY | O_CLOEXEC);
+    if (masterFd_ < 0 || grantpt(masterFd_) < 0 || unlockpt(masterFd_) < 0) {
+        throw std::runtime_error("no pseudo-terminal");
+    }
+    devicePath_ = ptsname(masterFd_);
+
+    /* Held open so the master never sees a hangup between hosts, and raw from the start */
+    slaveFd_ = open(devicePath_.c_str(), O_RDWR | O_NOCTTY | O_CLOEXEC);
+    termios tio = {};
+    tcgetattr(slaveFd_, &tio);
+    cfmakeraw(&tio);
+    tcsetattr(slaveFd_, TCSANOW, &tio);
+
+    decoder_.setVersion(version);
+    stopFd_ = eventfd(0, EFD_CLOEXEC);
+    thread_ = std::thread([this] { run(); });
+}
+
+FakeFirmware::~FakeFirmware()
+{
+    uint64_t one = 1;
+    if (::write(stopFd_, &one, sizeof(one)) == sizeof(one)) {
+        thread_.join();
+    }
+    else {
+        thread_.detach();
+    }
+    close(stopFd_);
+    close(slaveFd_);
+    close(masterFd_);
+}
+
+void FakeFirmware::dropFirst(uint16_t type)
+{
+    std::lock_guard<std::mutex> lock(mutex_);
+    dropFirst_.insert(type);
+}
+
+void FakeFirmware::sendFrame(uint16_t type, const std::vector<uint8_t> &data)
+{
+    writeFrame(version_, type, data);
+}
+
+void FakeFirmware::sendText(const std::string &text)
+{
+    write(std::vector<uint8_t>(text.begin(), text.end()));
+}
+
+unsigned FakeFirmware::received(uint16_t type)
+{
+    std::lock_guard<std::mutex> lock(mutex_);
+    return received_[type];
+}
+
+/****************************************************************************/
+/***        Local Functions                                               ***/
+/****************************************************************************/
+
+void FakeFirmware::run()
+{
+    pollfd fds[2] = {{masterFd_, POLLIN, 0}, {stopFd_, POLLIN, 0}};
+    uint8_t buffer[512];
+
+    for (;;) {
+        int ready = poll(fds, 2, QUIET_MS);
+        if (ready < 0 && errno == EINTR) {
+            continue;
+        }
+        if (ready <= 0) {
+            answerHeld();
+            continue;
+        }
+        if (fds[1].revents) {
+            return;
+        }
+        if (fds[0].revents & POLLIN) {
+            ssize_t count = read(masterFd_, buffer, sizeof(buffer));
+            if (count > 0) {
+                decoder_.feed(buffer, static_cast<size_t>(count));
+            }
+        }
+    }
+}
+
+void FakeFirmware::handleFrame(const lumi::Frame &frame)
+{
+    int version = version_;
+    size_t seqSize = (version >= 3) ? 1 : 0;
+
+    if (frame.data.size() < seqSize) {
+        return;
+    }
+
+    if (frame.type == lumi::MSG_SET_PROTOCOL_VERSION) {
+        if (frame.data.size() != seqSize + 1) {
+            /* Such as a version 2 request read as version 3, where the version becomes the sequence number */
+            if (version >= 3) {
+                writeFrame(version, frame.type | lumi::RESPONSE_FLAG, {frame.data[0], 1});
+            }
+            return;
+        }
+
+        /* Answered at once in the old framing; the new version applies from the next frame */
+        int requested = frame.data[seqSize];
+        int now = (requested >= 1 && requested <= 3) ? requested : version;
+        versionRequests_++;
+        if (version >= 3) {
+            writeFrame(version, frame.type | lumi::RESPONSE_FLAG,
+                       {frame.data[0], 0, static_cast<uint8_t>(now), WINDOW});
+        }
+        else {
+            writeFrame(version, frame.type, {static_cast<uint8_t>(now), WINDOW});
+        }
+        version_ = now;
+        decoder_.setVersion(now);
+        return;
+    }
+
+    if (version < 3 || frame.type == lumi::MSG_BENCHMARK_DATA) {
+        return;
+    }
+
+    std::lock_guard<std::mutex> lock(mutex_);
+    uint8_t seq = frame.data[0];
+    received_[frame.type]++;
+
+    if (dropFirst_.erase(frame.type) != 0) {
+        return;
+    }
+    auto cached = std::find_if(cache_.begin(), cache_.end(), [&](const auto &entry) {
+        return entry.first == std::make_pair(frame.type, seq);
+    });
+    if (cached != cache_.end()) {
+        writeFrame(version, frame.type | lumi::RESPONSE_FLAG, cached->second);
+        return;
+    }
+    if (std::any_of(held_.begin(), held_.end(), [&](const Held &held) {
+            return held.type == frame.type && held.seq == seq;
+        })) {
+        return;
+    }
+
+    held_.push_back(Held{frame.type, seq, std::vector<uint8_t>(frame.data.begin() + 1, frame.data.end())});
+    maxOutstanding_ = std::max<unsigned>(maxOutstanding_, static_cast<unsigned>(held_.size()));
+}
+
+void FakeFirmware::answerHeld()
+{
+    bool reset = false;
+    std::lock_guard<std::mutex> lock(mutex_);
+
+    for (const Held &held : held_) {
+        std::vector<uint8_t> reply = {held.seq, 0};
+        reply.insert(reply.end(), held.data.begin(), held.data.end());
+        writeFrame(version_, held.type | lumi::RESPONSE_FLAG, reply);
+
+        cache_.emplace_back(std::make_pair(held.type, held.seq), reply);
+        if (cache_.size() > WINDOW) {
+            cache_.erase(cache_.begin());
+        }
+        reset = reset || held.type == lumi::MSG_RESET || held.type == lumi::MSG_ERASE_PERSISTENT_DATA;
+    }
+    held_.clear();
+
+    if (reset) {
+        boot();
+    }
+}
+
+/* As after a reset: version 1, an empty reply cache and the boot message */
+void FakeFirmware::boot()
+{
+    version_ = 1;
+    decoder_.setVersion(1);
+    cache_.clear();
+    sendText(BOOT_TEXT);
+}
+
+void FakeFirmware::write(const std::vector<uint8_t> &bytes)
+{
+    size_t written = 0;
+
+    while (written < bytes.size()) {
+        ssize_t count = ::write(masterFd_, bytes.data() + written, bytes.size() - written);
+        if (count > 0) {
+            written += static_cast<size_t>(count);
+        }
+        else if (count < 0 && errno != EINTR && errno != EAGAIN) {
+            return;
+        }
+    }
+}
+
+void FakeFirmware::writeFrame(int version, uint16_t type, const std::vector<uint8_t> &data)
+{
+    std::vector<uint8_t> bytes;
+
+    lumi::encodeFrame(version, type, data.data(), data.size(), bytes);
+    write(bytes);
+}
+
+/****************************************************************************/
+/***        END OF FILE                                                   ***/
+/****************************************************************************/
@@ -0,0 +1,119 @@
+/****************************************************************************
+ *
+ * MODULE:              Lumi Router
+ *
+ * COMPONENT:           fake_firmware.h
+ *
+ * DESCRIPTION:         Router firmware stand-in on a pseudo-terminal
+ *
+ ****************************************************************************
+ *
+ * This software is owned by NXP B.V. and/or its supplier and is protected
+ * under applicable copyright laws. All rights are reserved. We grant You,
+ * and any third parties, a license to use this software solely and
+ * exclusively on NXP products [NXP Microcontrollers such as JN5168, JN5179].
+ * You, and any third parties must reproduce the copyright and warranty notice
+ * and any other legend of ownership on each copy or partial copy of the
+ * software.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+ * AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+ * IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE
+ * ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE
+ * LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR
+ * CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF
+ * SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS
+ * INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN
+ * CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE)
+ * ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+ * POSSIBILITY OF SUCH DAMAGE.
+ *
+ * Copyright NXP B.V. 2016. All rights reserved
+ *
+ ****************************************************************************/
+/****************************************************************************/
+/***        Include Files                                                 ***/
+/****************************************************************************/
+
+#ifndef FAKE_FIRMWARE_H
+#define FAKE_FIRMWARE_H
+
+#include <atomic>
+#include <cstdint>
+#include <map>
+#include <mutex>
+#include <set>
+#include <string>
+#include <thread>
+#include <utility>
+#include <vector>
+
+#include "frame.h"
+
+/****************************************************************************/
+/***        Type Definitions                                              ***/
+/****************************************************************************/
+
+/*
+ * Speaks the serial protocol of README.md on the master side of a pty, with
+ * a window of 4. Requests are held until the line has been quiet for a
+ * moment and then all answered, so a test can see how many a host keeps in
+ * flight. Replies echo the request data.
+ */
+class FakeFirmware {
+public:
+    explicit FakeFirmware(int version);
+    ~FakeFirmware();
+
+    /* Path for the host to open */
+    const std::string &devicePath() const { return devicePath_; }
+
+    /* Ignore the first copy of the next request of this type */
+    void dropFirst(uint16_t type);
+    /* Send a frame that is not a reply, in the version in use */
+    void sendFrame(uint16_t type, const std::vector<uint8_t> &data);
+    void sendText(const std::string &text);
+
+    int version() const { return version_; }
+    unsigned maxOutstanding() const { return maxOutstanding_; }
+    /* Copies of requests of this type received, repeats included */
+    unsigned received(uint16_t type);
+    unsigned versionRequests() const { return versionRequests_; }
+
+private:
+    struct Held {
+        uint16_t type;
+        uint8_t seq;
+        std::vector<uint8_t> data;
+    };
+
+    void run();
+    void handleFrame(const lumi::Frame &frame);
+    void answerHeld();
+    void boot();
+    void write(const std::vector<uint8_t> &bytes);
+    void writeFrame(int version, uint16_t type, const std::vector<uint8_t> &data);
+
+    int masterFd_;
+    int slaveFd_;
+    int stopFd_;
+    std::string devicePath_;
+    lumi::FrameDecoder decoder_;
+    std::atomic<int> version_;
+    std::atomic<unsigned> maxOutstanding_{0};
+    std::atomic<unsigned> versionRequests_{0};
+
+    std::mutex mutex_;
+    std::set<uint16_t> dropFirst_;
+    std::map<uint16_t, unsigned> received_;
+    std::vector<Held> held_;
+    /* Last replies, for repeated requests */
+    std::vector<std::pair<std::pair<uint16_t, uint8_t>, std::vector<uint8_t>>> cache_;
+    std::thread thread_;
+};
+
+#endif /* FAKE_FIRMWARE_H */
+
+/****************************************************************************/
+/***        END OF FILE                                                   ***/
+/****************************************************************************/
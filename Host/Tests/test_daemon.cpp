@@ -0,0 +1,254 @@
+/****************************************************************************
+ *
+ * MODULE:              Lumi Router
+ *
+ * COMPONENT:           test_daemon.cpp
+ *
+ * DESCRIPTION:         Tests of the daemon against a firmware stand-in
+ *
+ ****************************************************************************
+ *
+ * This software is owned by NXP B.V. and/or its supplier and is protected
+ * under applicable copyright laws. All rights are reserved. We grant You,
+ * and any third parties, a license to use this software solely and
+ * exclusively on NXP products [NXP Microcontrollers such as JN5168, JN5179].
+ * You, and any third parties must reproduce the copyright and warranty notice
+ * and any other legend of ownership on each copy or partial copy of the
+ * software.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+ * AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+ * IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE
+ * ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE
+ * LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR
+ * CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF
+ * SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS
+ * INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN
+ * CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE)
+ * ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+ * POSSIBILITY OF SUCH DAMAGE.
+ *
+ * Copyright NXP B.V. 2016. All rights reserved
+ *
+ ****************************************************************************/
+/****************************************************************************/
+/***        Include Files                                                 ***/
+/****************************************************************************/
+
+#include <unistd.h>
+
+#include <chrono>
+#include <map>
+#include <memory>
+#include <string>
+#include <thread>
+
+#include "client.h"
+#include "daemon.h"
+#include "fake_firmware.h"
+#include "link.h"
+#include "serial_port.h"
+#include "test.h"
+
+using namespace std::chrono_literals;
+
+/****************************************************************************/
+/***        Type Definitions                                              ***/
+/****************************************************************************/
+
+namespace {
+
+/* The daemon, run on its own thread as lumid runs it */
+class Host {
+public:
+    Host(FakeFirmware &firmware, const std::string &socketPath)
+    {
+        lumi::LinkOptions options;
+        options.replyTimeout = 100ms;
+        options.restartDelay = 50ms;
+
+        link_ = std::make_unique<lumi::Link>(loop_, lumi::openSerialPort(firmware.devicePath(), 115200, false),
+                                             options);
+        daemon_ = std::make_unique<lumi::Daemon>(loop_, *link_, socketPath);
+        link_->start();
+        thread_ = std::thread([this] { loop_.run(); });
+    }
+
+    ~Host()
+    {
+        loop_.stop();
+        thread_.join();
+    }
+
+private:
+    lumi::EventLoop loop_;
+    std::unique_ptr<lumi::Link> link_;
+    std::unique_ptr<lumi::Daemon> daemon_;
+    std::thread thread_;
+};
+
+/****************************************************************************/
+/***        Local Variables                                               ***/
+/****************************************************************************/
+
+const std::string socketPath = "/tmp/lumid-test-" + std::to_string(getpid()) + ".sock";
+
+/****************************************************************************/
+/***        Local Functions                                               ***/
+/****************************************************************************/
+
+/* Switches a firmware in version 1 to version 3 before answering */
+void testFirstRequest()
+{
+    FakeFirmware firmware(1);
+    Host host(firmware, socketPath);
+    lumi::Client client(socketPath);
+
+    lumi::Response response = client.request(lumi::MSG_GET_LINK_STATS, {1, 2});
+    TEST_CHECK(response.status == 0);
+    TEST_CHECK((response.data == std::vector<uint8_t>{1, 2}));
+    TEST_CHECK(firmware.version() == 3);
+}
+
+void testPipelining()
+{
+    FakeFirmware firmware(1);
+    Host host(firmware, socketPath);
+    lumi::Client client(socketPath);
+    std::map<uint32_t, uint8_t> sent;
+    lumi::ClientEvent event;
+    unsigned answered = 0;
+
+    for (uint8_t i = 0; i < 8; i++) {
+        sent[client.send(lumi::MSG_GET_QUEUE_STATS, {i})] = i;
+    }
+    while (answered < sent.size() && client.receive(event, 2s)) {
+        TEST_CHECK(event.kind == lumi::DAEMON_REPLY && event.status == 0);
+        TEST_CHECK((event.data == std::vector<uint8_t>{sent[event.tag]}));
+        answered++;
+    }
+    TEST_CHECK(answered == 8);
+
+    /* Never more than the window, and the window is used */
+    TEST_CHECK(firmware.maxOutstanding() == 4);
+}
+
+void testRetransmit()
+{
+    FakeFirmware firmware(1);
+    Host host(firmware, socketPath);
+    lumi::Client client(socketPath);
+
+    firmware.dropFirst(lumi::MSG_GET_CPU_STATS);
+    lumi::Response response = client.request(lumi::MSG_GET_CPU_STATS, {7});
+    TEST_CHECK(response.status == 0);
+    TEST_CHECK((response.data == std::vector<uint8_t>{7}));
+    TEST_CHECK(firmware.received(lumi::MSG_GET_CPU_STATS) == 2);
+}
+
+/* Replies go to the client that asked; frames and text to the clients subscribed to their channel */
+void testSharedLink()
+{
+    FakeFirmware firmware(1);
+    Host host(firmware, socketPath);
+    lumi::Client first(socketPath);
+    lumi::Client second(socketPath);
+    lumi::ClientEvent event;
+
+    second.subscribe(1 << lumi::CHANNEL_EVENT);
+    uint32_t firstTag = first.send(lumi::MSG_GET_STACK_STATS, {1});
+    uint32_t secondTag = second.send(lumi::MSG_GET_STACK_STATS, {2});
+    TEST_CHECK(firstTag == secondTag);
+
+    TEST_CHECK(first.receive(event, 2s) && event.kind == lumi::DAEMON_REPLY);
+    TEST_CHECK((event.data == std::vector<uint8_t>{1}));
+    TEST_CHECK(second.receive(event, 2s) && event.kind == lumi::DAEMON_REPLY);
+    TEST_CHECK((event.data == std::vector<uint8_t>{2}));
+
+    firmware.sendFrame(0x0140, {9});
+    firmware.sendFrame(0x0240, {8});
+    firmware.sendText("joined");
+    TEST_CHECK(second.receive(event, 2s) && event.kind == lumi::DAEMON_FRAME);
+    TEST_CHECK(event.type == 0x0140 && (event.data == std::vector<uint8_t>{9}));
+    TEST_CHECK(second.receive(event, 2s) && event.kind == lumi::DAEMON_TEXT);
+    TEST_CHECK(std::string(event.data.begin(), event.data.end()) == "joined");
+    TEST_CHECK(!second.receive(event, 100ms));
+    TEST_CHECK(!first.receive(event, 100ms));
+}
+
+/* The daemon owns the version, so clients may not change it */
+void testVersionRefused()
+{
+    FakeFirmware firmware(1);
+    Host host(firmware, socketPath);
+    lumi::Client client(socketPath);
+
+    TEST_CHECK(client.request(lumi::MSG_SET_PROTOCOL_VERSION, {1}).status == lumi::STATUS_REFUSED);
+    TEST_CHECK(firmware.version() == 3);
+}
+
+/* After a reset the firmware is back in version 1 and the daemon switches it again */
+void testReset()
+{
+    FakeFirmware firmware(1);
+    Host host(firmware, socketPath);
+    lumi::Client client(socketPath);
+
+    TEST_CHECK(client.request(lumi::MSG_RESET, {}).status == 0);
+    lumi::Response response = client.request(lumi::MSG_GET_POOL_STATS, {3});
+    TEST_CHECK(response.status == 0 && (response.data == std::vector<uint8_t>{3}));
+    TEST_CHECK(firmware.version() == 3);
+    TEST_CHECK(firmware.versionRequests() == 2);
+}
+
+/* The confirming frame at the new rate follows the acknowledgement without a client asking */
+void testBaudRate()
+{
+    FakeFirmware firmware(1);
+    Host host(firmware, socketPath);
+    lumi::Client client(socketPath);
+
+    TEST_CHECK(client.request(lumi::MSG_SET_BAUD_RATE, {0x00, 0x03, 0x84, 0x00}).status == 0);
+    TEST_CHECK(client.request(lumi::MSG_GET_LINK_STATS, {}).status == 0);
+    TEST_CHECK(firmware.received(lumi::MSG_GET_POOL_STATS) == 1);
+}
+
+/* A daemon started again finds the firmware still in version 3 */
+void testHostRestart()
+{
+    FakeFirmware firmware(1);
+    {
+        Host host(firmware, socketPath);
+        lumi::Client client(socketPath);
+        TEST_CHECK(client.request(lumi::MSG_GET_LINK_STATS, {}).status == 0);
+    }
+
+    Host host(firmware, socketPath);
+    lumi::Client client(socketPath);
+    lumi::Response response = client.request(lumi::MSG_GET_LINK_STATS, {5});
+    TEST_CHECK(response.status == 0 && (response.data == std::vector<uint8_t>{5}));
+}
+
+} // namespace
+
+/****************************************************************************/
+/***        Exported Functions                                            ***/
+/****************************************************************************/
+
+int main()
+{
+    testFirstRequest();
+    testPipelining();
+    testRetransmit();
+    testSharedLink();
+    testVersionRefused();
+    testReset();
+    testBaudRate();
+    testHostRestart();
+
+    return TEST_RESULT();
+}
+
+/****************************************************************************/
+/***        END OF FILE                                                   ***/
+/****************************************************************************/
@@ -0,0 +1,198 @@
+/****************************************************************************
+ *
+ * MODULE:              Lumi Router
+ *
+ * COMPONENT:           test_frame.cpp
+ *
+ * DESCRIPTION:         Tests of the host frame codec
+ *
+ ****************************************************************************
+ *
+ * This software is owned by NXP B.V. and/or its supplier and is protected
+ * under applicable copyright laws. All rights are reserved. We grant You,
+ * and any third parties, a license to use this software solely and
+ * exclusively on NXP products [NXP Microcontrollers such as JN5168, JN5179].
+ * You, and any third parties must reproduce the copyright and warranty notice
+ * and any other legend of ownership on each copy or partial copy of the
+ * software.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+ * AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+ * IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE
+ * ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE
+ * LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR
+ * CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF
+ * SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS
+ * INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN
+ * CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE)
+ * ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+ * POSSIBILITY OF SUCH DAMAGE.
+ *
+ * Copyright NXP B.V. 2016. All rights reserved
+ *
+ ****************************************************************************/
+/****************************************************************************/
+/***        Include Files                                                 ***/
+/****************************************************************************/
+
+#include <cstring>
+#include <string>
+#include <vector>
+
+#include "frame.h"
+#include "test.h"
+
+using lumi::Frame;
+using lumi::FrameDecoder;
+
+/****************************************************************************/
+/***        Local Variables                                               ***/
+/****************************************************************************/
+
+namespace {
+
+std::vector<Frame> frames;
+std::string text;
+
+FrameDecoder newDecoder(int version)
+{
+    FrameDecoder decoder([](const Frame &frame) { frames.push_back(frame); },
+                         [](const uint8_t *data, size_t length) { text.append(data, data + length); });
+    frames.clear();
+    text.clear();
+    decoder.setVersion(version);
+    return decoder;
+}
+
+/****************************************************************************/
+/***        Local Functions                                               ***/
+/****************************************************************************/
+
+void testCrc()
+{
+    const char *check = "123456789";
+
+    TEST_CHECK(lumi::crc16(0xFFFF, reinterpret_cast<const uint8_t *>(check), std::strlen(check)) == 0x29B1);
+}
+
+/* Worked by hand from the framing table in README.md */
+void testKnownFrames()
+{
+    const uint8_t data[] = {0x02, 0x41};
+    std::vector<uint8_t> out;
+
+    /* XOR of 00 18 00 02 02 41 is 0x59; 0x02 in the header and data is escaped */
+    lumi::encodeFrame(1, lumi::MSG_GET_LINK_STATS, data, sizeof(data), out);
+    TEST_CHECK((out == std::vector<uint8_t>{0x01, 0x00, 0x18, 0x00, 0x02, 0x12, 0x59, 0x02, 0x12, 0x41, 0x03}));
+
+    /* CRC-16 of 00 14 00 01 03 is 0xC308, sent most significant byte first */
+    const uint8_t version = 3;
+    out.clear();
+    lumi::encodeFrame(2, lumi::MSG_SET_PROTOCOL_VERSION, &version, 1, out);
+    TEST_CHECK((out == std::vector<uint8_t>{0x01, 0x00, 0x14, 0x00, 0x02, 0x11, 0xC3, 0x08, 0x02, 0x13, 0x03}));
+}
+
+void testRoundTrip(int version)
+{
+    std::vector<uint8_t> data(lumi::MAX_FRAME_DATA);
+    std::vector<uint8_t> out;
+
+    for (size_t i = 0; i < data.size(); i++) {
+        data[i] = static_cast<uint8_t>(i);
+    }
+    lumi::encodeFrame(version, 0x0217, data.data(), data.size(), out);
+    lumi::encodeFrame(version, 0x8001, nullptr, 0, out);
+
+    /* A byte at a time, as a slow read would deliver it */
+    FrameDecoder decoder = newDecoder(version);
+    for (uint8_t byte : out) {
+        decoder.feed(&byte, 1);
+    }
+    TEST_CHECK(frames.size() == 2);
+    TEST_CHECK(frames.size() == 2 && frames[0].type == 0x0217 && frames[0].data == data);
+    TEST_CHECK(frames.size() == 2 && frames[1].type == 0x8001 && frames[1].data.empty());
+    TEST_CHECK(decoder.badFrames() == 0);
+    TEST_CHECK(text.empty());
+}
+
+void testBadFrames()
+{
+    const uint8_t data[] = {0x10, 0x20, 0x30};
+    std::vector<uint8_t> good;
+    std::vector<uint8_t> out;
+
+    lumi::encodeFrame(2, 0x0140, data, sizeof(data), good);
+
+    /* Bad check */
+    out = good;
+    out[8] ^= 0x01;
+    FrameDecoder decoder = newDecoder(2);
+    decoder.feed(out.data(), out.size());
+    TEST_CHECK(frames.empty() && decoder.badFrames() == 1);
+
+    /* Decoded with the other version's header length */
+    decoder = newDecoder(1);
+    decoder.feed(good.data(), good.size());
+    TEST_CHECK(frames.empty() && decoder.badFrames() == 1);
+
+    /* Wrong length */
+    out = good;
+    out[4] = 0x04;
+    decoder = newDecoder(2);
+    decoder.feed(out.data(), out.size());
+    TEST_CHECK(frames.empty() && decoder.badFrames() == 1);
+
+    /* Over the limit */
+    std::vector<uint8_t> large(lumi::MAX_FRAME_DATA + 1, 0x55);
+    out.clear();
+    lumi::encodeFrame(2, 0x0140, large.data(), large.size(), out);
+    decoder = newDecoder(2);
+    decoder.feed(out.data(), out.size());
+    TEST_CHECK(frames.empty() && decoder.badFrames() == 1);
+
+    /* A start inside a frame abandons it and the next frame still decodes */
+    out.assign(good.begin(), good.begin() + 5);
+    out.insert(out.end(), good.begin(), good.end());
+    decoder = newDecoder(2);
+    decoder.feed(out.data(), out.size());
+    TEST_CHECK(frames.size() == 1 && decoder.badFrames() == 1);
+}
+
+/* The boot message and the ASCII replies of versions 1 and 2 are sent outside frames */
+void testText()
+{
+    const std::string boot = "Router started..";
+    std::vector<uint8_t> out(boot.begin(), boot.end());
+
+    lumi::encodeFrame(3, 0x0140, nullptr, 0, out);
+    out.insert(out.end(), {'o', 'k'});
+
+    FrameDecoder decoder = newDecoder(3);
+    decoder.feed(out.data(), 5);
+    decoder.feed(out.data() + 5, out.size() - 5);
+    TEST_CHECK(text == boot + "ok");
+    TEST_CHECK(frames.size() == 1 && frames[0].type == 0x0140);
+}
+
+} // namespace
+
+/****************************************************************************/
+/***        Exported Functions                                            ***/
+/****************************************************************************/
+
+int main()
+{
+    testCrc();
+    testKnownFrames();
+    testRoundTrip(1);
+    testRoundTrip(2);
+    testRoundTrip(3);
+    testBadFrames();
+    testText();
+
+    return TEST_RESULT();
+}
+
+/****************************************************************************/
+/***        END OF FILE                                                   ***/
+/****************************************************************************/
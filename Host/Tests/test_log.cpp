@@ -0,0 +1,180 @@
+/****************************************************************************
+ *
+ * MODULE:              Lumi Router
+ *
+ * COMPONENT:           test_log.cpp
+ *
+ * DESCRIPTION:         Tests of the log decoder
+ *
+ ****************************************************************************
+ *
+ * This software is owned by NXP B.V. and/or its supplier and is protected
+ * under applicable copyright laws. All rights are reserved. We grant You,
+ * and any third parties, a license to use this software solely and
+ * exclusively on NXP products [NXP Microcontrollers such as JN5168, JN5179].
+ * You, and any third parties must reproduce the copyright and warranty notice
+ * and any other legend of ownership on each copy or partial copy of the
+ * software.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+ * AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+ * IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE
+ * ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE
+ * LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR
+ * CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF
+ * SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS
+ * INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN
+ * CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE)
+ * ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+ * POSSIBILITY OF SUCH DAMAGE.
+ *
+ * Copyright NXP B.V. 2016. All rights reserved
+ *
+ ****************************************************************************/
+/****************************************************************************/
+/***        Include Files                                                 ***/
+/****************************************************************************/
+
+#include <sstream>
+#include <stdexcept>
+#include <string>
+#include <vector>
+
+#include "log.h"
+#include "test.h"
+
+using lumi::formatLog;
+using lumi::LogRecord;
+using lumi::LogTable;
+
+/****************************************************************************/
+/***        Local Variables                                               ***/
+/****************************************************************************/
+
+namespace {
+
+/* As the firmware build writes it */
+const char *const TABLE = "0 E_LOG_APP_PDM_CAPACITY APP INFO \"PDM: Capacity %d\"\n"
+                          "1 E_LOG_ZDO_LEAVE_INDICATION APP INFO \"APP-ZDO: Leave Indication %08x%08x Rejoin %d\"\n"
+                          "2 E_LOG_SERIAL_RX_NO_BUFFER SERIAL WARN \"RX Start, no buffer\"\n"
+                          "3 E_LOG_SERIAL_RX_CRC_BAD SERIAL WARN \"CRC BAD Type 0x%x CRC %04x Expected %04x\"\n";
+
+bool loads(const std::string &table)
+{
+    std::istringstream in(table);
+    LogTable log;
+
+    try {
+        log.load(in);
+    }
+    catch (const std::runtime_error &) {
+        return false;
+    }
+    return true;
+}
+
+/****************************************************************************/
+/***        Local Functions                                               ***/
+/****************************************************************************/
+
+void testTable()
+{
+    std::istringstream in(TABLE);
+    LogTable table;
+
+    table.load(in);
+    TEST_CHECK(table.find(4) == nullptr);
+
+    const lumi::LogMessage *message = table.find(3);
+    TEST_CHECK(message != nullptr);
+    TEST_CHECK(message->name == "E_LOG_SERIAL_RX_CRC_BAD");
+    TEST_CHECK(message->module == "SERIAL");
+    TEST_CHECK(message->level == "WARN");
+    TEST_CHECK(message->format == "CRC BAD Type 0x%x CRC %04x Expected %04x");
+
+    /* Line endings of either kind and escapes in the literal */
+    TEST_CHECK(loads("0 A APP INFO \"x\"\r\n1 B APP INFO \"say \\\"%d\\\"\"\n"));
+
+    /* Ids must count up from zero, and the format must be quoted */
+    TEST_CHECK(!loads("1 A APP INFO \"x\"\n"));
+    TEST_CHECK(!loads("0 A APP INFO x\n"));
+    TEST_CHECK(!loads("0 A APP\n"));
+}
+
+/* Records laid out as APP_vLog writes them */
+void testRecords()
+{
+    const uint8_t data[] = {
+        7 + 3 * 4, 0x00, 0x03, 0x12, 0x34, 0x56, 0x78, 0x00, 0x00, 0x00, 0x40, 0x00, 0x00, 0xBE, 0xEF,
+        0x00,      0x00, 0xCA, 0xFE, 7,    0x00, 0x02, 0x00, 0x00, 0x00, 0x01,
+    };
+    std::vector<LogRecord> records;
+
+    TEST_CHECK(lumi::parseLogRecords(data, sizeof(data), records));
+    TEST_CHECK(records.size() == 2);
+    TEST_CHECK(records[0].id == 3);
+    TEST_CHECK(records[0].ticks == 0x12345678);
+    TEST_CHECK((records[0].args == std::vector<uint32_t>{0x40, 0xBEEF, 0xCAFE}));
+    TEST_CHECK(records[1].id == 2);
+    TEST_CHECK(records[1].ticks == 1);
+    TEST_CHECK(records[1].args.empty());
+
+    /* A record cut short, or with a length the layout cannot have, ends the
+     * parse and keeps what came before */
+    records.clear();
+    TEST_CHECK(!lumi::parseLogRecords(data, sizeof(data) - 1, records));
+    TEST_CHECK(records.size() == 1);
+    const uint8_t badLength[] = {8, 0, 0, 0, 0, 0, 0, 0};
+    records.clear();
+    TEST_CHECK(!lumi::parseLogRecords(badLength, sizeof(badLength), records));
+    TEST_CHECK(records.empty());
+    TEST_CHECK(lumi::parseLogRecords(data, 0, records));
+}
+
+void testFormat()
+{
+    std::istringstream in(TABLE);
+    LogTable table;
+    LogRecord record;
+
+    table.load(in);
+    record.id = 3;
+    record.args = {0x40, 0xBEEF, 0x12};
+    TEST_CHECK(table.format(record) == "CRC BAD Type 0x40 CRC beef Expected 0012");
+
+    /* A 64-bit address goes as two arguments */
+    record.id = 1;
+    record.args = {0x00158D00, 0x01020304, 1};
+    TEST_CHECK(table.format(record) == "APP-ZDO: Leave Indication 00158d0001020304 Rejoin 1");
+
+    record.id = 9;
+    record.args = {1, 0xABCDEF};
+    TEST_CHECK(table.format(record) == "unknown message 9 00000001 00abcdef");
+
+    /* %d is signed 32 bits, whatever length modifier the source had */
+    TEST_CHECK(formatLog("%d %ld %u", {0xFFFFFFFE, 0xFFFFFFFF, 0xFFFFFFFF}) == "-2 -1 4294967295");
+    TEST_CHECK(formatLog("%-4d|%+d|%5X|%c", {7, 7, 0xAB, 'A'}) == "7   |+7|   AB|A");
+    TEST_CHECK(formatLog("100%% %d", {5}) == "100% 5");
+    TEST_CHECK(formatLog("%d %d", {5}) == "5 ?");
+    TEST_CHECK(formatLog("%s %d", {5}) == "%s 5");
+    TEST_CHECK(formatLog("end %", {}) == "end %");
+    TEST_CHECK(formatLog("%300d", {1}).size() == 300);
+}
+
+} // namespace
+
+/****************************************************************************/
+/***        Exported Functions                                            ***/
+/****************************************************************************/
+
+int main()
+{
+    testTable();
+    testRecords();
+    testFormat();
+    return TEST_RESULT();
+}
+
+/****************************************************************************/
+/***        END OF FILE                                                   ***/
+/****************************************************************************/
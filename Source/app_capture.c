@@ -0,0 +1,367 @@
+/****************************************************************************
+ *
+ * MODULE:              Lumi Router
+ *
+ * COMPONENT:           app_capture.c
+ *
+ * DESCRIPTION:         Relayed frame capture stream
+ *
+ ****************************************************************************
+ *
+ * This software is owned by NXP B.V. and/or its supplier and is protected
+ * under applicable copyright laws. All rights are reserved. We grant You,
+ * and any third parties, a license to use this software solely and
+ * exclusively on NXP products [NXP Microcontrollers such as JN5168, JN5179].
+ * You, and any third parties must reproduce the copyright and warranty notice
+ * and any other legend of ownership on each copy or partial copy of the
+ * software.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+ * AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+ * IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE
+ * ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE
+ * LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR
+ * CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF
+ * SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS
+ * INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN
+ * CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE)
+ * ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+ * POSSIBILITY OF SUCH DAMAGE.
+ *
+ * Copyright NXP B.V. 2016. All rights reserved
+ *
+ ****************************************************************************/
+
+/****************************************************************************/
+/***        Include Files                                                 ***/
+/****************************************************************************/
+
+#include <jendefs.h>
+
+/* Application */
+#include "app_capture.h"
+#include "app_clock.h"
+#include "app_serial_commands.h"
+
+/* SDK JN-SW-4170 */
+#include "pdum_apl.h"
+#include "zps_apl_af.h"
+
+/****************************************************************************/
+/***        Macro Definitions                                             ***/
+/****************************************************************************/
+
+/* Records are sent with the type of the capture command on the telemetry
+ * channel, so they never hold up a command response */
+#define CAPTURE_MSG_TYPE SERIAL_CHANNEL_TYPE(E_SERIAL_CHANNEL_TELEMETRY, 0x1B)
+
+/* pcap record header and the pseudo header in front of the payload */
+#define CAPTURE_PCAP_HEADER_SIZE   16
+#define CAPTURE_PSEUDO_HEADER_SIZE 14
+
+/* Rate limit credit is kept in thousandths of a record, so it can be
+ * topped up every millisecond without rounding away */
+#define CAPTURE_RECORD_COST 1000
+
+#define CAPTURE_NO_ADDRESS 0xFFFE
+
+/****************************************************************************/
+/***        Type Definitions                                              ***/
+/****************************************************************************/
+
+/****************************************************************************/
+/***        Local Function Prototypes                                     ***/
+/****************************************************************************/
+
+PRIVATE bool_t APP_bCaptureTakeToken(void);
+PRIVATE uint16 APP_u16CaptureAddress(uint8 u8AddrMode, ZPS_tuAddress *puAddress);
+PRIVATE uint8 *APP_pu8CapturePutU16(uint8 *pu8, uint16 u16Value);
+PRIVATE uint8 *APP_pu8CapturePutU32(uint8 *pu8, uint32 u32Value);
+
+/****************************************************************************/
+/***        Exported Variables                                            ***/
+/****************************************************************************/
+
+/****************************************************************************/
+/***        Local Variables                                               ***/
+/****************************************************************************/
+
+PRIVATE bool_t bCaptureEnabled;
+PRIVATE uint16 u16CaptureRate;
+PRIVATE uint8 u8CaptureSnapLength;
+PRIVATE uint32 u32Credit;
+PRIVATE uint32 u32CreditMsec;
+PRIVATE APP_tsCaptureStats sCaptureStats;
+
+/****************************************************************************/
+/***        Exported Functions                                            ***/
+/****************************************************************************/
+
+/****************************************************************************
+ *
+ * NAME: APP_vCaptureConfigure
+ *
+ * DESCRIPTION:
+ * Start or stop the capture stream. Starting clears the counters and
+ * allows a full second of records straight away.
+ *
+ * PARAMETERS:  Name                RW  Usage
+ *              bEnable             R   TRUE to capture
+ *              u16RecordsPerSec    R   Rate limit, 0 for the default
+ *              u8SnapLength        R   APS payload bytes kept, 0 for the default
+ *
+ ****************************************************************************/
+PUBLIC void APP_vCaptureConfigure(bool_t bEnable, uint16 u16RecordsPerSec, uint8 u8SnapLength)
+{
+    bCaptureEnabled = bEnable;
+    if (!bEnable) {
+        return;
+    }
+
+    u16CaptureRate = (u16RecordsPerSec == 0) ? APP_CAPTURE_DEFAULT_RATE : u16RecordsPerSec;
+
+    if (u8SnapLength == 0) {
+        u8CaptureSnapLength = APP_CAPTURE_DEFAULT_SNAP_LENGTH;
+    }
+    else if (u8SnapLength > APP_CAPTURE_MAX_SNAP_LENGTH) {
+        u8CaptureSnapLength = APP_CAPTURE_MAX_SNAP_LENGTH;
+    }
+    else {
+        u8CaptureSnapLength = u8SnapLength;
+    }
+
+    u32Credit = (uint32)u16CaptureRate * CAPTURE_RECORD_COST;
+    u32CreditMsec = APP_u32ClockMsec();
+
+    sCaptureStats.u32Captured = 0;
+    sCaptureStats.u32RateLimited = 0;
+    sCaptureStats.u32QueueFull = 0;
+}
+
+/****************************************************************************
+ *
+ * NAME: APP_vCaptureEvent
+ *
+ * DESCRIPTION:
+ * Send a stack event to the host as a pcap record, if capture is on and
+ * the rate limit allows it. APS data indications, confirms and acks and
+ * NWK status indications are captured; other events are ignored. Must be
+ * called before the APDU of an indication is freed.
+ *
+ * The record is a pcap record header followed by a 14 byte pseudo header,
+ * all big endian:
+ *   event type (1), status (1), APS counter (1), link quality (1),
+ *   source endpoint (1), destination endpoint (1), source address (2),
+ *   destination address (2), profile (2), cluster (2)
+ * and then up to the snap length of APS payload. Fields an event does not
+ * have are zero; addresses that are not short addresses are 0xFFFE.
+ *
+ ****************************************************************************/
+PUBLIC void APP_vCaptureEvent(ZPS_tsAfEvent *psAfEvent)
+{
+    uint8 au8Header[CAPTURE_PCAP_HEADER_SIZE + CAPTURE_PSEUDO_HEADER_SIZE] = {0};
+    uint8 *pu8Pseudo = &au8Header[CAPTURE_PCAP_HEADER_SIZE];
+    uint8 *pu8;
+    APP_tsSerialIoVec asRecord[2];
+    ZPS_tsAfDataIndEvent *psInd;
+    ZPS_tsAfDataConfEvent *psConf;
+    ZPS_tsAfDataAckEvent *psAck;
+    PDUM_thAPduInstance hAPduInst = PDUM_INVALID_HANDLE;
+    uint16 u16PayloadSize = 0;
+    uint16 u16CapturedSize;
+    uint32 u32Msec;
+
+    if (!bCaptureEnabled) {
+        return;
+    }
+
+    pu8Pseudo[0] = (uint8)psAfEvent->eType;
+
+    switch (psAfEvent->eType) {
+    case ZPS_EVENT_APS_DATA_INDICATION:
+        psInd = &psAfEvent->uEvent.sApsDataIndEvent;
+        pu8Pseudo[1] = psInd->eStatus;
+        pu8Pseudo[3] = psInd->u8LinkQuality;
+        pu8Pseudo[4] = psInd->u8SrcEndpoint;
+        pu8Pseudo[5] = psInd->u8DstEndpoint;
+        pu8 = APP_pu8CapturePutU16(&pu8Pseudo[6], APP_u16CaptureAddress(psInd->u8SrcAddrMode, &psInd->uSrcAddress));
+        pu8 = APP_pu8CapturePutU16(pu8, APP_u16CaptureAddress(psInd->u8DstAddrMode, &psInd->uDstAddress));
+        pu8 = APP_pu8CapturePutU16(pu8, psInd->u16ProfileId);
+        APP_pu8CapturePutU16(pu8, psInd->u16ClusterId);
+        hAPduInst = psInd->hAPduInst;
+        break;
+
+    case ZPS_EVENT_APS_DATA_CONFIRM:
+        psConf = &psAfEvent->uEvent.sApsDataConfirmEvent;
+        pu8Pseudo[1] = psConf->u8Status;
+        pu8Pseudo[2] = psConf->u8SequenceNum;
+        pu8Pseudo[4] = psConf->u8SrcEndpoint;
+        pu8Pseudo[5] = psConf->u8DstEndpoint;
+        APP_pu8CapturePutU16(&pu8Pseudo[8], APP_u16CaptureAddress(psConf->u8DstAddrMode, &psConf->uDstAddr));
+        break;
+
+    case ZPS_EVENT_APS_DATA_ACK:
+        psAck = &psAfEvent->uEvent.sApsDataAckEvent;
+        pu8Pseudo[1] = psAck->u8Status;
+        pu8Pseudo[2] = psAck->u8SequenceNum;
+        pu8Pseudo[4] = psAck->u8SrcEndpoint;
+        pu8Pseudo[5] = psAck->u8DstEndpoint;
+        pu8 = APP_pu8CapturePutU16(&pu8Pseudo[8], psAck->u16DstAddr);
+        pu8 = APP_pu8CapturePutU16(pu8, psAck->u16ProfileId);
+        APP_pu8CapturePutU16(pu8, psAck->u16ClusterId);
+        break;
+
+    case ZPS_EVENT_NWK_STATUS_INDICATION:
+        pu8Pseudo[1] = psAfEvent->uEvent.sNwkStatusIndicationEvent.u8Status;
+        APP_pu8CapturePutU16(&pu8Pseudo[6], psAfEvent->uEvent.sNwkStatusIndicationEvent.u16NwkAddr);
+        break;
+
+    default:
+        return;
+    }
+
+    if (!APP_bCaptureTakeToken()) {
+        sCaptureStats.u32RateLimited++;
+        return;
+    }
+
+    if (hAPduInst != PDUM_INVALID_HANDLE) {
+        u16PayloadSize = PDUM_u16APduInstanceGetPayloadSize(hAPduInst);
+    }
+    u16CapturedSize = (u16PayloadSize < u8CaptureSnapLength) ? u16PayloadSize : u8CaptureSnapLength;
+
+    u32Msec = APP_u32ClockMsec();
+    pu8 = APP_pu8CapturePutU32(au8Header, u32Msec / 1000);
+    pu8 = APP_pu8CapturePutU32(pu8, (u32Msec % 1000) * 1000);
+    pu8 = APP_pu8CapturePutU32(pu8, CAPTURE_PSEUDO_HEADER_SIZE + u16CapturedSize);
+    APP_pu8CapturePutU32(pu8, CAPTURE_PSEUDO_HEADER_SIZE + u16PayloadSize);
+
+    /* The payload goes straight from the APDU into the serial queue */
+    asRecord[0].pu8Data = au8Header;
+    asRecord[0].u16Length = sizeof(au8Header);
+    asRecord[1].pu8Data = (u16CapturedSize > 0) ? (const uint8 *)PDUM_pvAPduInstanceGetPayload(hAPduInst) : NULL;
+    asRecord[1].u16Length = u16CapturedSize;
+
+    if (APP_bWriteFrameToSerial(CAPTURE_MSG_TYPE, asRecord, 2)) {
+        sCaptureStats.u32Captured++;
+    }
+    else {
+        sCaptureStats.u32QueueFull++;
+    }
+}
+
+/****************************************************************************
+ *
+ * NAME: APP_vGetCaptureStats
+ *
+ * DESCRIPTION:
+ * Read the capture counters
+ *
+ ****************************************************************************/
+PUBLIC void APP_vGetCaptureStats(APP_tsCaptureStats *psStats)
+{
+    *psStats = sCaptureStats;
+}
+
+/****************************************************************************/
+/***        Local Functions                                               ***/
+/****************************************************************************/
+
+/****************************************************************************
+ *
+ * NAME: APP_bCaptureTakeToken
+ *
+ * DESCRIPTION:
+ * Token bucket rate limit: credit builds up at the configured rate to at
+ * most one second of records, and each record takes one token
+ *
+ * RETURNS:
+ * TRUE if a record may be sent
+ *
+ ****************************************************************************/
+PRIVATE bool_t APP_bCaptureTakeToken(void)
+{
+    uint32 u32Msec = APP_u32ClockMsec();
+    uint32 u32Limit = (uint32)u16CaptureRate * CAPTURE_RECORD_COST;
+    uint32 u32Elapsed = u32Msec - u32CreditMsec;
+
+    u32CreditMsec = u32Msec;
+
+    /* Past one second the bucket is full anyway, and the product below
+     * cannot overflow */
+    if (u32Elapsed >= 1000) {
+        u32Credit = u32Limit;
+    }
+    else {
+        u32Credit += u32Elapsed * u16CaptureRate;
+        if (u32Credit > u32Limit) {
+            u32Credit = u32Limit;
+        }
+    }
+
+    if (u32Credit < CAPTURE_RECORD_COST) {
+        return FALSE;
+    }
+
+    u32Credit -= CAPTURE_RECORD_COST;
+
+    return TRUE;
+}
+
+/****************************************************************************
+ *
+ * NAME: APP_u16CaptureAddress
+ *
+ * DESCRIPTION:
+ * Short address of an APS address, or CAPTURE_NO_ADDRESS for any other
+ * addressing mode
+ *
+ ****************************************************************************/
+PRIVATE uint16 APP_u16CaptureAddress(uint8 u8AddrMode, ZPS_tuAddress *puAddress)
+{
+    return (u8AddrMode == ZPS_E_ADDR_MODE_SHORT) ? puAddress->u16Addr : CAPTURE_NO_ADDRESS;
+}
+
+/****************************************************************************
+ *
+ * NAME: APP_pu8CapturePutU16
+ *
+ * DESCRIPTION:
+ * Store a uint16 big endian
+ *
+ * RETURNS:
+ * Pointer past the stored value
+ *
+ ****************************************************************************/
+PRIVATE uint8 *APP_pu8CapturePutU16(uint8 *pu8, uint16 u16Value)
+{
+    *pu8++ = (uint8)(u16Value >> 8);
+    *pu8++ = (uint8)u16Value;
+
+    return pu8;
+}
+
+/****************************************************************************
+ *
+ * NAME: APP_pu8CapturePutU32
+ *
+ * DESCRIPTION:
+ * Store a uint32 big endian
+ *
+ * RETURNS:
+ * Pointer past the stored value
+ *
+ ****************************************************************************/
+PRIVATE uint8 *APP_pu8CapturePutU32(uint8 *pu8, uint32 u32Value)
+{
+    *pu8++ = (uint8)(u32Value >> 24);
+    *pu8++ = (uint8)(u32Value >> 16);
+    *pu8++ = (uint8)(u32Value >> 8);
+    *pu8++ = (uint8)u32Value;
+
+    return pu8;
+}
+
+/****************************************************************************/
+/***        END OF FILE                                                   ***/
+/****************************************************************************/
@@ -0,0 +1,88 @@
+/****************************************************************************
+ *
+ * MODULE:              Lumi Router
+ *
+ * COMPONENT:           app_capture.h
+ *
+ * DESCRIPTION:         Relayed frame capture stream
+ *
+ ****************************************************************************
+ *
+ * This software is owned by NXP B.V. and/or its supplier and is protected
+ * under applicable copyright laws. All rights are reserved. We grant You,
+ * and any third parties, a license to use this software solely and
+ * exclusively on NXP products [NXP Microcontrollers such as JN5168, JN5179].
+ * You, and any third parties must reproduce the copyright and warranty notice
+ * and any other legend of ownership on each copy or partial copy of the
+ * software.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+ * AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+ * IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE
+ * ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE
+ * LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR
+ * CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF
+ * SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS
+ * INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN
+ * CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE)
+ * ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+ * POSSIBILITY OF SUCH DAMAGE.
+ *
+ * Copyright NXP B.V. 2016. All rights reserved
+ *
+ ****************************************************************************/
+
+#ifndef APP_CAPTURE_H
+#define APP_CAPTURE_H
+
+/****************************************************************************/
+/***        Include Files                                                 ***/
+/****************************************************************************/
+
+#include <jendefs.h>
+
+/* SDK JN-SW-4170 */
+#include "zps_apl_af.h"
+
+/****************************************************************************/
+/***        Macro Definitions                                             ***/
+/****************************************************************************/
+
+/* pcap link type of the records: LINKTYPE_USER0, with the pseudo header
+ * described in APP_vCaptureEvent in front of the APS payload */
+#define APP_CAPTURE_LINKTYPE 147
+
+/* Default and largest number of APS payload bytes kept per record */
+#define APP_CAPTURE_DEFAULT_SNAP_LENGTH 64
+#define APP_CAPTURE_MAX_SNAP_LENGTH     128
+
+/* Default records per second; up to one second of records may burst */
+#define APP_CAPTURE_DEFAULT_RATE 20
+
+/****************************************************************************/
+/***        Type Definitions                                              ***/
+/****************************************************************************/
+
+typedef struct {
+    uint32 u32Captured;    /* records sent to the host */
+    uint32 u32RateLimited; /* events skipped by the rate limit */
+    uint32 u32QueueFull;   /* records dropped because the serial queue was full */
+} APP_tsCaptureStats;
+
+/****************************************************************************/
+/***        Exported Variables                                            ***/
+/****************************************************************************/
+
+/****************************************************************************/
+/***        Exported Functions                                            ***/
+/****************************************************************************/
+
+PUBLIC void APP_vCaptureConfigure(bool_t bEnable, uint16 u16RecordsPerSec, uint8 u8SnapLength);
+PUBLIC void APP_vCaptureEvent(ZPS_tsAfEvent *psAfEvent);
+PUBLIC void APP_vGetCaptureStats(APP_tsCaptureStats *psStats);
+
+/****************************************************************************/
+/***        END OF FILE                                                   ***/
+/****************************************************************************/
+
+#endif /* APP_CAPTURE_H */
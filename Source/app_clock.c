@@ -0,0 +1,147 @@
+/****************************************************************************
+ *
+ * MODULE:              Lumi Router
+ *
+ * COMPONENT:           app_clock.c
+ *
+ * DESCRIPTION:         Free running high resolution timestamps
+ *
+ ****************************************************************************
+ *
+ * This software is owned by NXP B.V. and/or its supplier and is protected
+ * under applicable copyright laws. All rights are reserved. We grant You,
+ * and any third parties, a license to use this software solely and
+ * exclusively on NXP products [NXP Microcontrollers such as JN5168, JN5179].
+ * You, and any third parties must reproduce the copyright and warranty notice
+ * and any other legend of ownership on each copy or partial copy of the
+ * software.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+ * AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+ * IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE
+ * ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE
+ * LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR
+ * CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF
+ * SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS
+ * INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN
+ * CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE)
+ * ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+ * POSSIBILITY OF SUCH DAMAGE.
+ *
+ * Copyright NXP B.V. 2016. All rights reserved
+ *
+ ****************************************************************************/
+
+/****************************************************************************/
+/***        Include Files                                                 ***/
+/****************************************************************************/
+
+#include <jendefs.h>
+
+/* Application */
+#include "app_clock.h"
+#include "app_ztimer.h"
+
+/* SDK JN-SW-4170 */
+#include "AppHardwareApi.h"
+
+/****************************************************************************/
+/***        Macro Definitions                                             ***/
+/****************************************************************************/
+
+/****************************************************************************/
+/***        Type Definitions                                              ***/
+/****************************************************************************/
+
+/****************************************************************************/
+/***        Local Function Prototypes                                     ***/
+/****************************************************************************/
+
+/****************************************************************************/
+/***        Exported Variables                                            ***/
+/****************************************************************************/
+
+/****************************************************************************/
+/***        Local Variables                                               ***/
+/****************************************************************************/
+
+/* Milliseconds since boot, counted in the tick timer interrupt */
+PRIVATE volatile uint32 u32ClockMsec = 0;
+
+/****************************************************************************/
+/***        Exported Functions                                            ***/
+/****************************************************************************/
+
+extern void ISR_vTickTimer(void);
+
+/****************************************************************************
+ *
+ * NAME: APP_isrTickTimer
+ *
+ * DESCRIPTION:
+ * Tick timer interrupt. ZTimer runs the tick timer in restart mode with a
+ * 1 ms period, so every interrupt is one millisecond. The ZTimer task is
+ * made ready only on the tick a timer is due.
+ * ---
+ * Installed in PIC_SwVectTable in front of the ZTimer handler
+ *
+ ****************************************************************************/
+PUBLIC void APP_isrTickTimer(void)
+{
+    u32ClockMsec++;
+    ISR_vTickTimer();
+    APP_vZTimerTickIsr(u32ClockMsec);
+}
+
+/****************************************************************************
+ *
+ * NAME: APP_u32ClockTicks
+ *
+ * DESCRIPTION:
+ * Read a free running 16 MHz timestamp. It wraps after about 268 seconds,
+ * so it is only meant for measuring intervals with unsigned subtraction.
+ *
+ * RETURNS:
+ * Current timestamp in APP_CLOCK_TICKS_PER_USEC units
+ *
+ ****************************************************************************/
+PUBLIC uint32 APP_u32ClockTicks(void)
+{
+    uint32 u32Msec;
+    uint32 u32Count;
+
+    /* Retry if the millisecond interrupt ran between the two reads */
+    do {
+        u32Msec = u32ClockMsec;
+        u32Count = u32AHI_TickTimerRead();
+    } while (u32Msec != u32ClockMsec);
+
+    /* The counter restarted but the interrupt has not been serviced yet,
+     * e.g. when called with interrupts disabled */
+    if (bAHI_TickTimerIntStatus() && (u32Count < (APP_CLOCK_TICKS_PER_MSEC / 2))) {
+        u32Msec++;
+    }
+
+    return (u32Msec * APP_CLOCK_TICKS_PER_MSEC) + u32Count;
+}
+
+/****************************************************************************
+ *
+ * NAME: APP_u32ClockMsec
+ *
+ * DESCRIPTION:
+ * Milliseconds since boot
+ *
+ ****************************************************************************/
+PUBLIC uint32 APP_u32ClockMsec(void)
+{
+    return u32ClockMsec;
+}
+
+/****************************************************************************/
+/***        Local Functions                                               ***/
+/****************************************************************************/
+
+/****************************************************************************/
+/***        END OF FILE                                                   ***/
+/****************************************************************************/
@@ -0,0 +1,363 @@
+/****************************************************************************
+ *
+ * MODULE:              Lumi Router
+ *
+ * COMPONENT:           app_cpu.c
+ *
+ * DESCRIPTION:         CPU utilisation from doze time
+ *
+ ****************************************************************************
+ *
+ * This software is owned by NXP B.V. and/or its supplier and is protected
+ * under applicable copyright laws. All rights are reserved. We grant You,
+ * and any third parties, a license to use this software solely and
+ * exclusively on NXP products [NXP Microcontrollers such as JN5168, JN5179].
+ * You, and any third parties must reproduce the copyright and warranty notice
+ * and any other legend of ownership on each copy or partial copy of the
+ * software.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+ * AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+ * IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE
+ * ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE
+ * LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR
+ * CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF
+ * SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS
+ * INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN
+ * CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE)
+ * ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+ * POSSIBILITY OF SUCH DAMAGE.
+ *
+ * Copyright NXP B.V. 2016. All rights reserved
+ *
+ ****************************************************************************/
+
+/****************************************************************************/
+/***        Include Files                                                 ***/
+/****************************************************************************/
+
+#include <jendefs.h>
+
+/* Application */
+#include "app_clock.h"
+#include "app_cpu.h"
+
+/****************************************************************************/
+/***        Macro Definitions                                             ***/
+/****************************************************************************/
+
+#define CPU_TICKS_PER_SEC (1000UL * APP_CLOCK_TICKS_PER_MSEC)
+
+/* Averages are held in tenths of a percent scaled by 2^16 */
+#define CPU_LOAD_SHIFT 16
+
+/* Samples, one per second, in each moving average */
+#define CPU_LOAD_1MIN_SAMPLES 60
+#define CPU_LOAD_15MIN_SAMPLES 900
+
+#define CPU_ATTRIBUTE_COUNT (sizeof(asCLD_CpuUsageClusterAttributeDefinitions) / sizeof(tsZCL_AttributeDefinition))
+
+/****************************************************************************/
+/***        Type Definitions                                              ***/
+/****************************************************************************/
+
+/****************************************************************************/
+/***        Local Function Prototypes                                     ***/
+/****************************************************************************/
+
+PRIVATE void APP_vCpuAccount(uint32 u32Now, bool_t bDozing);
+PRIVATE void APP_vCpuSample(void);
+
+/****************************************************************************/
+/***        Exported Variables                                            ***/
+/****************************************************************************/
+
+const tsZCL_AttributeDefinition asCLD_CpuUsageClusterAttributeDefinitions[] = {
+    {E_APP_CPU_ATTR_ID_UTILISATION,
+     (E_ZCL_AF_RD | E_ZCL_AF_MS),
+     E_ZCL_UINT16,
+     (uint32)(&((APP_tsCLD_CpuUsage *)(0))->u16Utilisation),
+     0},
+    {E_APP_CPU_ATTR_ID_UTILISATION_1MIN,
+     (E_ZCL_AF_RD | E_ZCL_AF_MS),
+     E_ZCL_UINT16,
+     (uint32)(&((APP_tsCLD_CpuUsage *)(0))->u16Utilisation1Min),
+     0},
+    {E_APP_CPU_ATTR_ID_UTILISATION_15MIN,
+     (E_ZCL_AF_RD | E_ZCL_AF_MS),
+     E_ZCL_UINT16,
+     (uint32)(&((APP_tsCLD_CpuUsage *)(0))->u16Utilisation15Min),
+     0},
+    {E_APP_CPU_ATTR_ID_PEAK_BUSY,
+     (E_ZCL_AF_RD | E_ZCL_AF_MS),
+     E_ZCL_UINT32,
+     (uint32)(&((APP_tsCLD_CpuUsage *)(0))->u32PeakBusyUsec),
+     0}};
+
+tsZCL_ClusterDefinition APP_sCLD_CpuUsage = {APP_CLUSTER_ID_CPU_USAGE,
+                                             TRUE,
+                                             E_ZCL_SECURITY_NETWORK,
+                                             CPU_ATTRIBUTE_COUNT,
+                                             (tsZCL_AttributeDefinition *)asCLD_CpuUsageClusterAttributeDefinitions,
+                                             NULL
+#ifdef ZCL_COMMAND_DISCOVERY_SUPPORTED
+                                             ,
+                                             0,
+                                             NULL
+#endif
+};
+
+uint8 au8CpuUsageClusterAttributeControlBits[CPU_ATTRIBUTE_COUNT];
+
+/****************************************************************************/
+/***        Local Variables                                               ***/
+/****************************************************************************/
+
+/* Start of the second being measured, how far into it the time has been
+ * accounted, and the doze time within it so far */
+PRIVATE uint32 u32SecondStart;
+PRIVATE uint32 u32Accounted;
+PRIVATE uint32 u32SecondDoze;
+
+/* Start of the current run without a doze, and the longest run, in ticks */
+PRIVATE uint32 u32BusyStart;
+PRIVATE uint32 u32PeakBusy;
+
+PRIVATE uint16 u16Utilisation;
+PRIVATE int32 i32Load1Min;
+PRIVATE int32 i32Load15Min;
+PRIVATE bool_t bLoadSeeded;
+
+/****************************************************************************/
+/***        Exported Functions                                            ***/
+/****************************************************************************/
+
+/****************************************************************************
+ *
+ * NAME: APP_vCpuInit
+ *
+ * DESCRIPTION:
+ * Start measuring from now. Call once, before the main loop.
+ *
+ ****************************************************************************/
+PUBLIC void APP_vCpuInit(void)
+{
+    uint32 u32Now = APP_u32ClockTicks();
+
+    u32SecondStart = u32Now;
+    u32Accounted = u32Now;
+    u32SecondDoze = 0;
+    u32BusyStart = u32Now;
+    u32PeakBusy = 0;
+    u16Utilisation = 0;
+    i32Load1Min = 0;
+    i32Load15Min = 0;
+    bLoadSeeded = FALSE;
+}
+
+/****************************************************************************
+ *
+ * NAME: APP_vCpuDozeStart
+ *
+ * DESCRIPTION:
+ * Call just before the power manager dozes, with interrupts masked. The
+ * time since the last doze ended counts as busy.
+ *
+ ****************************************************************************/
+PUBLIC void APP_vCpuDozeStart(void)
+{
+    uint32 u32Now = APP_u32ClockTicks();
+
+    if ((u32Now - u32BusyStart) > u32PeakBusy) {
+        u32PeakBusy = u32Now - u32BusyStart;
+    }
+
+    APP_vCpuAccount(u32Now, FALSE);
+}
+
+/****************************************************************************
+ *
+ * NAME: APP_vCpuDozeEnd
+ *
+ * DESCRIPTION:
+ * Call just after the power manager returns, with interrupts still masked.
+ * The time since the doze started counts as idle. The interrupt that ended
+ * the doze is handled after this, so its time counts as busy, as does that
+ * of every interrupt taken while not dozing.
+ *
+ ****************************************************************************/
+PUBLIC void APP_vCpuDozeEnd(void)
+{
+    uint32 u32Now = APP_u32ClockTicks();
+
+    APP_vCpuAccount(u32Now, TRUE);
+    u32BusyStart = u32Now;
+}
+
+/****************************************************************************
+ *
+ * NAME: APP_vGetCpuStats
+ *
+ * DESCRIPTION:
+ * Read the utilisation. Called while busy, so the run in progress counts
+ * towards the peak.
+ *
+ ****************************************************************************/
+PUBLIC void APP_vGetCpuStats(APP_tsCpuStats *psStats)
+{
+    uint32 u32Now = APP_u32ClockTicks();
+    uint32 u32Peak = u32PeakBusy;
+
+    APP_vCpuAccount(u32Now, FALSE);
+
+    if ((u32Now - u32BusyStart) > u32Peak) {
+        u32Peak = u32Now - u32BusyStart;
+    }
+
+    psStats->u16Utilisation = u16Utilisation;
+    psStats->u16Utilisation1Min = (uint16)((i32Load1Min + (1L << (CPU_LOAD_SHIFT - 1))) >> CPU_LOAD_SHIFT);
+    psStats->u16Utilisation15Min = (uint16)((i32Load15Min + (1L << (CPU_LOAD_SHIFT - 1))) >> CPU_LOAD_SHIFT);
+    psStats->u32PeakBusyUsec = u32Peak / APP_CLOCK_TICKS_PER_USEC;
+}
+
+/****************************************************************************
+ *
+ * NAME: APP_vResetCpuStats
+ *
+ * DESCRIPTION:
+ * Clear the peak busy time. The averages carry on.
+ *
+ ****************************************************************************/
+PUBLIC void APP_vResetCpuStats(void)
+{
+    u32PeakBusy = 0;
+    u32BusyStart = APP_u32ClockTicks();
+}
+
+/****************************************************************************
+ *
+ * NAME: APP_eCpuUsageCreateCluster
+ *
+ * DESCRIPTION:
+ * Create the manufacturer specific CPU usage cluster
+ *
+ * RETURNS:
+ * teZCL_Status
+ *
+ ****************************************************************************/
+PUBLIC teZCL_Status APP_eCpuUsageCreateCluster(tsZCL_ClusterInstance *psClusterInstance,
+                                               bool_t bIsServer,
+                                               tsZCL_ClusterDefinition *psClusterDefinition,
+                                               void *pvEndPointSharedStructPtr,
+                                               uint8 *pu8AttributeControlBits)
+{
+    if ((psClusterInstance == NULL) || (psClusterDefinition == NULL) || (pvEndPointSharedStructPtr == NULL)) {
+        return E_ZCL_ERR_PARAMETER_NULL;
+    }
+
+    vZCL_InitializeClusterInstance(psClusterInstance,
+                                   bIsServer,
+                                   psClusterDefinition,
+                                   pvEndPointSharedStructPtr,
+                                   pu8AttributeControlBits,
+                                   NULL,
+                                   NULL);
+
+    APP_vCpuUsageUpdateAttributes((APP_tsCLD_CpuUsage *)pvEndPointSharedStructPtr);
+
+    return E_ZCL_SUCCESS;
+}
+
+/****************************************************************************
+ *
+ * NAME: APP_vCpuUsageUpdateAttributes
+ *
+ * DESCRIPTION:
+ * Copy the current utilisation into the cluster attributes
+ *
+ ****************************************************************************/
+PUBLIC void APP_vCpuUsageUpdateAttributes(APP_tsCLD_CpuUsage *psCluster)
+{
+    APP_tsCpuStats sStats;
+
+    APP_vGetCpuStats(&sStats);
+
+    psCluster->u16Utilisation = sStats.u16Utilisation;
+    psCluster->u16Utilisation1Min = sStats.u16Utilisation1Min;
+    psCluster->u16Utilisation15Min = sStats.u16Utilisation15Min;
+    psCluster->u32PeakBusyUsec = sStats.u32PeakBusyUsec;
+}
+
+/****************************************************************************/
+/***        Local Functions                                               ***/
+/****************************************************************************/
+
+/****************************************************************************
+ *
+ * NAME: APP_vCpuAccount
+ *
+ * DESCRIPTION:
+ * Account the time up to now as dozing or busy, splitting it at each second
+ * boundary and taking a sample for every second completed. The tick count
+ * wraps after about 268 s; the CPU never dozes that long, as the tick
+ * interrupt ends every doze within a millisecond.
+ *
+ * PARAMETERS:
+ * u32Now    Clock ticks now
+ * bDozing   TRUE if the time since the last call was spent dozing
+ *
+ ****************************************************************************/
+PRIVATE void APP_vCpuAccount(uint32 u32Now, bool_t bDozing)
+{
+    uint32 u32Elapsed = u32Now - u32Accounted;
+    uint32 u32Left;
+    uint32 u32Chunk;
+
+    while (u32Elapsed) {
+        u32Left = CPU_TICKS_PER_SEC - (u32Accounted - u32SecondStart);
+        u32Chunk = (u32Elapsed < u32Left) ? u32Elapsed : u32Left;
+
+        if (bDozing) {
+            u32SecondDoze += u32Chunk;
+        }
+        u32Accounted += u32Chunk;
+        u32Elapsed -= u32Chunk;
+
+        if (u32Chunk == u32Left) {
+            APP_vCpuSample();
+            u32SecondStart += CPU_TICKS_PER_SEC;
+            u32SecondDoze = 0;
+        }
+    }
+}
+
+/****************************************************************************
+ *
+ * NAME: APP_vCpuSample
+ *
+ * DESCRIPTION:
+ * Close the second just measured and fold it into the moving averages. The
+ * first second seeds them, so they do not start from idle.
+ *
+ ****************************************************************************/
+PRIVATE void APP_vCpuSample(void)
+{
+    int32 i32Sample;
+
+    u16Utilisation = (uint16)(1000 - (u32SecondDoze / APP_CLOCK_TICKS_PER_MSEC));
+    i32Sample = (int32)u16Utilisation << CPU_LOAD_SHIFT;
+
+    if (!bLoadSeeded) {
+        i32Load1Min = i32Sample;
+        i32Load15Min = i32Sample;
+        bLoadSeeded = TRUE;
+        return;
+    }
+
+    i32Load1Min += (i32Sample - i32Load1Min) / CPU_LOAD_1MIN_SAMPLES;
+    i32Load15Min += (i32Sample - i32Load15Min) / CPU_LOAD_15MIN_SAMPLES;
+}
+
+/****************************************************************************/
+/***        END OF FILE                                                   ***/
+/****************************************************************************/
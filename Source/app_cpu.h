@@ -0,0 +1,108 @@
+/****************************************************************************
+ *
+ * MODULE:              Lumi Router
+ *
+ * COMPONENT:           app_cpu.h
+ *
+ * DESCRIPTION:         CPU utilisation from doze time
+ *
+ ****************************************************************************
+ *
+ * This software is owned by NXP B.V. and/or its supplier and is protected
+ * under applicable copyright laws. All rights are reserved. We grant You,
+ * and any third parties, a license to use this software solely and
+ * exclusively on NXP products [NXP Microcontrollers such as JN5168, JN5179].
+ * You, and any third parties must reproduce the copyright and warranty notice
+ * and any other legend of ownership on each copy or partial copy of the
+ * software.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+ * AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+ * IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE
+ * ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE
+ * LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR
+ * CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF
+ * SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS
+ * INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN
+ * CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE)
+ * ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+ * POSSIBILITY OF SUCH DAMAGE.
+ *
+ * Copyright NXP B.V. 2016. All rights reserved
+ *
+ ****************************************************************************/
+
+#ifndef APP_CPU_H
+#define APP_CPU_H
+
+/****************************************************************************/
+/***        Include Files                                                 ***/
+/****************************************************************************/
+
+#include <jendefs.h>
+
+/* SDK JN-SW-4170 */
+#include "zcl.h"
+
+/****************************************************************************/
+/***        Macro Definitions                                             ***/
+/****************************************************************************/
+
+/* Manufacturer specific server cluster carrying the utilisation */
+#define APP_CLUSTER_ID_CPU_USAGE 0xFC00
+
+/****************************************************************************/
+/***        Type Definitions                                              ***/
+/****************************************************************************/
+
+/* Utilisation is in tenths of a percent of the time not spent dozing */
+typedef struct {
+    uint16 u16Utilisation;      /* over the last whole second */
+    uint16 u16Utilisation1Min;  /* averaged over about a minute */
+    uint16 u16Utilisation15Min; /* averaged over about 15 minutes */
+    uint32 u32PeakBusyUsec;     /* longest run without a doze since boot or the last reset */
+} APP_tsCpuStats;
+
+typedef enum {
+    E_APP_CPU_ATTR_ID_UTILISATION = 0x0000,
+    E_APP_CPU_ATTR_ID_UTILISATION_1MIN,
+    E_APP_CPU_ATTR_ID_UTILISATION_15MIN,
+    E_APP_CPU_ATTR_ID_PEAK_BUSY
+} APP_teCpuUsageAttributeId;
+
+/* Attribute storage of the cluster, laid out as APP_tsCpuStats */
+typedef struct {
+    zuint16 u16Utilisation;
+    zuint16 u16Utilisation1Min;
+    zuint16 u16Utilisation15Min;
+    zuint32 u32PeakBusyUsec;
+} APP_tsCLD_CpuUsage;
+
+/****************************************************************************/
+/***        Exported Variables                                            ***/
+/****************************************************************************/
+
+extern tsZCL_ClusterDefinition APP_sCLD_CpuUsage;
+extern uint8 au8CpuUsageClusterAttributeControlBits[];
+
+/****************************************************************************/
+/***        Exported Functions                                            ***/
+/****************************************************************************/
+
+PUBLIC void APP_vCpuInit(void);
+PUBLIC void APP_vCpuDozeStart(void);
+PUBLIC void APP_vCpuDozeEnd(void);
+PUBLIC void APP_vGetCpuStats(APP_tsCpuStats *psStats);
+PUBLIC void APP_vResetCpuStats(void);
+PUBLIC teZCL_Status APP_eCpuUsageCreateCluster(tsZCL_ClusterInstance *psClusterInstance,
+                                               bool_t bIsServer,
+                                               tsZCL_ClusterDefinition *psClusterDefinition,
+                                               void *pvEndPointSharedStructPtr,
+                                               uint8 *pu8AttributeControlBits);
+PUBLIC void APP_vCpuUsageUpdateAttributes(APP_tsCLD_CpuUsage *psCluster);
+
+/****************************************************************************/
+/***        END OF FILE                                                   ***/
+/****************************************************************************/
+
+#endif /* APP_CPU_H */
@@ -40,25 +40,21 @@
 
 /* Application */
 #include "app_device_temperature.h"
+#include "app_log.h"
 #include "app_main.h"
+#include "app_pt.h"
+#include "app_reporting.h"
+#include "app_timer.h"
 #include "app_zcl_task.h"
 
 /* SDK JN-SW-4170 */
 #include "AppHardwareApi.h"
-#include "ZTimer.h"
-#include "dbg.h"
 
 /****************************************************************************/
 /***        Macro Definitions                                             ***/
 /****************************************************************************/
 
-#ifdef DEBUG_DEVICE_TEMPERATURE
-#define TRACE_DEVICE_TEMPERATURE TRUE
-#else
-#define TRACE_DEVICE_TEMPERATURE FALSE
-#endif
-
-#define DEVICE_TEMPERATURE_UPDATE_TIME ZTIMER_TIME_SEC(10)
+#define DEVICE_TEMPERATURE_UPDATE_TIME APP_TIMER_TIME_SEC(10)
 
 /****************************************************************************/
 /***        Type Definitions                                              ***/
@@ -68,8 +64,7 @@
 /***        Local Function Prototypes                                     ***/
 /****************************************************************************/
 
-PRIVATE void APP_vDeviceTemperatureUpdate(void);
-PRIVATE int16 APP_i16GetDeviceTemperature(void);
+PRIVATE APP_tePtState APP_ptDeviceTemperatureUpdate(APP_tsPt *psPt);
 PRIVATE int16 APP_i16ConvertChipTemp(uint16 u16AdcValue);
 
 /****************************************************************************/
@@ -80,6 +75,12 @@ PRIVATE int16 APP_i16ConvertChipTemp(uint16 u16AdcValue);
 /***        Local Variables                                               ***/
 /****************************************************************************/
 
+PRIVATE APP_tsPtTask sUpdateTask;
+
+/* Temperature when ZCL was last woken for a change, from which the next
+ * reportable change is measured */
+PRIVATE int16 i16TickTemperature;
+
 /****************************************************************************/
 /***        Exported Functions                                            ***/
 /****************************************************************************/
@@ -103,12 +104,15 @@ PUBLIC void APP_vDeviceTemperatureInit(void)
     while (!bAHI_APRegulatorEnabled())
         ;
 
-    APP_vDeviceTemperatureUpdate();
+    i16TickTemperature = sLumiRouter.sDeviceTemperatureConfigurationServerCluster.i16CurrentTemperature;
 
-    DBG_vPrintf(TRACE_DEVICE_TEMPERATURE, "APP: Init Device Temperature\n");
+    APP_vPtCreate(&sUpdateTask, APP_ptDeviceTemperatureUpdate);
+    APP_bPtStart(&sUpdateTask);
+
+    APP_LOG(E_LOG_DEVICE_TEMPERATURE_INIT);
 
     /* Start the Device Temperature timer */
-    ZTIMER_eStart(u8TimerDeviceTemperature, DEVICE_TEMPERATURE_UPDATE_TIME);
+    APP_vTimerStartPeriodic(&sTimerDeviceTemperature, DEVICE_TEMPERATURE_UPDATE_TIME);
 }
 
 /****************************************************************************
@@ -121,8 +125,7 @@ PUBLIC void APP_vDeviceTemperatureInit(void)
  ****************************************************************************/
 PUBLIC void APP_cbTimerDeviceTemperatureUpdate(void *pvParam)
 {
-    APP_vDeviceTemperatureUpdate();
-    ZTIMER_eStart(u8TimerDeviceTemperature, DEVICE_TEMPERATURE_UPDATE_TIME);
+    APP_bPtStart(&sUpdateTask);
 }
 
 /****************************************************************************/
@@ -131,45 +134,42 @@ PUBLIC void APP_cbTimerDeviceTemperatureUpdate(void *pvParam)
 
 /****************************************************************************
  *
- * NAME: APP_vDeviceTemperatureUpdate
+ * NAME: APP_ptDeviceTemperatureUpdate
  *
  * DESCRIPTION:
- * Device Temperature update
+ * Device Temperature update. Samples the chip temperature sensor, letting
+ * the main loop run while the ADC converts.
  *
  ****************************************************************************/
-PRIVATE void APP_vDeviceTemperatureUpdate(void)
+PRIVATE APP_tePtState APP_ptDeviceTemperatureUpdate(APP_tsPt *psPt)
 {
-    int16 i16DeviceTemperature = APP_i16GetDeviceTemperature();
+    int16 i16DeviceTemperature;
 
-    DBG_vPrintf(TRACE_DEVICE_TEMPERATURE, "APP: Temp = %d C\n", i16DeviceTemperature);
-
-    sLumiRouter.sDeviceTemperatureConfigurationServerCluster.i16CurrentTemperature = i16DeviceTemperature;
-}
-
-/****************************************************************************
- *
- * NAME: APP_i16GetDeviceTemperature
- *
- * DESCRIPTION:
- * Read Device Temperature
- *
- * RETURNS:
- * Device Temperature
- *
- ****************************************************************************/
-PRIVATE int16 APP_i16GetDeviceTemperature(void)
-{
-    uint16 u16AdcTempSensor;
+    APP_PT_BEGIN(psPt);
 
     vAHI_AdcEnable(E_AHI_ADC_SINGLE_SHOT, E_AHI_AP_INPUT_RANGE_2, E_AHI_ADC_SRC_TEMP);
     vAHI_AdcStartSample();
 
-    while (bAHI_AdcPoll())
-        ;
+    APP_PT_WAIT_UNTIL(psPt, !bAHI_AdcPoll());
+
+    i16DeviceTemperature = APP_i16ConvertChipTemp(u16AHI_AdcRead());
 
-    u16AdcTempSensor = u16AHI_AdcRead();
+    APP_LOG(E_LOG_DEVICE_TEMPERATURE_READING, i16DeviceTemperature);
+
+    sLumiRouter.sDeviceTemperatureConfigurationServerCluster.i16CurrentTemperature = i16DeviceTemperature;
 
-    return APP_i16ConvertChipTemp(u16AdcTempSensor);
+    /* Let ZCL see a change it would report now rather than at its next
+     * deadline. Smaller changes go out with the periodic report, which
+     * the tick schedule already wakes ZCL for. */
+    if (APP_bIsReportableChange(GENERAL_CLUSTER_ID_DEVICE_TEMPERATURE_CONFIGURATION,
+                                E_CLD_DEVTEMPCFG_ATTR_ID_CURRENT_TEMPERATURE,
+                                i16TickTemperature,
+                                i16DeviceTemperature)) {
+        i16TickTemperature = i16DeviceTemperature;
+        APP_ZCL_vRequestTick();
+    }
+
+    APP_PT_END(psPt);
 }
 
 /****************************************************************************
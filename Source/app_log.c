@@ -0,0 +1,249 @@
+/****************************************************************************
+ *
+ * MODULE:              Lumi Router
+ *
+ * COMPONENT:           app_log.c
+ *
+ * DESCRIPTION:         Tokenized binary trace log
+ *
+ ****************************************************************************
+ *
+ * This software is owned by NXP B.V. and/or its supplier and is protected
+ * under applicable copyright laws. All rights are reserved. We grant You,
+ * and any third parties, a license to use this software solely and
+ * exclusively on NXP products [NXP Microcontrollers such as JN5168, JN5179].
+ * You, and any third parties must reproduce the copyright and warranty notice
+ * and any other legend of ownership on each copy or partial copy of the
+ * software.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+ * AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+ * IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE
+ * ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE
+ * LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR
+ * CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF
+ * SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS
+ * INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN
+ * CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE)
+ * ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+ * POSSIBILITY OF SUCH DAMAGE.
+ *
+ * Copyright NXP B.V. 2016. All rights reserved
+ *
+ ****************************************************************************/
+
+/****************************************************************************/
+/***        Include Files                                                 ***/
+/****************************************************************************/
+
+#include <jendefs.h>
+#include <stdarg.h>
+
+/* Application */
+#include "app_clock.h"
+#include "app_log.h"
+#include "app_ring_buffer.h"
+
+/* SDK JN-SW-4170 */
+#include "portmacro.h"
+
+/****************************************************************************/
+/***        Macro Definitions                                             ***/
+/****************************************************************************/
+
+#define LOG_RING_SIZE 512
+
+#if !RB_IS_POWER_OF_TWO(LOG_RING_SIZE)
+#error Log ring size must be a power of two
+#endif
+
+/****************************************************************************/
+/***        Type Definitions                                              ***/
+/****************************************************************************/
+
+/****************************************************************************/
+/***        Local Function Prototypes                                     ***/
+/****************************************************************************/
+
+PRIVATE uint8 *APP_pu8LogPutU32(uint8 *pu8, uint32 u32Value);
+
+/****************************************************************************/
+/***        Exported Variables                                            ***/
+/****************************************************************************/
+
+PUBLIC uint8 au8LogModuleLevel[E_LOG_MODULE_COUNT];
+
+/****************************************************************************/
+/***        Local Variables                                               ***/
+/****************************************************************************/
+
+PRIVATE RB_tsRingBuffer rbLog;
+PRIVATE uint8 au8LogBuffer[LOG_RING_SIZE];
+PRIVATE APP_tsLogStats sLogStats;
+
+/****************************************************************************/
+/***        Exported Functions                                            ***/
+/****************************************************************************/
+
+/****************************************************************************
+ *
+ * NAME: APP_vLogInit
+ *
+ * DESCRIPTION:
+ * Initialise the log ring and set every module to the default level
+ *
+ ****************************************************************************/
+PUBLIC void APP_vLogInit(void)
+{
+    uint8 i;
+
+    RB_vInit(&rbLog, au8LogBuffer, LOG_RING_SIZE);
+
+    for (i = 0; i < E_LOG_MODULE_COUNT; i++) {
+        au8LogModuleLevel[i] = APP_LOG_DEFAULT_LEVEL;
+    }
+}
+
+/****************************************************************************
+ *
+ * NAME: APP_vLog
+ *
+ * DESCRIPTION:
+ * Append a record to the log ring. Nothing is formatted: a record is its
+ * length, the message id, the clock ticks and the raw arguments, all big
+ * endian. Called through APP_LOG, which has already checked the level.
+ * May be called from an ISR.
+ *
+ * PARAMETERS:  Name            RW  Usage
+ *              u16Id           R   Message id from app_log_messages.h
+ *              u8Count         R   Number of uint32 arguments that follow
+ *
+ ****************************************************************************/
+PUBLIC void APP_vLog(uint16 u16Id, uint8 u8Count, ...)
+{
+    uint8 au8Record[APP_LOG_MAX_RECORD_SIZE];
+    uint8 *pu8 = au8Record;
+    uint32 u32Storage;
+    va_list ap;
+    uint8 i;
+
+    if (u8Count > APP_LOG_MAX_ARGS) {
+        u8Count = APP_LOG_MAX_ARGS;
+    }
+
+    *pu8++ = 7 + 4 * u8Count;
+    *pu8++ = (uint8)(u16Id >> 8);
+    *pu8++ = (uint8)u16Id;
+    pu8 = APP_pu8LogPutU32(pu8, APP_u32ClockTicks());
+
+    va_start(ap, u8Count);
+    for (i = 0; i < u8Count; i++) {
+        pu8 = APP_pu8LogPutU32(pu8, va_arg(ap, uint32));
+    }
+    va_end(ap);
+
+    /* Tasks and ISRs may both log, so the ring has several producers */
+    ZPS_eEnterCriticalSection(NULL, &u32Storage);
+    if (RB_u16Free(&rbLog) >= au8Record[0]) {
+        RB_u16PushN(&rbLog, au8Record, au8Record[0]);
+        sLogStats.u32Records++;
+    }
+    else {
+        sLogStats.u32Dropped++;
+    }
+    ZPS_eExitCriticalSection(NULL, &u32Storage);
+}
+
+/****************************************************************************
+ *
+ * NAME: APP_vLogSetLevel
+ *
+ * DESCRIPTION:
+ * Change the level of messages recorded for a module
+ *
+ ****************************************************************************/
+PUBLIC void APP_vLogSetLevel(APP_teLogModule eModule, APP_teLogLevel eLevel)
+{
+    if (eModule < E_LOG_MODULE_COUNT) {
+        au8LogModuleLevel[eModule] = eLevel;
+    }
+}
+
+/****************************************************************************
+ *
+ * NAME: APP_u16LogRead
+ *
+ * DESCRIPTION:
+ * Take as many whole records from the log ring as fit in a buffer. Must
+ * only be called from one task.
+ *
+ * RETURNS:
+ * Number of bytes read
+ *
+ ****************************************************************************/
+PUBLIC uint16 APP_u16LogRead(uint8 *pu8Buffer, uint16 u16Size)
+{
+    uint16 u16Read = 0;
+    uint8 u8Length;
+
+    while (RB_bPeek(&rbLog, &u8Length) && ((u16Read + u8Length) <= u16Size)) {
+        u16Read += RB_u16PopN(&rbLog, &pu8Buffer[u16Read], u8Length);
+    }
+
+    return u16Read;
+}
+
+/****************************************************************************
+ *
+ * NAME: APP_bLogIsEmpty
+ *
+ * DESCRIPTION:
+ * Check whether there are records waiting to be read
+ *
+ ****************************************************************************/
+PUBLIC bool_t APP_bLogIsEmpty(void)
+{
+    return RB_bIsEmpty(&rbLog);
+}
+
+/****************************************************************************
+ *
+ * NAME: APP_vLogGetStats
+ *
+ * DESCRIPTION:
+ * Read the number of records logged and dropped
+ *
+ ****************************************************************************/
+PUBLIC void APP_vLogGetStats(APP_tsLogStats *psStats)
+{
+    *psStats = sLogStats;
+}
+
+/****************************************************************************/
+/***        Local Functions                                               ***/
+/****************************************************************************/
+
+/****************************************************************************
+ *
+ * NAME: APP_pu8LogPutU32
+ *
+ * DESCRIPTION:
+ * Store a uint32 big endian
+ *
+ * RETURNS:
+ * Position after the stored value
+ *
+ ****************************************************************************/
+PRIVATE uint8 *APP_pu8LogPutU32(uint8 *pu8, uint32 u32Value)
+{
+    *pu8++ = (uint8)(u32Value >> 24);
+    *pu8++ = (uint8)(u32Value >> 16);
+    *pu8++ = (uint8)(u32Value >> 8);
+    *pu8++ = (uint8)u32Value;
+
+    return pu8;
+}
+
+/****************************************************************************/
+/***        END OF FILE                                                   ***/
+/****************************************************************************/
@@ -0,0 +1,138 @@
+/****************************************************************************
+ *
+ * MODULE:              Lumi Router
+ *
+ * COMPONENT:           app_log.h
+ *
+ * DESCRIPTION:         Tokenized binary trace log
+ *
+ ****************************************************************************
+ *
+ * This software is owned by NXP B.V. and/or its supplier and is protected
+ * under applicable copyright laws. All rights are reserved. We grant You,
+ * and any third parties, a license to use this software solely and
+ * exclusively on NXP products [NXP Microcontrollers such as JN5168, JN5179].
+ * You, and any third parties must reproduce the copyright and warranty notice
+ * and any other legend of ownership on each copy or partial copy of the
+ * software.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+ * AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+ * IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE
+ * ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE
+ * LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR
+ * CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF
+ * SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS
+ * INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN
+ * CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE)
+ * ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+ * POSSIBILITY OF SUCH DAMAGE.
+ *
+ * Copyright NXP B.V. 2016. All rights reserved
+ *
+ ****************************************************************************/
+
+#ifndef APP_LOG_H
+#define APP_LOG_H
+
+/****************************************************************************/
+/***        Include Files                                                 ***/
+/****************************************************************************/
+
+#include <jendefs.h>
+
+/****************************************************************************/
+/***        Macro Definitions                                             ***/
+/****************************************************************************/
+
+/* Records at or below this level are kept from boot, until changed at run
+ * time with APP_vLogSetLevel */
+#ifndef APP_LOG_DEFAULT_LEVEL
+#define APP_LOG_DEFAULT_LEVEL E_LOG_LEVEL_INFO
+#endif
+
+#define APP_LOG_MAX_ARGS 6
+
+/* Largest record: length, id, timestamp and arguments */
+#define APP_LOG_MAX_RECORD_SIZE (1 + 2 + 4 + 4 * APP_LOG_MAX_ARGS)
+
+/* Whether a message is recorded at the current level of its module. The
+ * test is against constants and one byte of RAM. */
+#define APP_LOG_ENABLED(id) (id##_LEVEL <= au8LogModuleLevel[id##_MODULE])
+
+/* Record a message. The arguments are not evaluated when the message is
+ * off. */
+#define APP_LOG(id, ...)                                                                                               \
+    do {                                                                                                               \
+        if (APP_LOG_ENABLED(id)) {                                                                                     \
+            APP_vLog((id), APP_LOG_NARGS(__VA_ARGS__), ##__VA_ARGS__);                                                 \
+        }                                                                                                              \
+    } while (0)
+
+#define APP_LOG_NARGS(...)                                  APP_LOG_NARGS_(0, ##__VA_ARGS__, 6, 5, 4, 3, 2, 1, 0)
+#define APP_LOG_NARGS_(_0, _1, _2, _3, _4, _5, _6, n, ...) n
+
+/****************************************************************************/
+/***        Type Definitions                                              ***/
+/****************************************************************************/
+
+typedef enum {
+    E_LOG_MODULE_APP,
+    E_LOG_MODULE_ZCL,
+    E_LOG_MODULE_REPORT,
+    E_LOG_MODULE_SERIAL,
+    E_LOG_MODULE_UART,
+    E_LOG_MODULE_DEVICE_TEMPERATURE,
+    E_LOG_MODULE_COUNT
+} APP_teLogModule;
+
+typedef enum {
+    E_LOG_LEVEL_OFF,
+    E_LOG_LEVEL_ERROR,
+    E_LOG_LEVEL_WARN,
+    E_LOG_LEVEL_INFO,
+    E_LOG_LEVEL_DEBUG
+} APP_teLogLevel;
+
+/* Message ids, in table order */
+typedef enum {
+#define LOG_MESSAGE(id, module, level, format) id,
+#include "app_log_messages.h"
+#undef LOG_MESSAGE
+    E_LOG_MESSAGE_COUNT
+} APP_teLogId;
+
+/* Module and level of every message as compile time constants */
+enum {
+#define LOG_MESSAGE(id, module, level, format) id##_MODULE = E_LOG_MODULE_##module, id##_LEVEL = E_LOG_LEVEL_##level,
+#include "app_log_messages.h"
+#undef LOG_MESSAGE
+};
+
+typedef struct {
+    uint32 u32Records;
+    uint32 u32Dropped; /* records lost because the log ring was full */
+} APP_tsLogStats;
+
+/****************************************************************************/
+/***        Exported Variables                                            ***/
+/****************************************************************************/
+
+extern PUBLIC uint8 au8LogModuleLevel[E_LOG_MODULE_COUNT];
+
+/****************************************************************************/
+/***        Exported Functions                                            ***/
+/****************************************************************************/
+
+PUBLIC void APP_vLogInit(void);
+PUBLIC void APP_vLog(uint16 u16Id, uint8 u8Count, ...);
+PUBLIC void APP_vLogSetLevel(APP_teLogModule eModule, APP_teLogLevel eLevel);
+PUBLIC uint16 APP_u16LogRead(uint8 *pu8Buffer, uint16 u16Size);
+PUBLIC bool_t APP_bLogIsEmpty(void);
+PUBLIC void APP_vLogGetStats(APP_tsLogStats *psStats);
+
+/****************************************************************************/
+/***        END OF FILE                                                   ***/
+/****************************************************************************/
+
+#endif /* APP_LOG_H */
@@ -0,0 +1,120 @@
+/****************************************************************************
+ *
+ * MODULE:              Lumi Router
+ *
+ * COMPONENT:           app_log_messages.h
+ *
+ * DESCRIPTION:         Tokenized log message table
+ *
+ ****************************************************************************
+ *
+ * This software is owned by NXP B.V. and/or its supplier and is protected
+ * under applicable copyright laws. All rights are reserved. We grant You,
+ * and any third parties, a license to use this software solely and
+ * exclusively on NXP products [NXP Microcontrollers such as JN5168, JN5179].
+ * You, and any third parties must reproduce the copyright and warranty notice
+ * and any other legend of ownership on each copy or partial copy of the
+ * software.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+ * AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+ * IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE
+ * ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE
+ * LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR
+ * CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF
+ * SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS
+ * INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN
+ * CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE)
+ * ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+ * POSSIBILITY OF SUCH DAMAGE.
+ *
+ * Copyright NXP B.V. 2016. All rights reserved
+ *
+ ****************************************************************************/
+
+/* Every message the tokenized log can record, one per line as
+ *
+ *     LOG_MESSAGE(id, module, level, format)
+ *
+ * The position in this table is the message id sent in a log record, so
+ * new messages go at the end. The format is never used on the chip; the
+ * build turns this table into the string table the host decodes with.
+ * Arguments are 32 bits wide; pass 64-bit values as two %08x halves.
+ *
+ * This file is included more than once with different definitions of
+ * LOG_MESSAGE and has no include guard. */
+
+LOG_MESSAGE(E_LOG_APP_PDM_CAPACITY, APP, INFO, "PDM: Capacity %d")
+LOG_MESSAGE(E_LOG_APP_PDM_OCCUPANCY, APP, INFO, "PDM: Occupancy %d")
+LOG_MESSAGE(E_LOG_APP_START_UP_STATE, APP, INFO, "Start Up State %d On Network %d")
+LOG_MESSAGE(E_LOG_APP_BDB_INIT_SUCCESS, APP, INFO, "APP: BDB_EVENT_INIT_SUCCESS")
+LOG_MESSAGE(E_LOG_APP_BDB_TRY_STEERING, APP, INFO, "BDB Try Steering status %d")
+LOG_MESSAGE(E_LOG_APP_BDB_INIT_RUNNING, APP, INFO, "BDB Init go Running")
+LOG_MESSAGE(E_LOG_APP_NWK_FORMATION_SUCCESS, APP, INFO, "APP: NwkFormation Success")
+LOG_MESSAGE(E_LOG_APP_NWK_STEERING_SUCCESS, APP, INFO, "APP: NwkSteering Success")
+LOG_MESSAGE(E_LOG_ZDO_DATA_INDICATION, APP, DEBUG, "APP-ZDO: Data Indication Status %02x from %04x Src Ep %d Dst Ep %d Profile %04x Cluster %04x")
+LOG_MESSAGE(E_LOG_ZDO_NWK_STARTED, APP, INFO, "APP-ZDO: Network started")
+LOG_MESSAGE(E_LOG_ZDO_JOINED_AS_ROUTER, APP, INFO, "APP-ZDO: Joined Network Addr %04x Rejoin %d")
+LOG_MESSAGE(E_LOG_ZDO_FAILED_TO_START, APP, WARN, "APP-ZDO: Network Failed To start")
+LOG_MESSAGE(E_LOG_ZDO_FAILED_TO_JOIN, APP, WARN, "APP-ZDO: Failed To Join %02x Rejoin %d")
+LOG_MESSAGE(E_LOG_ZDO_NEW_NODE, APP, INFO, "APP-ZDO: New Node %04x Has Joined")
+LOG_MESSAGE(E_LOG_ZDO_DISCOVERY_COMPLETE, APP, INFO, "APP-ZDO: Discovery Complete %02x")
+LOG_MESSAGE(E_LOG_ZDO_LEAVE_INDICATION, APP, INFO, "APP-ZDO: Leave Indication %08x%08x Rejoin %d")
+LOG_MESSAGE(E_LOG_ZDO_LEAVE_NO_REJOIN, APP, WARN, "LEAVE IND -> For Us No Rejoin")
+LOG_MESSAGE(E_LOG_ZDO_LEAVE_CONFIRM, APP, INFO, "APP-ZDO: Leave Confirm status %02x Addr %08x%08x")
+LOG_MESSAGE(E_LOG_ZDO_LEAVE_RESET, APP, WARN, "Leave -> Reset Data Structures")
+LOG_MESSAGE(E_LOG_ZDO_NWK_STATUS, APP, INFO, "APP-ZDO: Network status Indication %02x addr %04x")
+LOG_MESSAGE(E_LOG_ZDO_ROUTE_DISCOVERY_CONFIRM, APP, DEBUG, "APP-ZDO: Discovery Confirm")
+LOG_MESSAGE(E_LOG_ZDO_ED_SCAN, APP, DEBUG, "APP-ZDO: Energy Detect Scan %02x")
+LOG_MESSAGE(E_LOG_ZDO_BIND, APP, DEBUG, "APP-ZDO: Zdo Bind event")
+LOG_MESSAGE(E_LOG_ZDO_UNBIND, APP, DEBUG, "APP-ZDO: Zdo Unbind Event")
+LOG_MESSAGE(E_LOG_ZDO_LINK_KEY, APP, DEBUG, "APP-ZDO: Zdo Link Key Event Type %d Addr %08x%08x")
+LOG_MESSAGE(E_LOG_ZDO_BIND_REQUEST_SERVER, APP, DEBUG, "APP-ZDO: Bind Request Server Event")
+LOG_MESSAGE(E_LOG_ZDO_AF_ERROR, APP, ERROR, "APP-ZDO: AF Error Event %d")
+LOG_MESSAGE(E_LOG_ZDO_TC_STATUS, APP, INFO, "APP-ZDO: Trust Center Status %02x")
+LOG_MESSAGE(E_LOG_ZDO_UNHANDLED, APP, DEBUG, "APP-ZDO: Unhandled Event %d")
+LOG_MESSAGE(E_LOG_ZDO_APS_KEY, APP, DEBUG, "APS Key %d: MAC %08x%08x Incoming FC %d Outgoing FC %d")
+LOG_MESSAGE(E_LOG_APP_RESET, APP, INFO, "*** ROUTER RESET ***")
+LOG_MESSAGE(E_LOG_APP_WATCHDOG_RESET, APP, WARN, "APP: Watchdog timer has reset device!")
+LOG_MESSAGE(E_LOG_APP_SET_UP_HARDWARE, APP, DEBUG, "APP: Entering APP_vSetUpHardware()")
+LOG_MESSAGE(E_LOG_APP_INIT_RESOURCES, APP, DEBUG, "APP: Entering APP_vInitResources()")
+LOG_MESSAGE(E_LOG_APP_INITIALISE, APP, DEBUG, "APP: Entering APP_vInitialise()")
+LOG_MESSAGE(E_LOG_APP_BDB_START, APP, DEBUG, "APP: Entering BDB_vStart()")
+LOG_MESSAGE(E_LOG_APP_MAIN_LOOP, APP, DEBUG, "APP: Entering APP_vMainLoop()")
+LOG_MESSAGE(E_LOG_APP_EXTENDED_STATUS, APP, ERROR, "ERROR: Extended status 0x%02x")
+LOG_MESSAGE(E_LOG_ZCL_INIT_FAILED, ZCL, ERROR, "Err: eZLO_Initialise:%d")
+LOG_MESSAGE(E_LOG_ZCL_REGISTER_FAILED, ZCL, ERROR, "Error: APP_ZCL_eRegisterEndPoint: %02x")
+LOG_MESSAGE(E_LOG_ZCL_STACK_EVENT, ZCL, DEBUG, "ZCL_Task endpoint event:%d")
+LOG_MESSAGE(E_LOG_ZCL_GENERAL_EVENT, ZCL, DEBUG, "EVT: Type %d")
+LOG_MESSAGE(E_LOG_ZCL_ENDPOINT_EVENT, ZCL, DEBUG, "EP EVT: Type %d Status %02x")
+LOG_MESSAGE(E_LOG_ZCL_READ_ATTRIBUTE_RESPONSE, ZCL, DEBUG, "EP EVT: Rd Attr Rsp %04x AS %d")
+LOG_MESSAGE(E_LOG_ZCL_CUSTOM, ZCL, DEBUG, "EP EVT: Custom Cl %04x")
+LOG_MESSAGE(E_LOG_ZCL_REPORT_ATTRIBUTE, ZCL, DEBUG, "Individual Report Cluster %04x Attrib %04x Type %d Status %d")
+LOG_MESSAGE(E_LOG_ZCL_CONFIGURE_REPORT, ZCL, INFO, "Individual Configure Report Cluster %04x Attrib %04x Status %d")
+LOG_MESSAGE(E_LOG_ZCL_CLUSTER_UPDATE, ZCL, DEBUG, "Update Id %04x")
+LOG_MESSAGE(E_LOG_ZCL_FACTORY_RESET, ZCL, INFO, "Basic Factory Reset Received")
+LOG_MESSAGE(E_LOG_REPORT_RESTORE, REPORT, INFO, "eStatusReportReload = %d")
+LOG_MESSAGE(E_LOG_REPORT_MAKE_REPORTABLE, REPORT, DEBUG, "MAKE Reportable ep %d")
+LOG_MESSAGE(E_LOG_REPORT_LOAD_DEFAULTS, REPORT, INFO, "Loading default configuration for reports")
+LOG_MESSAGE(E_LOG_REPORT_SAVE, REPORT, DEBUG, "Save to report %d")
+LOG_MESSAGE(E_LOG_REPORT_RECORD, REPORT, DEBUG, "Cluster %04x Attrib %04x Type %d Direction %d")
+LOG_MESSAGE(E_LOG_REPORT_RECORD_INTERVALS, REPORT, DEBUG, "Min %d Max %d IntV %d Change %d")
+LOG_MESSAGE(E_LOG_SERIAL_BAUD_RATE_NOT_CONFIRMED, SERIAL, WARN, "Baud rate not confirmed, back to %d")
+LOG_MESSAGE(E_LOG_SERIAL_LEGACY_MESSAGE, SERIAL, DEBUG, "APP_WriteMessageToSerial(%d bytes)")
+LOG_MESSAGE(E_LOG_SERIAL_RX_NO_BUFFER, SERIAL, WARN, "RX Start, no buffer")
+LOG_MESSAGE(E_LOG_SERIAL_RX_START, SERIAL, DEBUG, "RX Start")
+LOG_MESSAGE(E_LOG_SERIAL_RX_HEADER, SERIAL, DEBUG, "Type 0x%x Length %d")
+LOG_MESSAGE(E_LOG_SERIAL_RX_OVERSIZE, SERIAL, WARN, "Length %d > MaxLength")
+LOG_MESSAGE(E_LOG_SERIAL_RX_END, SERIAL, DEBUG, "Got END")
+LOG_MESSAGE(E_LOG_SERIAL_RX_CRC_BAD, SERIAL, WARN, "CRC BAD Type 0x%x CRC %04x Expected %04x")
+LOG_MESSAGE(E_LOG_SERIAL_RX_FRAME, SERIAL, DEBUG, "APP_vRxEnd(%d, %d, %04x)")
+LOG_MESSAGE(E_LOG_SERIAL_REPEATED_REQUEST, SERIAL, INFO, "Request %d already done")
+LOG_MESSAGE(E_LOG_SERIAL_BENCHMARK, SERIAL, INFO, "Benchmark %d bytes in %d ms")
+LOG_MESSAGE(E_LOG_UART_INIT, UART, INFO, "UART: Initialised")
+LOG_MESSAGE(E_LOG_UART_BAUD_RATE, UART, INFO, "UART: Baud rate %d")
+LOG_MESSAGE(E_LOG_DEVICE_TEMPERATURE_INIT, DEVICE_TEMPERATURE, INFO, "APP: Init Device Temperature")
+LOG_MESSAGE(E_LOG_DEVICE_TEMPERATURE_READING, DEVICE_TEMPERATURE, DEBUG, "APP: Temp = %d C")
+
+/****************************************************************************/
+/***        END OF FILE                                                   ***/
+/****************************************************************************/
@@ -39,11 +39,19 @@
 #include <jendefs.h>
 
 /* Application */
+#include "app_cpu.h"
 #include "app_device_temperature.h"
 #include "app_main.h"
+#include "app_pt.h"
+#include "app_queue.h"
+#include "app_ring_buffer.h"
 #include "app_router_node.h"
+#include "app_scheduler.h"
 #include "app_serial_commands.h"
+#include "app_stack.h"
+#include "app_timer.h"
 #include "app_zcl_task.h"
+#include "app_ztimer.h"
 
 /* SDK JN-SW-4170 */
 #include "AppHardwareApi.h"
@@ -58,21 +66,40 @@
 /***        Macro Definitions                                             ***/
 /****************************************************************************/
 
-#ifdef DEBUG_APP
-#define TRACE_APP TRUE
-#else
-#define TRACE_APP FALSE
-#endif
+/* The application timers share one ZTimer through the timer wheel */
+#define APP_ZTIMER_STORAGE 1
 
-#define APP_ZTIMER_STORAGE 3
+#if (APP_ZTIMER_STORAGE + BDB_ZTIMER_STORAGE) > APP_ZTIMER_MAX_TIMERS
+#error More ZTimers than app_ztimer.c tracks
+#endif
 
 #define BDB_QUEUE_SIZE       2
 #define MLME_QUEQUE_SIZE     8
 #define MCPS_QUEUE_SIZE      20
 #define TIMER_QUEUE_SIZE     8
 #define MCPS_DCFM_QUEUE_SIZE 5
-#define TX_QUEUE_SIZE        150
-#define RX_QUEUE_SIZE        150
+#define TX_RING_SIZE         128
+#define RX_RING_SIZE         256
+
+/* Encoded frames waiting on each serial channel. Telemetry carries the
+ * benchmark echo of a data frame, which may be of the largest size. */
+#define RESPONSE_RING_SIZE  256
+#define EVENT_RING_SIZE     64
+#define TELEMETRY_RING_SIZE 1024
+#define LOG_RING_SIZE       256
+
+#if !RB_IS_POWER_OF_TWO(TX_RING_SIZE) || !RB_IS_POWER_OF_TWO(RX_RING_SIZE)
+#error Serial ring sizes must be a power of two
+#endif
+
+#if !RB_IS_POWER_OF_TWO(RESPONSE_RING_SIZE) || !RB_IS_POWER_OF_TWO(EVENT_RING_SIZE) ||                                \
+    !RB_IS_POWER_OF_TWO(TELEMETRY_RING_SIZE) || !RB_IS_POWER_OF_TWO(LOG_RING_SIZE)
+#error Serial channel ring sizes must be a power of two
+#endif
+
+#if TELEMETRY_RING_SIZE < SL_MAX_QUEUED_SIZE(MAX_PACKET_SIZE)
+#error The telemetry ring must hold the echo of the largest frame
+#endif
 
 /****************************************************************************/
 /***        Type Definitions                                              ***/
@@ -82,18 +109,25 @@
 /***        Local Function Prototypes                                     ***/
 /****************************************************************************/
 
+PRIVATE void APP_vPollTasks(void);
+PRIVATE void APP_vDoze(void);
+
 /****************************************************************************/
 /***        Exported Variables                                            ***/
 /****************************************************************************/
 
-PUBLIC uint8 u8TimerTick;
-PUBLIC uint8 u8TimerRestart;
-PUBLIC uint8 u8TimerDeviceTemperature;
+PUBLIC APP_tsTimer sTimerTick;
+PUBLIC APP_tsTimer sTimerRestart;
+PUBLIC APP_tsTimer sTimerDeviceTemperature;
+PUBLIC APP_tsTimer sTimerBaudRate;
 
 PUBLIC tszQueue APP_msgBdbEvents;
 PUBLIC tszQueue APP_msgAppEvents;
-PUBLIC tszQueue APP_msgSerialTx;
-PUBLIC tszQueue APP_msgSerialRx;
+PUBLIC tszQueue APP_msgSerialFrames;
+
+PUBLIC RB_tsRingBuffer APP_rbSerialTx;
+PUBLIC RB_tsRingBuffer APP_rbSerialRx;
+PUBLIC RB_tsRingBuffer APP_rbSerialChannel[E_SERIAL_CHANNEL_COUNT];
 
 /****************************************************************************/
 /***        Local Variables                                               ***/
@@ -106,8 +140,13 @@ PRIVATE MAC_tsMlmeVsDcfmInd asMacMlmeVsDcfmInd[MLME_QUEQUE_SIZE];
 PRIVATE MAC_tsMcpsVsDcfmInd asMacMcpsDcfmInd[MCPS_QUEUE_SIZE];
 PRIVATE zps_tsTimeEvent asTimeEvent[TIMER_QUEUE_SIZE];
 PRIVATE MAC_tsMcpsVsCfmData asMacMcpsDcfm[MCPS_DCFM_QUEUE_SIZE];
-PRIVATE uint8 au8TxBuffer[TX_QUEUE_SIZE];
-PRIVATE uint8 au8RxBuffer[RX_QUEUE_SIZE];
+PRIVATE uint8 au8TxBuffer[TX_RING_SIZE];
+PRIVATE uint8 au8RxBuffer[RX_RING_SIZE];
+PRIVATE uint8 au8ResponseBuffer[RESPONSE_RING_SIZE];
+PRIVATE uint8 au8EventBuffer[EVENT_RING_SIZE];
+PRIVATE uint8 au8TelemetryBuffer[TELEMETRY_RING_SIZE];
+PRIVATE uint8 au8LogBuffer[LOG_RING_SIZE];
+PRIVATE APP_tsSerialFrame *apsSerialFrame[SERIAL_FRAME_POOL_SIZE];
 
 /****************************************************************************/
 /***        Exported Functions                                            ***/
@@ -116,24 +155,40 @@ PRIVATE uint8 au8RxBuffer[RX_QUEUE_SIZE];
 extern void zps_taskZPS(void);
 extern void PWRM_vManagePower(void);
 
+/* Indexed by APP_teTask */
+PRIVATE const APP_tpfTask apfTasks[E_APP_TASK_COUNT] = {zps_taskZPS,
+                                                        bdb_taskBDB,
+                                                        APP_vZTimerTask,
+                                                        APP_taskAtSerial,
+                                                        APP_taskPt};
+
 /****************************************************************************
  *
  * NAME: APP_vMainLoop
  *
  * DESCRIPTION:
- * Main application loop
+ * Main application loop. Only the tasks with work run; the CPU dozes as
+ * soon as none has any.
  *
  ****************************************************************************/
 PUBLIC void APP_vMainLoop(void)
 {
+    uint32 u32Ran;
+
+    APP_vCpuInit();
+
     while (TRUE) {
-        zps_taskZPS();
+        APP_vPollTasks();
 
-        bdb_taskBDB();
+        u32Ran = APP_u32RunReadyTasks(apfTasks);
 
-        ZTIMER_vTask();
+        /* The application tasks may have made requests of the stack. The
+         * ZTimer task marks the stack itself, when a timer expired. */
+        if (u32Ran & ~(APP_TASK_MASK(E_APP_TASK_ZPS) | APP_TASK_MASK(E_APP_TASK_ZTIMER))) {
+            APP_vSetTaskReady(E_APP_TASK_ZPS);
+        }
 
-        APP_taskAtSerial();
+        APP_vLoopPassDone();
 
         /* Re-load the watch-dog timer. Execution must return through the idle
          * task before the CPU is suspended by the power manager. This ensures
@@ -142,8 +197,12 @@ PUBLIC void APP_vMainLoop(void)
         vAHI_WatchdogRestart();
 
         /* suspends CPU operation when the system is idle or puts the device to
-         * sleep if there are no activities in progress */
-        PWRM_vManagePower();
+         * sleep if there are no activities in progress. An interrupt that
+         * makes a task ready also ends the doze. */
+        if (!APP_bTasksReady()) {
+            APP_vStackScan();
+            APP_bDozeIfIdle(APP_vDoze);
+        }
     }
 }
 
@@ -174,27 +233,105 @@ PUBLIC void APP_vSetUpHardware(void)
 PUBLIC void APP_vInitResources(void)
 {
     /* Initialise the Z timer module */
-    ZTIMER_eInit(asTimers, sizeof(asTimers) / sizeof(ZTIMER_tsTimer));
-
-    /* Create Z timers */
-    ZTIMER_eOpen(&u8TimerTick, APP_cbTimerZclTick, NULL, ZTIMER_FLAG_PREVENT_SLEEP);
-    ZTIMER_eOpen(&u8TimerRestart, APP_cbTimerRestart, NULL, ZTIMER_FLAG_PREVENT_SLEEP);
-    ZTIMER_eOpen(&u8TimerDeviceTemperature, APP_cbTimerDeviceTemperatureUpdate, NULL, ZTIMER_FLAG_PREVENT_SLEEP);
-
-    /* Create all the queues */
-    ZQ_vQueueCreate(&APP_msgBdbEvents, BDB_QUEUE_SIZE, sizeof(BDB_tsZpsAfEvent), (uint8 *)asBdbEvent);
-    ZQ_vQueueCreate(&zps_msgMlmeDcfmInd, MLME_QUEQUE_SIZE, sizeof(MAC_tsMlmeVsDcfmInd), (uint8 *)asMacMlmeVsDcfmInd);
-    ZQ_vQueueCreate(&zps_msgMcpsDcfmInd, MCPS_QUEUE_SIZE, sizeof(MAC_tsMcpsVsDcfmInd), (uint8 *)asMacMcpsDcfmInd);
-    ZQ_vQueueCreate(&zps_TimeEvents, TIMER_QUEUE_SIZE, sizeof(zps_tsTimeEvent), (uint8 *)asTimeEvent);
-    ZQ_vQueueCreate(&zps_msgMcpsDcfm, MCPS_DCFM_QUEUE_SIZE, sizeof(MAC_tsMcpsVsCfmData), (uint8 *)asMacMcpsDcfm);
-    ZQ_vQueueCreate(&APP_msgSerialTx, TX_QUEUE_SIZE, sizeof(uint8), (uint8 *)au8TxBuffer);
-    ZQ_vQueueCreate(&APP_msgSerialRx, RX_QUEUE_SIZE, sizeof(uint8), (uint8 *)au8RxBuffer);
+    APP_vZTimerInit(asTimers, sizeof(asTimers) / sizeof(ZTIMER_tsTimer));
+
+    /* Create the application timers */
+    APP_vTimerInit();
+    APP_vTimerCreate(&sTimerTick, APP_cbTimerZclTick, NULL);
+    APP_vTimerCreate(&sTimerRestart, APP_cbTimerRestart, NULL);
+    APP_vTimerCreate(&sTimerDeviceTemperature, APP_cbTimerDeviceTemperatureUpdate, NULL);
+    APP_vTimerCreate(&sTimerBaudRate, APP_cbTimerBaudRate, NULL);
+
+    /* Create all the queues, tracking how full they get */
+    APP_vQueueCreate(E_APP_QUEUE_BDB_EVENTS,
+                     &APP_msgBdbEvents,
+                     BDB_QUEUE_SIZE,
+                     sizeof(BDB_tsZpsAfEvent),
+                     (uint8 *)asBdbEvent);
+    APP_vQueueCreate(E_APP_QUEUE_MLME_DCFM_IND,
+                     &zps_msgMlmeDcfmInd,
+                     MLME_QUEQUE_SIZE,
+                     sizeof(MAC_tsMlmeVsDcfmInd),
+                     (uint8 *)asMacMlmeVsDcfmInd);
+    APP_vQueueCreate(E_APP_QUEUE_MCPS_DCFM_IND,
+                     &zps_msgMcpsDcfmInd,
+                     MCPS_QUEUE_SIZE,
+                     sizeof(MAC_tsMcpsVsDcfmInd),
+                     (uint8 *)asMacMcpsDcfmInd);
+    APP_vQueueCreate(E_APP_QUEUE_TIME_EVENTS,
+                     &zps_TimeEvents,
+                     TIMER_QUEUE_SIZE,
+                     sizeof(zps_tsTimeEvent),
+                     (uint8 *)asTimeEvent);
+    APP_vQueueCreate(E_APP_QUEUE_MCPS_DCFM,
+                     &zps_msgMcpsDcfm,
+                     MCPS_DCFM_QUEUE_SIZE,
+                     sizeof(MAC_tsMcpsVsCfmData),
+                     (uint8 *)asMacMcpsDcfm);
+    APP_vQueueCreate(E_APP_QUEUE_SERIAL_FRAMES,
+                     &APP_msgSerialFrames,
+                     SERIAL_FRAME_POOL_SIZE,
+                     sizeof(APP_tsSerialFrame *),
+                     (uint8 *)apsSerialFrame);
+
+    /* The serial byte streams between APP_isrUart and the serial task */
+    RB_vInit(&APP_rbSerialTx, au8TxBuffer, TX_RING_SIZE);
+    RB_vInit(&APP_rbSerialRx, au8RxBuffer, RX_RING_SIZE);
+
+    /* Frames queued per channel by the serial task, ahead of the TX ring */
+    RB_vInit(&APP_rbSerialChannel[E_SERIAL_CHANNEL_RESPONSE], au8ResponseBuffer, RESPONSE_RING_SIZE);
+    RB_vInit(&APP_rbSerialChannel[E_SERIAL_CHANNEL_EVENT], au8EventBuffer, EVENT_RING_SIZE);
+    RB_vInit(&APP_rbSerialChannel[E_SERIAL_CHANNEL_TELEMETRY], au8TelemetryBuffer, TELEMETRY_RING_SIZE);
+    RB_vInit(&APP_rbSerialChannel[E_SERIAL_CHANNEL_LOG], au8LogBuffer, LOG_RING_SIZE);
 }
 
 /****************************************************************************/
 /***        Local Functions                                               ***/
 /****************************************************************************/
 
+/****************************************************************************
+ *
+ * NAME: APP_vPollTasks
+ *
+ * DESCRIPTION:
+ * Mark the tasks whose work arrives where no ready bit can be set: the
+ * stack queues are filled inside the SDK, and the serial task may have
+ * work left over from its last pass
+ *
+ ****************************************************************************/
+PRIVATE void APP_vPollTasks(void)
+{
+    if (!ZQ_bQueueIsEmpty(&zps_msgMlmeDcfmInd) || !ZQ_bQueueIsEmpty(&zps_msgMcpsDcfmInd) ||
+        !ZQ_bQueueIsEmpty(&zps_msgMcpsDcfm) || !ZQ_bQueueIsEmpty(&zps_TimeEvents)) {
+        APP_vSetTaskReady(E_APP_TASK_ZPS);
+    }
+
+    if (!ZQ_bQueueIsEmpty(&APP_msgBdbEvents)) {
+        APP_vSetTaskReady(E_APP_TASK_BDB);
+    }
+
+    if (APP_bSerialHasWork()) {
+        APP_vSetTaskReady(E_APP_TASK_SERIAL);
+    }
+}
+
+/****************************************************************************
+ *
+ * NAME: APP_vDoze
+ *
+ * DESCRIPTION:
+ * Doze in the power manager. Called with interrupts masked; the interrupt
+ * that ends the doze is serviced once they are unmasked again, after the
+ * doze has been timed. The time spent here is the idle time of the CPU.
+ *
+ ****************************************************************************/
+PRIVATE void APP_vDoze(void)
+{
+    APP_vCpuDozeStart();
+    PWRM_vManagePower();
+    APP_vCpuDozeEnd();
+}
+
 /****************************************************************************/
 /***        END OF FILE                                                   ***/
 /****************************************************************************/
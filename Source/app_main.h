@@ -41,6 +41,10 @@
 
 #include <jendefs.h>
 
+/* Application */
+#include "app_ring_buffer.h"
+#include "app_timer.h"
+
 /* SDK JN-SW-4170 */
 #include "ZQueue.h"
 
@@ -56,14 +60,18 @@
 /***        Exported Variables                                            ***/
 /****************************************************************************/
 
-extern PUBLIC uint8 u8TimerTick;
-extern PUBLIC uint8 u8TimerRestart;
-extern PUBLIC uint8 u8TimerDeviceTemperature;
+extern PUBLIC APP_tsTimer sTimerTick;
+extern PUBLIC APP_tsTimer sTimerRestart;
+extern PUBLIC APP_tsTimer sTimerDeviceTemperature;
+extern PUBLIC APP_tsTimer sTimerBaudRate;
 
 extern PUBLIC tszQueue APP_msgBdbEvents;
 extern PUBLIC tszQueue APP_msgAppEvents;
-extern PUBLIC tszQueue APP_msgSerialTx;
-extern PUBLIC tszQueue APP_msgSerialRx;
+extern PUBLIC tszQueue APP_msgSerialFrames;
+
+extern PUBLIC RB_tsRingBuffer APP_rbSerialTx;
+extern PUBLIC RB_tsRingBuffer APP_rbSerialRx;
+extern PUBLIC RB_tsRingBuffer APP_rbSerialChannel[];
 
 extern PUBLIC tszQueue zps_msgMlmeDcfmInd;
 extern PUBLIC tszQueue zps_msgMcpsDcfmInd;
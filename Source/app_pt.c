@@ -0,0 +1,173 @@
+/****************************************************************************
+ *
+ * MODULE:              Lumi Router
+ *
+ * COMPONENT:           APP_PT
+ *
+ * DESCRIPTION:         Protothreads for long application operations
+ *
+ ****************************************************************************
+ *
+ * This software is owned by NXP B.V. and/or its supplier and is protected
+ * under applicable copyright laws. All rights are reserved. We grant You,
+ * and any third parties, a license to use this software solely and
+ * exclusively on NXP products [NXP Microcontrollers such as JN5168, JN5179].
+ * You, and any third parties must reproduce the copyright and warranty notice
+ * and any other legend of ownership on each copy or partial copy of the
+ * software.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+ * AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+ * IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE
+ * ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE
+ * LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR
+ * CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF
+ * SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS
+ * INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN
+ * CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE)
+ * ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+ * POSSIBILITY OF SUCH DAMAGE.
+ *
+ * Copyright NXP B.V. 2016. All rights reserved
+ *
+ ****************************************************************************/
+
+/****************************************************************************/
+/***        Include Files                                                 ***/
+/****************************************************************************/
+
+#include <jendefs.h>
+
+/* Application */
+#include "app_pt.h"
+#include "app_scheduler.h"
+
+/****************************************************************************/
+/***        Macro Definitions                                             ***/
+/****************************************************************************/
+
+/****************************************************************************/
+/***        Type Definitions                                              ***/
+/****************************************************************************/
+
+/****************************************************************************/
+/***        Local Function Prototypes                                     ***/
+/****************************************************************************/
+
+/****************************************************************************/
+/***        Exported Variables                                            ***/
+/****************************************************************************/
+
+/****************************************************************************/
+/***        Local Variables                                               ***/
+/****************************************************************************/
+
+PRIVATE APP_tsPtTask *apsThreads[APP_PT_MAX_THREADS];
+
+/****************************************************************************/
+/***        Exported Functions                                            ***/
+/****************************************************************************/
+
+/****************************************************************************
+ *
+ * NAME: APP_vPtCreate
+ *
+ * DESCRIPTION:
+ * Set up a stopped thread
+ *
+ ****************************************************************************/
+PUBLIC void APP_vPtCreate(APP_tsPtTask *psTask, APP_tpfPtThread pfThread)
+{
+    psTask->sPt.u16Line = 0;
+    psTask->pfThread = pfThread;
+    psTask->bRunning = FALSE;
+}
+
+/****************************************************************************
+ *
+ * NAME: APP_bPtStart
+ *
+ * DESCRIPTION:
+ * Run a thread from its start, one step per main loop pass. A thread
+ * already running is left alone.
+ *
+ * RETURNS:
+ * FALSE if every thread slot is taken
+ *
+ ****************************************************************************/
+PUBLIC bool_t APP_bPtStart(APP_tsPtTask *psTask)
+{
+    uint8 i;
+
+    if (psTask->bRunning) {
+        return TRUE;
+    }
+
+    for (i = 0; i < APP_PT_MAX_THREADS; i++) {
+        if (apsThreads[i] == NULL) {
+            psTask->sPt.u16Line = 0;
+            psTask->bRunning = TRUE;
+            apsThreads[i] = psTask;
+            APP_vSetTaskReady(E_APP_TASK_PT);
+            return TRUE;
+        }
+    }
+
+    return FALSE;
+}
+
+/****************************************************************************
+ *
+ * NAME: APP_bPtRunning
+ *
+ * DESCRIPTION:
+ * Check whether a thread has yet to finish
+ *
+ ****************************************************************************/
+PUBLIC bool_t APP_bPtRunning(const APP_tsPtTask *psTask)
+{
+    return psTask->bRunning;
+}
+
+/****************************************************************************
+ *
+ * NAME: APP_taskPt
+ *
+ * DESCRIPTION:
+ * Main loop task. Step every running thread once and stay ready while
+ * any has more to do, so the stack runs between the steps.
+ *
+ ****************************************************************************/
+PUBLIC void APP_taskPt(void)
+{
+    APP_tsPtTask *psTask;
+    bool_t bPending = FALSE;
+    uint8 i;
+
+    for (i = 0; i < APP_PT_MAX_THREADS; i++) {
+        psTask = apsThreads[i];
+        if (psTask == NULL) {
+            continue;
+        }
+
+        if (psTask->pfThread(&psTask->sPt) == E_APP_PT_DONE) {
+            psTask->bRunning = FALSE;
+            apsThreads[i] = NULL;
+        }
+        else {
+            bPending = TRUE;
+        }
+    }
+
+    if (bPending) {
+        APP_vSetTaskReady(E_APP_TASK_PT);
+    }
+}
+
+/****************************************************************************/
+/***        Local Functions                                               ***/
+/****************************************************************************/
+
+/****************************************************************************/
+/***        END OF FILE                                                   ***/
+/****************************************************************************/
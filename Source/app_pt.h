@@ -0,0 +1,132 @@
+/****************************************************************************
+ *
+ * MODULE:              Lumi Router
+ *
+ * COMPONENT:           APP_PT
+ *
+ * DESCRIPTION:         Protothreads for long application operations
+ *
+ ****************************************************************************
+ *
+ * This software is owned by NXP B.V. and/or its supplier and is protected
+ * under applicable copyright laws. All rights are reserved. We grant You,
+ * and any third parties, a license to use this software solely and
+ * exclusively on NXP products [NXP Microcontrollers such as JN5168, JN5179].
+ * You, and any third parties must reproduce the copyright and warranty notice
+ * and any other legend of ownership on each copy or partial copy of the
+ * software.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+ * AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+ * IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE
+ * ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE
+ * LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR
+ * CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF
+ * SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS
+ * INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN
+ * CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE)
+ * ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+ * POSSIBILITY OF SUCH DAMAGE.
+ *
+ * Copyright NXP B.V. 2016. All rights reserved
+ *
+ ****************************************************************************/
+
+#ifndef APP_PT_H
+#define APP_PT_H
+
+/****************************************************************************/
+/***        Include Files                                                 ***/
+/****************************************************************************/
+
+#include <jendefs.h>
+
+/****************************************************************************/
+/***        Macro Definitions                                             ***/
+/****************************************************************************/
+
+/* Stackless coroutines. A thread is a function taking its APP_tsPt and
+ * returning APP_tePtState; its body sits between APP_PT_BEGIN and
+ * APP_PT_END. The resume point is kept as a source line in a switch, so
+ * locals do not survive a yield (keep state in statics), the body may not
+ * use switch itself around a yield, and each source line holds at most
+ * one yield or wait. */
+#define APP_PT_MAX_THREADS 4
+
+/* The first pass of a wait runs on into its case label. The JN516x gcc
+ * predates the attribute and the warning. */
+#if defined(__GNUC__) && (__GNUC__ >= 7)
+#define APP_PT_FALLTHROUGH __attribute__((fallthrough))
+#else
+#define APP_PT_FALLTHROUGH
+#endif
+
+#define APP_PT_BEGIN(psPt)                                                                                             \
+    switch ((psPt)->u16Line) {                                                                                         \
+    case 0:
+
+#define APP_PT_END(psPt)                                                                                               \
+    }                                                                                                                  \
+    (psPt)->u16Line = 0;                                                                                               \
+    return E_APP_PT_DONE
+
+/* Give the rest of the main loop a pass, then carry on here */
+#define APP_PT_YIELD(psPt)                                                                                             \
+    do {                                                                                                               \
+        (psPt)->u16Line = __LINE__;                                                                                    \
+        return E_APP_PT_YIELDED;                                                                                       \
+    case __LINE__:;                                                                                                    \
+    } while (0)
+
+/* Check the condition once per main loop pass until it holds */
+#define APP_PT_WAIT_UNTIL(psPt, bCondition)                                                                            \
+    do {                                                                                                               \
+        (psPt)->u16Line = __LINE__;                                                                                    \
+        APP_PT_FALLTHROUGH;                                                                                            \
+    case __LINE__:                                                                                                     \
+        if (!(bCondition)) {                                                                                           \
+            return E_APP_PT_WAITING;                                                                                   \
+        }                                                                                                              \
+    } while (0)
+
+/****************************************************************************/
+/***        Type Definitions                                              ***/
+/****************************************************************************/
+
+typedef enum {
+    E_APP_PT_WAITING,
+    E_APP_PT_YIELDED,
+    E_APP_PT_DONE
+} APP_tePtState;
+
+typedef struct {
+    uint16 u16Line;
+} APP_tsPt;
+
+typedef APP_tePtState (*APP_tpfPtThread)(APP_tsPt *psPt);
+
+/* A thread run by the APP_taskPt main loop task */
+typedef struct {
+    APP_tsPt sPt;
+    APP_tpfPtThread pfThread;
+    bool_t bRunning;
+} APP_tsPtTask;
+
+/****************************************************************************/
+/***        Exported Variables                                            ***/
+/****************************************************************************/
+
+/****************************************************************************/
+/***        Exported Functions                                            ***/
+/****************************************************************************/
+
+PUBLIC void APP_vPtCreate(APP_tsPtTask *psTask, APP_tpfPtThread pfThread);
+PUBLIC bool_t APP_bPtStart(APP_tsPtTask *psTask);
+PUBLIC bool_t APP_bPtRunning(const APP_tsPtTask *psTask);
+PUBLIC void APP_taskPt(void);
+
+/****************************************************************************/
+/***        END OF FILE                                                   ***/
+/****************************************************************************/
+
+#endif /* APP_PT_H */
@@ -0,0 +1,186 @@
+/****************************************************************************
+ *
+ * MODULE:              Lumi Router
+ *
+ * COMPONENT:           app_queue.c
+ *
+ * DESCRIPTION:         Queue usage statistics
+ *
+ ****************************************************************************
+ *
+ * This software is owned by NXP B.V. and/or its supplier and is protected
+ * under applicable copyright laws. All rights are reserved. We grant You,
+ * and any third parties, a license to use this software solely and
+ * exclusively on NXP products [NXP Microcontrollers such as JN5168, JN5179].
+ * You, and any third parties must reproduce the copyright and warranty notice
+ * and any other legend of ownership on each copy or partial copy of the
+ * software.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+ * AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+ * IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE
+ * ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE
+ * LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR
+ * CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF
+ * SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS
+ * INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN
+ * CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE)
+ * ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+ * POSSIBILITY OF SUCH DAMAGE.
+ *
+ * Copyright NXP B.V. 2016. All rights reserved
+ *
+ ****************************************************************************/
+
+/****************************************************************************/
+/***        Include Files                                                 ***/
+/****************************************************************************/
+
+#include <jendefs.h>
+
+/* Application */
+#include "app_queue.h"
+
+/* SDK JN-SW-4170 */
+#include "ZQueue.h"
+#include "portmacro.h"
+
+/****************************************************************************/
+/***        Macro Definitions                                             ***/
+/****************************************************************************/
+
+/****************************************************************************/
+/***        Type Definitions                                              ***/
+/****************************************************************************/
+
+/****************************************************************************/
+/***        Local Function Prototypes                                     ***/
+/****************************************************************************/
+
+/****************************************************************************/
+/***        Exported Variables                                            ***/
+/****************************************************************************/
+
+/****************************************************************************/
+/***        Local Variables                                               ***/
+/****************************************************************************/
+
+PRIVATE tszQueue *apsQueue[E_APP_QUEUE_COUNT];
+PRIVATE APP_tsQueueStats asQueueStats[E_APP_QUEUE_COUNT];
+
+/****************************************************************************/
+/***        Exported Functions                                            ***/
+/****************************************************************************/
+
+/* The linker is given --wrap=ZQ_bQueueSend, so every send, including those
+ * made inside the stack libraries, comes through __wrap_ZQ_bQueueSend */
+extern bool_t __real_ZQ_bQueueSend(void *pvQueueHandle, const void *pvItemToQueue);
+
+/****************************************************************************
+ *
+ * NAME: APP_vQueueCreate
+ *
+ * DESCRIPTION:
+ * Create a queue and track its usage
+ *
+ ****************************************************************************/
+PUBLIC void APP_vQueueCreate(APP_teQueue eQueue,
+                             tszQueue *psQueue,
+                             uint32 u32Length,
+                             uint32 u32ItemSize,
+                             uint8 *pu8Storage)
+{
+    ZQ_vQueueCreate(psQueue, u32Length, u32ItemSize, pu8Storage);
+
+    apsQueue[eQueue] = psQueue;
+    asQueueStats[eQueue].u16Size = (uint16)u32Length;
+}
+
+/****************************************************************************
+ *
+ * NAME: __wrap_ZQ_bQueueSend
+ *
+ * DESCRIPTION:
+ * Send to a queue, recording the peak depth and refused sends of the
+ * tracked queues. May be called from an ISR, as the original may.
+ *
+ ****************************************************************************/
+PUBLIC bool_t __wrap_ZQ_bQueueSend(void *pvQueueHandle, const void *pvItemToQueue)
+{
+    bool_t bSent = __real_ZQ_bQueueSend(pvQueueHandle, pvItemToQueue);
+    APP_tsQueueStats *psStats;
+    uint32 u32Storage;
+    uint16 u16Depth;
+    uint8 i;
+
+    for (i = 0; i < E_APP_QUEUE_COUNT; i++) {
+        if (apsQueue[i] == pvQueueHandle) {
+            break;
+        }
+    }
+    if (i == E_APP_QUEUE_COUNT) {
+        return bSent;
+    }
+
+    psStats = &asQueueStats[i];
+
+    ZPS_eEnterCriticalSection(NULL, &u32Storage);
+    if (bSent) {
+        u16Depth = (uint16)ZQ_u32QueueGetQueueMessageWaiting(pvQueueHandle);
+        if (u16Depth > psStats->u16Peak) {
+            psStats->u16Peak = u16Depth;
+        }
+    }
+    else {
+        psStats->u32Failed++;
+    }
+    ZPS_eExitCriticalSection(NULL, &u32Storage);
+
+    return bSent;
+}
+
+/****************************************************************************
+ *
+ * NAME: APP_vGetQueueStats
+ *
+ * DESCRIPTION:
+ * Read the usage of a queue
+ *
+ ****************************************************************************/
+PUBLIC void APP_vGetQueueStats(APP_teQueue eQueue, APP_tsQueueStats *psStats)
+{
+    uint32 u32Storage;
+
+    ZPS_eEnterCriticalSection(NULL, &u32Storage);
+    *psStats = asQueueStats[eQueue];
+    ZPS_eExitCriticalSection(NULL, &u32Storage);
+}
+
+/****************************************************************************
+ *
+ * NAME: APP_vResetQueueStats
+ *
+ * DESCRIPTION:
+ * Clear the peak depths and refused sends of every queue
+ *
+ ****************************************************************************/
+PUBLIC void APP_vResetQueueStats(void)
+{
+    uint32 u32Storage;
+    uint8 i;
+
+    ZPS_eEnterCriticalSection(NULL, &u32Storage);
+    for (i = 0; i < E_APP_QUEUE_COUNT; i++) {
+        asQueueStats[i].u16Peak = 0;
+        asQueueStats[i].u32Failed = 0;
+    }
+    ZPS_eExitCriticalSection(NULL, &u32Storage);
+}
+
+/****************************************************************************/
+/***        Local Functions                                               ***/
+/****************************************************************************/
+
+/****************************************************************************/
+/***        END OF FILE                                                   ***/
+/****************************************************************************/
@@ -0,0 +1,92 @@
+/****************************************************************************
+ *
+ * MODULE:              Lumi Router
+ *
+ * COMPONENT:           app_queue.h
+ *
+ * DESCRIPTION:         Queue usage statistics
+ *
+ ****************************************************************************
+ *
+ * This software is owned by NXP B.V. and/or its supplier and is protected
+ * under applicable copyright laws. All rights are reserved. We grant You,
+ * and any third parties, a license to use this software solely and
+ * exclusively on NXP products [NXP Microcontrollers such as JN5168, JN5179].
+ * You, and any third parties must reproduce the copyright and warranty notice
+ * and any other legend of ownership on each copy or partial copy of the
+ * software.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+ * AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+ * IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE
+ * ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE
+ * LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR
+ * CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF
+ * SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS
+ * INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN
+ * CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE)
+ * ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+ * POSSIBILITY OF SUCH DAMAGE.
+ *
+ * Copyright NXP B.V. 2016. All rights reserved
+ *
+ ****************************************************************************/
+
+#ifndef APP_QUEUE_H
+#define APP_QUEUE_H
+
+/****************************************************************************/
+/***        Include Files                                                 ***/
+/****************************************************************************/
+
+#include <jendefs.h>
+
+/* SDK JN-SW-4170 */
+#include "ZQueue.h"
+
+/****************************************************************************/
+/***        Macro Definitions                                             ***/
+/****************************************************************************/
+
+/****************************************************************************/
+/***        Type Definitions                                              ***/
+/****************************************************************************/
+
+/* Queues created in APP_vInitResources */
+typedef enum {
+    E_APP_QUEUE_BDB_EVENTS,
+    E_APP_QUEUE_MLME_DCFM_IND,
+    E_APP_QUEUE_MCPS_DCFM_IND,
+    E_APP_QUEUE_TIME_EVENTS,
+    E_APP_QUEUE_MCPS_DCFM,
+    E_APP_QUEUE_SERIAL_FRAMES,
+    E_APP_QUEUE_COUNT
+} APP_teQueue;
+
+typedef struct {
+    uint16 u16Size;
+    uint16 u16Peak;   /* most messages waiting at once */
+    uint32 u32Failed; /* sends refused because the queue was full */
+} APP_tsQueueStats;
+
+/****************************************************************************/
+/***        Exported Variables                                            ***/
+/****************************************************************************/
+
+/****************************************************************************/
+/***        Exported Functions                                            ***/
+/****************************************************************************/
+
+PUBLIC void APP_vQueueCreate(APP_teQueue eQueue,
+                             tszQueue *psQueue,
+                             uint32 u32Length,
+                             uint32 u32ItemSize,
+                             uint8 *pu8Storage);
+PUBLIC void APP_vGetQueueStats(APP_teQueue eQueue, APP_tsQueueStats *psStats);
+PUBLIC void APP_vResetQueueStats(void);
+
+/****************************************************************************/
+/***        END OF FILE                                                   ***/
+/****************************************************************************/
+
+#endif /* APP_QUEUE_H */
@@ -44,13 +44,13 @@
 
 /* Application */
 #include "PDM_IDs.h"
+#include "app_log.h"
 #include "app_reporting.h"
 #include "zcl_options.h"
 
 /* SDK JN-SW-4170 */
 #include "DeviceTemperatureConfiguration.h"
 #include "PDM.h"
-#include "dbg.h"
 #include "zcl.h"
 #include "zcl_common.h"
 
@@ -58,12 +58,6 @@
 /***        Macro Definitions                                             ***/
 /****************************************************************************/
 
-#ifdef DEBUG_REPORT
-#define TRACE_REPORT TRUE
-#else
-#define TRACE_REPORT FALSE
-#endif
-
 #define DEVICE_TEMPERATURE_MINIMUM_REPORTABLE_CHANGE 0x01
 
 /****************************************************************************/
@@ -80,6 +74,7 @@ typedef struct {
 /****************************************************************************/
 
 PRIVATE uint8 APP_u8GetRecordIndex(uint16 u16ClusterID, uint16 u16AttributeEnum);
+PRIVATE void APP_vLogReport(const APP_tsReports *psReport);
 
 /****************************************************************************/
 /***        Exported Variables                                            ***/
@@ -127,7 +122,7 @@ PUBLIC PDM_teStatus APP_eRestoreReports(void)
     PDM_teStatus eStatusReportReload =
         PDM_eReadDataFromRecord(PDM_ID_APP_REPORTS, asSavedReports, sizeof(asSavedReports), &u16ByteRead);
 
-    DBG_vPrintf(TRACE_REPORT, "eStatusReportReload = %d\n", eStatusReportReload);
+    APP_LOG(E_LOG_REPORT_RESTORE, eStatusReportReload);
     /* Restore any application data previously saved to flash */
 
     return (eStatusReportReload);
@@ -148,22 +143,13 @@ PUBLIC void APP_vMakeSupportedAttributesReportable(void)
     uint16 u16ClusterId;
     tsZCL_AttributeReportingConfigurationRecord *psAttributeReportingConfigurationRecord;
 
-    DBG_vPrintf(TRACE_REPORT, "MAKE Reportable ep %d\n", LUMIROUTER_APPLICATION_ENDPOINT);
+    APP_LOG(E_LOG_REPORT_MAKE_REPORTABLE, LUMIROUTER_APPLICATION_ENDPOINT);
 
     for (i = 0; i < ZCL_NUMBER_OF_REPORTS; i++) {
         u16AttributeEnum = asSavedReports[i].sAttributeReportingConfigurationRecord.u16AttributeEnum;
         u16ClusterId = asSavedReports[i].u16ClusterID;
         psAttributeReportingConfigurationRecord = &(asSavedReports[i].sAttributeReportingConfigurationRecord);
-        DBG_vPrintf(
-            TRACE_REPORT,
-            "Cluster %04x Attribute %04x Min %d Max %d IntV %d Direct %d Change %d\n",
-            u16ClusterId,
-            u16AttributeEnum,
-            asSavedReports[i].sAttributeReportingConfigurationRecord.u16MinimumReportingInterval,
-            asSavedReports[i].sAttributeReportingConfigurationRecord.u16MaximumReportingInterval,
-            asSavedReports[i].sAttributeReportingConfigurationRecord.u16TimeoutPeriodField,
-            asSavedReports[i].sAttributeReportingConfigurationRecord.u8DirectionIsReceived,
-            asSavedReports[i].sAttributeReportingConfigurationRecord.uAttributeReportableChange.zint8ReportableChange);
+        APP_vLogReport(&asSavedReports[i]);
         eZCL_SetReportableFlag(LUMIROUTER_APPLICATION_ENDPOINT, u16ClusterId, TRUE, FALSE, u16AttributeEnum);
         eZCL_CreateLocalReport(LUMIROUTER_APPLICATION_ENDPOINT,
                                u16ClusterId,
@@ -185,23 +171,13 @@ PUBLIC void APP_vLoadDefaultConfigForReportable(void)
 {
     int i;
 
-    DBG_vPrintf(TRACE_REPORT, "Loading default configuration for reports\n");
+    APP_LOG(E_LOG_REPORT_LOAD_DEFAULTS);
 
     memset(asSavedReports, 0, sizeof(asSavedReports));
 
     for (i = 0; i < ZCL_NUMBER_OF_REPORTS; i++) {
         asSavedReports[i] = asDefaultReports[i];
-        DBG_vPrintf(
-            TRACE_REPORT,
-            "Cluster %04x Type %d Attr %04x Min %d Max %d IntV %d Direct %d Change %d\n",
-            asSavedReports[i].u16ClusterID,
-            asSavedReports[i].sAttributeReportingConfigurationRecord.eAttributeDataType,
-            asSavedReports[i].sAttributeReportingConfigurationRecord.u16AttributeEnum,
-            asSavedReports[i].sAttributeReportingConfigurationRecord.u16MinimumReportingInterval,
-            asSavedReports[i].sAttributeReportingConfigurationRecord.u16MaximumReportingInterval,
-            asSavedReports[i].sAttributeReportingConfigurationRecord.u16TimeoutPeriodField,
-            asSavedReports[i].sAttributeReportingConfigurationRecord.u8DirectionIsReceived,
-            asSavedReports[i].sAttributeReportingConfigurationRecord.uAttributeReportableChange.zuint8ReportableChange);
+        APP_vLogReport(&asSavedReports[i]);
     }
 
     /* Save this Records */
@@ -226,7 +202,7 @@ APP_vSaveReportableRecord(uint16 u16ClusterID,
         return;
     }
 
-    DBG_vPrintf(TRACE_REPORT, "Save to report %d\n", u8Index);
+    APP_LOG(E_LOG_REPORT_SAVE, u8Index);
 
     /* For CurrentLevel attribute in LevelControl Cluster */
     asSavedReports[u8Index].u16ClusterID = u16ClusterID;
@@ -234,17 +210,7 @@ APP_vSaveReportableRecord(uint16 u16ClusterID,
            psAttributeReportingConfigurationRecord,
            sizeof(tsZCL_AttributeReportingConfigurationRecord));
 
-    DBG_vPrintf(TRACE_REPORT,
-                "Cluster %04x Type %d Attrib %04x Min %d Max %d IntV %d Direction %d Change %d\n",
-                asSavedReports[u8Index].u16ClusterID,
-                asSavedReports[u8Index].sAttributeReportingConfigurationRecord.eAttributeDataType,
-                asSavedReports[u8Index].sAttributeReportingConfigurationRecord.u16AttributeEnum,
-                asSavedReports[u8Index].sAttributeReportingConfigurationRecord.u16MinimumReportingInterval,
-                asSavedReports[u8Index].sAttributeReportingConfigurationRecord.u16MaximumReportingInterval,
-                asSavedReports[u8Index].sAttributeReportingConfigurationRecord.u16TimeoutPeriodField,
-                asSavedReports[u8Index].sAttributeReportingConfigurationRecord.u8DirectionIsReceived,
-                asSavedReports[u8Index]
-                    .sAttributeReportingConfigurationRecord.uAttributeReportableChange.zuint8ReportableChange);
+    APP_vLogReport(&asSavedReports[u8Index]);
 
     /* Save this Records */
     PDM_eSaveRecordData(PDM_ID_APP_REPORTS, asSavedReports, sizeof(asSavedReports));
@@ -275,28 +241,95 @@ APP_vRestoreDefaultRecord(uint8 u8EndPointID,
                            TRUE,
                            &(asDefaultReports[u8Index].sAttributeReportingConfigurationRecord));
 
-    DBG_vPrintf(TRACE_REPORT, "Save to report %d\n", u8Index);
+    APP_LOG(E_LOG_REPORT_SAVE, u8Index);
 
     memcpy(&(asSavedReports[u8Index].sAttributeReportingConfigurationRecord),
            &(asDefaultReports[u8Index].sAttributeReportingConfigurationRecord),
            sizeof(tsZCL_AttributeReportingConfigurationRecord));
 
-    DBG_vPrintf(TRACE_REPORT,
-                "Cluster %04x Type %d Attrib %04x Min %d Max %d IntV %d Direction %d Change %d\n",
-                asSavedReports[u8Index].u16ClusterID,
-                asSavedReports[u8Index].sAttributeReportingConfigurationRecord.eAttributeDataType,
-                asSavedReports[u8Index].sAttributeReportingConfigurationRecord.u16AttributeEnum,
-                asSavedReports[u8Index].sAttributeReportingConfigurationRecord.u16MinimumReportingInterval,
-                asSavedReports[u8Index].sAttributeReportingConfigurationRecord.u16MaximumReportingInterval,
-                asSavedReports[u8Index].sAttributeReportingConfigurationRecord.u16TimeoutPeriodField,
-                asSavedReports[u8Index].sAttributeReportingConfigurationRecord.u8DirectionIsReceived,
-                asSavedReports[u8Index]
-                    .sAttributeReportingConfigurationRecord.uAttributeReportableChange.zuint8ReportableChange);
+    APP_vLogReport(&asSavedReports[u8Index]);
 
     /* Save this Records */
     PDM_eSaveRecordData(PDM_ID_APP_REPORTS, asSavedReports, sizeof(asSavedReports));
 }
 
+/****************************************************************************
+ *
+ * NAME: APP_vGetReportIntervals
+ *
+ * DESCRIPTION:
+ * Find the shortest minimum and maximum reporting intervals among the
+ * configured reports. Intervals of 0, and of 0xFFFF for the maximum, do
+ * not limit when reports are sent and are skipped.
+ *
+ * PARAMETERS:  Name            RW  Usage
+ *              pu16MinInterval W   Shortest minimum interval in seconds, 0 if none
+ *              pu16MaxInterval W   Shortest maximum interval in seconds, 0 if none
+ *
+ ****************************************************************************/
+PUBLIC void APP_vGetReportIntervals(uint16 *pu16MinInterval, uint16 *pu16MaxInterval)
+{
+    tsZCL_AttributeReportingConfigurationRecord *psRecord;
+    int i;
+
+    *pu16MinInterval = 0;
+    *pu16MaxInterval = 0;
+
+    for (i = 0; i < ZCL_NUMBER_OF_REPORTS; i++) {
+        psRecord = &asSavedReports[i].sAttributeReportingConfigurationRecord;
+        if ((psRecord->u16MinimumReportingInterval != 0) &&
+            ((*pu16MinInterval == 0) || (psRecord->u16MinimumReportingInterval < *pu16MinInterval))) {
+            *pu16MinInterval = psRecord->u16MinimumReportingInterval;
+        }
+        if ((psRecord->u16MaximumReportingInterval != 0) && (psRecord->u16MaximumReportingInterval != 0xFFFF) &&
+            ((*pu16MaxInterval == 0) || (psRecord->u16MaximumReportingInterval < *pu16MaxInterval))) {
+            *pu16MaxInterval = psRecord->u16MaximumReportingInterval;
+        }
+    }
+}
+
+/****************************************************************************
+ *
+ * NAME: APP_bIsReportableChange
+ *
+ * DESCRIPTION:
+ * Check whether a signed 16 bit attribute has moved far enough for ZCL to
+ * send a change report, going by the saved reporting configuration. A
+ * reportable change of 0 makes any change reportable. Attributes without
+ * a report, or with reporting turned off, never are.
+ *
+ * PARAMETERS:  Name             RW  Usage
+ *              u16ClusterID     R   Cluster of the attribute
+ *              u16AttributeEnum R   Attribute
+ *              i16From          R   Value ZCL last saw reportable
+ *              i16To            R   Value now
+ *
+ * RETURNS:
+ * TRUE if the change is reportable
+ *
+ ****************************************************************************/
+PUBLIC bool_t APP_bIsReportableChange(uint16 u16ClusterID, uint16 u16AttributeEnum, int16 i16From, int16 i16To)
+{
+    uint8 u8Index = APP_u8GetRecordIndex(u16ClusterID, u16AttributeEnum);
+    tsZCL_AttributeReportingConfigurationRecord *psRecord;
+    int32 i32Change = (int32)i16To - (int32)i16From;
+
+    if (u8Index == 0xFF) {
+        return FALSE;
+    }
+
+    psRecord = &asSavedReports[u8Index].sAttributeReportingConfigurationRecord;
+    if ((psRecord->u16AttributeEnum != u16AttributeEnum) || (psRecord->u16MaximumReportingInterval == 0xFFFF)) {
+        return FALSE;
+    }
+
+    if (i32Change < 0) {
+        i32Change = -i32Change;
+    }
+
+    return (i32Change != 0) && (i32Change >= psRecord->uAttributeReportableChange.zint16ReportableChange);
+}
+
 /****************************************************************************/
 /***        Local Functions                                               ***/
 /****************************************************************************/
@@ -323,6 +356,31 @@ PRIVATE uint8 APP_u8GetRecordIndex(uint16 u16ClusterID, uint16 u16AttributeEnum)
     return u8Index;
 }
 
+/****************************************************************************
+ *
+ * NAME: APP_vLogReport
+ *
+ * DESCRIPTION:
+ * Records a report configuration. It takes two records as a record holds
+ * six arguments at most.
+ *
+ ****************************************************************************/
+PRIVATE void APP_vLogReport(const APP_tsReports *psReport)
+{
+    const tsZCL_AttributeReportingConfigurationRecord *psRecord = &psReport->sAttributeReportingConfigurationRecord;
+
+    APP_LOG(E_LOG_REPORT_RECORD,
+            psReport->u16ClusterID,
+            psRecord->u16AttributeEnum,
+            psRecord->eAttributeDataType,
+            psRecord->u8DirectionIsReceived);
+    APP_LOG(E_LOG_REPORT_RECORD_INTERVALS,
+            psRecord->u16MinimumReportingInterval,
+            psRecord->u16MaximumReportingInterval,
+            psRecord->u16TimeoutPeriodField,
+            psRecord->uAttributeReportableChange.zint16ReportableChange);
+}
+
 /****************************************************************************/
 /***        END OF FILE                                                   ***/
 /****************************************************************************/
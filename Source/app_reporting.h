@@ -71,6 +71,8 @@ PUBLIC void
 APP_vRestoreDefaultRecord(uint8 u8EndPointID,
                           uint16 u16ClusterID,
                           tsZCL_AttributeReportingConfigurationRecord *psAttributeReportingConfigurationRecord);
+PUBLIC void APP_vGetReportIntervals(uint16 *pu16MinInterval, uint16 *pu16MaxInterval);
+PUBLIC bool_t APP_bIsReportableChange(uint16 u16ClusterID, uint16 u16AttributeEnum, int16 i16From, int16 i16To);
 
 /****************************************************************************/
 /***        END OF FILE                                                   ***/
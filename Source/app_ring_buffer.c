@@ -0,0 +1,289 @@
+/****************************************************************************
+ *
+ * MODULE:              Lumi Router
+ *
+ * COMPONENT:           app_ring_buffer.c
+ *
+ * DESCRIPTION:         Single producer / single consumer byte ring buffer
+ *
+ ****************************************************************************
+ *
+ * This software is owned by NXP B.V. and/or its supplier and is protected
+ * under applicable copyright laws. All rights are reserved. We grant You,
+ * and any third parties, a license to use this software solely and
+ * exclusively on NXP products [NXP Microcontrollers such as JN5168, JN5179].
+ * You, and any third parties must reproduce the copyright and warranty notice
+ * and any other legend of ownership on each copy or partial copy of the
+ * software.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+ * AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+ * IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE
+ * ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE
+ * LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR
+ * CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF
+ * SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS
+ * INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN
+ * CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE)
+ * ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+ * POSSIBILITY OF SUCH DAMAGE.
+ *
+ * Copyright NXP B.V. 2016. All rights reserved
+ *
+ ****************************************************************************/
+
+/****************************************************************************/
+/***        Include Files                                                 ***/
+/****************************************************************************/
+
+#include <jendefs.h>
+#include <string.h>
+
+/* Application */
+#include "app_ring_buffer.h"
+
+/****************************************************************************/
+/***        Macro Definitions                                             ***/
+/****************************************************************************/
+
+/* Keep the compiler from moving buffer accesses across an index update */
+#define RB_MEMORY_BARRIER() __asm__ __volatile__("" ::: "memory")
+
+/****************************************************************************/
+/***        Type Definitions                                              ***/
+/****************************************************************************/
+
+/****************************************************************************/
+/***        Local Function Prototypes                                     ***/
+/****************************************************************************/
+
+/****************************************************************************/
+/***        Exported Variables                                            ***/
+/****************************************************************************/
+
+/****************************************************************************/
+/***        Local Variables                                               ***/
+/****************************************************************************/
+
+/****************************************************************************/
+/***        Exported Functions                                            ***/
+/****************************************************************************/
+
+/****************************************************************************
+ *
+ * NAME: RB_vInit
+ *
+ * DESCRIPTION:
+ * Initialise an empty ring on top of the given storage
+ *
+ * PARAMETERS:  Name            RW  Usage
+ *              psRing          W   Ring to initialise
+ *              pu8Buffer       R   Storage, u16Size bytes long
+ *              u16Size         R   Storage size, must be a power of two
+ *
+ ****************************************************************************/
+PUBLIC void RB_vInit(RB_tsRingBuffer *psRing, uint8 *pu8Buffer, uint16 u16Size)
+{
+    psRing->u16Head = 0;
+    psRing->u16Tail = 0;
+    psRing->u16Mask = u16Size - 1;
+    psRing->pu8Buffer = pu8Buffer;
+}
+
+/****************************************************************************
+ *
+ * NAME: RB_bPush
+ *
+ * DESCRIPTION:
+ * Add one byte to the ring (producer side)
+ *
+ * RETURNS:
+ * FALSE if the ring is full
+ *
+ ****************************************************************************/
+PUBLIC bool_t RB_bPush(RB_tsRingBuffer *psRing, uint8 u8Byte)
+{
+    uint16 u16Head = psRing->u16Head;
+
+    if ((uint16)(u16Head - psRing->u16Tail) > psRing->u16Mask) {
+        return FALSE;
+    }
+
+    psRing->pu8Buffer[u16Head & psRing->u16Mask] = u8Byte;
+    RB_MEMORY_BARRIER();
+    psRing->u16Head = u16Head + 1;
+
+    return TRUE;
+}
+
+/****************************************************************************
+ *
+ * NAME: RB_bPop
+ *
+ * DESCRIPTION:
+ * Remove one byte from the ring (consumer side)
+ *
+ * RETURNS:
+ * FALSE if the ring is empty
+ *
+ ****************************************************************************/
+PUBLIC bool_t RB_bPop(RB_tsRingBuffer *psRing, uint8 *pu8Byte)
+{
+    uint16 u16Tail = psRing->u16Tail;
+
+    if (u16Tail == psRing->u16Head) {
+        return FALSE;
+    }
+
+    RB_MEMORY_BARRIER();
+    *pu8Byte = psRing->pu8Buffer[u16Tail & psRing->u16Mask];
+    RB_MEMORY_BARRIER();
+    psRing->u16Tail = u16Tail + 1;
+
+    return TRUE;
+}
+
+/****************************************************************************
+ *
+ * NAME: RB_bPeek
+ *
+ * DESCRIPTION:
+ * Read the oldest byte without removing it (consumer side)
+ *
+ * RETURNS:
+ * FALSE if the ring is empty
+ *
+ ****************************************************************************/
+PUBLIC bool_t RB_bPeek(RB_tsRingBuffer *psRing, uint8 *pu8Byte)
+{
+    uint16 u16Tail = psRing->u16Tail;
+
+    if (u16Tail == psRing->u16Head) {
+        return FALSE;
+    }
+
+    RB_MEMORY_BARRIER();
+    *pu8Byte = psRing->pu8Buffer[u16Tail & psRing->u16Mask];
+
+    return TRUE;
+}
+
+/****************************************************************************
+ *
+ * NAME: RB_u16PushN
+ *
+ * DESCRIPTION:
+ * Add as many bytes as fit into the ring (producer side)
+ *
+ * RETURNS:
+ * Number of bytes added
+ *
+ ****************************************************************************/
+PUBLIC uint16 RB_u16PushN(RB_tsRingBuffer *psRing, const uint8 *pu8Data, uint16 u16Length)
+{
+    uint16 u16Head = psRing->u16Head;
+    uint16 u16Free = psRing->u16Mask + 1 - (uint16)(u16Head - psRing->u16Tail);
+    uint16 u16Offset = u16Head & psRing->u16Mask;
+    uint16 u16First;
+
+    if (u16Length > u16Free) {
+        u16Length = u16Free;
+    }
+
+    /* Copy up to the end of the storage, then wrap to the start */
+    u16First = psRing->u16Mask + 1 - u16Offset;
+    if (u16First > u16Length) {
+        u16First = u16Length;
+    }
+    memcpy(&psRing->pu8Buffer[u16Offset], pu8Data, u16First);
+    memcpy(psRing->pu8Buffer, &pu8Data[u16First], u16Length - u16First);
+
+    RB_MEMORY_BARRIER();
+    psRing->u16Head = u16Head + u16Length;
+
+    return u16Length;
+}
+
+/****************************************************************************
+ *
+ * NAME: RB_u16PopN
+ *
+ * DESCRIPTION:
+ * Remove up to u16Length bytes from the ring (consumer side)
+ *
+ * RETURNS:
+ * Number of bytes removed
+ *
+ ****************************************************************************/
+PUBLIC uint16 RB_u16PopN(RB_tsRingBuffer *psRing, uint8 *pu8Data, uint16 u16Length)
+{
+    uint16 u16Tail = psRing->u16Tail;
+    uint16 u16Count = (uint16)(psRing->u16Head - u16Tail);
+    uint16 u16Offset = u16Tail & psRing->u16Mask;
+    uint16 u16First;
+
+    if (u16Length > u16Count) {
+        u16Length = u16Count;
+    }
+
+    RB_MEMORY_BARRIER();
+
+    u16First = psRing->u16Mask + 1 - u16Offset;
+    if (u16First > u16Length) {
+        u16First = u16Length;
+    }
+    memcpy(pu8Data, &psRing->pu8Buffer[u16Offset], u16First);
+    memcpy(&pu8Data[u16First], psRing->pu8Buffer, u16Length - u16First);
+
+    RB_MEMORY_BARRIER();
+    psRing->u16Tail = u16Tail + u16Length;
+
+    return u16Length;
+}
+
+/****************************************************************************
+ *
+ * NAME: RB_u16Count
+ *
+ * DESCRIPTION:
+ * Number of bytes waiting in the ring
+ *
+ ****************************************************************************/
+PUBLIC uint16 RB_u16Count(RB_tsRingBuffer *psRing)
+{
+    return (uint16)(psRing->u16Head - psRing->u16Tail);
+}
+
+/****************************************************************************
+ *
+ * NAME: RB_u16Free
+ *
+ * DESCRIPTION:
+ * Number of bytes that can still be added to the ring
+ *
+ ****************************************************************************/
+PUBLIC uint16 RB_u16Free(RB_tsRingBuffer *psRing)
+{
+    return psRing->u16Mask + 1 - (uint16)(psRing->u16Head - psRing->u16Tail);
+}
+
+/****************************************************************************
+ *
+ * NAME: RB_bIsEmpty
+ *
+ * DESCRIPTION:
+ * Check whether the ring holds no data
+ *
+ ****************************************************************************/
+PUBLIC bool_t RB_bIsEmpty(RB_tsRingBuffer *psRing)
+{
+    return (psRing->u16Head == psRing->u16Tail);
+}
+
+/****************************************************************************/
+/***        Local Functions                                               ***/
+/****************************************************************************/
+
+/****************************************************************************/
+/***        END OF FILE                                                   ***/
+/****************************************************************************/
@@ -0,0 +1,88 @@
+/****************************************************************************
+ *
+ * MODULE:              Lumi Router
+ *
+ * COMPONENT:           app_ring_buffer.h
+ *
+ * DESCRIPTION:         Single producer / single consumer byte ring buffer
+ *
+ ****************************************************************************
+ *
+ * This software is owned by NXP B.V. and/or its supplier and is protected
+ * under applicable copyright laws. All rights are reserved. We grant You,
+ * and any third parties, a license to use this software solely and
+ * exclusively on NXP products [NXP Microcontrollers such as JN5168, JN5179].
+ * You, and any third parties must reproduce the copyright and warranty notice
+ * and any other legend of ownership on each copy or partial copy of the
+ * software.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+ * AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+ * IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE
+ * ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE
+ * LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR
+ * CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF
+ * SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS
+ * INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN
+ * CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE)
+ * ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+ * POSSIBILITY OF SUCH DAMAGE.
+ *
+ * Copyright NXP B.V. 2016. All rights reserved
+ *
+ ****************************************************************************/
+
+#ifndef APP_RING_BUFFER_H
+#define APP_RING_BUFFER_H
+
+/****************************************************************************/
+/***        Include Files                                                 ***/
+/****************************************************************************/
+
+#include <jendefs.h>
+
+/****************************************************************************/
+/***        Macro Definitions                                             ***/
+/****************************************************************************/
+
+/* Ring sizes must be a power of two so that the free running indices can be
+ * reduced with a mask and wrap together with uint16 arithmetic */
+#define RB_IS_POWER_OF_TWO(x) (((x) != 0) && (((x) & ((x)-1)) == 0))
+
+/****************************************************************************/
+/***        Type Definitions                                              ***/
+/****************************************************************************/
+
+/* The head index is only written by the producer and the tail index is only
+ * written by the consumer, so one side may run in an ISR and the other in a
+ * task without masking interrupts */
+typedef struct {
+    volatile uint16 u16Head;
+    volatile uint16 u16Tail;
+    uint16 u16Mask;
+    uint8 *pu8Buffer;
+} RB_tsRingBuffer;
+
+/****************************************************************************/
+/***        Exported Variables                                            ***/
+/****************************************************************************/
+
+/****************************************************************************/
+/***        Exported Functions                                            ***/
+/****************************************************************************/
+
+PUBLIC void RB_vInit(RB_tsRingBuffer *psRing, uint8 *pu8Buffer, uint16 u16Size);
+PUBLIC bool_t RB_bPush(RB_tsRingBuffer *psRing, uint8 u8Byte);
+PUBLIC bool_t RB_bPop(RB_tsRingBuffer *psRing, uint8 *pu8Byte);
+PUBLIC bool_t RB_bPeek(RB_tsRingBuffer *psRing, uint8 *pu8Byte);
+PUBLIC uint16 RB_u16PushN(RB_tsRingBuffer *psRing, const uint8 *pu8Data, uint16 u16Length);
+PUBLIC uint16 RB_u16PopN(RB_tsRingBuffer *psRing, uint8 *pu8Data, uint16 u16Length);
+PUBLIC uint16 RB_u16Count(RB_tsRingBuffer *psRing);
+PUBLIC uint16 RB_u16Free(RB_tsRingBuffer *psRing);
+PUBLIC bool_t RB_bIsEmpty(RB_tsRingBuffer *psRing);
+
+/****************************************************************************/
+/***        END OF FILE                                                   ***/
+/****************************************************************************/
+
+#endif /* APP_RING_BUFFER_H */
@@ -44,8 +44,11 @@
 
 /* Application */
 #include "PDM_IDs.h"
+#include "app_capture.h"
 #include "app_device_temperature.h"
+#include "app_log.h"
 #include "app_main.h"
+#include "app_pt.h"
 #include "app_reporting.h"
 #include "app_router_node.h"
 #include "app_serial_commands.h"
@@ -55,7 +58,6 @@
 #include "AppHardwareApi.h"
 #include "PDM.h"
 #include "bdb_api.h"
-#include "dbg.h"
 #include "mac_vs_sap.h"
 #include "pdum_apl.h"
 #include "pdum_nwk.h"
@@ -70,12 +72,6 @@
 /***        Macro Definitions                                             ***/
 /****************************************************************************/
 
-#ifdef DEBUG_APP
-#define TRACE_APP TRUE
-#else
-#define TRACE_APP FALSE
-#endif
-
 /****************************************************************************/
 /***        Type Definitions                                              ***/
 /****************************************************************************/
@@ -89,8 +85,9 @@ typedef enum { E_STARTUP, E_RUNNING } APP_teNodeState;
 PRIVATE void APP_vBdbInit(void);
 PRIVATE void APP_vHandleAfEvents(BDB_tsZpsAfEvent *psZpsAfEvent);
 PRIVATE void APP_vHandleZdoEvents(BDB_tsZpsAfEvent *psZpsAfEvent);
-PRIVATE void APP_vFactoryResetRecords(void);
-PRIVATE void APP_vPrintAPSTable(void);
+PRIVATE APP_tePtState APP_ptFactoryReset(APP_tsPt *psPt);
+PRIVATE void APP_vFactoryReset(void);
+PRIVATE void APP_vLogAPSTable(void);
 
 /****************************************************************************/
 /***        Exported Variables                                            ***/
@@ -101,6 +98,7 @@ PRIVATE void APP_vPrintAPSTable(void);
 /****************************************************************************/
 
 PRIVATE APP_teNodeState eNodeState;
+PRIVATE APP_tsPtTask sFactoryResetTask;
 
 /****************************************************************************/
 /***        Exported Functions                                            ***/
@@ -130,6 +128,8 @@ PUBLIC void APP_vInitialiseRouter(void)
     eNodeState = E_STARTUP;
     PDM_eReadDataFromRecord(PDM_ID_APP_ROUTER, &eNodeState, sizeof(APP_teNodeState), &u16ByteRead);
 
+    APP_vPtCreate(&sFactoryResetTask, APP_ptFactoryReset);
+
     /* Restore any report data that is previously saved to flash */
     eStatusReportReload = APP_eRestoreReports();
 
@@ -152,11 +152,11 @@ PUBLIC void APP_vInitialiseRouter(void)
 #ifdef PDM_EEPROM
     /* The functions u8PDM_CalculateFileSystemCapacity and u8PDM_GetFileSystemOccupancy
      * may be called at any time to monitor space available in  the eeprom */
-    DBG_vPrintf(TRACE_APP, "PDM: Capacity %d\n", u8PDM_CalculateFileSystemCapacity());
-    DBG_vPrintf(TRACE_APP, "PDM: Occupancy %d\n", u8PDM_GetFileSystemOccupancy());
+    APP_LOG(E_LOG_APP_PDM_CAPACITY, u8PDM_CalculateFileSystemCapacity());
+    APP_LOG(E_LOG_APP_PDM_OCCUPANCY, u8PDM_GetFileSystemOccupancy());
 #endif
 
-    DBG_vPrintf(TRACE_APP, "Start Up StaTe %d On Network %d\n", eNodeState, sBDB.sAttrib.bbdbNodeIsOnANetwork);
+    APP_LOG(E_LOG_APP_START_UP_STATE, eNodeState, sBDB.sAttrib.bbdbNodeIsOnANetwork);
 
     /* Load the reports from the PDM or the default ones depending on the PDM load record status */
     if (eStatusReportReload != PDM_E_STATUS_OK) {
@@ -205,24 +205,24 @@ PUBLIC void APP_vBdbCallback(BDB_tsBdbEvent *psBdbEvent)
         break;
 
     case BDB_EVENT_INIT_SUCCESS:
-        DBG_vPrintf(TRACE_APP, "APP: BDB_EVENT_INIT_SUCCESS\n");
+        APP_LOG(E_LOG_APP_BDB_INIT_SUCCESS);
         if (eNodeState == E_STARTUP) {
             eStatus = BDB_eNsStartNwkSteering();
-            DBG_vPrintf(TRACE_APP, "BDB Try Steering status %d\n", eStatus);
+            APP_LOG(E_LOG_APP_BDB_TRY_STEERING, eStatus);
         }
         else {
-            DBG_vPrintf(TRACE_APP, "BDB Init go Running\n");
+            APP_LOG(E_LOG_APP_BDB_INIT_RUNNING);
             eNodeState = E_RUNNING;
             PDM_eSaveRecordData(PDM_ID_APP_ROUTER, &eNodeState, sizeof(APP_teNodeState));
         }
         break;
 
     case BDB_EVENT_NWK_FORMATION_SUCCESS:
-        DBG_vPrintf(TRACE_APP, "APP: NwkFormation Success\n");
+        APP_LOG(E_LOG_APP_NWK_FORMATION_SUCCESS);
         break;
 
     case BDB_EVENT_NWK_STEERING_SUCCESS:
-        DBG_vPrintf(TRACE_APP, "APP: NwkSteering Success\n");
+        APP_LOG(E_LOG_APP_NWK_STEERING_SUCCESS);
         eNodeState = E_RUNNING;
         PDM_eSaveRecordData(PDM_ID_APP_ROUTER, &eNodeState, sizeof(APP_teNodeState));
         break;
@@ -263,6 +263,8 @@ PRIVATE void APP_vBdbInit(void)
  ****************************************************************************/
 PRIVATE void APP_vHandleAfEvents(BDB_tsZpsAfEvent *psZpsAfEvent)
 {
+    APP_vCaptureEvent(&psZpsAfEvent->sStackEvent);
+
     if (psZpsAfEvent->u8EndPoint == LUMIROUTER_APPLICATION_ENDPOINT) {
         if ((psZpsAfEvent->sStackEvent.eType == ZPS_EVENT_APS_DATA_INDICATION) ||
             (psZpsAfEvent->sStackEvent.eType == ZPS_EVENT_APS_INTERPAN_DATA_INDICATION)) {
@@ -296,14 +298,13 @@ PRIVATE void APP_vHandleZdoEvents(BDB_tsZpsAfEvent *psZpsAfEvent)
 
     switch (psAfEvent->eType) {
     case ZPS_EVENT_APS_DATA_INDICATION:
-        DBG_vPrintf(TRACE_APP,
-                    "APP-ZDO: Data Indication Status %02x from %04x Src Ep Dst %d Ep %d Profile %04x Cluster %04x\n",
-                    psAfEvent->uEvent.sApsDataIndEvent.eStatus,
-                    psAfEvent->uEvent.sApsDataIndEvent.uSrcAddress.u16Addr,
-                    psAfEvent->uEvent.sApsDataIndEvent.u8SrcEndpoint,
-                    psAfEvent->uEvent.sApsDataIndEvent.u8DstEndpoint,
-                    psAfEvent->uEvent.sApsDataIndEvent.u16ProfileId,
-                    psAfEvent->uEvent.sApsDataIndEvent.u16ClusterId);
+        APP_LOG(E_LOG_ZDO_DATA_INDICATION,
+                psAfEvent->uEvent.sApsDataIndEvent.eStatus,
+                psAfEvent->uEvent.sApsDataIndEvent.uSrcAddress.u16Addr,
+                psAfEvent->uEvent.sApsDataIndEvent.u8SrcEndpoint,
+                psAfEvent->uEvent.sApsDataIndEvent.u8DstEndpoint,
+                psAfEvent->uEvent.sApsDataIndEvent.u16ProfileId,
+                psAfEvent->uEvent.sApsDataIndEvent.u16ClusterId);
         break;
 
     case ZPS_EVENT_APS_DATA_CONFIRM:
@@ -313,123 +314,140 @@ PRIVATE void APP_vHandleZdoEvents(BDB_tsZpsAfEvent *psZpsAfEvent)
         break;
 
     case ZPS_EVENT_NWK_STARTED:
-        DBG_vPrintf(TRACE_APP, "APP-ZDO: Network started\n");
+        APP_LOG(E_LOG_ZDO_NWK_STARTED);
         break;
 
     case ZPS_EVENT_NWK_JOINED_AS_ROUTER:
-        DBG_vPrintf(TRACE_APP,
-                    "APP-ZDO: Joined Network Addr %04x Rejoin %d\n",
-                    psAfEvent->uEvent.sNwkJoinedEvent.u16Addr,
-                    psAfEvent->uEvent.sNwkJoinedEvent.bRejoin);
+        APP_LOG(E_LOG_ZDO_JOINED_AS_ROUTER,
+                psAfEvent->uEvent.sNwkJoinedEvent.u16Addr,
+                psAfEvent->uEvent.sNwkJoinedEvent.bRejoin);
         break;
     case ZPS_EVENT_NWK_FAILED_TO_START:
-        DBG_vPrintf(TRACE_APP, "APP-ZDO: Network Failed To start\n");
+        APP_LOG(E_LOG_ZDO_FAILED_TO_START);
         break;
 
     case ZPS_EVENT_NWK_FAILED_TO_JOIN:
-        DBG_vPrintf(TRACE_APP,
-                    "APP-ZDO: Failed To Join %02x Rejoin %d\n",
-                    psAfEvent->uEvent.sNwkJoinFailedEvent.u8Status,
-                    psAfEvent->uEvent.sNwkJoinFailedEvent.bRejoin);
+        APP_LOG(E_LOG_ZDO_FAILED_TO_JOIN,
+                psAfEvent->uEvent.sNwkJoinFailedEvent.u8Status,
+                psAfEvent->uEvent.sNwkJoinFailedEvent.bRejoin);
         break;
 
     case ZPS_EVENT_NWK_NEW_NODE_HAS_JOINED:
-        DBG_vPrintf(TRACE_APP,
-                    "APP-ZDO: New Node %04x Has Joined\n",
-                    psAfEvent->uEvent.sNwkJoinIndicationEvent.u16NwkAddr);
+        APP_LOG(E_LOG_ZDO_NEW_NODE, psAfEvent->uEvent.sNwkJoinIndicationEvent.u16NwkAddr);
         break;
 
     case ZPS_EVENT_NWK_DISCOVERY_COMPLETE:
-        DBG_vPrintf(TRACE_APP, "APP-ZDO: Discovery Complete %02x\n", psAfEvent->uEvent.sNwkDiscoveryEvent.eStatus);
-#if TRACE_APP
-        APP_vPrintAPSTable();
-#endif
+        APP_LOG(E_LOG_ZDO_DISCOVERY_COMPLETE, psAfEvent->uEvent.sNwkDiscoveryEvent.eStatus);
+        APP_vLogAPSTable();
         break;
 
     case ZPS_EVENT_NWK_LEAVE_INDICATION:
-        DBG_vPrintf(TRACE_APP,
-                    "APP-ZDO: Leave Indication %016llx Rejoin %d\n",
-                    psAfEvent->uEvent.sNwkLeaveIndicationEvent.u64ExtAddr,
-                    psAfEvent->uEvent.sNwkLeaveIndicationEvent.u8Rejoin);
+        APP_LOG(E_LOG_ZDO_LEAVE_INDICATION,
+                (uint32)(psAfEvent->uEvent.sNwkLeaveIndicationEvent.u64ExtAddr >> 32),
+                (uint32)psAfEvent->uEvent.sNwkLeaveIndicationEvent.u64ExtAddr,
+                psAfEvent->uEvent.sNwkLeaveIndicationEvent.u8Rejoin);
         if ((psAfEvent->uEvent.sNwkLeaveIndicationEvent.u64ExtAddr == 0UL) &&
             (psAfEvent->uEvent.sNwkLeaveIndicationEvent.u8Rejoin == 0)) {
             /* We sare asked to Leave without rejoin */
-            DBG_vPrintf(TRACE_APP, "LEAVE IND -> For Us No Rejoin\n");
-            APP_vFactoryResetRecords();
-            vAHI_SwReset();
+            APP_LOG(E_LOG_ZDO_LEAVE_NO_REJOIN);
+            if (!APP_bPtStart(&sFactoryResetTask)) {
+                APP_vFactoryReset();
+            }
         }
         break;
 
     case ZPS_EVENT_NWK_LEAVE_CONFIRM:
-        DBG_vPrintf(TRACE_APP,
-                    "APP-ZDO: Leave Confirm status %02x Addr %016llx\n",
-                    psAfEvent->uEvent.sNwkLeaveConfirmEvent.eStatus,
-                    psAfEvent->uEvent.sNwkLeaveConfirmEvent.u64ExtAddr);
+        APP_LOG(E_LOG_ZDO_LEAVE_CONFIRM,
+                psAfEvent->uEvent.sNwkLeaveConfirmEvent.eStatus,
+                (uint32)(psAfEvent->uEvent.sNwkLeaveConfirmEvent.u64ExtAddr >> 32),
+                (uint32)psAfEvent->uEvent.sNwkLeaveConfirmEvent.u64ExtAddr);
         if ((psAfEvent->uEvent.sNwkLeaveConfirmEvent.eStatus == ZPS_E_SUCCESS) &&
             (psAfEvent->uEvent.sNwkLeaveConfirmEvent.u64ExtAddr == 0UL)) {
-            DBG_vPrintf(TRACE_APP, "Leave -> Reset Data Structures\n");
-            APP_vFactoryResetRecords();
-            vAHI_SwReset();
+            APP_LOG(E_LOG_ZDO_LEAVE_RESET);
+            if (!APP_bPtStart(&sFactoryResetTask)) {
+                APP_vFactoryReset();
+            }
         }
         break;
 
     case ZPS_EVENT_NWK_STATUS_INDICATION:
-        DBG_vPrintf(TRACE_APP,
-                    "APP-ZDO: Network status Indication %02x addr %04x\n",
-                    psAfEvent->uEvent.sNwkStatusIndicationEvent.u8Status,
-                    psAfEvent->uEvent.sNwkStatusIndicationEvent.u16NwkAddr);
+        APP_LOG(E_LOG_ZDO_NWK_STATUS,
+                psAfEvent->uEvent.sNwkStatusIndicationEvent.u8Status,
+                psAfEvent->uEvent.sNwkStatusIndicationEvent.u16NwkAddr);
         break;
 
     case ZPS_EVENT_NWK_ROUTE_DISCOVERY_CONFIRM:
-        DBG_vPrintf(TRACE_APP, "APP-ZDO: Discovery Confirm\n");
+        APP_LOG(E_LOG_ZDO_ROUTE_DISCOVERY_CONFIRM);
         break;
 
     case ZPS_EVENT_NWK_ED_SCAN:
-        DBG_vPrintf(TRACE_APP, "APP-ZDO: Energy Detect Scan %02x\n", psAfEvent->uEvent.sNwkEdScanConfirmEvent.u8Status);
+        APP_LOG(E_LOG_ZDO_ED_SCAN, psAfEvent->uEvent.sNwkEdScanConfirmEvent.u8Status);
         break;
 
     case ZPS_EVENT_ZDO_BIND:
-        DBG_vPrintf(TRACE_APP, "APP-ZDO: Zdo Bind event\n");
+        APP_LOG(E_LOG_ZDO_BIND);
         break;
 
     case ZPS_EVENT_ZDO_UNBIND:
-        DBG_vPrintf(TRACE_APP, "APP-ZDO: Zdo Unbiind Event\n");
+        APP_LOG(E_LOG_ZDO_UNBIND);
         break;
 
     case ZPS_EVENT_ZDO_LINK_KEY:
-        DBG_vPrintf(TRACE_APP,
-                    "APP-ZDO: Zdo Link Key Event Type %d Addr %016llx\n",
-                    psAfEvent->uEvent.sZdoLinkKeyEvent.u8KeyType,
-                    psAfEvent->uEvent.sZdoLinkKeyEvent.u64IeeeLinkAddr);
+        APP_LOG(E_LOG_ZDO_LINK_KEY,
+                psAfEvent->uEvent.sZdoLinkKeyEvent.u8KeyType,
+                (uint32)(psAfEvent->uEvent.sZdoLinkKeyEvent.u64IeeeLinkAddr >> 32),
+                (uint32)psAfEvent->uEvent.sZdoLinkKeyEvent.u64IeeeLinkAddr);
         break;
 
     case ZPS_EVENT_BIND_REQUEST_SERVER:
-        DBG_vPrintf(TRACE_APP, "APP-ZDO: Bind Request Server Event\n");
+        APP_LOG(E_LOG_ZDO_BIND_REQUEST_SERVER);
         break;
 
     case ZPS_EVENT_ERROR:
-        DBG_vPrintf(TRACE_APP, "APP-ZDO: AF Error Event %d\n", psAfEvent->uEvent.sAfErrorEvent.eError);
+        APP_LOG(E_LOG_ZDO_AF_ERROR, psAfEvent->uEvent.sAfErrorEvent.eError);
         break;
 
     case ZPS_EVENT_TC_STATUS:
-        DBG_vPrintf(TRACE_APP, "APP-ZDO: Trust Center Status %02x\n", psAfEvent->uEvent.sApsTcEvent.u8Status);
+        APP_LOG(E_LOG_ZDO_TC_STATUS, psAfEvent->uEvent.sApsTcEvent.u8Status);
         break;
 
     default:
-        DBG_vPrintf(TRACE_APP, "APP-ZDO: Unhandled Event %d\n", psAfEvent->eType);
+        APP_LOG(E_LOG_ZDO_UNHANDLED, psAfEvent->eType);
         break;
     }
 }
 
 /****************************************************************************
  *
- * NAME: APP_vFactoryResetRecords
+ * NAME: APP_ptFactoryReset
  *
  * DESCRIPTION:
- * Resets persisted data structures to factory new state
+ * Factory reset from the main loop. It yields once first, so the stack has
+ * finished with the leave event that asked for the reset before its state
+ * is defaulted.
  *
  ****************************************************************************/
-PRIVATE void APP_vFactoryResetRecords(void)
+PRIVATE APP_tePtState APP_ptFactoryReset(APP_tsPt *psPt)
+{
+    APP_PT_BEGIN(psPt);
+
+    APP_PT_YIELD(psPt);
+    APP_vFactoryReset();
+
+    APP_PT_END(psPt);
+}
+
+/****************************************************************************
+ *
+ * NAME: APP_vFactoryReset
+ *
+ * DESCRIPTION:
+ * Resets persisted data structures to factory new state, then restarts.
+ * Nothing may run between the steps: the stack must not see its defaulted
+ * state, and the records must be saved before the reset.
+ *
+ ****************************************************************************/
+PRIVATE void APP_vFactoryReset(void)
 {
     /* clear out the stack */
     ZPS_vDefaultStack();
@@ -440,45 +458,43 @@ PRIVATE void APP_vFactoryResetRecords(void)
     eNodeState = E_STARTUP;
     PDM_eSaveRecordData(PDM_ID_APP_ROUTER, &eNodeState, sizeof(APP_teNodeState));
     ZPS_vSaveAllZpsRecords();
+
+    vAHI_SwReset();
 }
 
-#if TRACE_APP
 /****************************************************************************
  *
- * NAME: APP_vPrintAPSTable
+ * NAME: APP_vLogAPSTable
  *
  * DESCRIPTION:
- * Prints the content of APS table
+ * Logs the APS key table, without the keys themselves, as the log may be
+ * on in production builds
  *
  ****************************************************************************/
-PRIVATE void APP_vPrintAPSTable(void)
+PRIVATE void APP_vLogAPSTable(void)
 {
+    ZPS_tsAplAib *tsAplAib;
+    ZPS_tsAplApsKeyDescriptorEntry *psEntry;
+    uint64 u64Mac;
     uint8 i;
-    uint8 j;
 
-    ZPS_tsAplAib *tsAplAib;
+    if (!APP_LOG_ENABLED(E_LOG_ZDO_APS_KEY)) {
+        return;
+    }
 
     tsAplAib = ZPS_psAplAibGetAib();
 
     for (i = 0; i < (tsAplAib->psAplDeviceKeyPairTable->u16SizeOfKeyDescriptorTable + 1); i++) {
-        DBG_vPrintf(TRACE_APP,
-                    "MAC: %016llx Key: ",
-                    ZPS_u64NwkNibGetMappedIeeeAddr(
-                        ZPS_pvAplZdoGetNwkHandle(),
-                        tsAplAib->psAplDeviceKeyPairTable->psAplApsKeyDescriptorEntry[i].u16ExtAddrLkup));
-        for (j = 0; j < 16; j++) {
-            DBG_vPrintf(TRACE_APP,
-                        "%02x ",
-                        tsAplAib->psAplDeviceKeyPairTable->psAplApsKeyDescriptorEntry[i].au8LinkKey[j]);
-        }
-        DBG_vPrintf(TRACE_APP, "\n");
-        DBG_vPrintf(TRACE_APP, "Incoming FC: %d\n", tsAplAib->pu32IncomingFrameCounter[i]);
-        DBG_vPrintf(TRACE_APP,
-                    "Outgoing FC: %d\n",
-                    tsAplAib->psAplDeviceKeyPairTable->psAplApsKeyDescriptorEntry[i].u32OutgoingFrameCounter);
+        psEntry = &tsAplAib->psAplDeviceKeyPairTable->psAplApsKeyDescriptorEntry[i];
+        u64Mac = ZPS_u64NwkNibGetMappedIeeeAddr(ZPS_pvAplZdoGetNwkHandle(), psEntry->u16ExtAddrLkup);
+        APP_LOG(E_LOG_ZDO_APS_KEY,
+                i,
+                (uint32)(u64Mac >> 32),
+                (uint32)u64Mac,
+                tsAplAib->pu32IncomingFrameCounter[i],
+                psEntry->u32OutgoingFrameCounter);
     }
 }
-#endif
 
 /****************************************************************************/
 /***        END OF FILE                                                   ***/
@@ -0,0 +1,271 @@
+/****************************************************************************
+ *
+ * MODULE:              Lumi Router
+ *
+ * COMPONENT:           app_scheduler.c
+ *
+ * DESCRIPTION:         Ready mask task scheduler
+ *
+ ****************************************************************************
+ *
+ * This software is owned by NXP B.V. and/or its supplier and is protected
+ * under applicable copyright laws. All rights are reserved. We grant You,
+ * and any third parties, a license to use this software solely and
+ * exclusively on NXP products [NXP Microcontrollers such as JN5168, JN5179].
+ * You, and any third parties must reproduce the copyright and warranty notice
+ * and any other legend of ownership on each copy or partial copy of the
+ * software.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+ * AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+ * IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE
+ * ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE
+ * LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR
+ * CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF
+ * SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS
+ * INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN
+ * CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE)
+ * ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+ * POSSIBILITY OF SUCH DAMAGE.
+ *
+ * Copyright NXP B.V. 2016. All rights reserved
+ *
+ ****************************************************************************/
+
+/****************************************************************************/
+/***        Include Files                                                 ***/
+/****************************************************************************/
+
+#include <jendefs.h>
+#include <string.h>
+
+/* Application */
+#include "app_clock.h"
+#include "app_scheduler.h"
+
+/* SDK JN-SW-4170 */
+#include "portmacro.h"
+
+/****************************************************************************/
+/***        Macro Definitions                                             ***/
+/****************************************************************************/
+
+#if E_APP_TASK_COUNT > 32
+#error The ready tasks are kept in a 32-bit mask
+#endif
+
+/****************************************************************************/
+/***        Type Definitions                                              ***/
+/****************************************************************************/
+
+/****************************************************************************/
+/***        Local Function Prototypes                                     ***/
+/****************************************************************************/
+
+PRIVATE void APP_vRecordRun(APP_tsTaskStats *psStats, uint32 u32Ticks);
+
+/****************************************************************************/
+/***        Exported Variables                                            ***/
+/****************************************************************************/
+
+/****************************************************************************/
+/***        Local Variables                                               ***/
+/****************************************************************************/
+
+/* Every task runs once after boot */
+PRIVATE volatile uint32 u32ReadyMask = APP_TASK_MASK(E_APP_TASK_COUNT) - 1;
+
+PRIVATE APP_tsTaskStats asTaskStats[APP_TASK_STATS_COUNT];
+PRIVATE uint32 u32LastPassDone;
+PRIVATE bool_t bPassDone;
+
+/****************************************************************************/
+/***        Exported Functions                                            ***/
+/****************************************************************************/
+
+/****************************************************************************
+ *
+ * NAME: APP_vSetTaskReady
+ *
+ * DESCRIPTION:
+ * Mark a task as having work, so it runs on the next main loop pass.
+ * May be called from an ISR.
+ *
+ ****************************************************************************/
+PUBLIC void APP_vSetTaskReady(APP_teTask eTask)
+{
+    uint32 u32Storage;
+
+    ZPS_eEnterCriticalSection(NULL, &u32Storage);
+    u32ReadyMask |= APP_TASK_MASK(eTask);
+    ZPS_eExitCriticalSection(NULL, &u32Storage);
+}
+
+/****************************************************************************
+ *
+ * NAME: APP_bTasksReady
+ *
+ * DESCRIPTION:
+ * Check whether any task has work
+ *
+ ****************************************************************************/
+PUBLIC bool_t APP_bTasksReady(void)
+{
+    return u32ReadyMask != 0;
+}
+
+/****************************************************************************
+ *
+ * NAME: APP_bDozeIfIdle
+ *
+ * DESCRIPTION:
+ * Doze if no task is ready. The check and the doze are made with
+ * interrupts masked, as the power manager expects: an interrupt that made
+ * a task ready between an unmasked check and the doze would not end the
+ * doze, and the task would wait for the next interrupt. A pending
+ * interrupt still ends the doze and is serviced after it.
+ *
+ * PARAMETERS:  Name            RW  Usage
+ *              pfDoze          R   Enters and leaves the doze
+ *
+ * RETURNS:
+ * TRUE if the CPU dozed
+ *
+ ****************************************************************************/
+PUBLIC bool_t APP_bDozeIfIdle(APP_tpfTask pfDoze)
+{
+    uint32 u32Storage;
+    bool_t bIdle;
+
+    ZPS_eEnterCriticalSection(NULL, &u32Storage);
+    bIdle = (u32ReadyMask == 0);
+    if (bIdle) {
+        pfDoze();
+    }
+    ZPS_eExitCriticalSection(NULL, &u32Storage);
+
+    return bIdle;
+}
+
+/****************************************************************************
+ *
+ * NAME: APP_u32RunReadyTasks
+ *
+ * DESCRIPTION:
+ * Take the ready mask and run each ready task once, in task order. A task
+ * made ready while the pass is running waits for the next pass, so one
+ * busy task cannot keep the others from running. Every run is timed.
+ *
+ * PARAMETERS:  Name            RW  Usage
+ *              papfTasks       R   Task functions, indexed by APP_teTask
+ *
+ * RETURNS:
+ * Mask of the tasks that ran
+ *
+ ****************************************************************************/
+PUBLIC uint32 APP_u32RunReadyTasks(const APP_tpfTask *papfTasks)
+{
+    uint32 u32Storage;
+    uint32 u32Ready;
+    uint32 u32Start;
+    uint8 i;
+
+    ZPS_eEnterCriticalSection(NULL, &u32Storage);
+    u32Ready = u32ReadyMask;
+    u32ReadyMask = 0;
+    ZPS_eExitCriticalSection(NULL, &u32Storage);
+
+    for (i = 0; i < E_APP_TASK_COUNT; i++) {
+        if (u32Ready & APP_TASK_MASK(i)) {
+            u32Start = APP_u32ClockTicks();
+            papfTasks[i]();
+            APP_vRecordRun(&asTaskStats[i], APP_u32ClockTicks() - u32Start);
+        }
+    }
+
+    return u32Ready;
+}
+
+/****************************************************************************
+ *
+ * NAME: APP_vLoopPassDone
+ *
+ * DESCRIPTION:
+ * Time the main loop pass, from the last watchdog restart to this one.
+ * Call just before restarting the watchdog.
+ *
+ ****************************************************************************/
+PUBLIC void APP_vLoopPassDone(void)
+{
+    uint32 u32Now = APP_u32ClockTicks();
+
+    if (bPassDone) {
+        APP_vRecordRun(&asTaskStats[APP_TASK_STATS_LOOP], u32Now - u32LastPassDone);
+    }
+
+    u32LastPassDone = u32Now;
+    bPassDone = TRUE;
+}
+
+/****************************************************************************
+ *
+ * NAME: APP_vGetTaskStats
+ *
+ * DESCRIPTION:
+ * Read the run times of a task, or of the main loop for APP_TASK_STATS_LOOP
+ *
+ ****************************************************************************/
+PUBLIC void APP_vGetTaskStats(uint8 u8Slot, APP_tsTaskStats *psStats)
+{
+    *psStats = asTaskStats[u8Slot];
+}
+
+/****************************************************************************
+ *
+ * NAME: APP_vResetTaskStats
+ *
+ * DESCRIPTION:
+ * Clear the run times of every task and of the main loop
+ *
+ ****************************************************************************/
+PUBLIC void APP_vResetTaskStats(void)
+{
+    memset(asTaskStats, 0, sizeof(asTaskStats));
+}
+
+/****************************************************************************/
+/***        Local Functions                                               ***/
+/****************************************************************************/
+
+/****************************************************************************
+ *
+ * NAME: APP_vRecordRun
+ *
+ * DESCRIPTION:
+ * Account one run. Kept to a handful of instructions, as it runs for
+ * every task call; the histogram bin is the position of the top bit.
+ *
+ ****************************************************************************/
+PRIVATE void APP_vRecordRun(APP_tsTaskStats *psStats, uint32 u32Ticks)
+{
+    uint32 u32Usec = u32Ticks / APP_CLOCK_TICKS_PER_USEC;
+    uint8 u8Bin = (u32Usec == 0) ? 0 : (31 - __builtin_clz(u32Usec));
+
+    if (u8Bin >= APP_TASK_HISTOGRAM_BINS) {
+        u8Bin = APP_TASK_HISTOGRAM_BINS - 1;
+    }
+    psStats->au32Histogram[u8Bin]++;
+
+    if ((psStats->u32Runs == 0) || (u32Ticks < psStats->u32MinTicks)) {
+        psStats->u32MinTicks = u32Ticks;
+    }
+    if (u32Ticks > psStats->u32MaxTicks) {
+        psStats->u32MaxTicks = u32Ticks;
+    }
+    psStats->u64SumTicks += u32Ticks;
+    psStats->u32Runs++;
+}
+
+/****************************************************************************/
+/***        END OF FILE                                                   ***/
+/****************************************************************************/
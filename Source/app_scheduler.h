@@ -0,0 +1,103 @@
+/****************************************************************************
+ *
+ * MODULE:              Lumi Router
+ *
+ * COMPONENT:           app_scheduler.h
+ *
+ * DESCRIPTION:         Ready mask task scheduler
+ *
+ ****************************************************************************
+ *
+ * This software is owned by NXP B.V. and/or its supplier and is protected
+ * under applicable copyright laws. All rights are reserved. We grant You,
+ * and any third parties, a license to use this software solely and
+ * exclusively on NXP products [NXP Microcontrollers such as JN5168, JN5179].
+ * You, and any third parties must reproduce the copyright and warranty notice
+ * and any other legend of ownership on each copy or partial copy of the
+ * software.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+ * AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+ * IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE
+ * ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE
+ * LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR
+ * CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF
+ * SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS
+ * INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN
+ * CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE)
+ * ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+ * POSSIBILITY OF SUCH DAMAGE.
+ *
+ * Copyright NXP B.V. 2016. All rights reserved
+ *
+ ****************************************************************************/
+
+#ifndef APP_SCHEDULER_H
+#define APP_SCHEDULER_H
+
+/****************************************************************************/
+/***        Include Files                                                 ***/
+/****************************************************************************/
+
+#include <jendefs.h>
+
+/****************************************************************************/
+/***        Macro Definitions                                             ***/
+/****************************************************************************/
+
+#define APP_TASK_MASK(eTask) ((uint32)1 << (eTask))
+
+/* Timing slots: one per task, then one for the whole main loop */
+#define APP_TASK_STATS_LOOP  E_APP_TASK_COUNT
+#define APP_TASK_STATS_COUNT (E_APP_TASK_COUNT + 1)
+
+#define APP_TASK_HISTOGRAM_BINS 16
+
+/****************************************************************************/
+/***        Type Definitions                                              ***/
+/****************************************************************************/
+
+/* Tasks run by the main loop, in the order they run within a pass */
+typedef enum {
+    E_APP_TASK_ZPS,
+    E_APP_TASK_BDB,
+    E_APP_TASK_ZTIMER,
+    E_APP_TASK_SERIAL,
+    E_APP_TASK_PT,
+    E_APP_TASK_COUNT
+} APP_teTask;
+
+typedef void (*APP_tpfTask)(void);
+
+/* Run times in clock ticks. Histogram bin n counts runs of 2^n to
+ * 2^(n+1) - 1 us; bin 0 also takes shorter runs and the last bin longer
+ * ones. For the loop slot a run is the time between watchdog restarts. */
+typedef struct {
+    uint32 u32Runs;
+    uint32 u32MinTicks;
+    uint32 u32MaxTicks;
+    uint64 u64SumTicks;
+    uint32 au32Histogram[APP_TASK_HISTOGRAM_BINS];
+} APP_tsTaskStats;
+
+/****************************************************************************/
+/***        Exported Variables                                            ***/
+/****************************************************************************/
+
+/****************************************************************************/
+/***        Exported Functions                                            ***/
+/****************************************************************************/
+
+PUBLIC void APP_vSetTaskReady(APP_teTask eTask);
+PUBLIC bool_t APP_bTasksReady(void);
+PUBLIC bool_t APP_bDozeIfIdle(APP_tpfTask pfDoze);
+PUBLIC uint32 APP_u32RunReadyTasks(const APP_tpfTask *papfTasks);
+PUBLIC void APP_vLoopPassDone(void);
+PUBLIC void APP_vGetTaskStats(uint8 u8Slot, APP_tsTaskStats *psStats);
+PUBLIC void APP_vResetTaskStats(void);
+
+/****************************************************************************/
+/***        END OF FILE                                                   ***/
+/****************************************************************************/
+
+#endif /* APP_SCHEDULER_H */
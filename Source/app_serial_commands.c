@@ -37,34 +37,97 @@
 /****************************************************************************/
 
 #include <jendefs.h>
+#include <string.h>
 
 /* Application */
+#include "app_capture.h"
+#include "app_clock.h"
+#include "app_cpu.h"
+#include "app_crc16.h"
+#include "app_log.h"
 #include "app_main.h"
+#include "app_pt.h"
+#include "app_queue.h"
+#include "app_ring_buffer.h"
+#include "app_scheduler.h"
 #include "app_serial_commands.h"
+#include "app_stack.h"
+#include "app_timer.h"
 #include "uart.h"
 
 /* SDK JN-SW-4170 */
 #include "PDM.h"
 #include "ZQueue.h"
-#include "ZTimer.h"
-#include "dbg.h"
-#include "portmacro.h"
 
 /****************************************************************************/
 /***        Macro Definitions                                             ***/
 /****************************************************************************/
 
-#ifdef DEBUG_SERIAL
-#define TRACE_SERIAL TRUE
-#else
-#define TRACE_SERIAL FALSE
-#endif
-
 #define SL_START_CHAR 0x01
 #define SL_ESC_CHAR   0x02
 #define SL_END_CHAR   0x03
 
-#define MAX_PACKET_SIZE 32
+/* Only the framing characters are escaped, as SL_ESC_CHAR followed by the
+ * character XOR 0x10 */
+#define SL_NEEDS_ESCAPE(c) ((uint8)((c)-SL_START_CHAR) <= (SL_END_CHAR - SL_START_CHAR))
+
+/* Word at a time test for a framing character in any byte of a uint32 */
+#define SL_HAS_ZERO_BYTE(w)     (((w)-0x01010101UL) & ~(w) & 0x80808080UL)
+#define SL_HAS_FRAMING_CHAR(w)                                                                                        \
+    (SL_HAS_ZERO_BYTE((w) ^ 0x01010101UL) | SL_HAS_ZERO_BYTE((w) ^ 0x02020202UL) | SL_HAS_ZERO_BYTE((w) ^ 0x03030303UL))
+
+#if SERIAL_FRAME_POOL_SIZE > 8
+#error The serial frame pool is tracked in an 8-bit mask
+#endif
+
+/* Protocol versions. Version 1 is the original 8-bit XOR check, which
+ * every host understands; version 2 is a CRC-16/CCITT sent MSB first.
+ * Version 3 keeps the CRC-16 and adds a sequence number as the first payload
+ * byte of every request, answered by a framed response. The link always
+ * starts in version 1 and the host negotiates up. */
+#define SERIAL_PROTOCOL_V1 1
+#define SERIAL_PROTOCOL_V2 2
+#define SERIAL_PROTOCOL_V3 3
+
+/* Requests the host may have outstanding in version 3. Responses to the
+ * last SERIAL_WINDOW_SIZE requests are kept, so a retransmitted request is
+ * answered again without being executed twice. */
+#define SERIAL_WINDOW_SIZE 4
+
+#if SERIAL_WINDOW_SIZE >= SERIAL_FRAME_POOL_SIZE
+#error The frame pool must hold a full window of requests and the frame being received
+#endif
+
+/* Set in the message type of a version 3 response */
+#define SERIAL_RESPONSE_FLAG 0x8000
+
+/* Response data kept for a retransmitted request, enough for the largest
+ * reply (task stats) */
+#define SERIAL_RESPONSE_DATA_SIZE (5 * 4 + 4 * APP_TASK_HISTOGRAM_BINS)
+
+/* Fails to compile if a reply buffer is larger than the response cache, so
+ * every reply can be sent again unchanged */
+#define SERIAL_ASSERT_CACHEABLE(au8Reply) ((void)sizeof(char[(sizeof(au8Reply) <= SERIAL_RESPONSE_DATA_SIZE) ? 1 : -1]))
+
+/* Payload bytes per frame sent by the benchmark source mode */
+#define SERIAL_BENCHMARK_FRAME_SIZE 64
+
+/* Most log record bytes sent in one frame */
+#define SERIAL_LOG_FRAME_SIZE 64
+
+/* Work the serial task may do per main loop pass before yielding to the stack */
+#ifndef SERIAL_RX_BYTE_BUDGET
+#define SERIAL_RX_BYTE_BUDGET 64
+#endif
+#ifndef SERIAL_RX_TIME_BUDGET_USEC
+#define SERIAL_RX_TIME_BUDGET_USEC 500
+#endif
+
+#define SERIAL_RX_CHUNK_SIZE 16
+#define SERIAL_TX_CHUNK_SIZE 16
+
+/* Time the host has to send a valid frame at a new baud rate */
+#define SERIAL_BAUD_RATE_CONFIRM_TIME APP_TIMER_TIME_SEC(2)
 
 /****************************************************************************/
 /***        Type Definitions                                              ***/
@@ -73,25 +136,122 @@
 /* Enumerated list of states for receive state machine */
 typedef enum {
     E_STATE_RX_WAIT_START,
-    E_STATE_RX_WAIT_TYPEMSB,
-    E_STATE_RX_WAIT_TYPELSB,
-    E_STATE_RX_WAIT_LENMSB,
-    E_STATE_RX_WAIT_LENLSB,
-    E_STATE_RX_WAIT_CRC,
+    E_STATE_RX_WAIT_HEADER,
     E_STATE_RX_WAIT_DATA
 } APP_teRxState;
 
 /* Serial link message types */
-typedef enum { E_SC_MSG_RESET = 0x0011, E_SC_MSG_ERASE_PERSISTENT_DATA = 0x0012 };
+typedef enum {
+    E_SC_MSG_RESET = 0x0011,
+    E_SC_MSG_ERASE_PERSISTENT_DATA = 0x0012,
+    E_SC_MSG_SET_BAUD_RATE = 0x0013,
+    E_SC_MSG_SET_PROTOCOL_VERSION = 0x0014,
+    E_SC_MSG_GET_POOL_STATS = 0x0015,
+    E_SC_MSG_BENCHMARK = 0x0016,
+    E_SC_MSG_BENCHMARK_DATA = 0x0017,
+    E_SC_MSG_GET_LINK_STATS = 0x0018,
+    E_SC_MSG_SET_LOG_LEVEL = 0x0019,
+    E_SC_MSG_SET_CAPTURE = 0x001B,
+    E_SC_MSG_GET_TASK_STATS = 0x001C,
+    E_SC_MSG_GET_QUEUE_STATS = 0x001D,
+    E_SC_MSG_GET_STACK_STATS = 0x001E,
+    E_SC_MSG_GET_CPU_STATS = 0x001F,
+    /* Benchmark data sent by the firmware, echoed or from the source mode */
+    E_SC_MSG_BENCHMARK_TELEMETRY_DATA = SERIAL_CHANNEL_TYPE(E_SERIAL_CHANNEL_TELEMETRY, 0x17),
+    E_SC_MSG_LOG_RECORDS = SERIAL_CHANNEL_TYPE(E_SERIAL_CHANNEL_LOG, 0x1A)
+} APP_teSerialMessageType;
+
+/* Link benchmark modes, selected by E_SC_MSG_BENCHMARK */
+typedef enum {
+    E_BENCHMARK_STOP,   /* stop and report */
+    E_BENCHMARK_ECHO,   /* send every data frame back */
+    E_BENCHMARK_SINK,   /* count and discard data frames */
+    E_BENCHMARK_SOURCE  /* send a number of pattern bytes in data frames */
+} APP_teBenchmarkMode;
+
+/* Link benchmark counters. Error counters are snapshots taken at the start,
+ * so the report shows what happened during the run. */
+typedef struct {
+    APP_teBenchmarkMode eMode;
+    uint32 u32StartMsec;
+    uint32 u32RxBytes;
+    uint32 u32TxBytes;
+    uint32 u32SourceRemaining;
+    uint32 u32CrcErrors;
+    uint32 u32RxDropped;
+    uint32 u32TxDropped;
+    uint8 u8Pattern;
+} APP_tsBenchmark;
+
+/* Status returned in a version 3 response */
+typedef enum {
+    E_SC_STATUS_SUCCESS,
+    E_SC_STATUS_BAD_PARAMETER,
+    E_SC_STATUS_UNKNOWN_COMMAND
+} APP_teSerialStatus;
+
+/* Response sent for a recent version 3 request */
+typedef struct {
+    bool_t bValid;
+    uint16 u16Type;
+    uint8 u8DataLength;
+    uint8 u8Seq;
+    uint8 u8Status;
+    uint8 au8Data[SERIAL_RESPONSE_DATA_SIZE];
+} APP_tsSerialResponse;
+
+/* Steps of a baud rate change requested by the host */
+typedef enum {
+    E_BAUD_RATE_IDLE,
+    E_BAUD_RATE_DRAIN_TX, /* acknowledged at the old rate, waiting for TX to finish */
+    E_BAUD_RATE_CONFIRM   /* switched, waiting for a valid frame at the new rate */
+} APP_teBaudRateState;
 
 /****************************************************************************/
 /***        Local Function Prototypes                                     ***/
 /****************************************************************************/
 
-PRIVATE void APP_vProcessRxChar(uint8 u8Char);
-PRIVATE void APP_vProcessCommand(void);
-PRIVATE void APP_vWriteTxChar(uint8 u8Char);
-PRIVATE uint8 APP_u8CalculateCRC(uint16 u16Type, uint16 u16Length, uint8 *pu8Data);
+PRIVATE void APP_vProcessRxBlock(uint8 *pu8Data, uint16 u16Length);
+PRIVATE uint16 APP_u16CleanRun(const uint8 *pu8Data, uint16 u16Length);
+PRIVATE void APP_vRxStart(void);
+PRIVATE void APP_vRxBytes(const uint8 *pu8Data, uint16 u16Length);
+PRIVATE void APP_vRxHeader(void);
+PRIVATE void APP_vRxEnd(void);
+PRIVATE void APP_vProcessCommand(APP_tsSerialFrame *psFrame);
+PRIVATE void APP_vUpdateFrameStats(uint32 u32StartPass);
+PRIVATE APP_tePtState APP_ptErasePdm(APP_tsPt *psPt);
+PRIVATE void APP_vErasePdm(void);
+PRIVATE APP_tsSerialFrame *APP_psAllocFrame(void);
+PRIVATE void APP_vFreeFrame(APP_tsSerialFrame *psFrame);
+PRIVATE void APP_vGetPoolStats(void);
+PRIVATE void APP_vGetLinkStats(void);
+PRIVATE void APP_vSetLogLevel(void);
+PRIVATE void APP_vSendLogRecords(void);
+PRIVATE void APP_vSetCapture(void);
+PRIVATE void APP_vReportTaskStats(void);
+PRIVATE void APP_vReportQueueStats(void);
+PRIVATE void APP_vReportStackStats(void);
+PRIVATE void APP_vReportCpuStats(void);
+PRIVATE void APP_vReplyFrame(uint8 u8Status, const uint8 *pu8Data, uint8 u8Length);
+PRIVATE void APP_vBenchmark(void);
+PRIVATE void APP_vBenchmarkData(void);
+PRIVATE void APP_vBenchmarkSource(void);
+PRIVATE uint32 APP_u32RxDropped(void);
+PRIVATE void APP_vPutU32(uint8 *pu8Data, uint32 u32Value);
+PRIVATE void APP_vSetBaudRate(void);
+PRIVATE void APP_vHandleBaudRateChange(void);
+PRIVATE void APP_vSetProtocolVersion(void);
+PRIVATE void APP_vSendResponse(uint8 u8Status, const uint8 *pu8Data, uint8 u8Length);
+PRIVATE bool_t APP_bResendResponse(void);
+PRIVATE void APP_vWriteResponse(uint16 u16Type, uint8 u8Seq, uint8 u8Status, const uint8 *pu8Data, uint8 u8Length);
+PRIVATE void APP_vLegacyReply(const char *pcMessage);
+PRIVATE uint16 APP_u16InitCRC(uint8 u8Version);
+PRIVATE uint16 APP_u16UpdateCRC(uint8 u8Version, uint16 u16Crc, uint8 u8Byte);
+PRIVATE uint16 APP_u16UpdateCRCBlock(uint8 u8Version, uint16 u16Crc, const uint8 *pu8Data, uint16 u16Length);
+PRIVATE uint16 APP_u16ScanForTx(const uint8 *pu8Data, uint16 u16Length, uint16 *pu16Crc);
+PRIVATE void APP_vPushEscaped(RB_tsRingBuffer *psRing, const uint8 *pu8Data, uint16 u16Length);
+PRIVATE bool_t APP_bQueueHasRoom(APP_teSerialChannel eChannel, uint16 u16Length);
+PRIVATE void APP_vScheduleTx(void);
 
 /****************************************************************************/
 /***        Exported Variables                                            ***/
@@ -101,10 +261,56 @@ PRIVATE uint8 APP_u8CalculateCRC(uint16 u16Type, uint16 u16Length, uint8 *pu8Dat
 /***        Local Variables                                               ***/
 /****************************************************************************/
 
-PRIVATE uint8 au8LinkRxBuffer[32];
-PRIVATE uint16 u16PacketType;
-PRIVATE uint16 u16PacketLength;
-PRIVATE uint32 sStorage;
+PRIVATE APP_tsSerialFrame asFramePool[SERIAL_FRAME_POOL_SIZE];
+PRIVATE uint8 u8FramesInUse;
+PRIVATE APP_tsSerialPoolStats sPoolStats = {SERIAL_FRAME_POOL_SIZE, 0, 0, 0};
+
+/* Frame being received and frame being processed */
+PRIVATE APP_tsSerialFrame *psRxFrame;
+PRIVATE APP_tsSerialFrame *psCommand;
+
+/* Receive decoder state */
+PRIVATE APP_teRxState eRxState = E_STATE_RX_WAIT_START;
+PRIVATE bool_t bInEsc;
+PRIVATE uint8 au8RxHeader[SL_MAX_HEADER_SIZE];
+PRIVATE uint8 u8RxHeaderBytes;
+PRIVATE uint8 u8RxHeaderLength;
+PRIVATE uint8 u8RxVersion;
+PRIVATE uint16 u16RxBytes;
+PRIVATE uint16 u16RxCRC;
+PRIVATE uint16 u16RunningCRC;
+PRIVATE uint32 u32CrcErrors;
+PRIVATE uint32 u32OversizeFrames;
+PRIVATE uint32 u32UnknownCommands;
+
+/* Serial task passes, used to measure how many passes a frame takes */
+PRIVATE uint32 u32TaskPasses;
+PRIVATE APP_tsSerialFrameStats sFrameStats;
+
+PRIVATE APP_teBaudRateState eBaudRateState = E_BAUD_RATE_IDLE;
+PRIVATE uint32 u32NewBaudRate;
+PRIVATE uint32 u32OldBaudRate;
+
+PRIVATE uint8 u8ProtocolVersion = SERIAL_PROTOCOL_V1;
+
+/* Payload of the command being processed, after the sequence number */
+PRIVATE uint8 *pu8Payload;
+PRIVATE uint16 u16PayloadLength;
+PRIVATE uint8 u8RequestSeq;
+
+PRIVATE APP_tsSerialResponse asResponses[SERIAL_WINDOW_SIZE];
+PRIVATE uint8 u8NextResponse;
+
+/* Messages dropped because their channel queue had no room for them */
+PRIVATE uint32 u32TxDropped;
+
+/* Channel of the frame being moved into the TX ring and its bytes left */
+PRIVATE APP_teSerialChannel eTxChannel;
+PRIVATE uint16 u16TxRemaining;
+
+PRIVATE APP_tsBenchmark sBenchmark;
+
+PRIVATE APP_tsPtTask sErasePdmTask = {{0}, APP_ptErasePdm, FALSE};
 
 /****************************************************************************/
 /***        Exported Functions                                            ***/
@@ -115,32 +321,287 @@ PRIVATE uint32 sStorage;
  * NAME: APP_taskAtSerial
  *
  * DESCRIPTION:
- * Task that obtains a message from the serial Rx message queue.
+ * Task that drains the serial Rx ring in chunks, bounded by a byte and a
+ * time budget per main loop pass, then handles at most one received frame.
  *
  ****************************************************************************/
 PUBLIC void APP_taskAtSerial(void)
 {
-    uint8 u8RxByte;
-    if (ZQ_bQueueReceive(&APP_msgSerialRx, &u8RxByte)) {
-        APP_vProcessRxChar(u8RxByte);
+    APP_tsSerialFrame *psFrame;
+    uint8 au8Chunk[SERIAL_RX_CHUNK_SIZE];
+    uint32 u32Start = APP_u32ClockTicks();
+    uint16 u16Budget = SERIAL_RX_BYTE_BUDGET;
+    uint16 u16Length;
+
+    u32TaskPasses++;
+
+    APP_vHandleBaudRateChange();
+
+    if (sBenchmark.eMode == E_BENCHMARK_SOURCE) {
+        APP_vBenchmarkSource();
+    }
+
+    if (u8ProtocolVersion >= SERIAL_PROTOCOL_V3) {
+        APP_vSendLogRecords();
+    }
+
+    APP_vScheduleTx();
+
+    while (u16Budget > 0) {
+        u16Length = (u16Budget < sizeof(au8Chunk)) ? u16Budget : sizeof(au8Chunk);
+        u16Length = RB_u16PopN(&APP_rbSerialRx, au8Chunk, u16Length);
+        if (u16Length == 0) {
+            break;
+        }
+
+        APP_vProcessRxBlock(au8Chunk, u16Length);
+        u16Budget -= u16Length;
+
+        UART_vResumeRxFlow();
+
+        if ((APP_u32ClockTicks() - u32Start) >= APP_CLOCK_USEC(SERIAL_RX_TIME_BUDGET_USEC)) {
+            break;
+        }
+    }
+
+    if (ZQ_bQueueReceive(&APP_msgSerialFrames, &psFrame)) {
+        APP_vUpdateFrameStats(psFrame->u32StartPass);
+        APP_vProcessCommand(psFrame);
+        APP_vFreeFrame(psFrame);
+    }
+}
+
+/****************************************************************************
+ *
+ * NAME: APP_bSerialHasWork
+ *
+ * DESCRIPTION:
+ * Check whether the serial task has work that no interrupt will announce:
+ * received bytes or frames left over from the last pass, a baud rate
+ * change waiting for TX to drain, or benchmark data or log records to send
+ * with room for them. Data already queued to send is kept moving by the
+ * UART interrupt.
+ *
+ ****************************************************************************/
+PUBLIC bool_t APP_bSerialHasWork(void)
+{
+    if (!RB_bIsEmpty(&APP_rbSerialRx) || !ZQ_bQueueIsEmpty(&APP_msgSerialFrames) ||
+        (eBaudRateState == E_BAUD_RATE_DRAIN_TX)) {
+        return TRUE;
+    }
+
+    if ((sBenchmark.eMode == E_BENCHMARK_SOURCE) && (sBenchmark.u32SourceRemaining > 0) &&
+        APP_bQueueHasRoom(E_SERIAL_CHANNEL_TELEMETRY, SERIAL_BENCHMARK_FRAME_SIZE)) {
+        return TRUE;
+    }
+
+    return (u8ProtocolVersion >= SERIAL_PROTOCOL_V3) && !APP_bLogIsEmpty() &&
+           APP_bQueueHasRoom(E_SERIAL_CHANNEL_LOG, SERIAL_LOG_FRAME_SIZE);
+}
+
+/****************************************************************************
+ *
+ * NAME: APP_cbTimerBaudRate
+ *
+ * DESCRIPTION:
+ * CallBack For baud rate confirmation timer. No valid frame arrived at the
+ * new baud rate, so go back to the old one.
+ *
+ ****************************************************************************/
+PUBLIC void APP_cbTimerBaudRate(void *pvParam)
+{
+    if (eBaudRateState == E_BAUD_RATE_CONFIRM) {
+        APP_LOG(E_LOG_SERIAL_BAUD_RATE_NOT_CONFIRMED, u32OldBaudRate);
+        UART_bSetBaudRate(u32OldBaudRate);
+        eBaudRateState = E_BAUD_RATE_IDLE;
     }
 }
 
+/****************************************************************************
+ *
+ * NAME: APP_vGetSerialFrameStats
+ *
+ * DESCRIPTION:
+ * Read the number of serial task passes taken by received frames
+ *
+ ****************************************************************************/
+PUBLIC void APP_vGetSerialFrameStats(APP_tsSerialFrameStats *psStats)
+{
+    *psStats = sFrameStats;
+}
+
+/****************************************************************************
+ *
+ * NAME: APP_vGetSerialPoolStats
+ *
+ * DESCRIPTION:
+ * Read the receive frame pool usage
+ *
+ ****************************************************************************/
+PUBLIC void APP_vGetSerialPoolStats(APP_tsSerialPoolStats *psStats)
+{
+    *psStats = sPoolStats;
+}
+
+/****************************************************************************
+ *
+ * NAME: APP_vGetSerialLinkStats
+ *
+ * DESCRIPTION:
+ * Read the serial link health counters
+ *
+ ****************************************************************************/
+PUBLIC void APP_vGetSerialLinkStats(APP_tsSerialLinkStats *psStats)
+{
+    UART_tsStats sUartStats;
+
+    UART_vGetStats(&sUartStats);
+
+    psStats->u32RxOverruns = sUartStats.u32RxOverruns;
+    psStats->u32RxFramingErrors = sUartStats.u32RxFramingErrors;
+    psStats->u32RxDropped = sUartStats.u32RxDropped;
+    psStats->u32PoolExhausted = sPoolStats.u32Exhausted;
+    psStats->u32CrcErrors = u32CrcErrors;
+    psStats->u32OversizeFrames = u32OversizeFrames;
+    psStats->u32UnknownCommands = u32UnknownCommands;
+    psStats->u32TxDropped = u32TxDropped;
+}
+
+/****************************************************************************
+ *
+ * NAME: APP_vResetSerialLinkStats
+ *
+ * DESCRIPTION:
+ * Clear the serial link health counters
+ *
+ ****************************************************************************/
+PUBLIC void APP_vResetSerialLinkStats(void)
+{
+    UART_vResetStats();
+    sPoolStats.u32Exhausted = 0;
+    u32CrcErrors = 0;
+    u32OversizeFrames = 0;
+    u32UnknownCommands = 0;
+    u32TxDropped = 0;
+}
+
 /****************************************************************************
  *
  * NAME: APP_WriteMessageToSerial
  *
  * DESCRIPTION:
- * Write message to the serial link
+ * Write message to the serial link as an event
  *
  ****************************************************************************/
 PUBLIC void APP_WriteMessageToSerial(const char *message)
 {
-    DBG_vPrintf(TRACE_SERIAL, "APP_WriteMessageToSerial(%s)\n", message);
+    APP_LOG(E_LOG_SERIAL_LEGACY_MESSAGE, (uint32)strlen(message));
+
+    APP_bWriteToSerial(E_SERIAL_CHANNEL_EVENT, (const uint8 *)message, strlen(message));
+}
+
+/****************************************************************************
+ *
+ * NAME: APP_bWriteToSerial
+ *
+ * DESCRIPTION:
+ * Write a raw buffer to the serial link. The buffer is queued on a channel
+ * as one unit, so it never ends up in the middle of a frame.
+ *
+ * RETURNS:
+ * FALSE if the channel queue has no room for the whole buffer; nothing is sent
+ *
+ ****************************************************************************/
+PUBLIC bool_t APP_bWriteToSerial(APP_teSerialChannel eChannel, const uint8 *pu8Data, uint16 u16Length)
+{
+    RB_tsRingBuffer *psQueue = &APP_rbSerialChannel[eChannel];
+    uint8 au8Length[2];
+
+    if (RB_u16Free(psQueue) < (2 + u16Length)) {
+        u32TxDropped++;
+        return FALSE;
+    }
+
+    au8Length[0] = (uint8)(u16Length >> 8);
+    au8Length[1] = (uint8)u16Length;
+    RB_u16PushN(psQueue, au8Length, sizeof(au8Length));
+    RB_u16PushN(psQueue, pu8Data, u16Length);
+
+    APP_vScheduleTx();
+
+    return TRUE;
+}
+
+/****************************************************************************
+ *
+ * NAME: APP_bWriteFrameToSerial
+ *
+ * DESCRIPTION:
+ * Write a framed message to the serial link. The payload is gathered from
+ * u8Count segments, so a header, a payload and a trailer never have to be
+ * assembled into a temporary buffer. The frame is encoded into the queue of
+ * the channel selected by the message type.
+ *
+ * PARAMETERS:  Name            RW  Usage
+ *              u16Type         R   Message type
+ *              psPayload       R   Payload segments
+ *              u8Count         R   Number of payload segments
+ *
+ * RETURNS:
+ * FALSE if the channel queue has no room for the whole frame; nothing is sent
+ *
+ ****************************************************************************/
+PUBLIC bool_t APP_bWriteFrameToSerial(uint16 u16Type, const APP_tsSerialIoVec *psPayload, uint8 u8Count)
+{
+    RB_tsRingBuffer *psQueue = &APP_rbSerialChannel[SERIAL_CHANNEL_OF_TYPE(u16Type)];
+    uint8 au8Header[6];
+    uint8 u8HeaderLength = 4;
+    uint16 u16Length = 0;
+    uint16 u16Encoded;
+    uint16 u16Crc = APP_u16InitCRC(u8ProtocolVersion);
+    uint8 i;
+
+    for (i = 0; i < u8Count; i++) {
+        u16Length += psPayload[i].u16Length;
+    }
+
+    au8Header[0] = (uint8)(u16Type >> 8);
+    au8Header[1] = (uint8)u16Type;
+    au8Header[2] = (uint8)(u16Length >> 8);
+    au8Header[3] = (uint8)u16Length;
+
+    /* One pass over the payload for the CRC and the escaped length, which
+     * must be known before anything goes into the queue */
+    u16Encoded = 2 + APP_u16ScanForTx(au8Header, 4, &u16Crc);
+    for (i = 0; i < u8Count; i++) {
+        u16Encoded += APP_u16ScanForTx(psPayload[i].pu8Data, psPayload[i].u16Length, &u16Crc);
+    }
+
+    if (u8ProtocolVersion >= SERIAL_PROTOCOL_V2) {
+        au8Header[u8HeaderLength++] = (uint8)(u16Crc >> 8);
+    }
+    au8Header[u8HeaderLength++] = (uint8)u16Crc;
+    for (i = 4; i < u8HeaderLength; i++) {
+        u16Encoded += SL_NEEDS_ESCAPE(au8Header[i]) ? 2 : 1;
+    }
+
+    if (RB_u16Free(psQueue) < (2 + u16Encoded)) {
+        u32TxDropped++;
+        return FALSE;
+    }
 
-    for (; *message != '\0'; message++) {
-        APP_vWriteTxChar(*message);
+    RB_bPush(psQueue, (uint8)(u16Encoded >> 8));
+    RB_bPush(psQueue, (uint8)u16Encoded);
+    RB_bPush(psQueue, SL_START_CHAR);
+    APP_vPushEscaped(psQueue, au8Header, u8HeaderLength);
+    for (i = 0; i < u8Count; i++) {
+        APP_vPushEscaped(psQueue, psPayload[i].pu8Data, psPayload[i].u16Length);
     }
+    RB_bPush(psQueue, SL_END_CHAR);
+
+    APP_vScheduleTx();
+
+    return TRUE;
 }
 
 /****************************************************************************/
@@ -149,187 +610,1315 @@ PUBLIC void APP_WriteMessageToSerial(const char *message)
 
 /****************************************************************************
  *
- * NAME: APP_vProcessRxChar
+ * NAME: APP_vProcessRxBlock
  *
  * DESCRIPTION:
- * Processes the received character
+ * Decode a block of received bytes. Escaped bytes are unescaped in place,
+ * so everything between two framing characters is handed on in one go;
+ * only the framing characters themselves are handled one at a time.
  *
  ****************************************************************************/
-PRIVATE void APP_vProcessRxChar(uint8 u8Char)
+PRIVATE void APP_vProcessRxBlock(uint8 *pu8Data, uint16 u16Length)
 {
-    static APP_teRxState eRxState = E_STATE_RX_WAIT_START;
-    static uint8 u8CRC;
-    static uint16 u16Bytes;
-    static bool bInEsc = FALSE;
+    const uint8 *pu8In = pu8Data;
+    const uint8 *pu8End = pu8Data + u16Length;
+    uint8 *pu8Out = pu8Data;
+    uint8 *pu8Taken = pu8Data;
+    uint16 u16Run;
 
-    switch (u8Char) {
-    case SL_START_CHAR:
-        /* Reset state machine */
-        u16Bytes = 0;
-        bInEsc = FALSE;
-        DBG_vPrintf(TRACE_SERIAL, "RX Start\n");
-        eRxState = E_STATE_RX_WAIT_TYPEMSB;
-        break;
+    while (pu8In < pu8End) {
+        if (bInEsc && !SL_NEEDS_ESCAPE(*pu8In)) {
+            /* Unescape the character */
+            *pu8Out++ = *pu8In++ ^ 0x10;
+            bInEsc = FALSE;
+            continue;
+        }
 
-    case SL_ESC_CHAR:
-        /* Escape next character */
-        bInEsc = TRUE;
-        break;
+        u16Run = APP_u16CleanRun(pu8In, (uint16)(pu8End - pu8In));
+        if (u16Run > 0) {
+            /* Close up behind earlier escapes */
+            if (pu8Out != pu8In) {
+                memmove(pu8Out, pu8In, u16Run);
+            }
+            pu8Out += u16Run;
+            pu8In += u16Run;
+            continue;
+        }
 
-    case SL_END_CHAR:
-        /* End message */
-        DBG_vPrintf(TRACE_SERIAL, "Got END\n");
-        eRxState = E_STATE_RX_WAIT_START;
-        if (u16PacketLength < MAX_PACKET_SIZE) {
-            if (u8CRC == APP_u8CalculateCRC(u16PacketType, u16PacketLength, au8LinkRxBuffer)) {
-                /* CRC matches - valid packet */
-                DBG_vPrintf(TRACE_SERIAL, "APP_vProcessRxChar(%d, %d, %02x)\n", u16PacketType, u16PacketLength, u8CRC);
-                APP_vProcessCommand();
+        if (*pu8In == SL_ESC_CHAR) {
+            /* Escape next character */
+            bInEsc = TRUE;
+        }
+        else {
+            APP_vRxBytes(pu8Taken, (uint16)(pu8Out - pu8Taken));
+            pu8Taken = pu8Out;
+            if (*pu8In == SL_START_CHAR) {
+                APP_vRxStart();
+            }
+            else {
+                APP_vRxEnd();
             }
         }
-        DBG_vPrintf(TRACE_SERIAL, "CRC BAD\n");
-        break;
+        pu8In++;
+    }
 
-    default:
-        if (bInEsc) {
-            /* Unescape the character */
-            u8Char ^= 0x10;
-            bInEsc = FALSE;
+    APP_vRxBytes(pu8Taken, (uint16)(pu8Out - pu8Taken));
+}
+
+/****************************************************************************
+ *
+ * NAME: APP_u16CleanRun
+ *
+ * DESCRIPTION:
+ * Find the first framing character, a word at a time once the data is
+ * word aligned
+ *
+ * RETURNS:
+ * Number of bytes before the first framing character
+ *
+ ****************************************************************************/
+PRIVATE uint16 APP_u16CleanRun(const uint8 *pu8Data, uint16 u16Length)
+{
+    const uint8 *pu8 = pu8Data;
+    const uint8 *pu8End = pu8Data + u16Length;
+    uint32 u32Word;
+
+    while ((pu8 < pu8End) && (((uint32)pu8 & 3) != 0)) {
+        if (SL_NEEDS_ESCAPE(*pu8)) {
+            return (uint16)(pu8 - pu8Data);
         }
-        DBG_vPrintf(TRACE_SERIAL, "Data 0x%x\n", u8Char & 0xFF);
+        pu8++;
+    }
 
-        switch (eRxState) {
-        case E_STATE_RX_WAIT_START:
+    while ((pu8End - pu8) >= 4) {
+        /* Aligned above, so the compiler's word load cannot fault */
+        memcpy(&u32Word, pu8, sizeof(u32Word));
+        if (SL_HAS_FRAMING_CHAR(u32Word)) {
             break;
+        }
+        pu8 += 4;
+    }
 
-        case E_STATE_RX_WAIT_TYPEMSB:
-            u16PacketType = (uint16)u8Char << 8;
-            eRxState++;
-            break;
+    while ((pu8 < pu8End) && !SL_NEEDS_ESCAPE(*pu8)) {
+        pu8++;
+    }
 
-        case E_STATE_RX_WAIT_TYPELSB:
-            u16PacketType += (uint16)u8Char;
-            DBG_vPrintf(TRACE_SERIAL, "Type 0x%x\n", u16PacketType & 0xFFFF);
-            eRxState++;
-            break;
+    return (uint16)(pu8 - pu8Data);
+}
 
-        case E_STATE_RX_WAIT_LENMSB:
-            u16PacketLength = (uint16)u8Char << 8;
-            eRxState++;
-            break;
+/****************************************************************************
+ *
+ * NAME: APP_vRxStart
+ *
+ * DESCRIPTION:
+ * Start of frame. The buffer of a frame that was never completed is reused.
+ * The whole frame is decoded with the protocol version in use now, even if
+ * a version change takes effect before its end.
+ *
+ ****************************************************************************/
+PRIVATE void APP_vRxStart(void)
+{
+    bInEsc = FALSE;
+
+    if (psRxFrame == NULL) {
+        psRxFrame = APP_psAllocFrame();
+    }
+    if (psRxFrame == NULL) {
+        APP_LOG(E_LOG_SERIAL_RX_NO_BUFFER);
+        sPoolStats.u32Exhausted++;
+        eRxState = E_STATE_RX_WAIT_START;
+        return;
+    }
+
+    APP_LOG(E_LOG_SERIAL_RX_START);
+    psRxFrame->u32StartPass = u32TaskPasses;
+    u8RxHeaderBytes = 0;
+    u8RxVersion = u8ProtocolVersion;
+    u8RxHeaderLength = (u8RxVersion >= SERIAL_PROTOCOL_V2) ? 6 : 5;
+    u16RxBytes = 0;
+    eRxState = E_STATE_RX_WAIT_HEADER;
+}
 
-        case E_STATE_RX_WAIT_LENLSB:
-            u16PacketLength += (uint16)u8Char;
-            DBG_vPrintf(TRACE_SERIAL, "Length %d\n", u16PacketLength);
-            if (u16PacketLength > MAX_PACKET_SIZE) {
-                DBG_vPrintf(TRACE_SERIAL, "Length > MaxLength\n");
-                eRxState = E_STATE_RX_WAIT_START;
+/****************************************************************************
+ *
+ * NAME: APP_vRxBytes
+ *
+ * DESCRIPTION:
+ * Take unescaped bytes into the header or the data of the current frame
+ *
+ ****************************************************************************/
+PRIVATE void APP_vRxBytes(const uint8 *pu8Data, uint16 u16Length)
+{
+    uint16 u16Copy;
+
+    while (u16Length > 0) {
+        switch (eRxState) {
+        case E_STATE_RX_WAIT_HEADER:
+            u16Copy = u8RxHeaderLength - u8RxHeaderBytes;
+            if (u16Copy > u16Length) {
+                u16Copy = u16Length;
             }
-            else {
-                eRxState++;
+            memcpy(&au8RxHeader[u8RxHeaderBytes], pu8Data, u16Copy);
+            u8RxHeaderBytes += u16Copy;
+            if (u8RxHeaderBytes == u8RxHeaderLength) {
+                APP_vRxHeader();
             }
             break;
 
-        case E_STATE_RX_WAIT_CRC:
-            DBG_vPrintf(TRACE_SERIAL, "CRC %02x\n", u8Char);
-            u8CRC = u8Char;
-            eRxState++;
-            break;
-
         case E_STATE_RX_WAIT_DATA:
-            if (u16Bytes < u16PacketLength) {
-                DBG_vPrintf(TRACE_SERIAL, "%02x ", u8Char);
-                au8LinkRxBuffer[u16Bytes++] = u8Char;
+            u16Copy = psRxFrame->u16Length - u16RxBytes;
+            if (u16Copy > u16Length) {
+                u16Copy = u16Length;
             }
+            else if (u16Copy == 0) {
+                /* More data than the length said, ignored */
+                return;
+            }
+            memcpy(&psRxFrame->au8Data[u16RxBytes], pu8Data, u16Copy);
+            u16RunningCRC = APP_u16UpdateCRCBlock(u8RxVersion, u16RunningCRC, pu8Data, u16Copy);
+            u16RxBytes += u16Copy;
             break;
+
+        default:
+            /* Not in a frame */
+            return;
         }
-        break;
+
+        pu8Data += u16Copy;
+        u16Length -= u16Copy;
     }
 }
 
 /****************************************************************************
  *
- * NAME: APP_vProcessCommand
+ * NAME: APP_vRxHeader
  *
  * DESCRIPTION:
- * Processed the received command
+ * Decode the type, length and CRC of the current frame
  *
  ****************************************************************************/
-PRIVATE void APP_vProcessCommand(void)
+PRIVATE void APP_vRxHeader(void)
 {
-    switch (u16PacketType) {
-    case E_SC_MSG_RESET:
-        APP_WriteMessageToSerial("Reset...........");
-        ZTIMER_eStart(u8TimerRestart, ZTIMER_TIME_MSEC(100));
-        break;
+    psRxFrame->u16Type = ((uint16)au8RxHeader[0] << 8) | au8RxHeader[1];
+    psRxFrame->u16Length = ((uint16)au8RxHeader[2] << 8) | au8RxHeader[3];
+    APP_LOG(E_LOG_SERIAL_RX_HEADER, psRxFrame->u16Type, psRxFrame->u16Length);
 
-    case E_SC_MSG_ERASE_PERSISTENT_DATA:
-        APP_WriteMessageToSerial("Erase PDM.......");
-        PDM_vDeleteAllDataRecords();
-        APP_WriteMessageToSerial("Reset...........");
-        ZTIMER_eStart(u8TimerRestart, ZTIMER_TIME_MSEC(100));
-        break;
+    if (psRxFrame->u16Length > MAX_PACKET_SIZE) {
+        APP_LOG(E_LOG_SERIAL_RX_OVERSIZE, psRxFrame->u16Length);
+        u32OversizeFrames++;
+        eRxState = E_STATE_RX_WAIT_START;
+        return;
+    }
 
-    default:
-        break;
+    if (u8RxHeaderLength == 6) {
+        u16RxCRC = ((uint16)au8RxHeader[4] << 8) | au8RxHeader[5];
+    }
+    else {
+        u16RxCRC = au8RxHeader[4];
     }
+    u16RunningCRC = APP_u16UpdateCRCBlock(u8RxVersion, APP_u16InitCRC(u8RxVersion), au8RxHeader, 4);
+
+    eRxState = E_STATE_RX_WAIT_DATA;
 }
 
 /****************************************************************************
  *
- * NAME: APP_vWriteTxChar
+ * NAME: APP_vRxEnd
  *
  * DESCRIPTION:
- * Write byte to the serial link
+ * End of frame. A frame whose check matches is queued for the command
+ * handler.
  *
  ****************************************************************************/
-PRIVATE void APP_vWriteTxChar(uint8 u8Char)
+PRIVATE void APP_vRxEnd(void)
 {
-    ZPS_eEnterCriticalSection(NULL, &sStorage);
-
-    if (UART_bTxReady() && ZQ_bQueueIsEmpty(&APP_msgSerialTx)) {
-        /* send byte now and enable irq */
-        UART_vSetTxInterrupt(TRUE);
-        UART_vTxChar(u8Char);
-    }
-    else {
-        ZQ_bQueueSend(&APP_msgSerialTx, &u8Char);
+    APP_LOG(E_LOG_SERIAL_RX_END);
+    /* The CRC has been accumulated as the bytes arrived, so it only
+     * covers the whole frame if all of the data was received */
+    if ((eRxState == E_STATE_RX_WAIT_DATA) && (u16RxBytes == psRxFrame->u16Length)) {
+        if (u16RxCRC != u16RunningCRC) {
+            APP_LOG(E_LOG_SERIAL_RX_CRC_BAD, psRxFrame->u16Type, u16RxCRC, u16RunningCRC);
+            u32CrcErrors++;
+        }
+        else {
+            /* CRC matches - valid packet */
+            APP_LOG(E_LOG_SERIAL_RX_FRAME, psRxFrame->u16Type, u16RxBytes, u16RxCRC);
+            if (eBaudRateState == E_BAUD_RATE_CONFIRM) {
+                /* The host talks to us at the new baud rate */
+                APP_vTimerStop(&sTimerBaudRate);
+                eBaudRateState = E_BAUD_RATE_IDLE;
+            }
+            /* The queue holds as many entries as there are buffers */
+            ZQ_bQueueSend(&APP_msgSerialFrames, &psRxFrame);
+            psRxFrame = NULL;
+        }
     }
-
-    ZPS_eExitCriticalSection(NULL, &sStorage);
+    eRxState = E_STATE_RX_WAIT_START;
 }
 
 /****************************************************************************
  *
- * NAME: APP_u8CalculateCRC
+ * NAME: APP_vProcessCommand
  *
  * DESCRIPTION:
- * Calculate CRC of packet
- *
- * PARAMETERS: Name                   RW  Usage
- *             u8Type                 R   Message type
- *             u16Length              R   Message length
- *             pu8Data                R   Message payload
- *
- * RETURNS:
- * CRC of packet
+ * Processed the received command
  *
  ****************************************************************************/
-PRIVATE uint8 APP_u8CalculateCRC(uint16 u16Type, uint16 u16Length, uint8 *pu8Data)
+PRIVATE void APP_vProcessCommand(APP_tsSerialFrame *psFrame)
 {
-    int n;
-    uint8 u8CRC;
+    psCommand = psFrame;
+    pu8Payload = psFrame->au8Data;
+    u16PayloadLength = psFrame->u16Length;
 
-    u8CRC = (u16Type >> 0) & 0xff;
-    u8CRC ^= (u16Type >> 8) & 0xff;
-    u8CRC ^= (u16Length >> 0) & 0xff;
-    u8CRC ^= (u16Length >> 8) & 0xff;
+    if (psCommand->u16Type == E_SC_MSG_BENCHMARK_DATA) {
+        /* Benchmark traffic is not sequenced */
+        APP_vBenchmarkData();
+        return;
+    }
 
-    for (n = 0; n < u16Length; n++) {
-        u8CRC ^= pu8Data[n];
+    if (u8ProtocolVersion >= SERIAL_PROTOCOL_V3) {
+        if (u16PayloadLength == 0) {
+            /* No sequence number to answer with */
+            return;
+        }
+        u8RequestSeq = *pu8Payload++;
+        u16PayloadLength--;
+
+        if (APP_bResendResponse()) {
+            APP_LOG(E_LOG_SERIAL_REPEATED_REQUEST, u8RequestSeq);
+            return;
+        }
+    }
+
+    switch (psCommand->u16Type) {
+    case E_SC_MSG_RESET:
+        APP_vLegacyReply("Reset...........");
+        APP_vSendResponse(E_SC_STATUS_SUCCESS, NULL, 0);
+        APP_vTimerStart(&sTimerRestart, APP_TIMER_TIME_MSEC(100));
+        break;
+
+    case E_SC_MSG_ERASE_PERSISTENT_DATA:
+        APP_vLegacyReply("Erase PDM.......");
+        if (!APP_bPtStart(&sErasePdmTask)) {
+            /* No thread slot, so erase now, before the reply */
+            APP_vErasePdm();
+        }
+        APP_vLegacyReply("Reset...........");
+        APP_vSendResponse(E_SC_STATUS_SUCCESS, NULL, 0);
+        break;
+
+    case E_SC_MSG_SET_BAUD_RATE:
+        APP_vSetBaudRate();
+        break;
+
+    case E_SC_MSG_SET_PROTOCOL_VERSION:
+        APP_vSetProtocolVersion();
+        break;
+
+    case E_SC_MSG_GET_POOL_STATS:
+        APP_vGetPoolStats();
+        break;
+
+    case E_SC_MSG_BENCHMARK:
+        APP_vBenchmark();
+        break;
+
+    case E_SC_MSG_GET_LINK_STATS:
+        APP_vGetLinkStats();
+        break;
+
+    case E_SC_MSG_SET_LOG_LEVEL:
+        APP_vSetLogLevel();
+        break;
+
+    case E_SC_MSG_SET_CAPTURE:
+        APP_vSetCapture();
+        break;
+
+    case E_SC_MSG_GET_TASK_STATS:
+        APP_vReportTaskStats();
+        break;
+
+    case E_SC_MSG_GET_QUEUE_STATS:
+        APP_vReportQueueStats();
+        break;
+
+    case E_SC_MSG_GET_STACK_STATS:
+        APP_vReportStackStats();
+        break;
+
+    case E_SC_MSG_GET_CPU_STATS:
+        APP_vReportCpuStats();
+        break;
+
+    default:
+        u32UnknownCommands++;
+        APP_vSendResponse(E_SC_STATUS_UNKNOWN_COMMAND, NULL, 0);
+        break;
+    }
+}
+
+/****************************************************************************
+ *
+ * NAME: APP_vSetBaudRate
+ *
+ * DESCRIPTION:
+ * Handle a baud rate change request. The payload is the new baud rate as a
+ * big endian uint32. The request is acknowledged at the old baud rate and
+ * the switch happens once the acknowledgement has been sent.
+ *
+ ****************************************************************************/
+PRIVATE void APP_vSetBaudRate(void)
+{
+    uint32 u32BaudRate;
+
+    if (u16PayloadLength != sizeof(uint32)) {
+        APP_vSendResponse(E_SC_STATUS_BAD_PARAMETER, NULL, 0);
+        return;
+    }
+
+    u32BaudRate = ((uint32)pu8Payload[0] << 24) | ((uint32)pu8Payload[1] << 16) | ((uint32)pu8Payload[2] << 8) |
+                  (uint32)pu8Payload[3];
+
+    if (!UART_bIsBaudRateSupported(u32BaudRate)) {
+        APP_vLegacyReply("Bad baud rate...");
+        APP_vSendResponse(E_SC_STATUS_BAD_PARAMETER, NULL, 0);
+        return;
+    }
+
+    APP_vLegacyReply("Set baud rate...");
+    APP_vSendResponse(E_SC_STATUS_SUCCESS, NULL, 0);
+    u32NewBaudRate = u32BaudRate;
+    eBaudRateState = E_BAUD_RATE_DRAIN_TX;
+}
+
+/****************************************************************************
+ *
+ * NAME: APP_vHandleBaudRateChange
+ *
+ * DESCRIPTION:
+ * Switch to the requested baud rate once the acknowledgement has left the
+ * response queue and the UART, then give the host SERIAL_BAUD_RATE_CONFIRM_TIME to send a valid
+ * frame at the new rate
+ *
+ ****************************************************************************/
+PRIVATE void APP_vHandleBaudRateChange(void)
+{
+    if ((eBaudRateState == E_BAUD_RATE_DRAIN_TX) && (u16TxRemaining == 0) &&
+        RB_bIsEmpty(&APP_rbSerialChannel[E_SERIAL_CHANNEL_RESPONSE]) && UART_bTxIdle()) {
+        u32OldBaudRate = UART_u32GetBaudRate();
+        UART_bSetBaudRate(u32NewBaudRate);
+        eBaudRateState = E_BAUD_RATE_CONFIRM;
+        APP_vTimerStart(&sTimerBaudRate, SERIAL_BAUD_RATE_CONFIRM_TIME);
+    }
+}
+
+/****************************************************************************
+ *
+ * NAME: APP_ptErasePdm
+ *
+ * DESCRIPTION:
+ * Erase the persistent data and restart. The erase is a single PDM call,
+ * so it runs on its own main loop pass after the reply has been queued.
+ *
+ ****************************************************************************/
+PRIVATE APP_tePtState APP_ptErasePdm(APP_tsPt *psPt)
+{
+    APP_PT_BEGIN(psPt);
+
+    APP_PT_YIELD(psPt);
+    APP_vErasePdm();
+
+    APP_PT_END(psPt);
+}
+
+/****************************************************************************
+ *
+ * NAME: APP_vErasePdm
+ *
+ * DESCRIPTION:
+ * Erase the persistent data and restart once the reply has gone out
+ *
+ ****************************************************************************/
+PRIVATE void APP_vErasePdm(void)
+{
+    PDM_vDeleteAllDataRecords();
+    APP_vTimerStart(&sTimerRestart, APP_TIMER_TIME_MSEC(100));
+}
+
+/****************************************************************************
+ *
+ * NAME: APP_vUpdateFrameStats
+ *
+ * DESCRIPTION:
+ * Account the serial task passes taken by the frame about to be processed
+ *
+ ****************************************************************************/
+PRIVATE void APP_vUpdateFrameStats(uint32 u32StartPass)
+{
+    uint16 u16Passes = (uint16)(u32TaskPasses - u32StartPass + 1);
+
+    sFrameStats.u32Frames++;
+    sFrameStats.u32FramePassesTotal += u16Passes;
+    sFrameStats.u16FramePassesLast = u16Passes;
+    if (u16Passes > sFrameStats.u16FramePassesMax) {
+        sFrameStats.u16FramePassesMax = u16Passes;
+    }
+}
+
+/****************************************************************************
+ *
+ * NAME: APP_psAllocFrame
+ *
+ * DESCRIPTION:
+ * Take a free buffer from the receive frame pool
+ *
+ * RETURNS:
+ * NULL if every buffer is in use
+ *
+ ****************************************************************************/
+PRIVATE APP_tsSerialFrame *APP_psAllocFrame(void)
+{
+    uint8 i;
+
+    for (i = 0; i < SERIAL_FRAME_POOL_SIZE; i++) {
+        if ((u8FramesInUse & (1 << i)) == 0) {
+            u8FramesInUse |= (1 << i);
+            sPoolStats.u8InUse++;
+            if (sPoolStats.u8InUse > sPoolStats.u8HighWater) {
+                sPoolStats.u8HighWater = sPoolStats.u8InUse;
+            }
+            return &asFramePool[i];
+        }
+    }
+
+    return NULL;
+}
+
+/****************************************************************************
+ *
+ * NAME: APP_vFreeFrame
+ *
+ * DESCRIPTION:
+ * Return a buffer to the receive frame pool
+ *
+ ****************************************************************************/
+PRIVATE void APP_vFreeFrame(APP_tsSerialFrame *psFrame)
+{
+    u8FramesInUse &= ~(1 << (psFrame - asFramePool));
+    sPoolStats.u8InUse--;
+}
+
+/****************************************************************************
+ *
+ * NAME: APP_vGetPoolStats
+ *
+ * DESCRIPTION:
+ * Report the receive frame pool usage: size, buffers in use, high water
+ * mark and a big endian count of frames dropped for want of a buffer
+ *
+ ****************************************************************************/
+PRIVATE void APP_vGetPoolStats(void)
+{
+    uint8 au8Response[7];
+
+    au8Response[0] = sPoolStats.u8Size;
+    au8Response[1] = sPoolStats.u8InUse;
+    au8Response[2] = sPoolStats.u8HighWater;
+    APP_vPutU32(&au8Response[3], sPoolStats.u32Exhausted);
+
+    SERIAL_ASSERT_CACHEABLE(au8Response);
+    APP_vSendResponse(E_SC_STATUS_SUCCESS, au8Response, sizeof(au8Response));
+}
+
+/****************************************************************************
+ *
+ * NAME: APP_vGetLinkStats
+ *
+ * DESCRIPTION:
+ * Report the serial link health counters as big endian uint32s, in the
+ * order of APP_tsSerialLinkStats. A payload of 1 also clears them.
+ *
+ ****************************************************************************/
+PRIVATE void APP_vGetLinkStats(void)
+{
+    APP_tsSerialLinkStats sStats;
+    uint8 au8Report[32];
+
+    APP_vGetSerialLinkStats(&sStats);
+    if ((u16PayloadLength == 1) && (pu8Payload[0] == 1)) {
+        APP_vResetSerialLinkStats();
+    }
+
+    APP_vPutU32(&au8Report[0], sStats.u32RxOverruns);
+    APP_vPutU32(&au8Report[4], sStats.u32RxFramingErrors);
+    APP_vPutU32(&au8Report[8], sStats.u32RxDropped);
+    APP_vPutU32(&au8Report[12], sStats.u32PoolExhausted);
+    APP_vPutU32(&au8Report[16], sStats.u32CrcErrors);
+    APP_vPutU32(&au8Report[20], sStats.u32OversizeFrames);
+    APP_vPutU32(&au8Report[24], sStats.u32UnknownCommands);
+    APP_vPutU32(&au8Report[28], sStats.u32TxDropped);
+
+    SERIAL_ASSERT_CACHEABLE(au8Report);
+    APP_vReplyFrame(E_SC_STATUS_SUCCESS, au8Report, sizeof(au8Report));
+}
+
+/****************************************************************************
+ *
+ * NAME: APP_vSetLogLevel
+ *
+ * DESCRIPTION:
+ * Set the tokenized log level of a module. The payload is the module, or
+ * 0xFF for every module, and the level.
+ *
+ ****************************************************************************/
+PRIVATE void APP_vSetLogLevel(void)
+{
+    uint8 i;
+
+    if ((u16PayloadLength != 2) || ((pu8Payload[0] >= E_LOG_MODULE_COUNT) && (pu8Payload[0] != 0xFF)) ||
+        (pu8Payload[1] > E_LOG_LEVEL_DEBUG)) {
+        APP_vSendResponse(E_SC_STATUS_BAD_PARAMETER, NULL, 0);
+        return;
+    }
+
+    for (i = 0; i < E_LOG_MODULE_COUNT; i++) {
+        if ((pu8Payload[0] == i) || (pu8Payload[0] == 0xFF)) {
+            APP_vLogSetLevel((APP_teLogModule)i, (APP_teLogLevel)pu8Payload[1]);
+        }
+    }
+
+    APP_vSendResponse(E_SC_STATUS_SUCCESS, NULL, 0);
+}
+
+/****************************************************************************
+ *
+ * NAME: APP_vSendLogRecords
+ *
+ * DESCRIPTION:
+ * Send waiting tokenized log records to the host, one frame per pass and
+ * only when the log channel has room for it, so records stay in the log
+ * ring rather than being dropped
+ *
+ ****************************************************************************/
+PRIVATE void APP_vSendLogRecords(void)
+{
+    uint8 au8Records[SERIAL_LOG_FRAME_SIZE];
+    APP_tsSerialIoVec sPayload;
+
+    if (APP_bLogIsEmpty() || !APP_bQueueHasRoom(E_SERIAL_CHANNEL_LOG, sizeof(au8Records))) {
+        return;
+    }
+
+    sPayload.pu8Data = au8Records;
+    sPayload.u16Length = APP_u16LogRead(au8Records, sizeof(au8Records));
+    APP_bWriteFrameToSerial(E_SC_MSG_LOG_RECORDS, &sPayload, 1);
+}
+
+/****************************************************************************
+ *
+ * NAME: APP_vSetCapture
+ *
+ * DESCRIPTION:
+ * Start or stop the relayed frame capture stream. The payload is 1 to
+ * start or 0 to stop, optionally followed by the records per second as a
+ * big endian uint16 and the snap length. The reply is the counters of the
+ * run so far: records sent, events skipped by the rate limit and records
+ * dropped because the telemetry queue was full, as big endian uint32s.
+ *
+ ****************************************************************************/
+PRIVATE void APP_vSetCapture(void)
+{
+    APP_tsCaptureStats sStats;
+    uint8 au8Report[12];
+    uint16 u16Rate = 0;
+    uint8 u8SnapLength = 0;
+
+    if (((u16PayloadLength != 1) && (u16PayloadLength != 4)) || (pu8Payload[0] > 1)) {
+        APP_vSendResponse(E_SC_STATUS_BAD_PARAMETER, NULL, 0);
+        return;
+    }
+
+    if (u16PayloadLength == 4) {
+        u16Rate = ((uint16)pu8Payload[1] << 8) | pu8Payload[2];
+        u8SnapLength = pu8Payload[3];
+    }
+
+    APP_vGetCaptureStats(&sStats);
+    APP_vCaptureConfigure(pu8Payload[0], u16Rate, u8SnapLength);
+
+    APP_vPutU32(&au8Report[0], sStats.u32Captured);
+    APP_vPutU32(&au8Report[4], sStats.u32RateLimited);
+    APP_vPutU32(&au8Report[8], sStats.u32QueueFull);
+
+    SERIAL_ASSERT_CACHEABLE(au8Report);
+    APP_vReplyFrame(E_SC_STATUS_SUCCESS, au8Report, sizeof(au8Report));
+}
+
+/****************************************************************************
+ *
+ * NAME: APP_vReportTaskStats
+ *
+ * DESCRIPTION:
+ * Report the run times of a main loop task. The payload is the task, or
+ * E_APP_TASK_COUNT for the whole loop, optionally followed by 1 to clear
+ * every task's times after reading. The reply is, as big endian uint32s,
+ * the runs, the shortest and longest run and the total as a uint64, all
+ * in 16 MHz clock ticks, then the histogram bins.
+ *
+ ****************************************************************************/
+PRIVATE void APP_vReportTaskStats(void)
+{
+    APP_tsTaskStats sStats;
+    uint8 au8Report[SERIAL_RESPONSE_DATA_SIZE];
+    uint8 i;
+
+    if ((u16PayloadLength == 0) || (u16PayloadLength > 2) || (pu8Payload[0] >= APP_TASK_STATS_COUNT)) {
+        APP_vSendResponse(E_SC_STATUS_BAD_PARAMETER, NULL, 0);
+        return;
+    }
+
+    APP_vGetTaskStats(pu8Payload[0], &sStats);
+    if ((u16PayloadLength == 2) && (pu8Payload[1] == 1)) {
+        APP_vResetTaskStats();
+    }
+
+    APP_vPutU32(&au8Report[0], sStats.u32Runs);
+    APP_vPutU32(&au8Report[4], sStats.u32MinTicks);
+    APP_vPutU32(&au8Report[8], sStats.u32MaxTicks);
+    APP_vPutU32(&au8Report[12], (uint32)(sStats.u64SumTicks >> 32));
+    APP_vPutU32(&au8Report[16], (uint32)sStats.u64SumTicks);
+    for (i = 0; i < APP_TASK_HISTOGRAM_BINS; i++) {
+        APP_vPutU32(&au8Report[20 + 4 * i], sStats.au32Histogram[i]);
+    }
+
+    SERIAL_ASSERT_CACHEABLE(au8Report);
+    APP_vReplyFrame(E_SC_STATUS_SUCCESS, au8Report, sizeof(au8Report));
+}
+
+/****************************************************************************
+ *
+ * NAME: APP_vReportQueueStats
+ *
+ * DESCRIPTION:
+ * Report the usage of every queue created in APP_vInitResources, in
+ * APP_teQueue order: size and peak depth as big endian uint16s and
+ * refused sends as a big endian uint32. A payload of 1 clears the peaks
+ * and refused sends after reading.
+ *
+ ****************************************************************************/
+PRIVATE void APP_vReportQueueStats(void)
+{
+    APP_tsQueueStats sStats;
+    uint8 au8Report[8 * E_APP_QUEUE_COUNT];
+    uint8 *pu8 = au8Report;
+    uint8 i;
+
+    for (i = 0; i < E_APP_QUEUE_COUNT; i++) {
+        APP_vGetQueueStats((APP_teQueue)i, &sStats);
+        *pu8++ = (uint8)(sStats.u16Size >> 8);
+        *pu8++ = (uint8)sStats.u16Size;
+        *pu8++ = (uint8)(sStats.u16Peak >> 8);
+        *pu8++ = (uint8)sStats.u16Peak;
+        APP_vPutU32(pu8, sStats.u32Failed);
+        pu8 += 4;
+    }
+
+    if ((u16PayloadLength == 1) && (pu8Payload[0] == 1)) {
+        APP_vResetQueueStats();
+    }
+
+    SERIAL_ASSERT_CACHEABLE(au8Report);
+    APP_vReplyFrame(E_SC_STATUS_SUCCESS, au8Report, sizeof(au8Report));
+}
+
+/****************************************************************************
+ *
+ * NAME: APP_vReportStackStats
+ *
+ * DESCRIPTION:
+ * Report the stack size and peak stack use since this boot and since power
+ * on, as big endian uint32s. A payload of 1 restarts the power on peak.
+ *
+ ****************************************************************************/
+PRIVATE void APP_vReportStackStats(void)
+{
+    APP_tsStackStats sStats;
+    uint8 au8Report[12];
+
+    APP_vGetStackStats(&sStats);
+    if ((u16PayloadLength == 1) && (pu8Payload[0] == 1)) {
+        APP_vResetStackStats();
+    }
+
+    APP_vPutU32(&au8Report[0], sStats.u32Size);
+    APP_vPutU32(&au8Report[4], sStats.u32PeakUsed);
+    APP_vPutU32(&au8Report[8], sStats.u32PeakUsedRetained);
+
+    SERIAL_ASSERT_CACHEABLE(au8Report);
+    APP_vReplyFrame(E_SC_STATUS_SUCCESS, au8Report, sizeof(au8Report));
+}
+
+/****************************************************************************
+ *
+ * NAME: APP_vReportCpuStats
+ *
+ * DESCRIPTION:
+ * Report the CPU utilisation over the last second, the last minute and the
+ * last 15 minutes in tenths of a percent, and the longest run without a
+ * doze in microseconds, as big endian uint32s. A payload of 1 clears the
+ * longest run.
+ *
+ ****************************************************************************/
+PRIVATE void APP_vReportCpuStats(void)
+{
+    APP_tsCpuStats sStats;
+    uint8 au8Report[16];
+
+    APP_vGetCpuStats(&sStats);
+    if ((u16PayloadLength == 1) && (pu8Payload[0] == 1)) {
+        APP_vResetCpuStats();
+    }
+
+    APP_vPutU32(&au8Report[0], sStats.u16Utilisation);
+    APP_vPutU32(&au8Report[4], sStats.u16Utilisation1Min);
+    APP_vPutU32(&au8Report[8], sStats.u16Utilisation15Min);
+    APP_vPutU32(&au8Report[12], sStats.u32PeakBusyUsec);
+
+    SERIAL_ASSERT_CACHEABLE(au8Report);
+    APP_vReplyFrame(E_SC_STATUS_SUCCESS, au8Report, sizeof(au8Report));
+}
+
+/****************************************************************************
+ *
+ * NAME: APP_vBenchmark
+ *
+ * DESCRIPTION:
+ * Start or stop a link benchmark. The payload is the mode, followed for
+ * the source mode by the number of bytes to send as a big endian uint32.
+ * Starting resets the counters; stopping reports, as big endian uint32s,
+ * the elapsed time in ms, bytes received, bytes sent, bytes per second both
+ * ways, CRC failures, receive drops and transmit drops during the run.
+ *
+ ****************************************************************************/
+PRIVATE void APP_vBenchmark(void)
+{
+    uint8 au8Report[28];
+    uint32 u32Elapsed;
+    uint32 u32Bytes;
+
+    if ((u16PayloadLength == 0) || (pu8Payload[0] > E_BENCHMARK_SOURCE) ||
+        ((pu8Payload[0] == E_BENCHMARK_SOURCE) && (u16PayloadLength != 5))) {
+        APP_vSendResponse(E_SC_STATUS_BAD_PARAMETER, NULL, 0);
+        return;
+    }
+
+    if (pu8Payload[0] == E_BENCHMARK_STOP) {
+        u32Elapsed = APP_u32ClockMsec() - sBenchmark.u32StartMsec;
+        u32Bytes = sBenchmark.u32RxBytes + sBenchmark.u32TxBytes;
+
+        APP_vPutU32(&au8Report[0], u32Elapsed);
+        APP_vPutU32(&au8Report[4], sBenchmark.u32RxBytes);
+        APP_vPutU32(&au8Report[8], sBenchmark.u32TxBytes);
+        APP_vPutU32(&au8Report[12], (u32Elapsed > 0) ? (uint32)(((uint64)u32Bytes * 1000) / u32Elapsed) : 0);
+        APP_vPutU32(&au8Report[16], u32CrcErrors - sBenchmark.u32CrcErrors);
+        APP_vPutU32(&au8Report[20], APP_u32RxDropped() - sBenchmark.u32RxDropped);
+        APP_vPutU32(&au8Report[24], u32TxDropped - sBenchmark.u32TxDropped);
+
+        sBenchmark.eMode = E_BENCHMARK_STOP;
+        APP_LOG(E_LOG_SERIAL_BENCHMARK, u32Bytes, u32Elapsed);
+
+        SERIAL_ASSERT_CACHEABLE(au8Report);
+        APP_vReplyFrame(E_SC_STATUS_SUCCESS, au8Report, sizeof(au8Report));
+        return;
+    }
+
+    sBenchmark.eMode = (APP_teBenchmarkMode)pu8Payload[0];
+    sBenchmark.u32StartMsec = APP_u32ClockMsec();
+    sBenchmark.u32RxBytes = 0;
+    sBenchmark.u32TxBytes = 0;
+    sBenchmark.u32SourceRemaining = 0;
+    sBenchmark.u32CrcErrors = u32CrcErrors;
+    sBenchmark.u32RxDropped = APP_u32RxDropped();
+    sBenchmark.u32TxDropped = u32TxDropped;
+    sBenchmark.u8Pattern = 0;
+    if (sBenchmark.eMode == E_BENCHMARK_SOURCE) {
+        sBenchmark.u32SourceRemaining = ((uint32)pu8Payload[1] << 24) | ((uint32)pu8Payload[2] << 16) |
+                                        ((uint32)pu8Payload[3] << 8) | (uint32)pu8Payload[4];
+    }
+
+    APP_vSendResponse(E_SC_STATUS_SUCCESS, NULL, 0);
+}
+
+/****************************************************************************
+ *
+ * NAME: APP_vBenchmarkData
+ *
+ * DESCRIPTION:
+ * Handle a benchmark data frame in the echo and sink modes. Echoes go out
+ * on the telemetry channel, behind any command responses.
+ *
+ ****************************************************************************/
+PRIVATE void APP_vBenchmarkData(void)
+{
+    APP_tsSerialIoVec sPayload;
+
+    if ((sBenchmark.eMode != E_BENCHMARK_ECHO) && (sBenchmark.eMode != E_BENCHMARK_SINK)) {
+        return;
+    }
+
+    sBenchmark.u32RxBytes += psCommand->u16Length;
+
+    if (sBenchmark.eMode == E_BENCHMARK_ECHO) {
+        sPayload.pu8Data = psCommand->au8Data;
+        sPayload.u16Length = psCommand->u16Length;
+        if (APP_bWriteFrameToSerial(E_SC_MSG_BENCHMARK_TELEMETRY_DATA, &sPayload, 1)) {
+            sBenchmark.u32TxBytes += psCommand->u16Length;
+        }
+    }
+}
+
+/****************************************************************************
+ *
+ * NAME: APP_vBenchmarkSource
+ *
+ * DESCRIPTION:
+ * Send benchmark data frames of an incrementing byte pattern on the
+ * telemetry channel while its queue has room for them
+ *
+ ****************************************************************************/
+PRIVATE void APP_vBenchmarkSource(void)
+{
+    uint8 au8Data[SERIAL_BENCHMARK_FRAME_SIZE];
+    APP_tsSerialIoVec sPayload;
+    uint16 u16Length;
+    uint16 i;
+
+    while (sBenchmark.u32SourceRemaining > 0) {
+        u16Length = (sBenchmark.u32SourceRemaining < sizeof(au8Data)) ? (uint16)sBenchmark.u32SourceRemaining
+                                                                       : sizeof(au8Data);
+
+        /* Leave room for every byte to be escaped, so a full queue stops the
+         * source without counting as a TX drop */
+        if (!APP_bQueueHasRoom(E_SERIAL_CHANNEL_TELEMETRY, u16Length)) {
+            break;
+        }
+
+        for (i = 0; i < u16Length; i++) {
+            au8Data[i] = sBenchmark.u8Pattern++;
+        }
+
+        sPayload.pu8Data = au8Data;
+        sPayload.u16Length = u16Length;
+        APP_bWriteFrameToSerial(E_SC_MSG_BENCHMARK_TELEMETRY_DATA, &sPayload, 1);
+
+        sBenchmark.u32TxBytes += u16Length;
+        sBenchmark.u32SourceRemaining -= u16Length;
+    }
+}
+
+/****************************************************************************
+ *
+ * NAME: APP_u32RxDropped
+ *
+ * DESCRIPTION:
+ * Received bytes dropped by the UART driver plus frames dropped for want
+ * of a receive buffer
+ *
+ ****************************************************************************/
+PRIVATE uint32 APP_u32RxDropped(void)
+{
+    UART_tsStats sStats;
+
+    UART_vGetStats(&sStats);
+
+    return sStats.u32RxDropped + sPoolStats.u32Exhausted;
+}
+
+/****************************************************************************
+ *
+ * NAME: APP_vPutU32
+ *
+ * DESCRIPTION:
+ * Store a uint32 big endian
+ *
+ ****************************************************************************/
+PRIVATE void APP_vPutU32(uint8 *pu8Data, uint32 u32Value)
+{
+    pu8Data[0] = (uint8)(u32Value >> 24);
+    pu8Data[1] = (uint8)(u32Value >> 16);
+    pu8Data[2] = (uint8)(u32Value >> 8);
+    pu8Data[3] = (uint8)u32Value;
+}
+
+/****************************************************************************
+ *
+ * NAME: APP_vSetProtocolVersion
+ *
+ * DESCRIPTION:
+ * Handle a protocol version request. The payload is the requested version.
+ * The response carries the version in use from now on and the version 3
+ * window size, and is framed with the old version, so a host that asks for
+ * a version this firmware does not know gets the current version back and
+ * stays where it was. The switch happens here, while later frames from the
+ * host may already be arriving, so the host must not send another frame
+ * until it has the response.
+ *
+ ****************************************************************************/
+PRIVATE void APP_vSetProtocolVersion(void)
+{
+    APP_tsSerialIoVec sPayload;
+    uint8 au8Response[2];
+    uint8 u8Status = E_SC_STATUS_SUCCESS;
+    uint8 u8Version;
+    uint8 i;
+
+    if (u16PayloadLength != sizeof(uint8)) {
+        APP_vSendResponse(E_SC_STATUS_BAD_PARAMETER, NULL, 0);
+        return;
+    }
+
+    u8Version = pu8Payload[0];
+    if ((u8Version < SERIAL_PROTOCOL_V1) || (u8Version > SERIAL_PROTOCOL_V3)) {
+        u8Version = u8ProtocolVersion;
+        u8Status = E_SC_STATUS_BAD_PARAMETER;
+    }
+
+    au8Response[0] = u8Version;
+    au8Response[1] = SERIAL_WINDOW_SIZE;
+
+    if (u8ProtocolVersion >= SERIAL_PROTOCOL_V3) {
+        SERIAL_ASSERT_CACHEABLE(au8Response);
+        APP_vSendResponse(u8Status, au8Response, sizeof(au8Response));
+    }
+    else {
+        sPayload.pu8Data = au8Response;
+        sPayload.u16Length = sizeof(au8Response);
+        if (!APP_bWriteFrameToSerial(E_SC_MSG_SET_PROTOCOL_VERSION, &sPayload, 1)) {
+            /* The host never saw the response, so stay where we are */
+            return;
+        }
+    }
+
+    if (u8Version != u8ProtocolVersion) {
+        /* Sequence numbers start over in the new version */
+        for (i = 0; i < SERIAL_WINDOW_SIZE; i++) {
+            asResponses[i].bValid = FALSE;
+        }
+        u8ProtocolVersion = u8Version;
+    }
+}
+
+/****************************************************************************
+ *
+ * NAME: APP_vSendResponse
+ *
+ * DESCRIPTION:
+ * Answer the current version 3 request with a framed response of the
+ * request type with SERIAL_RESPONSE_FLAG set. The payload is the request
+ * sequence number, the status and any response data. The response is
+ * remembered in case the host retransmits the request. A response too big
+ * to remember whole is sent but not remembered, so a retransmitted request
+ * runs again rather than getting a shortened answer. Nothing is sent in the
+ * older versions.
+ *
+ ****************************************************************************/
+PRIVATE void APP_vSendResponse(uint8 u8Status, const uint8 *pu8Data, uint8 u8Length)
+{
+    APP_tsSerialResponse *psResponse = &asResponses[u8NextResponse];
+
+    if (u8ProtocolVersion < SERIAL_PROTOCOL_V3) {
+        return;
+    }
+
+    u8NextResponse = (u8NextResponse + 1) % SERIAL_WINDOW_SIZE;
+
+    if (u8Length > SERIAL_RESPONSE_DATA_SIZE) {
+        psResponse->bValid = FALSE;
+        APP_vWriteResponse(psCommand->u16Type, u8RequestSeq, u8Status, pu8Data, u8Length);
+        return;
+    }
+
+    psResponse->bValid = TRUE;
+    psResponse->u8Seq = u8RequestSeq;
+    psResponse->u16Type = psCommand->u16Type;
+    psResponse->u8Status = u8Status;
+    psResponse->u8DataLength = u8Length;
+    if (u8Length > 0) {
+        memcpy(psResponse->au8Data, pu8Data, u8Length);
+    }
+
+    APP_vWriteResponse(psResponse->u16Type,
+                       psResponse->u8Seq,
+                       psResponse->u8Status,
+                       psResponse->au8Data,
+                       psResponse->u8DataLength);
+}
+
+/****************************************************************************
+ *
+ * NAME: APP_vReplyFrame
+ *
+ * DESCRIPTION:
+ * Reply with data to a command that has no legacy text reply. Before
+ * protocol version 3 the data is framed with the request type.
+ *
+ ****************************************************************************/
+PRIVATE void APP_vReplyFrame(uint8 u8Status, const uint8 *pu8Data, uint8 u8Length)
+{
+    APP_tsSerialIoVec sPayload;
+
+    if (u8ProtocolVersion >= SERIAL_PROTOCOL_V3) {
+        APP_vSendResponse(u8Status, pu8Data, u8Length);
+    }
+    else {
+        sPayload.pu8Data = pu8Data;
+        sPayload.u16Length = u8Length;
+        APP_bWriteFrameToSerial(psCommand->u16Type, &sPayload, 1);
+    }
+}
+
+/****************************************************************************
+ *
+ * NAME: APP_bResendResponse
+ *
+ * DESCRIPTION:
+ * Answer a retransmitted version 3 request from the response cache
+ *
+ * RETURNS:
+ * TRUE if the request had already been executed
+ *
+ ****************************************************************************/
+PRIVATE bool_t APP_bResendResponse(void)
+{
+    APP_tsSerialResponse *psResponse;
+    uint8 i;
+
+    for (i = 0; i < SERIAL_WINDOW_SIZE; i++) {
+        psResponse = &asResponses[i];
+        if (psResponse->bValid && (psResponse->u8Seq == u8RequestSeq) && (psResponse->u16Type == psCommand->u16Type)) {
+            APP_vWriteResponse(psResponse->u16Type,
+                               psResponse->u8Seq,
+                               psResponse->u8Status,
+                               psResponse->au8Data,
+                               psResponse->u8DataLength);
+            return TRUE;
+        }
+    }
+
+    return FALSE;
+}
+
+/****************************************************************************
+ *
+ * NAME: APP_vWriteResponse
+ *
+ * DESCRIPTION:
+ * Frame a version 3 response to a request of type u16Type. The payload is
+ * gathered from the sequence number, the status and the data.
+ *
+ ****************************************************************************/
+PRIVATE void APP_vWriteResponse(uint16 u16Type, uint8 u8Seq, uint8 u8Status, const uint8 *pu8Data, uint8 u8Length)
+{
+    APP_tsSerialIoVec asPayload[3];
+
+    asPayload[0].pu8Data = &u8Seq;
+    asPayload[0].u16Length = sizeof(u8Seq);
+    asPayload[1].pu8Data = &u8Status;
+    asPayload[1].u16Length = sizeof(u8Status);
+    asPayload[2].pu8Data = pu8Data;
+    asPayload[2].u16Length = u8Length;
+    APP_bWriteFrameToSerial(u16Type | SERIAL_RESPONSE_FLAG, asPayload, 3);
+}
+
+/****************************************************************************
+ *
+ * NAME: APP_vLegacyReply
+ *
+ * DESCRIPTION:
+ * Write the unframed text reply used before protocol version 3
+ *
+ ****************************************************************************/
+PRIVATE void APP_vLegacyReply(const char *pcMessage)
+{
+    if (u8ProtocolVersion < SERIAL_PROTOCOL_V3) {
+        APP_bWriteToSerial(E_SERIAL_CHANNEL_RESPONSE, (const uint8 *)pcMessage, strlen(pcMessage));
+    }
+}
+
+/****************************************************************************
+ *
+ * NAME: APP_u16InitCRC
+ *
+ * DESCRIPTION:
+ * Initial frame check value for a protocol version
+ *
+ ****************************************************************************/
+PRIVATE uint16 APP_u16InitCRC(uint8 u8Version)
+{
+    return (u8Version >= SERIAL_PROTOCOL_V2) ? CRC16_INIT : 0;
+}
+
+/****************************************************************************
+ *
+ * NAME: APP_u16UpdateCRC
+ *
+ * DESCRIPTION:
+ * Fold one byte into the frame check for a protocol version
+ *
+ ****************************************************************************/
+PRIVATE uint16 APP_u16UpdateCRC(uint8 u8Version, uint16 u16Crc, uint8 u8Byte)
+{
+    if (u8Version >= SERIAL_PROTOCOL_V2) {
+        return CRC16_u16Update(u16Crc, u8Byte);
+    }
+
+    return u16Crc ^ u8Byte;
+}
+
+/****************************************************************************
+ *
+ * NAME: APP_u16UpdateCRCBlock
+ *
+ * DESCRIPTION:
+ * Fold a block of bytes into the frame check for a protocol version
+ *
+ ****************************************************************************/
+PRIVATE uint16 APP_u16UpdateCRCBlock(uint8 u8Version, uint16 u16Crc, const uint8 *pu8Data, uint16 u16Length)
+{
+    if (u8Version >= SERIAL_PROTOCOL_V2) {
+        return CRC16_u16UpdateBlock(u16Crc, pu8Data, u16Length);
+    }
+
+    while (u16Length--) {
+        u16Crc ^= *pu8Data++;
+    }
+
+    return u16Crc;
+}
+
+/****************************************************************************
+ *
+ * NAME: APP_u16ScanForTx
+ *
+ * DESCRIPTION:
+ * Fold data into a frame CRC and work out its length once escaped
+ *
+ * RETURNS:
+ * Number of bytes the data takes on the wire
+ *
+ ****************************************************************************/
+PRIVATE uint16 APP_u16ScanForTx(const uint8 *pu8Data, uint16 u16Length, uint16 *pu16Crc)
+{
+    uint16 u16Encoded = u16Length;
+    uint16 u16Crc = *pu16Crc;
+    uint16 n;
+
+    for (n = 0; n < u16Length; n++) {
+        u16Crc = APP_u16UpdateCRC(u8ProtocolVersion, u16Crc, pu8Data[n]);
+        if (SL_NEEDS_ESCAPE(pu8Data[n])) {
+            u16Encoded++;
+        }
+    }
+
+    *pu16Crc = u16Crc;
+
+    return u16Encoded;
+}
+
+/****************************************************************************
+ *
+ * NAME: APP_vPushEscaped
+ *
+ * DESCRIPTION:
+ * Copy data into a ring, escaping framing characters. Runs of clean bytes
+ * are copied in bulk. The caller has checked there is enough room.
+ *
+ ****************************************************************************/
+PRIVATE void APP_vPushEscaped(RB_tsRingBuffer *psRing, const uint8 *pu8Data, uint16 u16Length)
+{
+    uint16 u16Run = 0;
+    uint16 n;
+
+    for (n = 0; n < u16Length; n++) {
+        if (SL_NEEDS_ESCAPE(pu8Data[n])) {
+            RB_u16PushN(psRing, &pu8Data[u16Run], n - u16Run);
+            RB_bPush(psRing, SL_ESC_CHAR);
+            RB_bPush(psRing, pu8Data[n] ^ 0x10);
+            u16Run = n + 1;
+        }
+    }
+
+    RB_u16PushN(psRing, &pu8Data[u16Run], u16Length - u16Run);
+}
+
+/****************************************************************************
+ *
+ * NAME: APP_bQueueHasRoom
+ *
+ * DESCRIPTION:
+ * Check a channel queue can take a frame of u16Length payload bytes
+ * however many of them need escaping
+ *
+ ****************************************************************************/
+PRIVATE bool_t APP_bQueueHasRoom(APP_teSerialChannel eChannel, uint16 u16Length)
+{
+    return RB_u16Free(&APP_rbSerialChannel[eChannel]) >= SL_MAX_QUEUED_SIZE(u16Length);
+}
+
+/****************************************************************************
+ *
+ * NAME: APP_vScheduleTx
+ *
+ * DESCRIPTION:
+ * Move queued frames into the TX ring by strict channel priority. A frame
+ * is moved whole before the next one is chosen, in pieces if it is longer
+ * than the free space. Lower priority frames are only started on an empty
+ * TX ring, so a response waits for at most the one frame already on its
+ * way out. While a baud rate change waits for its acknowledgement to drain
+ * only responses are sent.
+ *
+ ****************************************************************************/
+PRIVATE void APP_vScheduleTx(void)
+{
+    uint8 au8Chunk[SERIAL_TX_CHUNK_SIZE];
+    RB_tsRingBuffer *psQueue;
+    uint16 u16Length;
+    uint8 i;
+
+    while (TRUE) {
+        if (u16TxRemaining == 0) {
+            for (i = 0; i < E_SERIAL_CHANNEL_COUNT; i++) {
+                if (!RB_bIsEmpty(&APP_rbSerialChannel[i])) {
+                    break;
+                }
+            }
+
+            if ((i == E_SERIAL_CHANNEL_COUNT) ||
+                ((i != E_SERIAL_CHANNEL_RESPONSE) &&
+                 (!RB_bIsEmpty(&APP_rbSerialTx) || (eBaudRateState == E_BAUD_RATE_DRAIN_TX)))) {
+                break;
+            }
+
+            eTxChannel = (APP_teSerialChannel)i;
+            RB_u16PopN(&APP_rbSerialChannel[i], au8Chunk, 2);
+            u16TxRemaining = ((uint16)au8Chunk[0] << 8) | au8Chunk[1];
+        }
+
+        psQueue = &APP_rbSerialChannel[eTxChannel];
+        u16Length = RB_u16Free(&APP_rbSerialTx);
+        u16Length = (u16Length < sizeof(au8Chunk)) ? u16Length : sizeof(au8Chunk);
+        u16Length = (u16Length < u16TxRemaining) ? u16Length : u16TxRemaining;
+        if (u16Length == 0) {
+            break;
+        }
+
+        RB_u16PopN(psQueue, au8Chunk, u16Length);
+        RB_u16PushN(&APP_rbSerialTx, au8Chunk, u16Length);
+        u16TxRemaining -= u16Length;
     }
 
-    return (u8CRC);
+    UART_vStartTx();
 }
 
 /****************************************************************************/
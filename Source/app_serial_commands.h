@@ -45,10 +45,80 @@
 /***        Macro Definitions                                             ***/
 /****************************************************************************/
 
+#define MAX_PACKET_SIZE 256
+
+/* Frames are received into a pool so that the next frame can be received
+ * while the last one is waiting for the command handler. A full version 3
+ * window of requests may be waiting, plus the frame being received. */
+#define SERIAL_FRAME_POOL_SIZE 5
+
+/* Type, length and a CRC of up to two bytes */
+#define SL_MAX_HEADER_SIZE 6
+
+/* Channel queue space a frame of u16Length payload bytes may need: the
+ * length prefix, START, END and every other byte escaped */
+#define SL_MAX_QUEUED_SIZE(u16Length) (2 + 2 + 2 * ((u16Length) + SL_MAX_HEADER_SIZE))
+
+/* Bits 8 to 11 of a message type select the logical channel it is sent on */
+#define SERIAL_CHANNEL_OF_TYPE(t)  ((APP_teSerialChannel)(((t) >> 8) & 0x0F))
+#define SERIAL_CHANNEL_TYPE(c, id) ((uint16)(((c) << 8) | (id)))
+
 /****************************************************************************/
 /***        Type Definitions                                              ***/
 /****************************************************************************/
 
+/* Logical channels sharing the serial link. Each has its own TX queue and
+ * the lowest numbered channel with a frame waiting is sent next. */
+typedef enum {
+    E_SERIAL_CHANNEL_RESPONSE,  /* command responses */
+    E_SERIAL_CHANNEL_EVENT,     /* asynchronous events */
+    E_SERIAL_CHANNEL_TELEMETRY, /* bulk data streams */
+    E_SERIAL_CHANNEL_LOG,       /* log records */
+    E_SERIAL_CHANNEL_COUNT
+} APP_teSerialChannel;
+
+/* A received frame, passed by pointer through APP_msgSerialFrames */
+typedef struct {
+    uint32 u32StartPass;
+    uint16 u16Type;
+    uint16 u16Length;
+    uint8 au8Data[MAX_PACKET_SIZE];
+} APP_tsSerialFrame;
+
+/* Receive frame pool usage */
+typedef struct {
+    uint8 u8Size;
+    uint8 u8InUse;
+    uint8 u8HighWater;
+    uint32 u32Exhausted; /* frames dropped because every buffer was in use */
+} APP_tsSerialPoolStats;
+
+/* One segment of a gathered serial write */
+typedef struct {
+    const uint8 *pu8Data;
+    uint16 u16Length;
+} APP_tsSerialIoVec;
+
+/* Main loop passes of the serial task from frame start to frame processing */
+typedef struct {
+    uint32 u32Frames;
+    uint32 u32FramePassesTotal;
+    uint16 u16FramePassesLast;
+    uint16 u16FramePassesMax;
+} APP_tsSerialFrameStats;
+
+/* Serial link health counters */
+typedef struct {
+    uint32 u32RxOverruns;      /* UART RX FIFO overruns */
+    uint32 u32RxFramingErrors; /* UART framing errors */
+    uint32 u32RxDropped;       /* bytes lost because the RX ring was full */
+    uint32 u32PoolExhausted;   /* frames lost because every frame buffer was in use */
+    uint32 u32CrcErrors;       /* frames with a bad check */
+    uint32 u32OversizeFrames;  /* frames longer than MAX_PACKET_SIZE */
+    uint32 u32UnknownCommands; /* frames with an unknown message type */
+    uint32 u32TxDropped;       /* messages lost because their channel queue was full */
+} APP_tsSerialLinkStats;
+
 /****************************************************************************/
 /***        Exported Variables                                            ***/
 /****************************************************************************/
@@ -58,7 +128,15 @@
 /****************************************************************************/
 
 PUBLIC void APP_taskAtSerial(void);
+PUBLIC bool_t APP_bSerialHasWork(void);
 PUBLIC void APP_WriteMessageToSerial(const char *message);
+PUBLIC bool_t APP_bWriteToSerial(APP_teSerialChannel eChannel, const uint8 *pu8Data, uint16 u16Length);
+PUBLIC bool_t APP_bWriteFrameToSerial(uint16 u16Type, const APP_tsSerialIoVec *psPayload, uint8 u8Count);
+PUBLIC void APP_vGetSerialFrameStats(APP_tsSerialFrameStats *psStats);
+PUBLIC void APP_vGetSerialPoolStats(APP_tsSerialPoolStats *psStats);
+PUBLIC void APP_vGetSerialLinkStats(APP_tsSerialLinkStats *psStats);
+PUBLIC void APP_vResetSerialLinkStats(void);
+PUBLIC void APP_cbTimerBaudRate(void *pvParam);
 
 /****************************************************************************/
 /***        END OF FILE                                                   ***/
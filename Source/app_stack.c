@@ -0,0 +1,198 @@
+/****************************************************************************
+ *
+ * MODULE:              Lumi Router
+ *
+ * COMPONENT:           app_stack.c
+ *
+ * DESCRIPTION:         Stack high-water measurement
+ *
+ ****************************************************************************
+ *
+ * This software is owned by NXP B.V. and/or its supplier and is protected
+ * under applicable copyright laws. All rights are reserved. We grant You,
+ * and any third parties, a license to use this software solely and
+ * exclusively on NXP products [NXP Microcontrollers such as JN5168, JN5179].
+ * You, and any third parties must reproduce the copyright and warranty notice
+ * and any other legend of ownership on each copy or partial copy of the
+ * software.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+ * AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+ * IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE
+ * ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE
+ * LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR
+ * CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF
+ * SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS
+ * INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN
+ * CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE)
+ * ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+ * POSSIBILITY OF SUCH DAMAGE.
+ *
+ * Copyright NXP B.V. 2016. All rights reserved
+ *
+ ****************************************************************************/
+
+/****************************************************************************/
+/***        Include Files                                                 ***/
+/****************************************************************************/
+
+#include <jendefs.h>
+
+/* Application */
+#include "app_stack.h"
+
+/****************************************************************************/
+/***        Macro Definitions                                             ***/
+/****************************************************************************/
+
+#define STACK_PAINT_PATTERN 0xA5A5A5A5UL
+
+/* Stack in use by vAppMain and its callers when the stack is painted */
+#define STACK_PAINT_MARGIN 64
+
+/* Words checked per idle pass */
+#define STACK_SCAN_WORDS 32
+
+/* Marks the retained record as written by this firmware since power on */
+#define STACK_RETAINED_MAGIC 0x53544B31UL
+
+/****************************************************************************/
+/***        Type Definitions                                              ***/
+/****************************************************************************/
+
+typedef struct {
+    uint32 u32Magic;
+    uint32 u32PeakUsed;
+} APP_tsStackRetained;
+
+/****************************************************************************/
+/***        Local Function Prototypes                                     ***/
+/****************************************************************************/
+
+/****************************************************************************/
+/***        Exported Variables                                            ***/
+/****************************************************************************/
+
+/* Lowest address the stack may grow to, from the linker command file */
+extern void *_stack_low_water_mark;
+
+/****************************************************************************/
+/***        Local Variables                                               ***/
+/****************************************************************************/
+
+/* Lowest painted word found overwritten, and the next word to check */
+PRIVATE uint32 *pu32Lowest;
+PRIVATE uint32 *pu32Scan;
+
+PRIVATE uint32 u32PeakUsed;
+
+/* Placed after .bss by Build/app_noinit.ld, so the startup code does not
+ * clear it and it survives a software reset */
+PRIVATE APP_tsStackRetained sRetained __attribute__((section(".noinit")));
+
+/****************************************************************************/
+/***        Exported Functions                                            ***/
+/****************************************************************************/
+
+/****************************************************************************
+ *
+ * NAME: APP_vStackPaint
+ *
+ * DESCRIPTION:
+ * Fill the unused part of the stack with a pattern, from the low water mark
+ * up to just below the caller's frame. Call once at boot, before interrupts
+ * are enabled.
+ *
+ ****************************************************************************/
+PUBLIC void __attribute__((noinline)) APP_vStackPaint(void)
+{
+    uint32 u32Marker;
+    uint32 *pu32;
+
+    pu32Lowest = (uint32 *)((((uint32)&u32Marker) - STACK_PAINT_MARGIN) & ~3UL);
+    pu32Scan = (uint32 *)&_stack_low_water_mark;
+
+    for (pu32 = pu32Scan; pu32 < pu32Lowest; pu32++) {
+        *pu32 = STACK_PAINT_PATTERN;
+    }
+
+    u32PeakUsed = APP_STACK_SIZE - ((uint32)pu32Lowest - (uint32)&_stack_low_water_mark);
+
+    if (sRetained.u32Magic != STACK_RETAINED_MAGIC) {
+        sRetained.u32Magic = STACK_RETAINED_MAGIC;
+        sRetained.u32PeakUsed = 0;
+    }
+}
+
+/****************************************************************************
+ *
+ * NAME: APP_vStackScan
+ *
+ * DESCRIPTION:
+ * Check a few more painted words, working up from the low water mark. The
+ * first overwritten word is the deepest the stack has been. Only the words
+ * below the deepest point so far need checking, so a sweep gets shorter
+ * as the stack gets deeper. Call when idle.
+ *
+ ****************************************************************************/
+PUBLIC void APP_vStackScan(void)
+{
+    uint8 i;
+
+    for (i = 0; i < STACK_SCAN_WORDS; i++) {
+        if (pu32Scan >= pu32Lowest) {
+            pu32Scan = (uint32 *)&_stack_low_water_mark;
+            return;
+        }
+
+        if (*pu32Scan != STACK_PAINT_PATTERN) {
+            pu32Lowest = pu32Scan;
+            u32PeakUsed = APP_STACK_SIZE - ((uint32)pu32Lowest - (uint32)&_stack_low_water_mark);
+            if (u32PeakUsed > sRetained.u32PeakUsed) {
+                sRetained.u32PeakUsed = u32PeakUsed;
+            }
+
+            pu32Scan = (uint32 *)&_stack_low_water_mark;
+            return;
+        }
+
+        pu32Scan++;
+    }
+}
+
+/****************************************************************************
+ *
+ * NAME: APP_vGetStackStats
+ *
+ * DESCRIPTION:
+ * Read the peak stack use
+ *
+ ****************************************************************************/
+PUBLIC void APP_vGetStackStats(APP_tsStackStats *psStats)
+{
+    psStats->u32Size = APP_STACK_SIZE;
+    psStats->u32PeakUsed = u32PeakUsed;
+    psStats->u32PeakUsedRetained = (sRetained.u32PeakUsed > u32PeakUsed) ? sRetained.u32PeakUsed : u32PeakUsed;
+}
+
+/****************************************************************************
+ *
+ * NAME: APP_vResetStackStats
+ *
+ * DESCRIPTION:
+ * Restart the retained peak from the peak of this boot. Painted words
+ * cannot be repainted while in use, so the peak of this boot stays.
+ *
+ ****************************************************************************/
+PUBLIC void APP_vResetStackStats(void)
+{
+    sRetained.u32PeakUsed = u32PeakUsed;
+}
+
+/****************************************************************************/
+/***        Local Functions                                               ***/
+/****************************************************************************/
+
+/****************************************************************************/
+/***        END OF FILE                                                   ***/
+/****************************************************************************/
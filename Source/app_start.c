@@ -42,8 +42,10 @@
 #include "pdum_gen.h"
 
 /* Application */
+#include "app_log.h"
 #include "app_main.h"
 #include "app_router_node.h"
+#include "app_stack.h"
 #include "uart.h"
 
 /* SDK JN-SW-4170 */
@@ -60,12 +62,6 @@
 /***        Macro Definitions                                             ***/
 /****************************************************************************/
 
-#ifdef DEBUG_APP
-#define TRACE_APP TRUE
-#else
-#define TRACE_APP FALSE
-#endif
-
 /****************************************************************************/
 /***        Type Definitions                                              ***/
 /****************************************************************************/
@@ -110,6 +106,9 @@ PUBLIC void vAppMain(void)
     /* Move CPU to 32 MHz; vAHI_OptimiseWaitStates automatically called */
     bAHI_SetClockRate(3);
 
+    /* Initialise the log first so that everything after can record to it */
+    APP_vLogInit();
+
 #ifdef UART_DEBUGGING
     /* Initialise the debug diagnostics module to use UART1 at 115K Baud */
     DBG_vUartInit(DBG_E_UART_1, DBG_E_UART_BAUD_RATE_115200);
@@ -120,9 +119,12 @@ PUBLIC void vAppMain(void)
      * stack size. */
     vAHI_SetStackOverflow(TRUE, (uint32)&_stack_low_water_mark);
 
+    /* Fill the unused stack with a pattern so its peak use can be measured */
+    APP_vStackPaint();
+
     /* Catch resets due to watchdog timer expiry. Comment out to harden code. */
     if (bAHI_WatchdogResetEvent()) {
-        DBG_vPrintf(TRACE_APP, "APP: Watchdog timer has reset device!\n");
+        APP_LOG(E_LOG_APP_WATCHDOG_RESET);
         DBG_vDumpStack();
     }
 
@@ -139,21 +141,21 @@ PUBLIC void vAppMain(void)
 #endif
 
     /* idle task commences here */
-    DBG_vPrintf(TRACE_APP, "*** ROUTER RESET ***\n");
+    APP_LOG(E_LOG_APP_RESET);
 
-    DBG_vPrintf(TRACE_APP, "APP: Entering APP_vSetUpHardware()\n");
+    APP_LOG(E_LOG_APP_SET_UP_HARDWARE);
     APP_vSetUpHardware();
 
-    DBG_vPrintf(TRACE_APP, "APP: Entering APP_vInitResources()\n");
+    APP_LOG(E_LOG_APP_INIT_RESOURCES);
     APP_vInitResources();
 
-    DBG_vPrintf(TRACE_APP, "APP: Entering APP_vInitialise()\n");
+    APP_LOG(E_LOG_APP_INITIALISE);
     APP_vInitialise();
 
-    DBG_vPrintf(TRACE_APP, "APP: Entering BDB_vStart()\n");
+    APP_LOG(E_LOG_APP_BDB_START);
     BDB_vStart();
 
-    DBG_vPrintf(TRACE_APP, "APP: Entering APP_vMainLoop()\n");
+    APP_LOG(E_LOG_APP_MAIN_LOOP);
     APP_vMainLoop();
 }
 
@@ -216,7 +218,7 @@ PRIVATE void APP_vInitialise(void)
  ****************************************************************************/
 PRIVATE void vfExtendedStatusCallBack(ZPS_teExtendedStatus eExtendedStatus)
 {
-    DBG_vPrintf(TRACE_APP, "ERROR: Extended status 0x%02x\n", eExtendedStatus);
+    APP_LOG(E_LOG_APP_EXTENDED_STATUS, eExtendedStatus);
 }
 
 /****************************************************************************/
@@ -0,0 +1,492 @@
+/****************************************************************************
+ *
+ * MODULE:              Lumi Router
+ *
+ * COMPONENT:           APP_TIMER
+ *
+ * DESCRIPTION:         Timer wheel hosting the application timers on one ZTimer
+ *
+ ****************************************************************************
+ *
+ * This software is owned by NXP B.V. and/or its supplier and is protected
+ * under applicable copyright laws. All rights are reserved. We grant You,
+ * and any third parties, a license to use this software solely and
+ * exclusively on NXP products [NXP Microcontrollers such as JN5168, JN5179].
+ * You, and any third parties must reproduce the copyright and warranty notice
+ * and any other legend of ownership on each copy or partial copy of the
+ * software.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+ * AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+ * IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE
+ * ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE
+ * LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR
+ * CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF
+ * SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS
+ * INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN
+ * CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE)
+ * ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+ * POSSIBILITY OF SUCH DAMAGE.
+ *
+ * Copyright NXP B.V. 2016. All rights reserved
+ *
+ ****************************************************************************/
+
+/****************************************************************************/
+/***        Include Files                                                 ***/
+/****************************************************************************/
+
+#include <jendefs.h>
+
+/* Application */
+#include "app_clock.h"
+#include "app_timer.h"
+
+/* SDK JN-SW-4170 */
+#include "ZTimer.h"
+
+/****************************************************************************/
+/***        Macro Definitions                                             ***/
+/****************************************************************************/
+
+/* Three levels of 32 slots. A slot covers 1, 32 and 1024 ticks on each
+ * level, so the wheel reaches about 5 minutes ahead at a 10 ms tick.
+ * Later timers wait in the furthest top level slot and are placed again
+ * when it cascades. */
+#define TIMER_LEVELS    3
+#define TIMER_SLOT_BITS 5
+#define TIMER_SLOTS     (1 << TIMER_SLOT_BITS)
+#define TIMER_SLOT_MASK (TIMER_SLOTS - 1)
+
+#define TIMER_SHIFT(u8Level) ((u8Level)*TIMER_SLOT_BITS)
+#define TIMER_SLOT_BIT(u32Slot) ((uint32)1 << (u32Slot))
+
+#if TIMER_SLOTS > 32
+#error The occupied slots are kept in a 32-bit mask
+#endif
+
+/****************************************************************************/
+/***        Type Definitions                                              ***/
+/****************************************************************************/
+
+/****************************************************************************/
+/***        Local Function Prototypes                                     ***/
+/****************************************************************************/
+
+PRIVATE void APP_cbTimerWheel(void *pvParam);
+PRIVATE void APP_vTimerStartTicks(APP_tsTimer *psTimer, uint32 u32Msec, bool_t bPeriodic);
+PRIVATE void APP_vTimerCatchUp(void);
+PRIVATE void APP_vTimerTick(void);
+PRIVATE void APP_vTimerInsert(APP_tsTimer *psTimer);
+PRIVATE void APP_vTimerUnlink(APP_tsTimer *psTimer);
+PRIVATE APP_tsTimer *APP_psTimerTakeSlot(uint8 u8Level, uint32 u32Slot);
+PRIVATE void APP_vTimerArm(void);
+
+/****************************************************************************/
+/***        Exported Variables                                            ***/
+/****************************************************************************/
+
+/****************************************************************************/
+/***        Local Variables                                               ***/
+/****************************************************************************/
+
+PRIVATE APP_tsTimer *apsSlot[TIMER_LEVELS][TIMER_SLOTS];
+PRIVATE uint32 au32Occupied[TIMER_LEVELS];
+
+/* Last tick processed and the clock time it stands for */
+PRIVATE uint32 u32Now;
+PRIVATE uint32 u32NowMsec;
+
+PRIVATE uint32 u32Running;
+PRIVATE uint32 u32ArmedTick;
+PRIVATE bool_t bArmed;
+PRIVATE bool_t bAdvancing;
+PRIVATE uint8 u8TimerWheel;
+
+/****************************************************************************/
+/***        Exported Functions                                            ***/
+/****************************************************************************/
+
+/****************************************************************************
+ *
+ * NAME: APP_vTimerInit
+ *
+ * DESCRIPTION:
+ * Open the ZTimer that drives the wheel. Call after ZTIMER_eInit.
+ *
+ ****************************************************************************/
+PUBLIC void APP_vTimerInit(void)
+{
+    ZTIMER_eOpen(&u8TimerWheel, APP_cbTimerWheel, NULL, ZTIMER_FLAG_PREVENT_SLEEP);
+    u32NowMsec = APP_u32ClockMsec();
+}
+
+/****************************************************************************
+ *
+ * NAME: APP_vTimerCreate
+ *
+ * DESCRIPTION:
+ * Set up a stopped timer
+ *
+ * PARAMETERS:  Name            RW  Usage
+ *              psTimer         W   Timer, must stay valid while running
+ *              pfCallback      R   Called from the ZTimer task on expiry
+ *              pvParam         R   Passed to the callback
+ *
+ ****************************************************************************/
+PUBLIC void APP_vTimerCreate(APP_tsTimer *psTimer, APP_tpfTimerCallback pfCallback, void *pvParam)
+{
+    psTimer->psNext = NULL;
+    psTimer->ppsPrev = NULL;
+    psTimer->u32Expiry = 0;
+    psTimer->u32Period = 0;
+    psTimer->pfCallback = pfCallback;
+    psTimer->pvParam = pvParam;
+}
+
+/****************************************************************************
+ *
+ * NAME: APP_vTimerStart
+ *
+ * DESCRIPTION:
+ * Start, or restart, a timer that expires once after u32Msec
+ *
+ ****************************************************************************/
+PUBLIC void APP_vTimerStart(APP_tsTimer *psTimer, uint32 u32Msec)
+{
+    APP_vTimerStartTicks(psTimer, u32Msec, FALSE);
+}
+
+/****************************************************************************
+ *
+ * NAME: APP_vTimerStartPeriodic
+ *
+ * DESCRIPTION:
+ * Start, or restart, a timer that expires every u32Msec. Each expiry is
+ * counted from the previous one, so late callbacks do not add up to drift.
+ *
+ ****************************************************************************/
+PUBLIC void APP_vTimerStartPeriodic(APP_tsTimer *psTimer, uint32 u32Msec)
+{
+    APP_vTimerStartTicks(psTimer, u32Msec, TRUE);
+}
+
+/****************************************************************************
+ *
+ * NAME: APP_vTimerStop
+ *
+ * DESCRIPTION:
+ * Stop a timer. Stopping a stopped timer does nothing.
+ *
+ ****************************************************************************/
+PUBLIC void APP_vTimerStop(APP_tsTimer *psTimer)
+{
+    if (psTimer->ppsPrev == NULL) {
+        return;
+    }
+
+    APP_vTimerUnlink(psTimer);
+    u32Running--;
+
+    if ((u32Running == 0) && !bAdvancing) {
+        ZTIMER_eStop(u8TimerWheel);
+        bArmed = FALSE;
+    }
+}
+
+/****************************************************************************
+ *
+ * NAME: APP_bTimerIsRunning
+ *
+ * DESCRIPTION:
+ * Check whether a timer is waiting to expire
+ *
+ ****************************************************************************/
+PUBLIC bool_t APP_bTimerIsRunning(const APP_tsTimer *psTimer)
+{
+    return psTimer->ppsPrev != NULL;
+}
+
+/****************************************************************************/
+/***        Local Functions                                               ***/
+/****************************************************************************/
+
+/****************************************************************************
+ *
+ * NAME: APP_cbTimerWheel
+ *
+ * DESCRIPTION:
+ * ZTimer callback. Process every tick up to the current time, running the
+ * timers of each tick together, then arm the ZTimer for the next tick
+ * with work to do.
+ *
+ ****************************************************************************/
+PRIVATE void APP_cbTimerWheel(void *pvParam)
+{
+    bArmed = FALSE;
+    bAdvancing = TRUE;
+
+    while ((uint32)(APP_u32ClockMsec() - u32NowMsec) >= APP_TIMER_TICK_MSEC) {
+        if (u32Running == 0) {
+            APP_vTimerCatchUp();
+            break;
+        }
+        APP_vTimerTick();
+    }
+
+    bAdvancing = FALSE;
+    APP_vTimerArm();
+}
+
+/****************************************************************************
+ *
+ * NAME: APP_vTimerStartTicks
+ *
+ * DESCRIPTION:
+ * Put a timer on the wheel. The time is counted from now, not from the
+ * last tick processed, and rounded up to the next tick boundary, so the
+ * timer never expires early and is at most one tick late.
+ *
+ ****************************************************************************/
+PRIVATE void APP_vTimerStartTicks(APP_tsTimer *psTimer, uint32 u32Msec, bool_t bPeriodic)
+{
+    uint32 u32FirstTicks;
+    uint32 u32Elapsed;
+    uint32 u32Ticks;
+
+    if (psTimer->ppsPrev != NULL) {
+        APP_vTimerUnlink(psTimer);
+    }
+    else {
+        APP_vTimerCatchUp();
+        u32Running++;
+    }
+
+    u32Ticks = (u32Msec + APP_TIMER_TICK_MSEC - 1) / APP_TIMER_TICK_MSEC;
+    if (u32Ticks == 0) {
+        u32Ticks = 1;
+    }
+
+    /* Now may be part way into a tick, which the first expiry has to wait
+     * out as well */
+    u32Elapsed = APP_u32ClockMsec() - u32NowMsec;
+    u32FirstTicks = ((u32Elapsed % APP_TIMER_TICK_MSEC) + u32Msec + APP_TIMER_TICK_MSEC - 1) / APP_TIMER_TICK_MSEC;
+    if (u32FirstTicks == 0) {
+        u32FirstTicks = 1;
+    }
+
+    psTimer->u32Period = bPeriodic ? u32Ticks : 0;
+    psTimer->u32Expiry = u32Now + (u32Elapsed / APP_TIMER_TICK_MSEC) + u32FirstTicks;
+    APP_vTimerInsert(psTimer);
+
+    if (!bAdvancing && (!bArmed || ((int32)(psTimer->u32Expiry - u32ArmedTick) < 0))) {
+        APP_vTimerArm();
+    }
+}
+
+/****************************************************************************
+ *
+ * NAME: APP_vTimerCatchUp
+ *
+ * DESCRIPTION:
+ * Move an empty wheel to the current time in one step
+ *
+ ****************************************************************************/
+PRIVATE void APP_vTimerCatchUp(void)
+{
+    uint32 u32Ticks;
+
+    if (u32Running == 0) {
+        u32Ticks = (APP_u32ClockMsec() - u32NowMsec) / APP_TIMER_TICK_MSEC;
+        u32Now += u32Ticks;
+        u32NowMsec += u32Ticks * APP_TIMER_TICK_MSEC;
+    }
+}
+
+/****************************************************************************
+ *
+ * NAME: APP_vTimerTick
+ *
+ * DESCRIPTION:
+ * Process one tick. Where a higher level slot comes due, its timers move
+ * down to the level that fits their remaining time, then every timer in
+ * the bottom slot expires. Periodic timers go back on the wheel before
+ * their callback runs, so the callback may stop or restart them.
+ *
+ ****************************************************************************/
+PRIVATE void APP_vTimerTick(void)
+{
+    APP_tsTimer *psList;
+    APP_tsTimer *psTimer;
+    uint8 u8Level;
+
+    u32Now++;
+    u32NowMsec += APP_TIMER_TICK_MSEC;
+
+    for (u8Level = TIMER_LEVELS - 1; u8Level > 0; u8Level--) {
+        if ((u32Now & (((uint32)1 << TIMER_SHIFT(u8Level)) - 1)) == 0) {
+            psList = APP_psTimerTakeSlot(u8Level, (u32Now >> TIMER_SHIFT(u8Level)) & TIMER_SLOT_MASK);
+            if (psList != NULL) {
+                psList->ppsPrev = &psList;
+            }
+            while ((psTimer = psList) != NULL) {
+                APP_vTimerUnlink(psTimer);
+                APP_vTimerInsert(psTimer);
+            }
+        }
+    }
+
+    psList = APP_psTimerTakeSlot(0, u32Now & TIMER_SLOT_MASK);
+    if (psList != NULL) {
+        psList->ppsPrev = &psList;
+    }
+    /* A callback may stop timers still on this list, which unlinks them */
+    while ((psTimer = psList) != NULL) {
+        APP_vTimerUnlink(psTimer);
+        if (psTimer->u32Period != 0) {
+            psTimer->u32Expiry += psTimer->u32Period;
+            APP_vTimerInsert(psTimer);
+        }
+        else {
+            u32Running--;
+        }
+        psTimer->pfCallback(psTimer->pvParam);
+    }
+}
+
+/****************************************************************************
+ *
+ * NAME: APP_vTimerInsert
+ *
+ * DESCRIPTION:
+ * Link a timer into the lowest level whose slots reach its expiry
+ *
+ ****************************************************************************/
+PRIVATE void APP_vTimerInsert(APP_tsTimer *psTimer)
+{
+    APP_tsTimer **ppsHead;
+    uint32 u32Slot;
+    uint8 u8Level;
+
+    for (u8Level = 0; u8Level < TIMER_LEVELS; u8Level++) {
+        if (((psTimer->u32Expiry >> TIMER_SHIFT(u8Level)) - (u32Now >> TIMER_SHIFT(u8Level))) < TIMER_SLOTS) {
+            break;
+        }
+    }
+
+    if (u8Level < TIMER_LEVELS) {
+        u32Slot = (psTimer->u32Expiry >> TIMER_SHIFT(u8Level)) & TIMER_SLOT_MASK;
+    }
+    else {
+        u8Level = TIMER_LEVELS - 1;
+        u32Slot = ((u32Now >> TIMER_SHIFT(u8Level)) + TIMER_SLOTS - 1) & TIMER_SLOT_MASK;
+    }
+
+    ppsHead = &apsSlot[u8Level][u32Slot];
+    psTimer->psNext = *ppsHead;
+    if (psTimer->psNext != NULL) {
+        psTimer->psNext->ppsPrev = &psTimer->psNext;
+    }
+    psTimer->ppsPrev = ppsHead;
+    *ppsHead = psTimer;
+    au32Occupied[u8Level] |= TIMER_SLOT_BIT(u32Slot);
+}
+
+/****************************************************************************
+ *
+ * NAME: APP_vTimerUnlink
+ *
+ * DESCRIPTION:
+ * Take a timer off whichever list holds it, clearing the occupied bit of
+ * a wheel slot left empty
+ *
+ ****************************************************************************/
+PRIVATE void APP_vTimerUnlink(APP_tsTimer *psTimer)
+{
+    APP_tsTimer **ppsPrev = psTimer->ppsPrev;
+    uint32 u32Index;
+
+    *ppsPrev = psTimer->psNext;
+    if (psTimer->psNext != NULL) {
+        psTimer->psNext->ppsPrev = ppsPrev;
+    }
+    else if ((ppsPrev >= &apsSlot[0][0]) && (ppsPrev < &apsSlot[0][0] + (TIMER_LEVELS * TIMER_SLOTS))) {
+        if (*ppsPrev == NULL) {
+            u32Index = ppsPrev - &apsSlot[0][0];
+            au32Occupied[u32Index / TIMER_SLOTS] &= ~TIMER_SLOT_BIT(u32Index % TIMER_SLOTS);
+        }
+    }
+
+    psTimer->psNext = NULL;
+    psTimer->ppsPrev = NULL;
+}
+
+/****************************************************************************
+ *
+ * NAME: APP_psTimerTakeSlot
+ *
+ * DESCRIPTION:
+ * Detach the whole list of a slot
+ *
+ ****************************************************************************/
+PRIVATE APP_tsTimer *APP_psTimerTakeSlot(uint8 u8Level, uint32 u32Slot)
+{
+    APP_tsTimer *psList = apsSlot[u8Level][u32Slot];
+
+    apsSlot[u8Level][u32Slot] = NULL;
+    au32Occupied[u8Level] &= ~TIMER_SLOT_BIT(u32Slot);
+
+    return psList;
+}
+
+/****************************************************************************
+ *
+ * NAME: APP_vTimerArm
+ *
+ * DESCRIPTION:
+ * Start the ZTimer for the next occupied bottom slot, or for the next
+ * cascade while higher levels hold timers, whichever comes first
+ *
+ ****************************************************************************/
+PRIVATE void APP_vTimerArm(void)
+{
+    uint32 u32Ticks = 0;
+    uint32 u32Pending;
+    uint32 u32Shift;
+    int32 i32Delay;
+    uint8 u8Level;
+
+    ZTIMER_eStop(u8TimerWheel);
+    bArmed = FALSE;
+
+    if (u32Running == 0) {
+        return;
+    }
+
+    for (u8Level = 1; u8Level < TIMER_LEVELS; u8Level++) {
+        if (au32Occupied[u8Level] != 0) {
+            u32Ticks = TIMER_SLOTS - (u32Now & TIMER_SLOT_MASK);
+            break;
+        }
+    }
+
+    /* Rotate so that bit 0 is the slot of the next tick */
+    u32Shift = (u32Now + 1) & TIMER_SLOT_MASK;
+    u32Pending = (au32Occupied[0] >> u32Shift) | (au32Occupied[0] << ((TIMER_SLOTS - u32Shift) & TIMER_SLOT_MASK));
+    if ((u32Pending != 0) && ((u32Ticks == 0) || ((uint32)__builtin_ctz(u32Pending) + 1 < u32Ticks))) {
+        u32Ticks = (uint32)__builtin_ctz(u32Pending) + 1;
+    }
+
+    i32Delay = (int32)(u32NowMsec + (u32Ticks * APP_TIMER_TICK_MSEC) - APP_u32ClockMsec());
+    if (i32Delay < 1) {
+        i32Delay = 1;
+    }
+
+    ZTIMER_eStart(u8TimerWheel, ZTIMER_TIME_MSEC(i32Delay));
+    u32ArmedTick = u32Now + u32Ticks;
+    bArmed = TRUE;
+}
+
+/****************************************************************************/
+/***        END OF FILE                                                   ***/
+/****************************************************************************/
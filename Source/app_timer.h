@@ -0,0 +1,90 @@
+/****************************************************************************
+ *
+ * MODULE:              Lumi Router
+ *
+ * COMPONENT:           APP_TIMER
+ *
+ * DESCRIPTION:         Timer wheel hosting the application timers on one ZTimer
+ *
+ ****************************************************************************
+ *
+ * This software is owned by NXP B.V. and/or its supplier and is protected
+ * under applicable copyright laws. All rights are reserved. We grant You,
+ * and any third parties, a license to use this software solely and
+ * exclusively on NXP products [NXP Microcontrollers such as JN5168, JN5179].
+ * You, and any third parties must reproduce the copyright and warranty notice
+ * and any other legend of ownership on each copy or partial copy of the
+ * software.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+ * AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+ * IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE
+ * ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE
+ * LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR
+ * CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF
+ * SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS
+ * INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN
+ * CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE)
+ * ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+ * POSSIBILITY OF SUCH DAMAGE.
+ *
+ * Copyright NXP B.V. 2016. All rights reserved
+ *
+ ****************************************************************************/
+
+#ifndef APP_TIMER_H
+#define APP_TIMER_H
+
+/****************************************************************************/
+/***        Include Files                                                 ***/
+/****************************************************************************/
+
+#include <jendefs.h>
+
+/****************************************************************************/
+/***        Macro Definitions                                             ***/
+/****************************************************************************/
+
+/* Resolution of the wheel. Times are rounded up to whole ticks. */
+#define APP_TIMER_TICK_MSEC 10
+
+#define APP_TIMER_TIME_MSEC(x) ((uint32)(x))
+#define APP_TIMER_TIME_SEC(x)  ((uint32)(x)*1000)
+
+/****************************************************************************/
+/***        Type Definitions                                              ***/
+/****************************************************************************/
+
+typedef void (*APP_tpfTimerCallback)(void *pvParam);
+
+/* Owned by the caller and linked into the wheel while running. The fields
+ * are private to app_timer.c. */
+typedef struct APP_tsTimer {
+    struct APP_tsTimer *psNext;
+    struct APP_tsTimer **ppsPrev;
+    uint32 u32Expiry;
+    uint32 u32Period;
+    APP_tpfTimerCallback pfCallback;
+    void *pvParam;
+} APP_tsTimer;
+
+/****************************************************************************/
+/***        Exported Variables                                            ***/
+/****************************************************************************/
+
+/****************************************************************************/
+/***        Exported Functions                                            ***/
+/****************************************************************************/
+
+PUBLIC void APP_vTimerInit(void);
+PUBLIC void APP_vTimerCreate(APP_tsTimer *psTimer, APP_tpfTimerCallback pfCallback, void *pvParam);
+PUBLIC void APP_vTimerStart(APP_tsTimer *psTimer, uint32 u32Msec);
+PUBLIC void APP_vTimerStartPeriodic(APP_tsTimer *psTimer, uint32 u32Msec);
+PUBLIC void APP_vTimerStop(APP_tsTimer *psTimer);
+PUBLIC bool_t APP_bTimerIsRunning(const APP_tsTimer *psTimer);
+
+/****************************************************************************/
+/***        END OF FILE                                                   ***/
+/****************************************************************************/
+
+#endif /* APP_TIMER_H */
@@ -44,29 +44,39 @@
 #include "zps_gen.h"
 
 /* Application */
+#include "app_clock.h"
+#include "app_log.h"
 #include "app_main.h"
 #include "app_reporting.h"
+#include "app_timer.h"
 #include "app_zcl_task.h"
 #include "zcl_options.h"
 
 /* SDK JN-SW-4170 */
 #include "Basic.h"
 #include "DeviceTemperatureConfiguration.h"
-#include "ZTimer.h"
-#include "dbg.h"
 #include "zcl.h"
 
 /****************************************************************************/
 /***        Macro Definitions                                             ***/
 /****************************************************************************/
 
-#ifdef DEBUG_ZCL
-#define TRACE_ZCL TRUE
-#else
-#define TRACE_ZCL FALSE
-#endif
+/* ZCL counts time in timer events, one per second */
+#define ZCL_TICK_TIME APP_TIMER_TIME_SEC(1)
 
-#define ZCL_TICK_TIME ZTIMER_TIME_SEC(1)
+/* After ZCL activity, tick every second for this long so that queued
+ * reports go out and ZCL transactions time out on time. The ZCL library
+ * does not say whether it has a transaction open, so one is assumed open
+ * for this long after a frame arrives, a reportable change is made or a
+ * held report becomes due. */
+#define ZCL_TICK_ACTIVE_SECONDS 5
+
+/* While idle, a periodic report goes out at most this fraction of its
+ * maximum interval late */
+#define ZCL_TICK_IDLE_FRACTION 10
+
+/* Longest time the ZCL is left without ticks */
+#define ZCL_TICK_IDLE_SECONDS 60
 
 /****************************************************************************/
 /***        Type Definitions                                              ***/
@@ -77,6 +87,8 @@
 /****************************************************************************/
 
 PRIVATE void APP_ZCL_vTick(void);
+PRIVATE void APP_ZCL_vCatchUp(void);
+PRIVATE void APP_ZCL_vScheduleTick(void);
 PRIVATE void APP_ZCL_cbGeneralCallback(tsZCL_CallBackEvent *psEvent);
 PRIVATE void APP_ZCL_cbEndpointCallback(tsZCL_CallBackEvent *psEvent);
 PRIVATE void APP_ZCL_vHandleClusterCustomCommands(tsZCL_CallBackEvent *psEvent);
@@ -93,6 +105,14 @@ PUBLIC APP_tsLumiRouter sLumiRouter;
 /***        Local Variables                                               ***/
 /****************************************************************************/
 
+/* Clock time up to which timer events have been passed to ZCL */
+PRIVATE uint32 u32ZclTickMsec;
+
+PRIVATE uint8 u8ActiveSeconds;
+
+/* Seconds until a report held back by its minimum interval may go out */
+PRIVATE uint16 u16HeldSeconds;
+
 /****************************************************************************/
 /***        Exported Functions                                            ***/
 /****************************************************************************/
@@ -112,16 +132,18 @@ PUBLIC void APP_ZCL_vInitialise(void)
     /* Initialise ZLL */
     eZCL_Status = eZCL_Initialise(&APP_ZCL_cbGeneralCallback, apduZCL);
     if (eZCL_Status != E_ZCL_SUCCESS) {
-        DBG_vPrintf(TRACE_ZCL, "Err: eZLO_Initialise:%d\n", eZCL_Status);
+        APP_LOG(E_LOG_ZCL_INIT_FAILED, eZCL_Status);
     }
 
     /* Start the tick timer */
-    ZTIMER_eStart(u8TimerTick, ZCL_TICK_TIME);
+    u32ZclTickMsec = APP_u32ClockMsec();
+    u8ActiveSeconds = ZCL_TICK_ACTIVE_SECONDS;
+    APP_ZCL_vScheduleTick();
 
     /* Register Light EndPoint */
     eZCL_Status = APP_ZCL_eRegisterEndPoint(&APP_ZCL_cbEndpointCallback, &sLumiRouter);
     if (eZCL_Status != E_ZCL_SUCCESS) {
-        DBG_vPrintf(TRACE_ZCL, "Error: APP_ZCL_eRegisterEndPoint: %02x\n", eZCL_Status);
+        APP_LOG(E_LOG_ZCL_REGISTER_FAILED, eZCL_Status);
     }
 
     APP_ZCL_vDeviceSpecific_Init();
@@ -140,27 +162,55 @@ PUBLIC void APP_ZCL_vEventHandler(ZPS_tsAfEvent *psStackEvent)
     tsZCL_CallBackEvent sCallBackEvent;
     sCallBackEvent.pZPSevent = psStackEvent;
 
-    DBG_vPrintf(TRACE_ZCL, "ZCL_Task endpoint event:%d \n", psStackEvent->eType);
+    /* Bring ZCL time up to date before it handles the frame, which may
+     * start a transaction or change the report configuration */
+    APP_ZCL_vRequestTick();
+
+    APP_LOG(E_LOG_ZCL_STACK_EVENT, psStackEvent->eType);
     sCallBackEvent.eEventType = E_ZCL_CBET_ZIGBEE_EVENT;
     vZCL_EventHandler(&sCallBackEvent);
 }
 
+/****************************************************************************
+ *
+ * NAME: APP_ZCL_vRequestTick
+ *
+ * DESCRIPTION:
+ * Pass the seconds elapsed so far to ZCL now and tick every second for a
+ * while. Call when an attribute changes by at least its reportable change
+ * or ZCL gets work.
+ *
+ ****************************************************************************/
+PUBLIC void APP_ZCL_vRequestTick(void)
+{
+    uint16 u16MinInterval;
+    uint16 u16MaxInterval;
+
+    APP_ZCL_vCatchUp();
+
+    /* A change report may be held back for up to the minimum interval */
+    APP_vGetReportIntervals(&u16MinInterval, &u16MaxInterval);
+    if (u16MinInterval > u16HeldSeconds) {
+        u16HeldSeconds = u16MinInterval;
+    }
+
+    u8ActiveSeconds = ZCL_TICK_ACTIVE_SECONDS;
+    APP_ZCL_vScheduleTick();
+}
+
 /****************************************************************************
  *
  * NAME: APP_cbTimerZclTick
  *
  * DESCRIPTION:
- * CallBack For ZCL Tick timer
+ * CallBack For ZCL Tick timer. Runs at the next deadline rather than
+ * every second.
  *
  ****************************************************************************/
 PUBLIC void APP_cbTimerZclTick(void *pvParam)
 {
-    /*
-     * If the 1 second tick timer has expired, restart it and pass
-     * the event on to ZCL
-     */
-    APP_ZCL_vTick();
-    ZTIMER_eStart(u8TimerTick, ZCL_TICK_TIME);
+    APP_ZCL_vCatchUp();
+    APP_ZCL_vScheduleTick();
 }
 
 /****************************************************************************/
@@ -186,59 +236,77 @@ PRIVATE void APP_ZCL_vTick(void)
 
 /****************************************************************************
  *
- * NAME: APP_ZCL_cbGeneralCallback
+ * NAME: APP_ZCL_vCatchUp
  *
  * DESCRIPTION:
- * General callback for ZCL events
+ * Pass one timer event to ZCL for every whole second since the last one.
+ * ZCL counts report intervals in timer events, so seconds slept through
+ * are handed over late rather than dropped.
  *
  ****************************************************************************/
-PRIVATE void APP_ZCL_cbGeneralCallback(tsZCL_CallBackEvent *psEvent)
+PRIVATE void APP_ZCL_vCatchUp(void)
 {
-    switch (psEvent->eEventType) {
-    case E_ZCL_CBET_LOCK_MUTEX:
-        DBG_vPrintf(TRACE_ZCL, "EVT: Lock Mutex\n");
-        break;
+    while ((uint32)(APP_u32ClockMsec() - u32ZclTickMsec) >= ZCL_TICK_TIME) {
+        u32ZclTickMsec += ZCL_TICK_TIME;
+        APP_ZCL_vTick();
 
-    case E_ZCL_CBET_UNLOCK_MUTEX:
-        DBG_vPrintf(TRACE_ZCL, "EVT: Unlock Mutex\n");
-        break;
-
-    case E_ZCL_CBET_UNHANDLED_EVENT:
-        DBG_vPrintf(TRACE_ZCL, "EVT: Unhandled Event\n");
-        break;
-
-    case E_ZCL_CBET_READ_ATTRIBUTES_RESPONSE:
-        DBG_vPrintf(TRACE_ZCL, "EVT: Read attributes response\n");
-        break;
-
-    case E_ZCL_CBET_READ_REQUEST:
-        DBG_vPrintf(TRACE_ZCL, "EVT: Read request\n");
-        break;
-
-    case E_ZCL_CBET_DEFAULT_RESPONSE:
-        DBG_vPrintf(TRACE_ZCL, "EVT: Default response\n");
-        break;
-
-    case E_ZCL_CBET_ERROR:
-        DBG_vPrintf(TRACE_ZCL, "EVT: Error\n");
-        break;
+        if (u8ActiveSeconds != 0) {
+            u8ActiveSeconds--;
+        }
+        if ((u16HeldSeconds != 0) && (--u16HeldSeconds == 0)) {
+            /* A held report may go out now */
+            u8ActiveSeconds = ZCL_TICK_ACTIVE_SECONDS;
+        }
+    }
+}
 
-    case E_ZCL_CBET_TIMER:
-        DBG_vPrintf(TRACE_ZCL, "EVT: Timer\n");
-        break;
+/****************************************************************************
+ *
+ * NAME: APP_ZCL_vScheduleTick
+ *
+ * DESCRIPTION:
+ * Start the tick timer for the next second ZCL has to act on: every
+ * second while active, otherwise the end of a held report's minimum
+ * interval or a fraction of the shortest maximum interval
+ *
+ ****************************************************************************/
+PRIVATE void APP_ZCL_vScheduleTick(void)
+{
+    uint16 u16MinInterval;
+    uint16 u16MaxInterval;
+    uint32 u32Seconds = ZCL_TICK_IDLE_SECONDS;
 
-    case E_ZCL_CBET_ZIGBEE_EVENT:
-        DBG_vPrintf(TRACE_ZCL, "EVT: ZigBee\n");
-        break;
+    if (u8ActiveSeconds != 0) {
+        u32Seconds = 1;
+    }
+    else {
+        APP_vGetReportIntervals(&u16MinInterval, &u16MaxInterval);
+        if ((u16MaxInterval != 0) && ((u16MaxInterval / ZCL_TICK_IDLE_FRACTION) < u32Seconds)) {
+            u32Seconds = u16MaxInterval / ZCL_TICK_IDLE_FRACTION;
+        }
+        if ((u16HeldSeconds != 0) && (u16HeldSeconds < u32Seconds)) {
+            u32Seconds = u16HeldSeconds;
+        }
+        if (u32Seconds == 0) {
+            u32Seconds = 1;
+        }
+    }
 
-    case E_ZCL_CBET_CLUSTER_CUSTOM:
-        DBG_vPrintf(TRACE_ZCL, "EP EVT: Custom\n");
-        break;
+    /* Counted from the last event passed, so the seconds do not drift */
+    APP_vTimerStart(&sTimerTick, u32ZclTickMsec + (u32Seconds * ZCL_TICK_TIME) - APP_u32ClockMsec());
+}
 
-    default:
-        DBG_vPrintf(TRACE_ZCL, "Invalid event type\n");
-        break;
-    }
+/****************************************************************************
+ *
+ * NAME: APP_ZCL_cbGeneralCallback
+ *
+ * DESCRIPTION:
+ * General callback for ZCL events
+ *
+ ****************************************************************************/
+PRIVATE void APP_ZCL_cbGeneralCallback(tsZCL_CallBackEvent *psEvent)
+{
+    APP_LOG(E_LOG_ZCL_GENERAL_EVENT, psEvent->eEventType);
 }
 
 /****************************************************************************
@@ -251,83 +319,43 @@ PRIVATE void APP_ZCL_cbGeneralCallback(tsZCL_CallBackEvent *psEvent)
  ****************************************************************************/
 PRIVATE void APP_ZCL_cbEndpointCallback(tsZCL_CallBackEvent *psEvent)
 {
+    APP_LOG(E_LOG_ZCL_ENDPOINT_EVENT, psEvent->eEventType, psEvent->eZCL_Status);
 
     switch (psEvent->eEventType) {
-    case E_ZCL_CBET_LOCK_MUTEX:
-        break;
-
-    case E_ZCL_CBET_UNLOCK_MUTEX:
-        break;
-
-    case E_ZCL_CBET_UNHANDLED_EVENT:
-        DBG_vPrintf(TRACE_ZCL, "EP EVT: Unhandled event\n");
-        break;
-
     case E_ZCL_CBET_READ_INDIVIDUAL_ATTRIBUTE_RESPONSE:
-        DBG_vPrintf(TRACE_ZCL,
-                    "EP EVT: Rd Attr Rsp %04x AS %d\n",
-                    psEvent->uMessage.sIndividualAttributeResponse.u16AttributeEnum,
-                    psEvent->uMessage.sIndividualAttributeResponse.eAttributeStatus);
-        break;
-
-    case E_ZCL_CBET_READ_ATTRIBUTES_RESPONSE:
-        DBG_vPrintf(TRACE_ZCL, "EP EVT: Read attributes response\n");
+        APP_LOG(E_LOG_ZCL_READ_ATTRIBUTE_RESPONSE,
+                psEvent->uMessage.sIndividualAttributeResponse.u16AttributeEnum,
+                psEvent->uMessage.sIndividualAttributeResponse.eAttributeStatus);
         break;
 
     case E_ZCL_CBET_READ_REQUEST:
-        DBG_vPrintf(TRACE_ZCL, "EP EVT: Read request\n");
-        break;
-
-    case E_ZCL_CBET_DEFAULT_RESPONSE:
-        DBG_vPrintf(TRACE_ZCL, "EP EVT: Default response\n");
-        break;
-
-    case E_ZCL_CBET_ERROR:
-        DBG_vPrintf(TRACE_ZCL, "EP EVT: Error\n");
-        break;
-
-    case E_ZCL_CBET_TIMER:
-        DBG_vPrintf(TRACE_ZCL, "EP EVT: Timer\n");
-        break;
-
-    case E_ZCL_CBET_ZIGBEE_EVENT:
-        DBG_vPrintf(TRACE_ZCL, "EP EVT: ZigBee\n");
+        /* The CPU usage attributes are only brought up to date when read */
+        if ((psEvent->psClusterInstance != NULL) &&
+            (psEvent->psClusterInstance->psClusterDefinition->u16ClusterEnum == APP_CLUSTER_ID_CPU_USAGE)) {
+            APP_vCpuUsageUpdateAttributes(&sLumiRouter.sCpuUsageServerCluster);
+        }
         break;
 
     case E_ZCL_CBET_CLUSTER_CUSTOM:
-        DBG_vPrintf(TRACE_ZCL, "EP EVT: Custom Cl %04x\n", psEvent->uMessage.sClusterCustomMessage.u16ClusterId);
+        APP_LOG(E_LOG_ZCL_CUSTOM, psEvent->uMessage.sClusterCustomMessage.u16ClusterId);
         APP_ZCL_vHandleClusterCustomCommands(psEvent);
         break;
 
-    case E_ZCL_CBET_WRITE_INDIVIDUAL_ATTRIBUTE:
-        DBG_vPrintf(TRACE_ZCL, "EP EVT: Write Individual Attribute Status %02x\n", psEvent->eZCL_Status);
+    case E_ZCL_CBET_REPORT_INDIVIDUAL_ATTRIBUTE:
+        APP_LOG(E_LOG_ZCL_REPORT_ATTRIBUTE,
+                psEvent->psClusterInstance->psClusterDefinition->u16ClusterEnum,
+                psEvent->uMessage.sIndividualAttributeResponse.u16AttributeEnum,
+                psEvent->uMessage.sIndividualAttributeResponse.eAttributeDataType,
+                psEvent->uMessage.sIndividualAttributeResponse.eAttributeStatus);
         break;
 
-    case E_ZCL_CBET_REPORT_INDIVIDUAL_ATTRIBUTE: {
-        tsZCL_IndividualAttributesResponse *psIndividualAttributeResponse =
-            &psEvent->uMessage.sIndividualAttributeResponse;
-        DBG_vPrintf(TRACE_ZCL,
-                    "Individual Report attribute for Cluster = %d\n",
-                    psEvent->psClusterInstance->psClusterDefinition->u16ClusterEnum);
-        DBG_vPrintf(TRACE_ZCL, "eAttributeDataType = %d\n", psIndividualAttributeResponse->eAttributeDataType);
-        DBG_vPrintf(TRACE_ZCL, "u16AttributeEnum = %d\n", psIndividualAttributeResponse->u16AttributeEnum);
-        DBG_vPrintf(TRACE_ZCL, "eAttributeStatus = %d\n", psIndividualAttributeResponse->eAttributeStatus);
-    } break;
-
     case E_ZCL_CBET_REPORT_INDIVIDUAL_ATTRIBUTES_CONFIGURE: {
         tsZCL_AttributeReportingConfigurationRecord *psAttributeReportingRecord =
             &psEvent->uMessage.sAttributeReportingConfigurationRecord;
-        DBG_vPrintf(
-            TRACE_ZCL,
-            "Individual Configure Report Cluster %d Attrib %d Type %d Min %d Max %d IntV %d Direcct %d Change %d\n",
-            psEvent->psClusterInstance->psClusterDefinition->u16ClusterEnum,
-            psAttributeReportingRecord->u16AttributeEnum,
-            psAttributeReportingRecord->eAttributeDataType,
-            psAttributeReportingRecord->u16MinimumReportingInterval,
-            psAttributeReportingRecord->u16MaximumReportingInterval,
-            psAttributeReportingRecord->u16TimeoutPeriodField,
-            psAttributeReportingRecord->u8DirectionIsReceived,
-            psAttributeReportingRecord->uAttributeReportableChange);
+        APP_LOG(E_LOG_ZCL_CONFIGURE_REPORT,
+                psEvent->psClusterInstance->psClusterDefinition->u16ClusterEnum,
+                psAttributeReportingRecord->u16AttributeEnum,
+                psEvent->eZCL_Status);
 
         if (E_ZCL_SUCCESS == psEvent->eZCL_Status) {
             APP_vSaveReportableRecord(psEvent->psClusterInstance->psClusterDefinition->u16ClusterEnum,
@@ -341,14 +369,10 @@ PRIVATE void APP_ZCL_cbEndpointCallback(tsZCL_CallBackEvent *psEvent)
     } break;
 
     case E_ZCL_CBET_CLUSTER_UPDATE:
-        DBG_vPrintf(TRACE_ZCL, "Update Id %04x\n", psEvent->psClusterInstance->psClusterDefinition->u16ClusterEnum);
-        break;
-
-    case E_ZCL_CBET_REPORT_REQUEST:
+        APP_LOG(E_LOG_ZCL_CLUSTER_UPDATE, psEvent->psClusterInstance->psClusterDefinition->u16ClusterEnum);
         break;
 
     default:
-        DBG_vPrintf(TRACE_ZCL, "EP EVT: Invalid evt type 0x%x\n", (uint8)psEvent->eEventType);
         break;
     }
 }
@@ -367,7 +391,7 @@ PRIVATE void APP_ZCL_vHandleClusterCustomCommands(tsZCL_CallBackEvent *psEvent)
         tsCLD_BasicCallBackMessage *psCallBackMessage =
             (tsCLD_BasicCallBackMessage *)psEvent->uMessage.sClusterCustomMessage.pvCustomData;
         if (psCallBackMessage->u8CommandId == E_CLD_BASIC_CMD_RESET_TO_FACTORY_DEFAULTS) {
-            DBG_vPrintf(TRACE_ZCL, "Basic Factory Reset Received\n");
+            APP_LOG(E_LOG_ZCL_FACTORY_RESET);
             memset(&sLumiRouter, 0, sizeof(APP_tsLumiRouter));
             APP_ZCL_eRegisterEndPoint(&APP_ZCL_cbEndpointCallback, &sLumiRouter);
             APP_ZCL_vDeviceSpecific_Init();
@@ -421,6 +445,14 @@ PRIVATE teZCL_Status APP_ZCL_eRegisterEndPoint(tfpZCL_ZCLCallBackFunction cbCall
         return E_ZCL_FAIL;
     }
 
+    if (APP_eCpuUsageCreateCluster(&psDeviceInfo->sClusterInstance.sCpuUsageServer,
+                                   TRUE,
+                                   &APP_sCLD_CpuUsage,
+                                   &psDeviceInfo->sCpuUsageServerCluster,
+                                   &au8CpuUsageClusterAttributeControlBits[0]) != E_ZCL_SUCCESS) {
+        return E_ZCL_FAIL;
+    }
+
     return eZCL_Register(&psDeviceInfo->sEndPoint);
 }
 
@@ -55,6 +55,9 @@
 
 #include <jendefs.h>
 
+/* Application */
+#include "app_cpu.h"
+
 /* SDK JN-SW-4170 */
 #include "Basic.h"
 #include "DeviceTemperatureConfiguration.h"
@@ -71,6 +74,7 @@
 typedef struct {
     tsZCL_ClusterInstance sBasicServer;
     tsZCL_ClusterInstance sDeviceTemperatureConfigurationServer;
+    tsZCL_ClusterInstance sCpuUsageServer;
 
 } APP_tsLumiRouterClusterInstances __attribute__((aligned(4)));
 
@@ -86,6 +90,9 @@ typedef struct {
     /* Device Temperature Configuration Cluster - Server */
     tsCLD_DeviceTemperatureConfiguration sDeviceTemperatureConfigurationServerCluster;
 
+    /* CPU Usage Cluster - Server, manufacturer specific */
+    APP_tsCLD_CpuUsage sCpuUsageServerCluster;
+
 } APP_tsLumiRouter;
 
 /****************************************************************************/
@@ -100,6 +107,7 @@ extern PUBLIC APP_tsLumiRouter sLumiRouter;
 
 PUBLIC void APP_ZCL_vInitialise(void);
 PUBLIC void APP_ZCL_vEventHandler(ZPS_tsAfEvent *psStackEvent);
+PUBLIC void APP_ZCL_vRequestTick(void);
 PUBLIC void APP_cbTimerZclTick(void *pvParam);
 
 /****************************************************************************/
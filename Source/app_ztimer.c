@@ -0,0 +1,263 @@
+/****************************************************************************
+ *
+ * MODULE:              Lumi Router
+ *
+ * COMPONENT:           app_ztimer.c
+ *
+ * DESCRIPTION:         ZTimer wakeups
+ *
+ ****************************************************************************
+ *
+ * This software is owned by NXP B.V. and/or its supplier and is protected
+ * under applicable copyright laws. All rights are reserved. We grant You,
+ * and any third parties, a license to use this software solely and
+ * exclusively on NXP products [NXP Microcontrollers such as JN5168, JN5179].
+ * You, and any third parties must reproduce the copyright and warranty notice
+ * and any other legend of ownership on each copy or partial copy of the
+ * software.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+ * AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+ * IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE
+ * ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE
+ * LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR
+ * CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF
+ * SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS
+ * INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN
+ * CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE)
+ * ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+ * POSSIBILITY OF SUCH DAMAGE.
+ *
+ * Copyright NXP B.V. 2016. All rights reserved
+ *
+ ****************************************************************************/
+
+/****************************************************************************/
+/***        Include Files                                                 ***/
+/****************************************************************************/
+
+#include <jendefs.h>
+
+/* Application */
+#include "app_clock.h"
+#include "app_scheduler.h"
+#include "app_ztimer.h"
+
+/* SDK JN-SW-4170 */
+#include "ZTimer.h"
+#include "portmacro.h"
+
+/****************************************************************************/
+/***        Macro Definitions                                             ***/
+/****************************************************************************/
+
+#if APP_ZTIMER_MAX_TIMERS > 32
+#error The running ZTimers are kept in a 32-bit mask
+#endif
+
+#define ZTIMER_BIT(u8Index) ((uint32)1 << (u8Index))
+
+/****************************************************************************/
+/***        Type Definitions                                              ***/
+/****************************************************************************/
+
+/****************************************************************************/
+/***        Local Function Prototypes                                     ***/
+/****************************************************************************/
+
+PRIVATE void APP_vZTimerArm(void);
+
+/****************************************************************************/
+/***        Exported Variables                                            ***/
+/****************************************************************************/
+
+/****************************************************************************/
+/***        Local Variables                                               ***/
+/****************************************************************************/
+
+PRIVATE uint8 u8NumTimers;
+
+/* Clock time each running timer is due, for the timers in u32Running */
+PRIVATE uint32 au32DueMsec[APP_ZTIMER_MAX_TIMERS];
+PRIVATE uint32 u32Running;
+
+/* Clock time of the last ZTIMER_vTask run, up to which it has taken the
+ * ticks off every running timer */
+PRIVATE uint32 u32LastRunMsec;
+
+/* Earliest due time, checked by the tick interrupt */
+PRIVATE volatile uint32 u32NextDueMsec;
+PRIVATE volatile bool_t bNextDue;
+
+/****************************************************************************/
+/***        Exported Functions                                            ***/
+/****************************************************************************/
+
+/* The linker is given --wrap=ZTIMER_eStart and --wrap=ZTIMER_eStop, so
+ * every start and stop, including those made inside BDB, comes through
+ * the wrappers below */
+extern ZTIMER_teStatus __real_ZTIMER_eStart(uint8 u8Index, uint32 u32Time);
+extern ZTIMER_teStatus __real_ZTIMER_eStop(uint8 u8Index);
+
+/****************************************************************************
+ *
+ * NAME: APP_vZTimerInit
+ *
+ * DESCRIPTION:
+ * Initialise the ZTimer module and start tracking its timers
+ *
+ ****************************************************************************/
+PUBLIC void APP_vZTimerInit(ZTIMER_tsTimer *pasTimers, uint8 u8Count)
+{
+    ZTIMER_eInit(pasTimers, u8Count);
+
+    u8NumTimers = u8Count;
+    u32Running = 0;
+    u32LastRunMsec = APP_u32ClockMsec();
+    bNextDue = FALSE;
+}
+
+/****************************************************************************
+ *
+ * NAME: APP_vZTimerTask
+ *
+ * DESCRIPTION:
+ * Run ZTIMER_vTask, then arm the wakeup for the next timer due. Runs only
+ * when the tick interrupt found a timer due, so it marks the stack ready
+ * after a run that expired one: the callback may have made requests of it.
+ *
+ ****************************************************************************/
+PUBLIC void APP_vZTimerTask(void)
+{
+    uint32 u32Now = APP_u32ClockMsec();
+    bool_t bExpired = FALSE;
+    uint8 i;
+
+    for (i = 0; i < u8NumTimers; i++) {
+        if ((u32Running & ZTIMER_BIT(i)) && ((int32)(u32Now - au32DueMsec[i]) >= 0)) {
+            bExpired = TRUE;
+        }
+    }
+
+    u32LastRunMsec = u32Now;
+    ZTIMER_vTask();
+
+    /* Timers restarted from their callback are running again */
+    for (i = 0; i < u8NumTimers; i++) {
+        if ((u32Running & ZTIMER_BIT(i)) && (ZTIMER_eGetState(i) != E_ZTIMER_STATE_RUNNING)) {
+            u32Running &= ~ZTIMER_BIT(i);
+        }
+    }
+    APP_vZTimerArm();
+
+    if (bExpired) {
+        APP_vSetTaskReady(E_APP_TASK_ZPS);
+    }
+}
+
+/****************************************************************************
+ *
+ * NAME: APP_vZTimerTickIsr
+ *
+ * DESCRIPTION:
+ * Make the ZTimer task ready once the next timer is due.
+ * Called from the tick timer interrupt.
+ *
+ ****************************************************************************/
+PUBLIC void APP_vZTimerTickIsr(uint32 u32Msec)
+{
+    if (bNextDue && ((int32)(u32Msec - u32NextDueMsec) >= 0)) {
+        bNextDue = FALSE;
+        APP_vSetTaskReady(E_APP_TASK_ZTIMER);
+    }
+}
+
+/****************************************************************************
+ *
+ * NAME: __wrap_ZTIMER_eStart
+ *
+ * DESCRIPTION:
+ * Start a ZTimer and track when it is due. ZTIMER_vTask takes every tick
+ * since its last run off each running timer, including one started since,
+ * so those ticks are added back and the timer runs its full time from now.
+ *
+ ****************************************************************************/
+PUBLIC ZTIMER_teStatus __wrap_ZTIMER_eStart(uint8 u8Index, uint32 u32Time)
+{
+    uint32 u32Now = APP_u32ClockMsec();
+    ZTIMER_teStatus eStatus = __real_ZTIMER_eStart(u8Index, u32Time + (u32Now - u32LastRunMsec));
+
+    if ((eStatus == E_ZTIMER_OK) && (u8Index < u8NumTimers)) {
+        au32DueMsec[u8Index] = u32Now + u32Time;
+        u32Running |= ZTIMER_BIT(u8Index);
+        APP_vZTimerArm();
+    }
+
+    return eStatus;
+}
+
+/****************************************************************************
+ *
+ * NAME: __wrap_ZTIMER_eStop
+ *
+ * DESCRIPTION:
+ * Stop a ZTimer and stop tracking it
+ *
+ ****************************************************************************/
+PUBLIC ZTIMER_teStatus __wrap_ZTIMER_eStop(uint8 u8Index)
+{
+    ZTIMER_teStatus eStatus = __real_ZTIMER_eStop(u8Index);
+
+    if (u8Index < u8NumTimers) {
+        u32Running &= ~ZTIMER_BIT(u8Index);
+        APP_vZTimerArm();
+    }
+
+    return eStatus;
+}
+
+/****************************************************************************/
+/***        Local Functions                                               ***/
+/****************************************************************************/
+
+/****************************************************************************
+ *
+ * NAME: APP_vZTimerArm
+ *
+ * DESCRIPTION:
+ * Point the tick interrupt at the earliest running timer. A timer already
+ * due that ZTIMER_vTask has not expired yet, as it counts one tick fewer,
+ * is looked at again on the next tick.
+ *
+ ****************************************************************************/
+PRIVATE void APP_vZTimerArm(void)
+{
+    uint32 u32Now = APP_u32ClockMsec();
+    uint32 u32Storage;
+    int32 i32Next = 0;
+    bool_t bDue = FALSE;
+    int32 i32Left;
+    uint8 i;
+
+    for (i = 0; i < u8NumTimers; i++) {
+        if (u32Running & ZTIMER_BIT(i)) {
+            i32Left = (int32)(au32DueMsec[i] - u32Now);
+            if (!bDue || (i32Left < i32Next)) {
+                i32Next = i32Left;
+                bDue = TRUE;
+            }
+        }
+    }
+    if (i32Next < 1) {
+        i32Next = 1;
+    }
+
+    ZPS_eEnterCriticalSection(NULL, &u32Storage);
+    u32NextDueMsec = u32Now + (uint32)i32Next;
+    bNextDue = bDue;
+    ZPS_eExitCriticalSection(NULL, &u32Storage);
+}
+
+/****************************************************************************/
+/***        END OF FILE                                                   ***/
+/****************************************************************************/
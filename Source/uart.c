@@ -37,40 +37,63 @@
 /****************************************************************************/
 
 #include <jendefs.h>
-#include <stdlib.h>
+#include <string.h>
 
 /* Application */
+#include "app_log.h"
 #include "app_main.h"
+#include "app_ring_buffer.h"
+#include "app_scheduler.h"
 #include "uart.h"
 
 /* SDK JN-SW-4170 */
 #include "AppHardwareApi.h"
-#include "ZQueue.h"
-#include "dbg.h"
+#include "portmacro.h"
 
 /****************************************************************************/
 /***        Macro Definitions                                             ***/
 /****************************************************************************/
 
-#ifdef DEBUG_UART
-#define TRACE_UART TRUE
-#else
-#define TRACE_UART FALSE
-#endif
-
 #define UART           E_AHI_UART_0
 #define UART_BAUD_RATE 115200
 #define UART_START_ADR 0x02003000UL
 
+#define UART_TX_FIFO_SIZE  16
+#define UART_RX_FIFO_SIZE  127
+#define UART_RX_BURST_SIZE 16
+
+/* RX FIFO fill level that raises the receive interrupt. A partial burst below
+ * this level is flushed by the character timeout interrupt. */
+#ifndef UART_RX_TRIGGER_LEVEL
+#define UART_RX_TRIGGER_LEVEL E_AHI_UART_FIFO_LEVEL_8
+#endif
+
+/* APP_rbSerialRx occupancy at which RTS stops the host and lets it resume */
+#ifndef UART_RX_HIGH_WATERMARK
+#define UART_RX_HIGH_WATERMARK 192
+#endif
+#ifndef UART_RX_LOW_WATERMARK
+#define UART_RX_LOW_WATERMARK 64
+#endif
+
 /****************************************************************************/
 /***        Type Definitions                                              ***/
 /****************************************************************************/
 
+typedef struct {
+    uint32 u32BaudRate;
+    uint16 u16Divisor;
+    uint8 u8ClocksPerBit;
+} UART_tsBaudRate;
+
 /****************************************************************************/
 /***        Local Function Prototypes                                     ***/
 /****************************************************************************/
 
-PRIVATE void UART_vSetBaudRate(uint32 u32BaudRate);
+PRIVATE const UART_tsBaudRate *UART_psFindBaudRate(uint32 u32BaudRate);
+PRIVATE uint8 UART_u8ReadLineStatus(void);
+PRIVATE void UART_vDrainRxFifo(void);
+PRIVATE uint16 UART_u16FillTxFifo(void);
 
 /****************************************************************************/
 /***        Exported Variables                                            ***/
@@ -80,8 +103,32 @@ PRIVATE void UART_vSetBaudRate(uint32 u32BaudRate);
 /***        Local Variables                                               ***/
 /****************************************************************************/
 
-PRIVATE uint8 txbuf[16];
-PRIVATE uint8 rxbuf[127];
+PRIVATE uint8 txbuf[UART_TX_FIFO_SIZE];
+PRIVATE uint8 rxbuf[UART_RX_FIFO_SIZE];
+
+/* TRUE while the TX interrupt is enabled and draining APP_rbSerialTx */
+PRIVATE volatile bool_t bTxActive = FALSE;
+
+/* TRUE while RTS is holding off the host */
+PRIVATE volatile bool_t bRxFlowStopped = FALSE;
+
+PRIVATE UART_tsStats sStats;
+
+/* Divisor and clocks per bit for the 16 MHz UART clock, precomputed for the
+ * smallest error: baud = 16000000 / ((u8ClocksPerBit + 1) * u16Divisor).
+ * Only rates within 2% are listed, leaving room for the host's own error.
+ * 921600 is left out, as the nearest is 888889 (-3.55%). */
+PRIVATE const UART_tsBaudRate asBaudRates[] = {
+    {57600, 31, 8},   /* -0.44% */
+    {115200, 23, 5},  /* +0.64% */
+    {230400, 5, 13},  /* -0.79% */
+    {250000, 4, 15},  /* 0% */
+    {460800, 5, 6},   /* -0.79% */
+    {500000, 2, 15},  /* 0% */
+    {1000000, 1, 15}, /* 0% */
+};
+
+PRIVATE uint32 u32CurrentBaudRate;
 
 /****************************************************************************/
 /***        Exported Functions                                            ***/
@@ -97,23 +144,31 @@ PRIVATE uint8 rxbuf[127];
  ****************************************************************************/
 PUBLIC void UART_vInit(void)
 {
-    DBG_vPrintf(TRACE_UART, "Initialising UART... ");
-
+#ifdef UART_FLOW_CONTROL
+    vAHI_UartSetRTSCTS(UART, TRUE);
+#else
     vAHI_UartSetRTSCTS(UART, FALSE);
+#endif
 
-    bAHI_UartEnable(UART, txbuf, (uint8)16, rxbuf, (uint8)127);
+    bAHI_UartEnable(UART, txbuf, (uint8)UART_TX_FIFO_SIZE, rxbuf, (uint8)UART_RX_FIFO_SIZE);
 
     vAHI_UartReset(UART, TRUE, TRUE);
     vAHI_UartReset(UART, FALSE, FALSE);
 
     /* Set the clock divisor register to give required buad, this has to be done
        directly as the normal routines (in ROM) do not support all baud rates */
-    UART_vSetBaudRate(UART_BAUD_RATE);
+    UART_bSetBaudRate(UART_BAUD_RATE);
 
     vAHI_UartSetControl(UART, FALSE, FALSE, E_AHI_UART_WORD_LEN_8, TRUE, FALSE);
-    vAHI_UartSetInterrupt(UART, FALSE, FALSE, FALSE, TRUE, E_AHI_UART_FIFO_LEVEL_1);
+    vAHI_UartSetInterrupt(UART, FALSE, TRUE, FALSE, TRUE, UART_RX_TRIGGER_LEVEL);
+
+#if defined(UART_FLOW_CONTROL) && defined(UART_CTS_FLOW_CONTROL)
+    /* Let the hardware hold TX while the host deasserts CTS. RTS stays under
+     * software control, driven by the RX ring watermarks. */
+    vAHI_UartSetAutoFlowCtrl(UART, 0, FALSE, FALSE, TRUE);
+#endif
 
-    DBG_vPrintf(TRACE_UART, "Done\n");
+    APP_LOG(E_LOG_UART_INIT);
 }
 
 /****************************************************************************
@@ -121,28 +176,147 @@ PUBLIC void UART_vInit(void)
  * NAME: APP_isrUart
  *
  * DESCRIPTION:
- * Handle interrupts from uart
+ * Handle interrupts from uart. Each entry moves a whole burst: all received
+ * bytes are drained and the TX FIFO is refilled up to its free space, no
+ * matter which of the pending interrupts was reported. The serial task is
+ * made ready to decode what arrived or to queue more to send.
  *
  ****************************************************************************/
 PUBLIC void APP_isrUart(void)
 {
+    /* Reading the interrupt identification also acknowledges a TX interrupt */
     uint32 u32ItemBitmap = ((*((volatile uint32 *)(UART_START_ADR + 0x08))) >> 1) & 0x0007;
-    uint8 u8Byte;
 
-    if (u32ItemBitmap & E_AHI_UART_INT_RXDATA) {
-        u8Byte = u8AHI_UartReadData(UART);
-        ZQ_bQueueSend(&APP_msgSerialRx, &u8Byte);
+    /* Also acknowledges a line status interrupt */
+    UART_u8ReadLineStatus();
+
+    UART_vDrainRxFifo();
+
+#ifdef UART_FLOW_CONTROL
+    if (!bRxFlowStopped && (RB_u16Count(&APP_rbSerialRx) >= UART_RX_HIGH_WATERMARK)) {
+        UART_vRtsStopFlow();
+        bRxFlowStopped = TRUE;
+        sStats.u32RxFlowStops++;
     }
-    else if (u32ItemBitmap & E_AHI_UART_INT_TX) {
-        if (ZQ_bQueueReceive(&APP_msgSerialTx, &u8Byte)) {
-            UART_vSetTxInterrupt(TRUE);
-            vAHI_UartWriteData(UART, u8Byte);
-        }
-        else {
-            /* disable tx interrupt as nothing to send */
-            UART_vSetTxInterrupt(FALSE);
-        }
+#endif
+
+    if (bTxActive && (UART_u16FillTxFifo() == 0) && (u32ItemBitmap == E_AHI_UART_INT_TX)) {
+        /* disable tx interrupt as nothing to send */
+        bTxActive = FALSE;
+        UART_vSetTxInterrupt(FALSE);
     }
+
+    APP_vSetTaskReady(E_APP_TASK_SERIAL);
+}
+
+/****************************************************************************
+ *
+ * NAME: UART_vStartTx
+ *
+ * DESCRIPTION:
+ * Start draining APP_rbSerialTx if the TX interrupt is idle. Call after
+ * adding data to the ring.
+ *
+ ****************************************************************************/
+PUBLIC void UART_vStartTx(void)
+{
+    uint32 u32Storage;
+
+    /* The ISR is already draining the ring and will pick up the new data.
+     * Only this task adds to the ring, so an empty ring stays empty and
+     * there is nothing to start. */
+    if (bTxActive || RB_bIsEmpty(&APP_rbSerialTx)) {
+        return;
+    }
+
+    /* The ISR is idle, so for a moment this task acts as the ring consumer */
+    ZPS_eEnterCriticalSection(NULL, &u32Storage);
+
+    if (!bTxActive && !RB_bIsEmpty(&APP_rbSerialTx)) {
+        bTxActive = TRUE;
+        UART_vSetTxInterrupt(TRUE);
+        UART_u16FillTxFifo();
+    }
+
+    ZPS_eExitCriticalSection(NULL, &u32Storage);
+}
+
+/****************************************************************************
+ *
+ * NAME: UART_vResumeRxFlow
+ *
+ * DESCRIPTION:
+ * Release RTS once the RX ring has drained to the low watermark. Call after
+ * taking data out of APP_rbSerialRx.
+ *
+ ****************************************************************************/
+PUBLIC void UART_vResumeRxFlow(void)
+{
+#ifdef UART_FLOW_CONTROL
+    uint32 u32Storage;
+
+    if (bRxFlowStopped && (RB_u16Count(&APP_rbSerialRx) <= UART_RX_LOW_WATERMARK)) {
+        /* The ISR writes the same control register when it stops the flow */
+        ZPS_eEnterCriticalSection(NULL, &u32Storage);
+        UART_vRtsStartFlow();
+        bRxFlowStopped = FALSE;
+        ZPS_eExitCriticalSection(NULL, &u32Storage);
+    }
+#endif
+}
+
+/****************************************************************************
+ *
+ * NAME: UART_vGetStats
+ *
+ * DESCRIPTION:
+ * Read the UART drop and flow control counters
+ *
+ ****************************************************************************/
+PUBLIC void UART_vGetStats(UART_tsStats *psStats)
+{
+    uint32 u32Storage;
+
+    ZPS_eEnterCriticalSection(NULL, &u32Storage);
+    *psStats = sStats;
+    ZPS_eExitCriticalSection(NULL, &u32Storage);
+}
+
+/****************************************************************************
+ *
+ * NAME: UART_vResetStats
+ *
+ * DESCRIPTION:
+ * Clear the link counters
+ *
+ ****************************************************************************/
+PUBLIC void UART_vResetStats(void)
+{
+    uint32 u32Storage;
+
+    ZPS_eEnterCriticalSection(NULL, &u32Storage);
+    memset(&sStats, 0, sizeof(sStats));
+    ZPS_eExitCriticalSection(NULL, &u32Storage);
+}
+
+/****************************************************************************
+ *
+ * NAME: UART_bTxIdle
+ *
+ * DESCRIPTION:
+ * Check that everything queued for transmission has left the shift register
+ *
+ ****************************************************************************/
+PUBLIC bool_t UART_bTxIdle(void)
+{
+    uint32 u32Storage;
+    uint8 u8LineStatus;
+
+    ZPS_eEnterCriticalSection(NULL, &u32Storage);
+    u8LineStatus = UART_u8ReadLineStatus();
+    ZPS_eExitCriticalSection(NULL, &u32Storage);
+
+    return RB_bIsEmpty(&APP_rbSerialTx) && (u8LineStatus & E_AHI_UART_LS_TEMT);
 }
 
 /****************************************************************************
@@ -168,7 +342,14 @@ PUBLIC void UART_vTxChar(uint8 u8Char)
  ****************************************************************************/
 PUBLIC bool_t UART_bTxReady()
 {
-    return u8AHI_UartReadLineStatus(UART) & E_AHI_UART_LS_THRE;
+    uint32 u32Storage;
+    uint8 u8LineStatus;
+
+    ZPS_eEnterCriticalSection(NULL, &u32Storage);
+    u8LineStatus = UART_u8ReadLineStatus();
+    ZPS_eExitCriticalSection(NULL, &u32Storage);
+
+    return u8LineStatus & E_AHI_UART_LS_THRE;
 }
 
 /****************************************************************************
@@ -181,7 +362,66 @@ PUBLIC bool_t UART_bTxReady()
  ****************************************************************************/
 PUBLIC void UART_vSetTxInterrupt(bool_t bState)
 {
-    vAHI_UartSetInterrupt(UART, FALSE, FALSE, bState, TRUE, E_AHI_UART_FIFO_LEVEL_1);
+    vAHI_UartSetInterrupt(UART, FALSE, TRUE, bState, TRUE, UART_RX_TRIGGER_LEVEL);
+}
+
+/****************************************************************************
+ *
+ * NAME: UART_bSetBaudRate
+ *
+ * DESCRIPTION:
+ * Set baud rates UART from the precomputed divisor table
+ *
+ * RETURNS:
+ * FALSE if the baud rate is not supported
+ *
+ ****************************************************************************/
+PUBLIC bool_t UART_bSetBaudRate(uint32 u32BaudRate)
+{
+    const UART_tsBaudRate *psBaudRate = UART_psFindBaudRate(u32BaudRate);
+    uint32 u32Storage;
+
+    if (psBaudRate == NULL) {
+        return FALSE;
+    }
+
+    /* Setting the divisor opens the divisor latch in place of the data and
+     * control registers the ISR uses, so keep the ISR out until it closes */
+    ZPS_eEnterCriticalSection(NULL, &u32Storage);
+    vAHI_UartSetClocksPerBit(UART, psBaudRate->u8ClocksPerBit);
+    vAHI_UartSetBaudDivisor(UART, psBaudRate->u16Divisor);
+    u32CurrentBaudRate = u32BaudRate;
+    ZPS_eExitCriticalSection(NULL, &u32Storage);
+
+    APP_LOG(E_LOG_UART_BAUD_RATE, u32BaudRate);
+
+    return TRUE;
+}
+
+/****************************************************************************
+ *
+ * NAME: UART_bIsBaudRateSupported
+ *
+ * DESCRIPTION:
+ * Check whether the baud rate is in the precomputed divisor table
+ *
+ ****************************************************************************/
+PUBLIC bool_t UART_bIsBaudRateSupported(uint32 u32BaudRate)
+{
+    return (UART_psFindBaudRate(u32BaudRate) != NULL);
+}
+
+/****************************************************************************
+ *
+ * NAME: UART_u32GetBaudRate
+ *
+ * DESCRIPTION:
+ * Baud rate currently in use
+ *
+ ****************************************************************************/
+PUBLIC uint32 UART_u32GetBaudRate(void)
+{
+    return u32CurrentBaudRate;
 }
 
 /****************************************************************************
@@ -216,45 +456,94 @@ PUBLIC void UART_vRtsStopFlow(void)
 
 /****************************************************************************
  *
- * NAME: UART_vSetBaudRate
+ * NAME: UART_psFindBaudRate
  *
  * DESCRIPTION:
- * Set baud rates UART
+ * Look up the divisor table entry for a baud rate
+ *
+ * RETURNS:
+ * Table entry, or NULL if the baud rate is not supported
  *
  ****************************************************************************/
-PRIVATE void UART_vSetBaudRate(uint32 u32BaudRate)
+PRIVATE const UART_tsBaudRate *UART_psFindBaudRate(uint32 u32BaudRate)
 {
-    uint16 u16Divisor = 0;
-    uint32 u32Remainder;
-    uint8 u8ClocksPerBit = 16;
-    uint32 u32CalcBaudRate = 0;
-    int32 i32BaudError = 0x7FFFFFFF;
-
-    while (abs(i32BaudError) > (int32)(u32BaudRate >> 4)) {
-        if (--u8ClocksPerBit < 3) {
-            return;
+    uint8 i;
+
+    for (i = 0; i < sizeof(asBaudRates) / sizeof(UART_tsBaudRate); i++) {
+        if (asBaudRates[i].u32BaudRate == u32BaudRate) {
+            return &asBaudRates[i];
         }
+    }
 
-        /* Calculate Divisor register = 16MHz / (16 x baud rate) */
-        u16Divisor = (uint16)(16000000UL / ((u8ClocksPerBit + 1) * u32BaudRate));
+    return NULL;
+}
 
-        /* Correct for rounding errors */
-        u32Remainder = (uint32)(16000000UL % ((u8ClocksPerBit + 1) * u32BaudRate));
+/****************************************************************************
+ *
+ * NAME: UART_u8ReadLineStatus
+ *
+ * DESCRIPTION:
+ * Read the line status and count receive errors. Reading the line status
+ * clears the error bits, so every read must go through here, from the ISR
+ * or with interrupts disabled.
+ *
+ ****************************************************************************/
+PRIVATE uint8 UART_u8ReadLineStatus(void)
+{
+    uint8 u8LineStatus = u8AHI_UartReadLineStatus(UART);
 
-        if (u32Remainder >= (((u8ClocksPerBit + 1) * u32BaudRate) / 2)) {
-            u16Divisor += 1;
-        }
+    if (u8LineStatus & E_AHI_UART_LS_OE) {
+        sStats.u32RxOverruns++;
+    }
+    if (u8LineStatus & E_AHI_UART_LS_FE) {
+        sStats.u32RxFramingErrors++;
+    }
 
-        u32CalcBaudRate = (16000000UL / ((u8ClocksPerBit + 1) * u16Divisor));
+    return u8LineStatus;
+}
 
-        i32BaudError = (int32)u32CalcBaudRate - (int32)u32BaudRate;
-    }
+/****************************************************************************
+ *
+ * NAME: UART_vDrainRxFifo
+ *
+ * DESCRIPTION:
+ * Move every byte waiting in the RX FIFO into APP_rbSerialRx
+ *
+ ****************************************************************************/
+PRIVATE void UART_vDrainRxFifo(void)
+{
+    uint8 au8Burst[UART_RX_BURST_SIZE];
+    uint16 u16Length;
 
-    /* Set the calculated clocks per bit */
-    vAHI_UartSetClocksPerBit(UART, u8ClocksPerBit);
+    do {
+        u16Length = u16AHI_UartBlockReadData(UART, au8Burst, sizeof(au8Burst));
+        sStats.u32RxDropped += u16Length - RB_u16PushN(&APP_rbSerialRx, au8Burst, u16Length);
+    } while (u16Length == sizeof(au8Burst));
+}
+
+/****************************************************************************
+ *
+ * NAME: UART_u16FillTxFifo
+ *
+ * DESCRIPTION:
+ * Move as much of APP_rbSerialTx into the TX FIFO as it has room for.
+ * Must only be called from the ISR or with interrupts disabled.
+ *
+ * RETURNS:
+ * Number of bytes written to the FIFO
+ *
+ ****************************************************************************/
+PRIVATE uint16 UART_u16FillTxFifo(void)
+{
+    uint8 au8Burst[UART_TX_FIFO_SIZE];
+    uint16 u16Length;
+
+    u16Length = RB_u16PopN(&APP_rbSerialTx, au8Burst, UART_TX_FIFO_SIZE - u16AHI_UartReadTxFifoLevel(UART));
+    if (u16Length > 0) {
+        u16AHI_UartBlockWriteData(UART, au8Burst, u16Length);
+    }
 
-    /* Set the calculated divisor */
-    vAHI_UartSetBaudDivisor(UART, u16Divisor);
+    return u16Length;
 }
 
 /****************************************************************************/
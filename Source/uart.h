@@ -49,6 +49,13 @@
 /***        Type Definitions                                              ***/
 /****************************************************************************/
 
+typedef struct {
+    uint32 u32RxDropped;       /* bytes lost because APP_rbSerialRx was full */
+    uint32 u32RxFlowStops;     /* times RTS was raised at the high watermark */
+    uint32 u32RxOverruns;      /* times the RX FIFO overran */
+    uint32 u32RxFramingErrors; /* characters received without a valid stop bit */
+} UART_tsStats;
+
 /****************************************************************************/
 /***        Exported Variables                                            ***/
 /****************************************************************************/
@@ -62,8 +69,16 @@ PUBLIC void APP_isrUart(void);
 PUBLIC void UART_vTxChar(uint8 u8TxChar);
 PUBLIC bool_t UART_bTxReady(void);
 PUBLIC void UART_vSetTxInterrupt(bool_t bState);
+PUBLIC void UART_vStartTx(void);
+PUBLIC bool_t UART_bTxIdle(void);
+PUBLIC bool_t UART_bSetBaudRate(uint32 u32BaudRate);
+PUBLIC bool_t UART_bIsBaudRateSupported(uint32 u32BaudRate);
+PUBLIC uint32 UART_u32GetBaudRate(void);
 PUBLIC void UART_vRtsStartFlow(void);
 PUBLIC void UART_vRtsStopFlow(void);
+PUBLIC void UART_vResumeRxFlow(void);
+PUBLIC void UART_vGetStats(UART_tsStats *psStats);
+PUBLIC void UART_vResetStats(void);
 
 /****************************************************************************/
 /***        END OF FILE                                                   ***/
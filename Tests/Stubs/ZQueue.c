@@ -0,0 +1,107 @@
+/****************************************************************************
+ *
+ * MODULE:              Lumi Router
+ *
+ * COMPONENT:           ZQueue.c
+ *
+ * DESCRIPTION:         Host build of the SDK message queue
+ *
+ ****************************************************************************
+ *
+ * This software is owned by NXP B.V. and/or its supplier and is protected
+ * under applicable copyright laws. All rights are reserved. We grant You,
+ * and any third parties, a license to use this software solely and
+ * exclusively on NXP products [NXP Microcontrollers such as JN5168, JN5179].
+ * You, and any third parties must reproduce the copyright and warranty notice
+ * and any other legend of ownership on each copy or partial copy of the
+ * software.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+ * AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+ * IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE
+ * ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE
+ * LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR
+ * CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF
+ * SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS
+ * INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN
+ * CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE)
+ * ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+ * POSSIBILITY OF SUCH DAMAGE.
+ *
+ * Copyright NXP B.V. 2016. All rights reserved
+ *
+ ****************************************************************************/
+
+/****************************************************************************/
+/***        Include Files                                                 ***/
+/****************************************************************************/
+
+#include <jendefs.h>
+#include <string.h>
+
+#include "ZQueue.h"
+
+/****************************************************************************/
+/***        Exported Functions                                            ***/
+/****************************************************************************/
+
+PUBLIC void ZQ_vQueueCreate(tszQueue *psQueueHandle, uint32 u32QueueLength, uint32 u32ItemSize, uint8 *pu8StartQueue)
+{
+    psQueueHandle->u32Length = u32QueueLength;
+    psQueueHandle->u32ItemSize = u32ItemSize;
+    psQueueHandle->u32MessageWaiting = 0;
+    psQueueHandle->pu8Head = pu8StartQueue;
+    psQueueHandle->pu8Tail = pu8StartQueue + (u32QueueLength * u32ItemSize);
+    psQueueHandle->pu8WriteTo = pu8StartQueue;
+    psQueueHandle->pu8ReadFrom = pu8StartQueue;
+}
+
+PUBLIC bool_t ZQ_bQueueSend(void *pvQueueHandle, const void *pvItemToQueue)
+{
+    tszQueue *psQueue = (tszQueue *)pvQueueHandle;
+
+    if (psQueue->u32MessageWaiting >= psQueue->u32Length) {
+        return FALSE;
+    }
+
+    memcpy(psQueue->pu8WriteTo, pvItemToQueue, psQueue->u32ItemSize);
+    psQueue->u32MessageWaiting++;
+    psQueue->pu8WriteTo += psQueue->u32ItemSize;
+    if (psQueue->pu8WriteTo >= psQueue->pu8Tail) {
+        psQueue->pu8WriteTo = psQueue->pu8Head;
+    }
+
+    return TRUE;
+}
+
+PUBLIC bool_t ZQ_bQueueReceive(void *pvQueueHandle, void *pvItemFromQueue)
+{
+    tszQueue *psQueue = (tszQueue *)pvQueueHandle;
+
+    if (psQueue->u32MessageWaiting == 0) {
+        return FALSE;
+    }
+
+    memcpy(pvItemFromQueue, psQueue->pu8ReadFrom, psQueue->u32ItemSize);
+    psQueue->u32MessageWaiting--;
+    psQueue->pu8ReadFrom += psQueue->u32ItemSize;
+    if (psQueue->pu8ReadFrom >= psQueue->pu8Tail) {
+        psQueue->pu8ReadFrom = psQueue->pu8Head;
+    }
+
+    return TRUE;
+}
+
+PUBLIC bool_t ZQ_bQueueIsEmpty(void *pvQueueHandle)
+{
+    return ((tszQueue *)pvQueueHandle)->u32MessageWaiting == 0;
+}
+
+PUBLIC uint32 ZQ_u32QueueGetQueueMessageWaiting(void *pvQueueHandle)
+{
+    return ((tszQueue *)pvQueueHandle)->u32MessageWaiting;
+}
+
+/****************************************************************************/
+/***        END OF FILE                                                   ***/
+/****************************************************************************/
@@ -0,0 +1,154 @@
+/****************************************************************************
+ *
+ * MODULE:              Lumi Router
+ *
+ * COMPONENT:           ZTimer.c
+ *
+ * DESCRIPTION:         Host stand-in for the SDK ZTimer
+ *
+ ****************************************************************************
+ *
+ * This software is owned by NXP B.V. and/or its supplier and is protected
+ * under applicable copyright laws. All rights are reserved. We grant You,
+ * and any third parties, a license to use this software solely and
+ * exclusively on NXP products [NXP Microcontrollers such as JN5168, JN5179].
+ * You, and any third parties must reproduce the copyright and warranty notice
+ * and any other legend of ownership on each copy or partial copy of the
+ * software.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+ * AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+ * IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE
+ * ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE
+ * LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR
+ * CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF
+ * SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS
+ * INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN
+ * CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE)
+ * ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+ * POSSIBILITY OF SUCH DAMAGE.
+ *
+ * Copyright NXP B.V. 2016. All rights reserved
+ *
+ ****************************************************************************/
+
+/****************************************************************************/
+/***        Include Files                                                 ***/
+/****************************************************************************/
+
+#include <jendefs.h>
+
+#include "ZTimer.h"
+
+/****************************************************************************/
+/***        Local Variables                                               ***/
+/****************************************************************************/
+
+PRIVATE ZTIMER_tsTimer *pasTimers;
+PRIVATE uint8 u8Timers;
+
+/* Ticks since ZTIMER_vTask last ran */
+PRIVATE volatile uint32 u32Ticks;
+
+/****************************************************************************/
+/***        Exported Functions                                            ***/
+/****************************************************************************/
+
+PUBLIC ZTIMER_teStatus ZTIMER_eInit(ZTIMER_tsTimer *psTimers, uint8 u8NumTimers)
+{
+    uint8 i;
+
+    pasTimers = psTimers;
+    u8Timers = u8NumTimers;
+    u32Ticks = 0;
+    for (i = 0; i < u8NumTimers; i++) {
+        psTimers[i].eState = E_ZTIMER_STATE_CLOSED;
+    }
+
+    return E_ZTIMER_OK;
+}
+
+PUBLIC ZTIMER_teStatus ZTIMER_eOpen(uint8 *pu8TimerIndex,
+                                    ZTIMER_tpfCallback pfCallback,
+                                    void *pvParams,
+                                    uint8 u8Flags)
+{
+    uint8 i;
+
+    for (i = 0; i < u8Timers; i++) {
+        if (pasTimers[i].eState == E_ZTIMER_STATE_CLOSED) {
+            pasTimers[i].u8Flags = u8Flags;
+            pasTimers[i].eState = E_ZTIMER_STATE_STOPPED;
+            pasTimers[i].pvParameters = pvParams;
+            pasTimers[i].pfCallback = pfCallback;
+            *pu8TimerIndex = i;
+            return E_ZTIMER_OK;
+        }
+    }
+
+    return E_ZTIMER_FAIL;
+}
+
+PUBLIC ZTIMER_teStatus ZTIMER_eStart(uint8 u8TimerIndex, uint32 u32Time)
+{
+    if ((u8TimerIndex >= u8Timers) || (pasTimers[u8TimerIndex].eState == E_ZTIMER_STATE_CLOSED) ||
+        (u32Time == 0)) {
+        return E_ZTIMER_FAIL;
+    }
+
+    pasTimers[u8TimerIndex].u32Time = u32Time;
+    pasTimers[u8TimerIndex].eState = E_ZTIMER_STATE_RUNNING;
+    return E_ZTIMER_OK;
+}
+
+PUBLIC ZTIMER_teStatus ZTIMER_eStop(uint8 u8TimerIndex)
+{
+    if ((u8TimerIndex >= u8Timers) || (pasTimers[u8TimerIndex].eState == E_ZTIMER_STATE_CLOSED)) {
+        return E_ZTIMER_FAIL;
+    }
+
+    pasTimers[u8TimerIndex].eState = E_ZTIMER_STATE_STOPPED;
+    return E_ZTIMER_OK;
+}
+
+PUBLIC ZTIMER_teState ZTIMER_eGetState(uint8 u8TimerIndex)
+{
+    return (u8TimerIndex < u8Timers) ? pasTimers[u8TimerIndex].eState : E_ZTIMER_STATE_CLOSED;
+}
+
+PUBLIC void ZTIMER_vTask(void)
+{
+    uint32 u32Elapsed = u32Ticks;
+    ZTIMER_tsTimer *psTimer;
+    uint8 i;
+
+    u32Ticks = 0;
+    if (u32Elapsed == 0) {
+        return;
+    }
+
+    for (i = 0; i < u8Timers; i++) {
+        psTimer = &pasTimers[i];
+        if (psTimer->eState != E_ZTIMER_STATE_RUNNING) {
+            continue;
+        }
+        if (psTimer->u32Time > u32Elapsed) {
+            psTimer->u32Time -= u32Elapsed;
+            continue;
+        }
+
+        psTimer->eState = E_ZTIMER_STATE_EXPIRED;
+        if (psTimer->pfCallback != NULL) {
+            psTimer->pfCallback(psTimer->pvParameters);
+        }
+    }
+}
+
+PUBLIC void ISR_vTickTimer(void)
+{
+    u32Ticks++;
+}
+
+/****************************************************************************/
+/***        END OF FILE                                                   ***/
+/****************************************************************************/
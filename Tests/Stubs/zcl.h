@@ -0,0 +1,98 @@
+/****************************************************************************
+ *
+ * MODULE:              Lumi Router
+ *
+ * COMPONENT:           zcl.h
+ *
+ * DESCRIPTION:         Host build of the SDK ZCL types
+ *
+ ****************************************************************************
+ *
+ * This software is owned by NXP B.V. and/or its supplier and is protected
+ * under applicable copyright laws. All rights are reserved. We grant You,
+ * and any third parties, a license to use this software solely and
+ * exclusively on NXP products [NXP Microcontrollers such as JN5168, JN5179].
+ * You, and any third parties must reproduce the copyright and warranty notice
+ * and any other legend of ownership on each copy or partial copy of the
+ * software.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+ * AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+ * IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE
+ * ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE
+ * LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR
+ * CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF
+ * SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS
+ * INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN
+ * CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE)
+ * ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+ * POSSIBILITY OF SUCH DAMAGE.
+ *
+ * Copyright NXP B.V. 2016. All rights reserved
+ *
+ ****************************************************************************/
+
+/* Host stand-in for the SDK zcl.h. Clusters are declared and created, but
+ * never registered, in the modules built on the host. */
+
+#ifndef ZCL_H
+#define ZCL_H
+
+#include <jendefs.h>
+
+typedef uint8 zuint8;
+typedef uint16 zuint16;
+typedef uint32 zuint32;
+
+typedef enum {
+    E_ZCL_SUCCESS,
+    E_ZCL_FAIL,
+    E_ZCL_ERR_PARAMETER_NULL
+} teZCL_Status;
+
+typedef enum {
+    E_ZCL_UINT8 = 0x20,
+    E_ZCL_UINT16,
+    E_ZCL_UINT24,
+    E_ZCL_UINT32
+} teZCL_ZCLAttributeType;
+
+/* Attribute flags */
+#define E_ZCL_AF_RD (1 << 0)
+#define E_ZCL_AF_WR (1 << 1)
+#define E_ZCL_AF_RP (1 << 2)
+#define E_ZCL_AF_MS (1 << 3)
+
+/* Cluster control flags */
+#define E_ZCL_SECURITY_NETWORK 0
+
+typedef struct {
+    uint16 u16AttributeEnum;
+    uint8 u8AttributeFlags;
+    teZCL_ZCLAttributeType eAttributeDataType;
+    uint16 u16OffsetFromStructBase;
+    uint16 u16AttributeArrayLength;
+} tsZCL_AttributeDefinition;
+
+typedef struct tsZCL_ClusterInstance tsZCL_ClusterInstance;
+
+typedef struct tsZCL_ClusterDefinition {
+    uint16 u16ClusterEnum;
+    bool_t bIsManufacturerSpecificCluster;
+    uint8 u8ClusterControlFlags;
+    uint16 u16NumberOfAttributes;
+    tsZCL_AttributeDefinition *psAttributeDefinition;
+    void *psSceneExtensionTable;
+} tsZCL_ClusterDefinition;
+
+typedef void (*tfpZCL_ZCLCustomcallCallBackFunction)(void *pvParams);
+
+PUBLIC void vZCL_InitializeClusterInstance(tsZCL_ClusterInstance *psClusterInstance,
+                                           bool_t bIsServer,
+                                           tsZCL_ClusterDefinition *psClusterDefinition,
+                                           void *pvEndPointSharedStructPtr,
+                                           uint8 *pu8AttributeControlBits,
+                                           void *pvEndPointCustomStructPtr,
+                                           tfpZCL_ZCLCustomcallCallBackFunction fCustomcallCallBackFunction);
+
+#endif /* ZCL_H */
@@ -0,0 +1,116 @@
+/****************************************************************************
+ *
+ * MODULE:              Lumi Router
+ *
+ * COMPONENT:           zps_apl_af.h
+ *
+ * DESCRIPTION:         Host build of the SDK application framework types
+ *
+ ****************************************************************************
+ *
+ * This software is owned by NXP B.V. and/or its supplier and is protected
+ * under applicable copyright laws. All rights are reserved. We grant You,
+ * and any third parties, a license to use this software solely and
+ * exclusively on NXP products [NXP Microcontrollers such as JN5168, JN5179].
+ * You, and any third parties must reproduce the copyright and warranty notice
+ * and any other legend of ownership on each copy or partial copy of the
+ * software.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+ * AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+ * IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE
+ * ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE
+ * LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR
+ * CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF
+ * SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS
+ * INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN
+ * CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE)
+ * ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+ * POSSIBILITY OF SUCH DAMAGE.
+ *
+ * Copyright NXP B.V. 2016. All rights reserved
+ *
+ ****************************************************************************/
+
+/* Host stand-in for the SDK zps_apl_af.h, with the fields of the stack
+ * events that the capture module reads. Event numbers are not the SDK's. */
+
+#ifndef ZPS_APL_AF_H
+#define ZPS_APL_AF_H
+
+#include <jendefs.h>
+
+#include "pdum_apl.h"
+
+typedef enum {
+    ZPS_E_ADDR_MODE_BOUND,
+    ZPS_E_ADDR_MODE_GROUP,
+    ZPS_E_ADDR_MODE_SHORT,
+    ZPS_E_ADDR_MODE_IEEE
+} ZPS_teAplAfAddrMode;
+
+typedef enum {
+    ZPS_EVENT_NONE,
+    ZPS_EVENT_APS_DATA_INDICATION,
+    ZPS_EVENT_APS_DATA_CONFIRM,
+    ZPS_EVENT_APS_DATA_ACK,
+    ZPS_EVENT_NWK_STARTED,
+    ZPS_EVENT_NWK_STATUS_INDICATION
+} ZPS_teAfEventType;
+
+typedef union {
+    uint16 u16Addr;
+    uint64 u64Addr;
+} ZPS_tuAddress;
+
+typedef struct {
+    uint8 u8DstAddrMode;
+    ZPS_tuAddress uDstAddress;
+    uint8 u8DstEndpoint;
+    uint8 u8SrcAddrMode;
+    ZPS_tuAddress uSrcAddress;
+    uint8 u8SrcEndpoint;
+    uint16 u16ProfileId;
+    uint16 u16ClusterId;
+    PDUM_thAPduInstance hAPduInst;
+    uint8 eStatus;
+    uint8 eSecurityStatus;
+    uint8 u8LinkQuality;
+    uint32 u32RxTime;
+} ZPS_tsAfDataIndEvent;
+
+typedef struct {
+    uint8 u8DstAddrMode;
+    ZPS_tuAddress uDstAddr;
+    uint8 u8SrcEndpoint;
+    uint8 u8DstEndpoint;
+    uint8 u8Status;
+    uint8 u8SequenceNum;
+} ZPS_tsAfDataConfEvent;
+
+typedef struct {
+    uint16 u16DstAddr;
+    uint8 u8SrcEndpoint;
+    uint8 u8DstEndpoint;
+    uint16 u16ProfileId;
+    uint16 u16ClusterId;
+    uint8 u8Status;
+    uint8 u8SequenceNum;
+} ZPS_tsAfDataAckEvent;
+
+typedef struct {
+    uint16 u16NwkAddr;
+    uint8 u8Status;
+} ZPS_tsAfNwkStatusIndEvent;
+
+typedef struct {
+    ZPS_teAfEventType eType;
+    union {
+        ZPS_tsAfDataIndEvent sApsDataIndEvent;
+        ZPS_tsAfDataConfEvent sApsDataConfirmEvent;
+        ZPS_tsAfDataAckEvent sApsDataAckEvent;
+        ZPS_tsAfNwkStatusIndEvent sNwkStatusIndicationEvent;
+    } uEvent;
+} ZPS_tsAfEvent;
+
+#endif /* ZPS_APL_AF_H */
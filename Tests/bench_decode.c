@@ -0,0 +1,314 @@
+/****************************************************************************
+ *
+ * MODULE:              Lumi Router
+ *
+ * COMPONENT:           bench_decode.c
+ *
+ * DESCRIPTION:         Host benchmark of the serial receive decoder
+ *
+ ****************************************************************************
+ *
+ * This software is owned by NXP B.V. and/or its supplier and is protected
+ * under applicable copyright laws. All rights are reserved. We grant You,
+ * and any third parties, a license to use this software solely and
+ * exclusively on NXP products [NXP Microcontrollers such as JN5168, JN5179].
+ * You, and any third parties must reproduce the copyright and warranty notice
+ * and any other legend of ownership on each copy or partial copy of the
+ * software.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+ * AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+ * IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE
+ * ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE
+ * LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR
+ * CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF
+ * SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS
+ * INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN
+ * CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE)
+ * ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+ * POSSIBILITY OF SUCH DAMAGE.
+ *
+ * Copyright NXP B.V. 2016. All rights reserved
+ *
+ ****************************************************************************/
+
+/* The frames carry a wrong check value, so the serial task decodes each
+ * one in full and drops it at the end without a command or a reply, and
+ * only the decoder is timed. The per byte decoder is APP_vProcessRxChar as
+ * it was before the run decoder, without its traces. */
+
+/****************************************************************************/
+/***        Include Files                                                 ***/
+/****************************************************************************/
+
+#include <jendefs.h>
+#include <stdlib.h>
+#include <string.h>
+
+/* Application */
+#include "app_crc16.h"
+#include "app_main.h"
+#include "app_ring_buffer.h"
+#include "app_serial_commands.h"
+#include "host_serial.h"
+#include "test.h"
+
+/****************************************************************************/
+/***        Macro Definitions                                             ***/
+/****************************************************************************/
+
+#define BENCH_FRAMES 200000UL
+
+/* Payload of the frames. Escaped, it still fits the 256 byte RX ring. */
+#define FRAME_DATA_SIZE 96
+
+#define BENCH_FRAME_TYPE 0x0040
+
+#define BENCH_MSG_SET_PROTOCOL_VERSION 0x0014
+
+#define SL_START_CHAR 0x01
+#define SL_ESC_CHAR   0x02
+#define SL_END_CHAR   0x03
+
+/* Chunk size of APP_taskAtSerial */
+#define RX_CHUNK_SIZE 16
+
+/****************************************************************************/
+/***        Type Definitions                                              ***/
+/****************************************************************************/
+
+typedef void (*tpfDecode)(void);
+
+typedef enum {
+    E_STATE_RX_WAIT_START,
+    E_STATE_RX_WAIT_TYPEMSB,
+    E_STATE_RX_WAIT_TYPELSB,
+    E_STATE_RX_WAIT_LENMSB,
+    E_STATE_RX_WAIT_LENLSB,
+    E_STATE_RX_WAIT_CRC,
+    E_STATE_RX_WAIT_CRCLSB,
+    E_STATE_RX_WAIT_DATA
+} teRxState;
+
+/****************************************************************************/
+/***        Local Function Prototypes                                     ***/
+/****************************************************************************/
+
+PRIVATE uint16 u16EncodeBad(uint8 *pu8Out, const uint8 *pu8Data);
+PRIVATE void vRun(const char *pcName, tpfDecode pfDecode, const uint8 *pu8Encoded, uint16 u16Length);
+PRIVATE void vRunDecode(void);
+PRIVATE void vCharDecode(void);
+PRIVATE void vProcessRxChar(uint8 u8Char);
+PRIVATE uint32 u32CrcErrors(void);
+
+/****************************************************************************/
+/***        Local Variables                                               ***/
+/****************************************************************************/
+
+/* Per byte decoder state */
+PRIVATE teRxState eRxState = E_STATE_RX_WAIT_START;
+PRIVATE bool_t bInEsc;
+PRIVATE uint16 u16Type;
+PRIVATE uint16 u16Length;
+PRIVATE uint16 u16Crc;
+PRIVATE uint16 u16RunningCrc;
+PRIVATE uint16 u16Bytes;
+PRIVATE uint8 au8Data[MAX_PACKET_SIZE];
+PRIVATE uint32 u32CharCrcErrors;
+
+/****************************************************************************/
+/***        Exported Functions                                            ***/
+/****************************************************************************/
+
+int main(void)
+{
+    uint8 au8Typical[FRAME_DATA_SIZE];
+    uint8 au8Escaped[FRAME_DATA_SIZE];
+    uint8 au8Encoded[2 * (FRAME_DATA_SIZE + 8)];
+    uint8 u8Version = 2;
+    uint32 u32Random = 1;
+    uint16 u16Encoded;
+    uint8 i;
+
+    /* Typical traffic is random, so 3 bytes in 256 need escaping. The worst
+     * case is made only of bytes that need escaping. */
+    for (i = 0; i < FRAME_DATA_SIZE; i++) {
+        u32Random = u32Random * 1103515245UL + 12345;
+        au8Typical[i] = (uint8)(u32Random >> 16);
+        au8Escaped[i] = SL_START_CHAR + (i % 3);
+    }
+
+    /* Version 2 framing, with the CRC-16 */
+    HOST_vSerialInit();
+    HOST_vSendFrame(BENCH_MSG_SET_PROTOCOL_VERSION, &u8Version, 1);
+    HOST_vRunSerial();
+    HOST_vSetVersion(u8Version);
+
+    printf("%lu frames of %u bytes each\n", BENCH_FRAMES, FRAME_DATA_SIZE);
+    printf("%-22s %10s %10s\n", "", "ns/byte", "Mbyte/s");
+
+    u16Encoded = u16EncodeBad(au8Encoded, au8Typical);
+    vRun("Per byte, typical", vCharDecode, au8Encoded, u16Encoded);
+    vRun("Runs, typical", vRunDecode, au8Encoded, u16Encoded);
+
+    u16Encoded = u16EncodeBad(au8Encoded, au8Escaped);
+    vRun("Per byte, escaped", vCharDecode, au8Encoded, u16Encoded);
+    vRun("Runs, escaped", vRunDecode, au8Encoded, u16Encoded);
+
+    return 0;
+}
+
+/****************************************************************************/
+/***        Local Functions                                               ***/
+/****************************************************************************/
+
+/* Encode a frame and change its last data byte, which the check value then
+ * does not match. 0x20 and 0x21 can stand alone or follow an escape. */
+PRIVATE uint16 u16EncodeBad(uint8 *pu8Out, const uint8 *pu8Data)
+{
+    uint16 u16Encoded = HOST_u16Encode(pu8Out, BENCH_FRAME_TYPE, pu8Data, FRAME_DATA_SIZE);
+
+    pu8Out[u16Encoded - 2] = (pu8Out[u16Encoded - 2] == 0x20) ? 0x21 : 0x20;
+
+    return u16Encoded;
+}
+
+/* Receive the frame again and again, and check that every copy got as far
+ * as the check value. The time is per byte on the wire. */
+PRIVATE void vRun(const char *pcName, tpfDecode pfDecode, const uint8 *pu8Encoded, uint16 u16Length)
+{
+    uint64 u64Start;
+    uint64 u64Elapsed;
+    uint32 u32Errors = u32CrcErrors();
+    uint32 n;
+
+    u64Start = TEST_u64Nsec();
+    for (n = 0; n < BENCH_FRAMES; n++) {
+        RB_u16PushN(&APP_rbSerialRx, pu8Encoded, u16Length);
+        pfDecode();
+    }
+    u64Elapsed = TEST_u64Nsec() - u64Start;
+
+    if ((u32CrcErrors() - u32Errors) != BENCH_FRAMES) {
+        printf("%s: frames not decoded in full\n", pcName);
+        exit(1);
+    }
+
+    printf("%-22s %10.2f %10.1f\n",
+           pcName,
+           (double)u64Elapsed / ((double)BENCH_FRAMES * u16Length),
+           ((double)BENCH_FRAMES * u16Length * 1000.0) / (double)u64Elapsed);
+}
+
+/* The serial task, until it has taken the whole frame from the RX ring */
+PRIVATE void vRunDecode(void)
+{
+    while (!RB_bIsEmpty(&APP_rbSerialRx)) {
+        APP_taskAtSerial();
+    }
+}
+
+/* The serial task loop with the per byte decoder */
+PRIVATE void vCharDecode(void)
+{
+    uint8 au8Chunk[RX_CHUNK_SIZE];
+    uint16 u16Chunk;
+    uint16 i;
+
+    while ((u16Chunk = RB_u16PopN(&APP_rbSerialRx, au8Chunk, sizeof(au8Chunk))) > 0) {
+        for (i = 0; i < u16Chunk; i++) {
+            vProcessRxChar(au8Chunk[i]);
+        }
+    }
+}
+
+PRIVATE void vProcessRxChar(uint8 u8Char)
+{
+    switch (u8Char) {
+    case SL_START_CHAR:
+        u16Bytes = 0;
+        bInEsc = FALSE;
+        u16RunningCrc = CRC16_INIT;
+        eRxState = E_STATE_RX_WAIT_TYPEMSB;
+        break;
+
+    case SL_ESC_CHAR:
+        bInEsc = TRUE;
+        break;
+
+    case SL_END_CHAR:
+        if ((eRxState == E_STATE_RX_WAIT_DATA) && (u16Bytes == u16Length)) {
+            if (u16Crc != u16RunningCrc) {
+                u32CharCrcErrors++;
+            }
+        }
+        eRxState = E_STATE_RX_WAIT_START;
+        break;
+
+    default:
+        if (bInEsc) {
+            u8Char ^= 0x10;
+            bInEsc = FALSE;
+        }
+
+        switch (eRxState) {
+        case E_STATE_RX_WAIT_START:
+            break;
+
+        case E_STATE_RX_WAIT_TYPEMSB:
+            u16RunningCrc = CRC16_u16Update(u16RunningCrc, u8Char);
+            u16Type = (uint16)u8Char << 8;
+            eRxState++;
+            break;
+
+        case E_STATE_RX_WAIT_TYPELSB:
+            u16RunningCrc = CRC16_u16Update(u16RunningCrc, u8Char);
+            u16Type += (uint16)u8Char;
+            eRxState++;
+            break;
+
+        case E_STATE_RX_WAIT_LENMSB:
+            u16RunningCrc = CRC16_u16Update(u16RunningCrc, u8Char);
+            u16Length = (uint16)u8Char << 8;
+            eRxState++;
+            break;
+
+        case E_STATE_RX_WAIT_LENLSB:
+            u16RunningCrc = CRC16_u16Update(u16RunningCrc, u8Char);
+            u16Length += (uint16)u8Char;
+            eRxState = (u16Length > MAX_PACKET_SIZE) ? E_STATE_RX_WAIT_START : E_STATE_RX_WAIT_CRC;
+            break;
+
+        case E_STATE_RX_WAIT_CRC:
+            u16Crc = (uint16)u8Char << 8;
+            eRxState++;
+            break;
+
+        case E_STATE_RX_WAIT_CRCLSB:
+            u16Crc |= u8Char;
+            eRxState++;
+            break;
+
+        case E_STATE_RX_WAIT_DATA:
+            if (u16Bytes < u16Length) {
+                u16RunningCrc = CRC16_u16Update(u16RunningCrc, u8Char);
+                au8Data[u16Bytes++] = u8Char;
+            }
+            break;
+        }
+        break;
+    }
+}
+
+/* Frames dropped on their check value, by either decoder */
+PRIVATE uint32 u32CrcErrors(void)
+{
+    APP_tsSerialLinkStats sStats;
+
+    APP_vGetSerialLinkStats(&sStats);
+    return sStats.u32CrcErrors + u32CharCrcErrors;
+}
+
+/****************************************************************************/
+/***        END OF FILE                                                   ***/
+/****************************************************************************/
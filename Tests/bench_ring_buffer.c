@@ -0,0 +1,223 @@
+/****************************************************************************
+ *
+ * MODULE:              Lumi Router
+ *
+ * COMPONENT:           bench_ring_buffer.c
+ *
+ * DESCRIPTION:         Byte ring against the ZQueue it replaced
+ *
+ ****************************************************************************
+ *
+ * This software is owned by NXP B.V. and/or its supplier and is protected
+ * under applicable copyright laws. All rights are reserved. We grant You,
+ * and any third parties, a license to use this software solely and
+ * exclusively on NXP products [NXP Microcontrollers such as JN5168, JN5179].
+ * You, and any third parties must reproduce the copyright and warranty notice
+ * and any other legend of ownership on each copy or partial copy of the
+ * software.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+ * AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+ * IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE
+ * ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE
+ * LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR
+ * CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF
+ * SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS
+ * INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN
+ * CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE)
+ * ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+ * POSSIBILITY OF SUCH DAMAGE.
+ *
+ * Copyright NXP B.V. 2016. All rights reserved
+ *
+ ****************************************************************************/
+
+/****************************************************************************/
+/***        Include Files                                                 ***/
+/****************************************************************************/
+
+#include <jendefs.h>
+#include <string.h>
+
+/* Application */
+#include "app_ring_buffer.h"
+#include "test.h"
+
+/****************************************************************************/
+/***        Macro Definitions                                             ***/
+/****************************************************************************/
+
+/* Same sizes as the serial path: the RX ring and one RX FIFO burst */
+#define QUEUE_SIZE 256
+#define BURST_SIZE 8
+
+#define BENCH_BYTES 100000000UL
+
+/****************************************************************************/
+/***        Type Definitions                                              ***/
+/****************************************************************************/
+
+/* Model of the SDK ZQueue the serial path used before: a queue of
+ * one-byte items, each send and receive copying the item under masked
+ * interrupts */
+typedef struct {
+    uint32 u32Length;
+    uint32 u32ItemSize;
+    uint32 u32MessageWaiting;
+    uint8 *pu8Head;
+    uint8 *pu8Tail;
+    uint8 *pu8WriteTo;
+    uint8 *pu8ReadFrom;
+} tsQueueModel;
+
+/****************************************************************************/
+/***        Local Function Prototypes                                     ***/
+/****************************************************************************/
+
+PRIVATE void vQueueCreate(tsQueueModel *psQueue, uint32 u32Length, uint32 u32ItemSize, uint8 *pu8Storage);
+PRIVATE bool_t bQueueSend(tsQueueModel *psQueue, const void *pvItem);
+PRIVATE bool_t bQueueReceive(tsQueueModel *psQueue, void *pvItem);
+PRIVATE void vItemCopy(uint8 *pu8To, const uint8 *pu8From, uint32 u32Size);
+PRIVATE void vReport(const char *pcName, uint64 u64Nsec);
+
+/****************************************************************************/
+/***        Local Variables                                               ***/
+/****************************************************************************/
+
+/* Stands in for the interrupt enable bits saved and restored around each
+ * queue operation */
+PRIVATE volatile uint32 u32InterruptMask = 1;
+
+PRIVATE uint8 au8Storage[QUEUE_SIZE];
+PRIVATE volatile uint8 u8Sink;
+
+/****************************************************************************/
+/***        Exported Functions                                            ***/
+/****************************************************************************/
+
+int main(void)
+{
+    tsQueueModel sQueue;
+    RB_tsRingBuffer sRing;
+    uint8 au8Burst[BURST_SIZE];
+    uint8 u8Byte;
+    uint64 u64Start;
+    uint32 u32Bytes;
+    uint8 i;
+
+    for (i = 0; i < BURST_SIZE; i++) {
+        au8Burst[i] = i;
+    }
+
+    printf("%lu bytes in bursts of %u through a %u byte queue\n", BENCH_BYTES, BURST_SIZE, QUEUE_SIZE);
+
+    vQueueCreate(&sQueue, QUEUE_SIZE, sizeof(uint8), au8Storage);
+    u64Start = TEST_u64Nsec();
+    for (u32Bytes = 0; u32Bytes < BENCH_BYTES; u32Bytes += BURST_SIZE) {
+        for (i = 0; i < BURST_SIZE; i++) {
+            bQueueSend(&sQueue, &au8Burst[i]);
+        }
+        while (bQueueReceive(&sQueue, &u8Byte)) {
+            u8Sink = u8Byte;
+        }
+    }
+    vReport("ZQueue, per byte", TEST_u64Nsec() - u64Start);
+
+    RB_vInit(&sRing, au8Storage, QUEUE_SIZE);
+    u64Start = TEST_u64Nsec();
+    for (u32Bytes = 0; u32Bytes < BENCH_BYTES; u32Bytes += BURST_SIZE) {
+        for (i = 0; i < BURST_SIZE; i++) {
+            RB_bPush(&sRing, au8Burst[i]);
+        }
+        while (RB_bPop(&sRing, &u8Byte)) {
+            u8Sink = u8Byte;
+        }
+    }
+    vReport("Ring, per byte", TEST_u64Nsec() - u64Start);
+
+    RB_vInit(&sRing, au8Storage, QUEUE_SIZE);
+    u64Start = TEST_u64Nsec();
+    for (u32Bytes = 0; u32Bytes < BENCH_BYTES; u32Bytes += BURST_SIZE) {
+        RB_u16PushN(&sRing, au8Burst, BURST_SIZE);
+        RB_u16PopN(&sRing, au8Burst, BURST_SIZE);
+        u8Sink = au8Burst[0];
+    }
+    vReport("Ring, bulk", TEST_u64Nsec() - u64Start);
+
+    return 0;
+}
+
+/****************************************************************************/
+/***        Local Functions                                               ***/
+/****************************************************************************/
+
+PRIVATE void vQueueCreate(tsQueueModel *psQueue, uint32 u32Length, uint32 u32ItemSize, uint8 *pu8Storage)
+{
+    psQueue->u32Length = u32Length;
+    psQueue->u32ItemSize = u32ItemSize;
+    psQueue->u32MessageWaiting = 0;
+    psQueue->pu8Head = pu8Storage;
+    psQueue->pu8Tail = pu8Storage + (u32Length * u32ItemSize);
+    psQueue->pu8WriteTo = pu8Storage;
+    psQueue->pu8ReadFrom = pu8Storage;
+}
+
+PRIVATE bool_t bQueueSend(tsQueueModel *psQueue, const void *pvItem)
+{
+    uint32 u32Store = u32InterruptMask;
+    bool_t bSent = FALSE;
+
+    u32InterruptMask = 0;
+    if (psQueue->u32MessageWaiting < psQueue->u32Length) {
+        vItemCopy(psQueue->pu8WriteTo, pvItem, psQueue->u32ItemSize);
+        psQueue->u32MessageWaiting++;
+        psQueue->pu8WriteTo += psQueue->u32ItemSize;
+        if (psQueue->pu8WriteTo >= psQueue->pu8Tail) {
+            psQueue->pu8WriteTo = psQueue->pu8Head;
+        }
+        bSent = TRUE;
+    }
+    u32InterruptMask = u32Store;
+
+    return bSent;
+}
+
+PRIVATE bool_t bQueueReceive(tsQueueModel *psQueue, void *pvItem)
+{
+    uint32 u32Store = u32InterruptMask;
+    bool_t bReceived = FALSE;
+
+    u32InterruptMask = 0;
+    if (psQueue->u32MessageWaiting > 0) {
+        vItemCopy(pvItem, psQueue->pu8ReadFrom, psQueue->u32ItemSize);
+        psQueue->u32MessageWaiting--;
+        psQueue->pu8ReadFrom += psQueue->u32ItemSize;
+        if (psQueue->pu8ReadFrom >= psQueue->pu8Tail) {
+            psQueue->pu8ReadFrom = psQueue->pu8Head;
+        }
+        bReceived = TRUE;
+    }
+    u32InterruptMask = u32Store;
+
+    return bReceived;
+}
+
+/* Not inlined, as the library copy is a call */
+PRIVATE void __attribute__((noinline)) vItemCopy(uint8 *pu8To, const uint8 *pu8From, uint32 u32Size)
+{
+    while (u32Size--) {
+        *pu8To++ = *pu8From++;
+    }
+}
+
+PRIVATE void vReport(const char *pcName, uint64 u64Nsec)
+{
+    printf("%-18s %8.1f Mbyte/s %6.2f ns/byte\n",
+           pcName,
+           (double)BENCH_BYTES * 1000.0 / (double)u64Nsec,
+           (double)u64Nsec / (double)BENCH_BYTES);
+}
+
+/****************************************************************************/
+/***        END OF FILE                                                   ***/
+/****************************************************************************/
@@ -0,0 +1,206 @@
+/****************************************************************************
+ *
+ * MODULE:              Lumi Router
+ *
+ * COMPONENT:           bench_scheduler.c
+ *
+ * DESCRIPTION:         Benchmark of main loop wakeups
+ *
+ ****************************************************************************
+ *
+ * This software is owned by NXP B.V. and/or its supplier and is protected
+ * under applicable copyright laws. All rights are reserved. We grant You,
+ * and any third parties, a license to use this software solely and
+ * exclusively on NXP products [NXP Microcontrollers such as JN5168, JN5179].
+ * You, and any third parties must reproduce the copyright and warranty notice
+ * and any other legend of ownership on each copy or partial copy of the
+ * software.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+ * AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+ * IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE
+ * ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE
+ * LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR
+ * CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF
+ * SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS
+ * INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN
+ * CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE)
+ * ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+ * POSSIBILITY OF SUCH DAMAGE.
+ *
+ * Copyright NXP B.V. 2016. All rights reserved
+ *
+ ****************************************************************************/
+
+/****************************************************************************/
+/***        Include Files                                                 ***/
+/****************************************************************************/
+
+#include <jendefs.h>
+#include <stdio.h>
+
+/* Application */
+#include "app_scheduler.h"
+#include "app_ztimer.h"
+#include "host_clock.h"
+#include "test.h"
+
+/* SDK JN-SW-4170 */
+#include "ZTimer.h"
+
+/****************************************************************************/
+/***        Macro Definitions                                             ***/
+/****************************************************************************/
+
+#define BENCH_SECONDS 600
+
+/* An idle router: the ZCL tick of the timer wheel and a slower timer */
+#define FAST_PERIOD_MSEC 1000
+#define SLOW_PERIOD_MSEC 10000
+
+#define ZTIMER_STORAGE 2
+
+/****************************************************************************/
+/***        Type Definitions                                              ***/
+/****************************************************************************/
+
+typedef struct {
+    uint32 u32WakeTicks; /* ticks after which a task ran, keeping the CPU awake */
+    uint32 u32ZTimerRuns;
+    uint32 u32StackRuns;
+    uint64 u64Nsec;
+} tsResult;
+
+/****************************************************************************/
+/***        Local Function Prototypes                                     ***/
+/****************************************************************************/
+
+PRIVATE void vRun(const char *pcName, bool_t bEveryTick);
+PRIVATE void vTimerExpired(void *pvParam);
+PRIVATE void vTaskZps(void);
+PRIVATE void vTaskZTimer(void);
+PRIVATE void vTaskIdle(void);
+
+/****************************************************************************/
+/***        Local Variables                                               ***/
+/****************************************************************************/
+
+PRIVATE const APP_tpfTask apfTasks[E_APP_TASK_COUNT] = {vTaskZps, vTaskIdle, vTaskZTimer, vTaskIdle, vTaskIdle};
+
+PRIVATE ZTIMER_tsTimer asTimers[ZTIMER_STORAGE];
+PRIVATE uint8 au8Timer[ZTIMER_STORAGE];
+PRIVATE const uint32 au32Period[ZTIMER_STORAGE] = {FAST_PERIOD_MSEC, SLOW_PERIOD_MSEC};
+
+PRIVATE tsResult sResult;
+
+/****************************************************************************/
+/***        Exported Functions                                            ***/
+/****************************************************************************/
+
+int main(void)
+{
+    uint8 i;
+
+    HOST_vClockInit(0);
+    APP_vZTimerInit(asTimers, ZTIMER_STORAGE);
+    for (i = 0; i < ZTIMER_STORAGE; i++) {
+        ZTIMER_eOpen(&au8Timer[i], vTimerExpired, (void *)&au32Period[i], ZTIMER_FLAG_PREVENT_SLEEP);
+    }
+
+    /* The boot pass */
+    while (APP_bTasksReady()) {
+        APP_u32RunReadyTasks(apfTasks);
+    }
+
+    printf("%u s of an idle router with timers every %u ms and %u ms\n",
+           BENCH_SECONDS,
+           FAST_PERIOD_MSEC,
+           SLOW_PERIOD_MSEC);
+    printf("%-22s %10s %14s %13s %10s\n", "", "wakeups/s", "ZTimer runs/s", "stack runs/s", "host ns/s");
+
+    vRun("ZTimer every tick", TRUE);
+    vRun("ZTimer when due", FALSE);
+
+    return 0;
+}
+
+/****************************************************************************/
+/***        Local Functions                                               ***/
+/****************************************************************************/
+
+/* The main loop of app_main.c after each tick interrupt. bEveryTick is the
+ * loop this replaced: the tick interrupt made the ZTimer task ready, and
+ * its run made the stack ready. */
+PRIVATE void vRun(const char *pcName, bool_t bEveryTick)
+{
+    uint32 u32Quiet = APP_TASK_MASK(E_APP_TASK_ZPS) | (bEveryTick ? 0 : APP_TASK_MASK(E_APP_TASK_ZTIMER));
+    uint64 u64Start;
+    uint32 u32Tick;
+    uint32 u32Ran;
+    uint8 i;
+
+    sResult = (tsResult){0};
+    for (i = 0; i < ZTIMER_STORAGE; i++) {
+        ZTIMER_eStart(au8Timer[i], ZTIMER_TIME_MSEC(au32Period[i]));
+    }
+
+    u64Start = TEST_u64Nsec();
+    for (u32Tick = 0; u32Tick < BENCH_SECONDS * 1000UL; u32Tick++) {
+        HOST_vTick();
+        if (bEveryTick) {
+            APP_vSetTaskReady(E_APP_TASK_ZTIMER);
+        }
+
+        if (APP_bTasksReady()) {
+            sResult.u32WakeTicks++;
+        }
+        while (APP_bTasksReady()) {
+            u32Ran = APP_u32RunReadyTasks(apfTasks);
+            if (u32Ran & ~u32Quiet) {
+                APP_vSetTaskReady(E_APP_TASK_ZPS);
+            }
+        }
+    }
+    sResult.u64Nsec = TEST_u64Nsec() - u64Start;
+
+    for (i = 0; i < ZTIMER_STORAGE; i++) {
+        ZTIMER_eStop(au8Timer[i]);
+    }
+
+    printf("%-22s %10.1f %14.1f %13.1f %10.0f\n",
+           pcName,
+           (double)sResult.u32WakeTicks / BENCH_SECONDS,
+           (double)sResult.u32ZTimerRuns / BENCH_SECONDS,
+           (double)sResult.u32StackRuns / BENCH_SECONDS,
+           (double)sResult.u64Nsec / BENCH_SECONDS);
+}
+
+PRIVATE void vTimerExpired(void *pvParam)
+{
+    uint8 i;
+
+    for (i = 0; i < ZTIMER_STORAGE; i++) {
+        if (pvParam == &au32Period[i]) {
+            ZTIMER_eStart(au8Timer[i], ZTIMER_TIME_MSEC(au32Period[i]));
+        }
+    }
+}
+
+PRIVATE void vTaskZps(void)
+{
+    sResult.u32StackRuns++;
+}
+
+PRIVATE void vTaskZTimer(void)
+{
+    sResult.u32ZTimerRuns++;
+    APP_vZTimerTask();
+}
+
+PRIVATE void vTaskIdle(void)
+{
+}
+
+/****************************************************************************/
+/***        END OF FILE                                                   ***/
+/****************************************************************************/
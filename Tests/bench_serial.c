@@ -0,0 +1,271 @@
+/****************************************************************************
+ *
+ * MODULE:              Lumi Router
+ *
+ * COMPONENT:           bench_serial.c
+ *
+ * DESCRIPTION:         Host benchmark of the serial write path
+ *
+ ****************************************************************************
+ *
+ * This software is owned by NXP B.V. and/or its supplier and is protected
+ * under applicable copyright laws. All rights are reserved. We grant You,
+ * and any third parties, a license to use this software solely and
+ * exclusively on NXP products [NXP Microcontrollers such as JN5168, JN5179].
+ * You, and any third parties must reproduce the copyright and warranty notice
+ * and any other legend of ownership on each copy or partial copy of the
+ * software.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+ * AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+ * IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE
+ * ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE
+ * LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR
+ * CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF
+ * SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS
+ * INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN
+ * CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE)
+ * ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+ * POSSIBILITY OF SUCH DAMAGE.
+ *
+ * Copyright NXP B.V. 2016. All rights reserved
+ *
+ ****************************************************************************/
+
+/****************************************************************************/
+/***        Include Files                                                 ***/
+/****************************************************************************/
+
+#include <jendefs.h>
+#include <string.h>
+
+/* Application */
+#include "app_serial_commands.h"
+#include "host_serial.h"
+#include "test.h"
+
+/* SDK JN-SW-4170 */
+#include "ZQueue.h"
+
+/****************************************************************************/
+/***        Macro Definitions                                             ***/
+/****************************************************************************/
+
+#define BENCH_MESSAGES 1000000UL
+
+/* TX queue of the per-character path, as in app_main.c before the ring */
+#define TX_QUEUE_SIZE 150
+
+/* Payload of the framed messages: a command reply of a few counters */
+#define FRAME_DATA_SIZE 32
+
+#define BENCH_FRAME_TYPE SERIAL_CHANNEL_TYPE(E_SERIAL_CHANNEL_EVENT, 0x40)
+
+/****************************************************************************/
+/***        Type Definitions                                              ***/
+/****************************************************************************/
+
+typedef void (*tpfWrite)(void);
+
+/****************************************************************************/
+/***        Local Function Prototypes                                     ***/
+/****************************************************************************/
+
+PRIVATE void vRun(const char *pcName, tpfWrite pfWrite, tpfWrite pfDrain);
+PRIVATE void vCharText(void);
+PRIVATE void vCharFrame(void);
+PRIVATE void vBulkText(void);
+PRIVATE void vGatheredFrame(void);
+PRIVATE void vCharDrain(void);
+PRIVATE void vBulkDrain(void);
+PRIVATE void vWriteTxChar(uint8 u8Char);
+PRIVATE uint64 u64ClockOverhead(void);
+
+/****************************************************************************/
+/***        Local Variables                                               ***/
+/****************************************************************************/
+
+PRIVATE const char acText[] = "Reset...........";
+
+PRIVATE uint8 au8Header[3];
+PRIVATE uint8 au8FrameData[FRAME_DATA_SIZE];
+
+/* Per-character path: the byte queue and a UART that is either idle or
+ * sending with its TX interrupt on */
+PRIVATE tszQueue sTxQueue;
+PRIVATE uint8 au8TxQueue[TX_QUEUE_SIZE];
+PRIVATE bool_t bCharTxActive;
+PRIVATE volatile uint8 u8Sink;
+
+PRIVATE uint64 u64Overhead;
+
+/****************************************************************************/
+/***        Exported Functions                                            ***/
+/****************************************************************************/
+
+int main(void)
+{
+    uint8 i;
+
+    for (i = 0; i < FRAME_DATA_SIZE; i++) {
+        au8FrameData[i] = i;
+    }
+    au8Header[0] = 0;
+    au8Header[1] = 0x80;
+    au8Header[2] = 7;
+
+    HOST_vSerialInit();
+    ZQ_vQueueCreate(&sTxQueue, TX_QUEUE_SIZE, sizeof(uint8), au8TxQueue);
+    u64Overhead = u64ClockOverhead();
+
+    printf("%lu messages each, a %u byte text or a %u byte framed reply\n",
+           BENCH_MESSAGES,
+           (unsigned)strlen(acText),
+           (unsigned)(sizeof(au8Header) + FRAME_DATA_SIZE));
+    printf("%-22s %10s %10s %12s\n", "", "ns/msg", "masks/msg", "masked ns/msg");
+
+    vRun("Per char, text", vCharText, vCharDrain);
+    vRun("Bulk, text", vBulkText, vBulkDrain);
+    vRun("Per char, frame", vCharFrame, vCharDrain);
+    vRun("Gathered, frame", vGatheredFrame, vBulkDrain);
+
+    return 0;
+}
+
+/****************************************************************************/
+/***        Local Functions                                               ***/
+/****************************************************************************/
+
+/* Write and drain the messages twice: once for the time per message, and
+ * once timing the critical sections, less the cost of reading the clock */
+PRIVATE void vRun(const char *pcName, tpfWrite pfWrite, tpfWrite pfDrain)
+{
+    uint64 u64Start;
+    uint64 u64Elapsed;
+    uint64 u64Masked;
+    uint32 u32Sections;
+    uint32 n;
+
+    HOST_vSerialInit();
+    u64Start = TEST_u64Nsec();
+    for (n = 0; n < BENCH_MESSAGES; n++) {
+        pfWrite();
+        pfDrain();
+    }
+    u64Elapsed = TEST_u64Nsec() - u64Start;
+    u32Sections = HOST_sStats.u32CriticalSections;
+
+    HOST_vSerialInit();
+    HOST_vTimeCritical(TRUE);
+    for (n = 0; n < BENCH_MESSAGES; n++) {
+        pfWrite();
+        pfDrain();
+    }
+    HOST_vTimeCritical(FALSE);
+    u64Masked = HOST_sStats.u64CriticalNsec;
+    u64Masked = (u64Masked > u64Overhead * u32Sections) ? u64Masked - u64Overhead * u32Sections : 0;
+
+    printf("%-22s %10.1f %10.2f %12.1f\n",
+           pcName,
+           (double)u64Elapsed / BENCH_MESSAGES,
+           (double)u32Sections / BENCH_MESSAGES,
+           (double)u64Masked / BENCH_MESSAGES);
+}
+
+/* The text reply as APP_WriteMessageToSerial sent it before, one queued
+ * character at a time */
+PRIVATE void vCharText(void)
+{
+    const char *pc;
+
+    for (pc = acText; *pc != '\0'; pc++) {
+        vWriteTxChar((uint8)*pc);
+    }
+}
+
+/* A framed reply assembled into a temporary buffer, then written a
+ * character at a time */
+PRIVATE void vCharFrame(void)
+{
+    uint8 au8Payload[sizeof(au8Header) + FRAME_DATA_SIZE];
+    uint8 au8Encoded[2 * (sizeof(au8Payload) + 8)];
+    uint16 u16Length;
+    uint16 i;
+
+    memcpy(au8Payload, au8Header, sizeof(au8Header));
+    memcpy(&au8Payload[sizeof(au8Header)], au8FrameData, FRAME_DATA_SIZE);
+    u16Length = HOST_u16Encode(au8Encoded, BENCH_FRAME_TYPE, au8Payload, sizeof(au8Payload));
+    for (i = 0; i < u16Length; i++) {
+        vWriteTxChar(au8Encoded[i]);
+    }
+}
+
+PRIVATE void vBulkText(void)
+{
+    APP_WriteMessageToSerial(acText);
+}
+
+PRIVATE void vGatheredFrame(void)
+{
+    APP_tsSerialIoVec asPayload[2];
+
+    asPayload[0].pu8Data = au8Header;
+    asPayload[0].u16Length = sizeof(au8Header);
+    asPayload[1].pu8Data = au8FrameData;
+    asPayload[1].u16Length = FRAME_DATA_SIZE;
+    APP_bWriteFrameToSerial(BENCH_FRAME_TYPE, asPayload, 2);
+}
+
+/* TX interrupts of the per-character path, one byte per queue receive */
+PRIVATE void vCharDrain(void)
+{
+    uint8 u8Char;
+
+    while (ZQ_bQueueReceive(&sTxQueue, &u8Char)) {
+        u8Sink = u8Char;
+    }
+    bCharTxActive = FALSE;
+}
+
+PRIVATE void vBulkDrain(void)
+{
+    HOST_vUartDrain();
+    HOST_vWireReset();
+}
+
+/* APP_vWriteTxChar as it was: interrupts masked around every character */
+PRIVATE void vWriteTxChar(uint8 u8Char)
+{
+    HOST_vEnterCritical();
+
+    if (!bCharTxActive && ZQ_bQueueIsEmpty(&sTxQueue)) {
+        /* send byte now and enable irq */
+        bCharTxActive = TRUE;
+        u8Sink = u8Char;
+    }
+    else {
+        ZQ_bQueueSend(&sTxQueue, &u8Char);
+    }
+
+    HOST_vExitCritical();
+}
+
+/* Time an empty critical section, which is what timing one adds */
+PRIVATE uint64 u64ClockOverhead(void)
+{
+    uint32 n;
+
+    memset(&HOST_sStats, 0, sizeof(HOST_sStats));
+    HOST_vTimeCritical(TRUE);
+    for (n = 0; n < BENCH_MESSAGES; n++) {
+        HOST_vEnterCritical();
+        HOST_vExitCritical();
+    }
+    HOST_vTimeCritical(FALSE);
+
+    return HOST_sStats.u64CriticalNsec / BENCH_MESSAGES;
+}
+
+/****************************************************************************/
+/***        END OF FILE                                                   ***/
+/****************************************************************************/
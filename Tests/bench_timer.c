@@ -0,0 +1,228 @@
+/****************************************************************************
+ *
+ * MODULE:              Lumi Router
+ *
+ * COMPONENT:           bench_timer.c
+ *
+ * DESCRIPTION:         Benchmark of the application timer wheel
+ *
+ ****************************************************************************
+ *
+ * This software is owned by NXP B.V. and/or its supplier and is protected
+ * under applicable copyright laws. All rights are reserved. We grant You,
+ * and any third parties, a license to use this software solely and
+ * exclusively on NXP products [NXP Microcontrollers such as JN5168, JN5179].
+ * You, and any third parties must reproduce the copyright and warranty notice
+ * and any other legend of ownership on each copy or partial copy of the
+ * software.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+ * AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+ * IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE
+ * ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE
+ * LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR
+ * CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF
+ * SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS
+ * INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN
+ * CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE)
+ * ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+ * POSSIBILITY OF SUCH DAMAGE.
+ *
+ * Copyright NXP B.V. 2016. All rights reserved
+ *
+ ****************************************************************************/
+
+/****************************************************************************/
+/***        Include Files                                                 ***/
+/****************************************************************************/
+
+#include <jendefs.h>
+#include <stdio.h>
+
+/* Application */
+#include "app_clock.h"
+#include "app_timer.h"
+#include "test.h"
+
+/* SDK JN-SW-4170 */
+#include "ZTimer.h"
+
+/****************************************************************************/
+/***        Macro Definitions                                             ***/
+/****************************************************************************/
+
+#define BENCH_SECONDS   60
+#define BENCH_MAX_TIMERS 5000
+
+/* ZTimer indices are 8-bit */
+#define BENCH_MAX_SLOTS 255
+
+/* Periods of the timers */
+#define BENCH_MIN_MSEC 100
+#define BENCH_MAX_MSEC 60000
+
+#define BENCH_RESTARTS 1000000
+
+/****************************************************************************/
+/***        Type Definitions                                              ***/
+/****************************************************************************/
+
+typedef struct {
+    uint64 u64Nsec;
+    uint32 u32Expiries;
+} tsResult;
+
+/****************************************************************************/
+/***        Local Function Prototypes                                     ***/
+/****************************************************************************/
+
+PRIVATE void vRunSlots(uint32 u32Timers, tsResult *psResult);
+PRIVATE void vRunWheel(uint32 u32Timers, tsResult *psResult, uint64 *pu64RestartNsec);
+PRIVATE void vTicks(uint32 u32Count);
+PRIVATE void vSlotExpired(void *pvParam);
+PRIVATE void vWheelExpired(void *pvParam);
+
+/****************************************************************************/
+/***        Local Variables                                               ***/
+/****************************************************************************/
+
+PRIVATE const uint32 au32Timers[] = {16, 64, 255, 1000, BENCH_MAX_TIMERS};
+
+PRIVATE uint32 u32ClockMsec;
+PRIVATE uint32 u32Expiries;
+
+PRIVATE uint32 au32Period[BENCH_MAX_TIMERS];
+PRIVATE uint8 au8Slot[BENCH_MAX_SLOTS];
+PRIVATE ZTIMER_tsTimer asSlots[BENCH_MAX_SLOTS];
+PRIVATE APP_tsTimer asTimers[BENCH_MAX_TIMERS];
+PRIVATE ZTIMER_tsTimer sWheelSlot;
+
+/****************************************************************************/
+/***        Exported Functions                                            ***/
+/****************************************************************************/
+
+int main(void)
+{
+    tsResult sSlots;
+    tsResult sWheel;
+    uint64 u64RestartNsec;
+    uint32 u32Seed = 1;
+    uint32 i;
+
+    /* The same periods for both, from a fixed seed */
+    for (i = 0; i < BENCH_MAX_TIMERS; i++) {
+        u32Seed = u32Seed * 1103515245 + 12345;
+        au32Period[i] = BENCH_MIN_MSEC + (u32Seed >> 8) % (BENCH_MAX_MSEC - BENCH_MIN_MSEC);
+    }
+
+    printf("Periodic timers of %u to %u ms over %u s, the ZTimer task run every 1 ms tick\n",
+           BENCH_MIN_MSEC,
+           BENCH_MAX_MSEC,
+           BENCH_SECONDS);
+    printf("%-8s %14s %14s %12s %18s\n", "Timers", "slots ns/s", "wheel ns/s", "expiries/s", "wheel restart ns");
+
+    for (i = 0; i < sizeof(au32Timers) / sizeof(au32Timers[0]); i++) {
+        vRunWheel(au32Timers[i], &sWheel, &u64RestartNsec);
+        if (au32Timers[i] <= BENCH_MAX_SLOTS) {
+            vRunSlots(au32Timers[i], &sSlots);
+            printf("%-8u %14.0f", au32Timers[i], (double)sSlots.u64Nsec / BENCH_SECONDS);
+        }
+        else {
+            printf("%-8u %14s", au32Timers[i], "-");
+        }
+        printf(" %14.0f %12.1f %18.1f\n",
+               (double)sWheel.u64Nsec / BENCH_SECONDS,
+               (double)sWheel.u32Expiries / BENCH_SECONDS,
+               (double)u64RestartNsec / BENCH_RESTARTS);
+    }
+
+    return 0;
+}
+
+PUBLIC uint32 APP_u32ClockMsec(void)
+{
+    return u32ClockMsec;
+}
+
+/****************************************************************************/
+/***        Local Functions                                               ***/
+/****************************************************************************/
+
+/* One ZTimer slot per timer, as before the wheel. ZTIMER_vTask visits
+ * every slot on every run. */
+PRIVATE void vRunSlots(uint32 u32Timers, tsResult *psResult)
+{
+    uint64 u64Start;
+    uint32 i;
+
+    ZTIMER_eInit(asSlots, (uint8)u32Timers);
+    for (i = 0; i < u32Timers; i++) {
+        ZTIMER_eOpen(&au8Slot[i], vSlotExpired, &au32Period[i], ZTIMER_FLAG_PREVENT_SLEEP);
+        ZTIMER_eStart(au8Slot[i], ZTIMER_TIME_MSEC(au32Period[i]));
+    }
+
+    u32Expiries = 0;
+    u64Start = TEST_u64Nsec();
+    vTicks(BENCH_SECONDS * 1000);
+    psResult->u64Nsec = TEST_u64Nsec() - u64Start;
+    psResult->u32Expiries = u32Expiries;
+}
+
+/* All timers on the wheel, which takes one ZTimer slot */
+PRIVATE void vRunWheel(uint32 u32Timers, tsResult *psResult, uint64 *pu64RestartNsec)
+{
+    uint64 u64Start;
+    uint32 i;
+
+    ZTIMER_eInit(&sWheelSlot, 1);
+    APP_vTimerInit();
+    for (i = 0; i < u32Timers; i++) {
+        APP_vTimerCreate(&asTimers[i], vWheelExpired, NULL);
+        APP_vTimerStartPeriodic(&asTimers[i], au32Period[i]);
+    }
+
+    u32Expiries = 0;
+    u64Start = TEST_u64Nsec();
+    vTicks(BENCH_SECONDS * 1000);
+    psResult->u64Nsec = TEST_u64Nsec() - u64Start;
+    psResult->u32Expiries = u32Expiries;
+
+    /* Stop and start again with all of them running */
+    u64Start = TEST_u64Nsec();
+    for (i = 0; i < BENCH_RESTARTS; i++) {
+        APP_vTimerStop(&asTimers[i % u32Timers]);
+        APP_vTimerStartPeriodic(&asTimers[i % u32Timers], au32Period[i % u32Timers]);
+    }
+    *pu64RestartNsec = TEST_u64Nsec() - u64Start;
+
+    for (i = 0; i < u32Timers; i++) {
+        APP_vTimerStop(&asTimers[i]);
+    }
+}
+
+/* Tick interrupts, each followed by a run of the ZTimer task */
+PRIVATE void vTicks(uint32 u32Count)
+{
+    while (u32Count-- > 0) {
+        u32ClockMsec++;
+        ISR_vTickTimer();
+        ZTIMER_vTask();
+    }
+}
+
+PRIVATE void vSlotExpired(void *pvParam)
+{
+    uint32 u32Index = (uint32)((uint32 *)pvParam - au32Period);
+
+    u32Expiries++;
+    ZTIMER_eStart(au8Slot[u32Index], ZTIMER_TIME_MSEC(au32Period[u32Index]));
+}
+
+PRIVATE void vWheelExpired(void *pvParam)
+{
+    u32Expiries++;
+}
+
+/****************************************************************************/
+/***        END OF FILE                                                   ***/
+/****************************************************************************/
@@ -0,0 +1,125 @@
+/****************************************************************************
+ *
+ * MODULE:              Lumi Router
+ *
+ * COMPONENT:           host_clock.c
+ *
+ * DESCRIPTION:         Host model of the tick interrupt
+ *
+ ****************************************************************************
+ *
+ * This software is owned by NXP B.V. and/or its supplier and is protected
+ * under applicable copyright laws. All rights are reserved. We grant You,
+ * and any third parties, a license to use this software solely and
+ * exclusively on NXP products [NXP Microcontrollers such as JN5168, JN5179].
+ * You, and any third parties must reproduce the copyright and warranty notice
+ * and any other legend of ownership on each copy or partial copy of the
+ * software.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+ * AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+ * IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE
+ * ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE
+ * LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR
+ * CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF
+ * SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS
+ * INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN
+ * CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE)
+ * ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+ * POSSIBILITY OF SUCH DAMAGE.
+ *
+ * Copyright NXP B.V. 2016. All rights reserved
+ *
+ ****************************************************************************/
+
+/* The clock of app_clock.c and the critical sections of the SDK, for the
+ * tests of the modules driven by the tick interrupt. HOST_vTick does what
+ * APP_isrTickTimer does. */
+
+/****************************************************************************/
+/***        Include Files                                                 ***/
+/****************************************************************************/
+
+#include <jendefs.h>
+
+/* Application */
+#include "app_clock.h"
+#include "app_ztimer.h"
+#include "host_clock.h"
+
+/* SDK JN-SW-4170 */
+#include "ZTimer.h"
+#include "portmacro.h"
+
+/****************************************************************************/
+/***        Exported Variables                                            ***/
+/****************************************************************************/
+
+PUBLIC uint32 HOST_u32ClockMsec;
+PUBLIC uint32 HOST_u32ClockExtraTicks;
+PUBLIC bool_t HOST_bMasked;
+PUBLIC uint32 HOST_u32CriticalSections;
+
+/****************************************************************************/
+/***        Exported Functions                                            ***/
+/****************************************************************************/
+
+/****************************************************************************
+ *
+ * NAME: HOST_vClockInit
+ *
+ * DESCRIPTION:
+ * Set the clock, for tests that start away from zero to cover wrapping
+ *
+ ****************************************************************************/
+PUBLIC void HOST_vClockInit(uint32 u32Msec)
+{
+    HOST_u32ClockMsec = u32Msec;
+    HOST_u32ClockExtraTicks = 0;
+    HOST_bMasked = FALSE;
+    HOST_u32CriticalSections = 0;
+}
+
+/****************************************************************************
+ *
+ * NAME: HOST_vTick
+ *
+ * DESCRIPTION:
+ * One millisecond tick interrupt, as APP_isrTickTimer
+ *
+ ****************************************************************************/
+PUBLIC void HOST_vTick(void)
+{
+    HOST_u32ClockMsec++;
+    ISR_vTickTimer();
+    APP_vZTimerTickIsr(HOST_u32ClockMsec);
+}
+
+PUBLIC uint32 APP_u32ClockTicks(void)
+{
+    return HOST_u32ClockMsec * APP_CLOCK_TICKS_PER_MSEC + HOST_u32ClockExtraTicks;
+}
+
+PUBLIC uint32 APP_u32ClockMsec(void)
+{
+    return HOST_u32ClockMsec;
+}
+
+/* Sections nest on the JN516x, as each restores the state it saved */
+PUBLIC uint8 ZPS_eEnterCriticalSection(void *hMutex, uint32 *psIntStore)
+{
+    *psIntStore = HOST_bMasked;
+    HOST_bMasked = TRUE;
+    HOST_u32CriticalSections++;
+    return 0;
+}
+
+PUBLIC uint8 ZPS_eExitCriticalSection(void *hMutex, uint32 *psIntStore)
+{
+    HOST_bMasked = (bool_t)*psIntStore;
+    return 0;
+}
+
+/****************************************************************************/
+/***        END OF FILE                                                   ***/
+/****************************************************************************/
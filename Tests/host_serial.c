@@ -0,0 +1,752 @@
+/****************************************************************************
+ *
+ * MODULE:              Lumi Router
+ *
+ * COMPONENT:           host_serial.c
+ *
+ * DESCRIPTION:         Host harness for the serial link
+ *
+ ****************************************************************************
+ *
+ * This software is owned by NXP B.V. and/or its supplier and is protected
+ * under applicable copyright laws. All rights are reserved. We grant You,
+ * and any third parties, a license to use this software solely and
+ * exclusively on NXP products [NXP Microcontrollers such as JN5168, JN5179].
+ * You, and any third parties must reproduce the copyright and warranty notice
+ * and any other legend of ownership on each copy or partial copy of the
+ * software.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+ * AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+ * IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE
+ * ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE
+ * LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR
+ * CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF
+ * SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS
+ * INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN
+ * CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE)
+ * ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+ * POSSIBILITY OF SUCH DAMAGE.
+ *
+ * Copyright NXP B.V. 2016. All rights reserved
+ *
+ ****************************************************************************/
+
+/* Builds the serial command module as it is linked into the firmware, with
+ * the rings and queue of app_main.c, a model of the UART transmit path and
+ * stand-ins for the rest of the application. The test plays the host: it
+ * encodes frames into the RX ring and decodes what the UART model sent. */
+
+/****************************************************************************/
+/***        Include Files                                                 ***/
+/****************************************************************************/
+
+#include <jendefs.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+/* Application */
+#include "app_capture.h"
+#include "app_clock.h"
+#include "app_cpu.h"
+#include "app_crc16.h"
+#include "app_log.h"
+#include "app_main.h"
+#include "app_pt.h"
+#include "app_queue.h"
+#include "app_ring_buffer.h"
+#include "app_scheduler.h"
+#include "app_serial_commands.h"
+#include "app_stack.h"
+#include "app_timer.h"
+#include "host_serial.h"
+#include "test.h"
+#include "uart.h"
+
+/* SDK JN-SW-4170 */
+#include "PDM.h"
+#include "ZQueue.h"
+
+/****************************************************************************/
+/***        Macro Definitions                                             ***/
+/****************************************************************************/
+
+#define SL_START_CHAR 0x01
+#define SL_ESC_CHAR   0x02
+#define SL_END_CHAR   0x03
+
+/* Sizes from app_main.c */
+#define TX_RING_SIZE        128
+#define RX_RING_SIZE        256
+#define RESPONSE_QUEUE_SIZE 256
+#define EVENT_QUEUE_SIZE    64
+#define TELEMETRY_QUEUE_SIZE 1024
+#define LOG_QUEUE_SIZE      256
+
+#define UART_TX_FIFO_SIZE 16
+
+/* Serial task passes after which HOST_vRunSerial gives up */
+#define MAX_PASSES 10000
+
+/****************************************************************************/
+/***        Local Function Prototypes                                     ***/
+/****************************************************************************/
+
+PRIVATE void vFillTxFifo(void);
+PRIVATE bool_t bSerialIdle(void);
+PRIVATE uint16 u16Check(const uint8 *pu8Data, uint16 u16Length);
+PRIVATE uint8 *pu8PutEscaped(uint8 *pu8Out, uint8 u8Byte);
+
+/****************************************************************************/
+/***        Exported Variables                                            ***/
+/****************************************************************************/
+
+HOST_tsStats HOST_sStats;
+uint32 HOST_u32Msec;
+
+/* Globals of app_main.c used by the serial module */
+PUBLIC APP_tsTimer sTimerRestart;
+PUBLIC APP_tsTimer sTimerBaudRate;
+PUBLIC tszQueue APP_msgSerialFrames;
+PUBLIC RB_tsRingBuffer APP_rbSerialTx;
+PUBLIC RB_tsRingBuffer APP_rbSerialRx;
+PUBLIC RB_tsRingBuffer APP_rbSerialChannel[E_SERIAL_CHANNEL_COUNT];
+
+/* Every module logs at off, so no record is ever made */
+PUBLIC uint8 au8LogModuleLevel[E_LOG_MODULE_COUNT];
+
+/****************************************************************************/
+/***        Local Variables                                               ***/
+/****************************************************************************/
+
+PRIVATE uint8 au8SerialTx[TX_RING_SIZE];
+PRIVATE uint8 au8SerialRx[RX_RING_SIZE];
+PRIVATE uint8 au8SerialResponse[RESPONSE_QUEUE_SIZE];
+PRIVATE uint8 au8SerialEvent[EVENT_QUEUE_SIZE];
+PRIVATE uint8 au8SerialTelemetry[TELEMETRY_QUEUE_SIZE];
+PRIVATE uint8 au8SerialLog[LOG_QUEUE_SIZE];
+PRIVATE APP_tsSerialFrame *apsSerialFrames[SERIAL_FRAME_POOL_SIZE];
+
+/* Framing version the host side uses */
+PRIVATE uint8 u8HostVersion = 1;
+
+/* UART model: bytes in the TX FIFO and whether the TX interrupt is on */
+PRIVATE uint16 u16TxFifoLevel;
+PRIVATE bool_t bTxActive;
+PRIVATE bool_t bTxHeld;
+PRIVATE uint32 u32BaudRate = 115200;
+
+PRIVATE bool_t bPtReady;
+
+PRIVATE bool_t bTimeCritical;
+PRIVATE uint64 u64CriticalStart;
+
+PRIVATE uint8 au8Wire[HOST_WIRE_SIZE];
+PRIVATE uint32 u32WireWrite;
+PRIVATE uint32 u32WireRead;
+
+/****************************************************************************/
+/***        Exported Functions                                            ***/
+/****************************************************************************/
+
+/****************************************************************************
+ *
+ * NAME: HOST_vSerialInit
+ *
+ * DESCRIPTION:
+ * Create the rings and the frame queue as APP_vInitResources does, and
+ * start with an idle UART and an empty wire. The state of the serial module
+ * itself carries over from earlier tests in the same program.
+ *
+ ****************************************************************************/
+PUBLIC void HOST_vSerialInit(void)
+{
+    RB_vInit(&APP_rbSerialTx, au8SerialTx, sizeof(au8SerialTx));
+    RB_vInit(&APP_rbSerialRx, au8SerialRx, sizeof(au8SerialRx));
+    RB_vInit(&APP_rbSerialChannel[E_SERIAL_CHANNEL_RESPONSE], au8SerialResponse, sizeof(au8SerialResponse));
+    RB_vInit(&APP_rbSerialChannel[E_SERIAL_CHANNEL_EVENT], au8SerialEvent, sizeof(au8SerialEvent));
+    RB_vInit(&APP_rbSerialChannel[E_SERIAL_CHANNEL_TELEMETRY], au8SerialTelemetry, sizeof(au8SerialTelemetry));
+    RB_vInit(&APP_rbSerialChannel[E_SERIAL_CHANNEL_LOG], au8SerialLog, sizeof(au8SerialLog));
+    ZQ_vQueueCreate(&APP_msgSerialFrames,
+                    SERIAL_FRAME_POOL_SIZE,
+                    sizeof(APP_tsSerialFrame *),
+                    (uint8 *)apsSerialFrames);
+
+    u16TxFifoLevel = 0;
+    bTxActive = FALSE;
+    memset(&HOST_sStats, 0, sizeof(HOST_sStats));
+    HOST_vWireReset();
+}
+
+/****************************************************************************
+ *
+ * NAME: HOST_vSetVersion
+ *
+ * DESCRIPTION:
+ * Select the framing the host side encodes and decodes with
+ *
+ ****************************************************************************/
+PUBLIC void HOST_vSetVersion(uint8 u8Version)
+{
+    u8HostVersion = u8Version;
+}
+
+/****************************************************************************
+ *
+ * NAME: HOST_u16Encode
+ *
+ * DESCRIPTION:
+ * Encode a frame as a host would send it
+ *
+ * RETURNS:
+ * Number of bytes written to pu8Out, which needs room for every byte escaped
+ *
+ ****************************************************************************/
+PUBLIC uint16 HOST_u16Encode(uint8 *pu8Out, uint16 u16Type, const uint8 *pu8Data, uint16 u16Length)
+{
+    uint8 au8Header[4];
+    uint8 *pu8 = pu8Out;
+    uint16 u16Crc;
+    uint16 i;
+
+    au8Header[0] = (uint8)(u16Type >> 8);
+    au8Header[1] = (uint8)u16Type;
+    au8Header[2] = (uint8)(u16Length >> 8);
+    au8Header[3] = (uint8)u16Length;
+
+    if (u8HostVersion >= 2) {
+        u16Crc = CRC16_u16UpdateBlock(CRC16_INIT, au8Header, sizeof(au8Header));
+        u16Crc = CRC16_u16UpdateBlock(u16Crc, pu8Data, u16Length);
+    }
+    else {
+        u16Crc = u16Check(au8Header, sizeof(au8Header)) ^ u16Check(pu8Data, u16Length);
+    }
+
+    *pu8++ = SL_START_CHAR;
+    for (i = 0; i < sizeof(au8Header); i++) {
+        pu8 = pu8PutEscaped(pu8, au8Header[i]);
+    }
+    if (u8HostVersion >= 2) {
+        pu8 = pu8PutEscaped(pu8, (uint8)(u16Crc >> 8));
+    }
+    pu8 = pu8PutEscaped(pu8, (uint8)u16Crc);
+    for (i = 0; i < u16Length; i++) {
+        pu8 = pu8PutEscaped(pu8, pu8Data[i]);
+    }
+    *pu8++ = SL_END_CHAR;
+
+    return (uint16)(pu8 - pu8Out);
+}
+
+/****************************************************************************
+ *
+ * NAME: HOST_vSendFrame
+ *
+ * DESCRIPTION:
+ * Encode a frame into the RX ring, as the UART interrupt would receive it
+ *
+ ****************************************************************************/
+PUBLIC void HOST_vSendFrame(uint16 u16Type, const uint8 *pu8Data, uint16 u16Length)
+{
+    uint8 au8Encoded[2 * (MAX_PACKET_SIZE + 8)];
+    uint16 u16Encoded = HOST_u16Encode(au8Encoded, u16Type, pu8Data, u16Length);
+
+    if (RB_u16PushN(&APP_rbSerialRx, au8Encoded, u16Encoded) != u16Encoded) {
+        printf("host_serial: RX ring full\n");
+        exit(2);
+    }
+}
+
+/****************************************************************************
+ *
+ * NAME: HOST_vSendRequest
+ *
+ * DESCRIPTION:
+ * Send a version 3 request: the sequence number, then the data
+ *
+ ****************************************************************************/
+PUBLIC void HOST_vSendRequest(uint16 u16Type, uint8 u8Seq, const uint8 *pu8Data, uint16 u16Length)
+{
+    uint8 au8Payload[MAX_PACKET_SIZE];
+
+    au8Payload[0] = u8Seq;
+    if (u16Length > 0) {
+        memcpy(&au8Payload[1], pu8Data, u16Length);
+    }
+    HOST_vSendFrame(u16Type, au8Payload, u16Length + 1);
+}
+
+/****************************************************************************
+ *
+ * NAME: HOST_vRunSerial
+ *
+ * DESCRIPTION:
+ * Run the serial task, the protothreads and the UART interrupt model until
+ * nothing is left to receive or send. While TX is held only one pass runs.
+ *
+ ****************************************************************************/
+PUBLIC void HOST_vRunSerial(void)
+{
+    uint32 u32Passes;
+
+    for (u32Passes = 0; u32Passes < MAX_PASSES; u32Passes++) {
+        APP_taskAtSerial();
+        if (bPtReady) {
+            bPtReady = FALSE;
+            APP_taskPt();
+        }
+        HOST_vUartDrain();
+
+        if (bTxHeld || bSerialIdle()) {
+            return;
+        }
+    }
+
+    printf("host_serial: serial task still busy after %u passes\n", MAX_PASSES);
+    exit(2);
+}
+
+/****************************************************************************
+ *
+ * NAME: HOST_vUartTxInterrupt
+ *
+ * DESCRIPTION:
+ * TX FIFO empty interrupt: what was in the FIFO is on the wire, refill it
+ * from the TX ring or turn the interrupt off
+ *
+ ****************************************************************************/
+PUBLIC void HOST_vUartTxInterrupt(void)
+{
+    if (!bTxActive || bTxHeld) {
+        return;
+    }
+
+    HOST_sStats.u32TxInterrupts++;
+    u16TxFifoLevel = 0;
+    vFillTxFifo();
+    if (u16TxFifoLevel == 0) {
+        bTxActive = FALSE;
+    }
+}
+
+/****************************************************************************
+ *
+ * NAME: HOST_vUartDrain
+ *
+ * DESCRIPTION:
+ * Take TX interrupts until the TX ring is empty and the UART idle
+ *
+ ****************************************************************************/
+PUBLIC void HOST_vUartDrain(void)
+{
+    while (bTxActive && !bTxHeld) {
+        HOST_vUartTxInterrupt();
+    }
+}
+
+/****************************************************************************
+ *
+ * NAME: HOST_vHoldTx
+ *
+ * DESCRIPTION:
+ * Stop or restart the UART sending, as CTS would, so data backs up into
+ * the TX ring and the channel queues
+ *
+ ****************************************************************************/
+PUBLIC void HOST_vHoldTx(bool_t bHold)
+{
+    bTxHeld = bHold;
+}
+
+/****************************************************************************
+ *
+ * NAME: HOST_vEnterCritical
+ *
+ * DESCRIPTION:
+ * Stand-in for ZPS_eEnterCriticalSection, counting the sections and, when
+ * timing is on, the time spent in them
+ *
+ ****************************************************************************/
+PUBLIC void HOST_vEnterCritical(void)
+{
+    HOST_sStats.u32CriticalSections++;
+    if (bTimeCritical) {
+        u64CriticalStart = TEST_u64Nsec();
+    }
+}
+
+/****************************************************************************
+ *
+ * NAME: HOST_vExitCritical
+ *
+ * DESCRIPTION:
+ * Stand-in for ZPS_eExitCriticalSection
+ *
+ ****************************************************************************/
+PUBLIC void HOST_vExitCritical(void)
+{
+    if (bTimeCritical) {
+        HOST_sStats.u64CriticalNsec += TEST_u64Nsec() - u64CriticalStart;
+    }
+}
+
+/****************************************************************************
+ *
+ * NAME: HOST_vTimeCritical
+ *
+ * DESCRIPTION:
+ * Turn timing of critical sections on or off. Timing reads the clock twice
+ * per section, which the benchmark allows for.
+ *
+ ****************************************************************************/
+PUBLIC void HOST_vTimeCritical(bool_t bEnable)
+{
+    bTimeCritical = bEnable;
+}
+
+/****************************************************************************
+ *
+ * NAME: HOST_bReadFrame
+ *
+ * DESCRIPTION:
+ * Decode the next frame the firmware sent, with the host side framing.
+ * Bytes outside frames, such as the legacy text replies, are skipped.
+ *
+ * RETURNS:
+ * FALSE if the wire holds no complete frame
+ *
+ ****************************************************************************/
+PUBLIC bool_t HOST_bReadFrame(HOST_tsFrame *psFrame)
+{
+    uint8 au8Frame[MAX_PACKET_SIZE + 8];
+    uint8 u8HeaderLength = (u8HostVersion >= 2) ? 6 : 5;
+    uint32 u32Pos = u32WireRead;
+    uint16 u16Bytes = 0;
+    uint16 u16Crc;
+    uint16 u16RxCrc;
+    bool_t bEsc = FALSE;
+    uint8 u8Byte;
+
+    while ((u32Pos < u32WireWrite) && (au8Wire[u32Pos] != SL_START_CHAR)) {
+        u32Pos++;
+    }
+    if (u32Pos == u32WireWrite) {
+        u32WireRead = u32Pos;
+        return FALSE;
+    }
+
+    for (u32Pos++; u32Pos < u32WireWrite; u32Pos++) {
+        u8Byte = au8Wire[u32Pos];
+        if (u8Byte == SL_END_CHAR) {
+            break;
+        }
+        if (u8Byte == SL_ESC_CHAR) {
+            bEsc = TRUE;
+            continue;
+        }
+        if (bEsc) {
+            u8Byte ^= 0x10;
+            bEsc = FALSE;
+        }
+        if (u16Bytes < sizeof(au8Frame)) {
+            au8Frame[u16Bytes++] = u8Byte;
+        }
+    }
+    if (u32Pos == u32WireWrite) {
+        return FALSE;
+    }
+    u32WireRead = u32Pos + 1;
+
+    if (u16Bytes < u8HeaderLength) {
+        memset(psFrame, 0, sizeof(*psFrame));
+        return TRUE;
+    }
+
+    psFrame->u16Type = ((uint16)au8Frame[0] << 8) | au8Frame[1];
+    psFrame->u16Length = u16Bytes - u8HeaderLength;
+    memcpy(psFrame->au8Data, &au8Frame[u8HeaderLength], psFrame->u16Length);
+
+    if (u8HostVersion >= 2) {
+        u16RxCrc = ((uint16)au8Frame[4] << 8) | au8Frame[5];
+        u16Crc = CRC16_u16UpdateBlock(CRC16_INIT, au8Frame, 4);
+        u16Crc = CRC16_u16UpdateBlock(u16Crc, psFrame->au8Data, psFrame->u16Length);
+    }
+    else {
+        u16RxCrc = au8Frame[4];
+        u16Crc = u16Check(au8Frame, 4) ^ u16Check(psFrame->au8Data, psFrame->u16Length);
+    }
+    psFrame->bCheckOk = (u16Crc == u16RxCrc) && (psFrame->u16Length == (((uint16)au8Frame[2] << 8) | au8Frame[3]));
+
+    return TRUE;
+}
+
+/****************************************************************************
+ *
+ * NAME: HOST_u32WireRead
+ *
+ * DESCRIPTION:
+ * Take raw bytes the firmware sent
+ *
+ * RETURNS:
+ * Number of bytes copied
+ *
+ ****************************************************************************/
+PUBLIC uint32 HOST_u32WireRead(uint8 *pu8Out, uint32 u32Size)
+{
+    uint32 u32Length = u32WireWrite - u32WireRead;
+
+    if (u32Length > u32Size) {
+        u32Length = u32Size;
+    }
+    memcpy(pu8Out, &au8Wire[u32WireRead], u32Length);
+    u32WireRead += u32Length;
+
+    return u32Length;
+}
+
+/****************************************************************************
+ *
+ * NAME: HOST_vWireReset
+ *
+ * DESCRIPTION:
+ * Forget everything sent so far
+ *
+ ****************************************************************************/
+PUBLIC void HOST_vWireReset(void)
+{
+    u32WireWrite = 0;
+    u32WireRead = 0;
+}
+
+/****************************************************************************/
+/***        Stand-ins for the rest of the application                     ***/
+/****************************************************************************/
+
+PUBLIC void UART_vStartTx(void)
+{
+    if (bTxActive || RB_bIsEmpty(&APP_rbSerialTx)) {
+        return;
+    }
+
+    HOST_vEnterCritical();
+    if (!bTxActive && !RB_bIsEmpty(&APP_rbSerialTx)) {
+        bTxActive = TRUE;
+        if (!bTxHeld) {
+            vFillTxFifo();
+        }
+    }
+    HOST_vExitCritical();
+}
+
+PUBLIC bool_t UART_bTxIdle(void)
+{
+    return RB_bIsEmpty(&APP_rbSerialTx) && !bTxActive;
+}
+
+PUBLIC bool_t UART_bIsBaudRateSupported(uint32 u32Rate)
+{
+    return (u32Rate == 115200) || (u32Rate == 230400) || (u32Rate == 460800);
+}
+
+PUBLIC bool_t UART_bSetBaudRate(uint32 u32Rate)
+{
+    HOST_sStats.u32BaudRateChanges++;
+    u32BaudRate = u32Rate;
+    return TRUE;
+}
+
+PUBLIC uint32 UART_u32GetBaudRate(void)
+{
+    return u32BaudRate;
+}
+
+PUBLIC void UART_vGetStats(UART_tsStats *psStats)
+{
+    memset(psStats, 0, sizeof(*psStats));
+}
+
+PUBLIC void UART_vResetStats(void)
+{
+}
+
+PUBLIC void UART_vResumeRxFlow(void)
+{
+}
+
+PUBLIC uint32 APP_u32ClockTicks(void)
+{
+    return HOST_u32Msec * APP_CLOCK_TICKS_PER_MSEC;
+}
+
+PUBLIC uint32 APP_u32ClockMsec(void)
+{
+    return HOST_u32Msec;
+}
+
+PUBLIC void APP_vTimerStart(APP_tsTimer *psTimer, uint32 u32Msec)
+{
+    (void)u32Msec;
+    if (psTimer == &sTimerRestart) {
+        HOST_sStats.u32RestartsStarted++;
+    }
+}
+
+PUBLIC void APP_vTimerStop(APP_tsTimer *psTimer)
+{
+    (void)psTimer;
+}
+
+PUBLIC void APP_vSetTaskReady(APP_teTask eTask)
+{
+    if (eTask == E_APP_TASK_PT) {
+        bPtReady = TRUE;
+    }
+}
+
+PUBLIC void PDM_vDeleteAllDataRecords(void)
+{
+    HOST_sStats.u32PdmErases++;
+}
+
+PUBLIC void APP_vLog(uint16 u16Id, uint8 u8Count, ...)
+{
+    (void)u16Id;
+    (void)u8Count;
+}
+
+PUBLIC void APP_vLogSetLevel(APP_teLogModule eModule, APP_teLogLevel eLevel)
+{
+    (void)eModule;
+    (void)eLevel;
+}
+
+PUBLIC uint16 APP_u16LogRead(uint8 *pu8Buffer, uint16 u16Size)
+{
+    (void)pu8Buffer;
+    (void)u16Size;
+    return 0;
+}
+
+PUBLIC bool_t APP_bLogIsEmpty(void)
+{
+    return TRUE;
+}
+
+PUBLIC void APP_vCaptureConfigure(bool_t bEnable, uint16 u16RecordsPerSec, uint8 u8SnapLength)
+{
+    (void)bEnable;
+    (void)u16RecordsPerSec;
+    (void)u8SnapLength;
+}
+
+PUBLIC void APP_vGetCaptureStats(APP_tsCaptureStats *psStats)
+{
+    memset(psStats, 0, sizeof(*psStats));
+}
+
+/* Task stats filled with a pattern, so the largest reply has known content */
+PUBLIC void APP_vGetTaskStats(uint8 u8Slot, APP_tsTaskStats *psStats)
+{
+    uint8 i;
+
+    psStats->u32Runs = 0x01000000UL | u8Slot;
+    psStats->u32MinTicks = 0x02000000UL | u8Slot;
+    psStats->u32MaxTicks = 0x03000000UL | u8Slot;
+    psStats->u64SumTicks = 0x0400000005000000ULL | u8Slot;
+    for (i = 0; i < APP_TASK_HISTOGRAM_BINS; i++) {
+        psStats->au32Histogram[i] = 0x10000000UL | ((uint32)i << 8) | u8Slot;
+    }
+}
+
+PUBLIC void APP_vResetTaskStats(void)
+{
+}
+
+PUBLIC void APP_vGetQueueStats(APP_teQueue eQueue, APP_tsQueueStats *psStats)
+{
+    (void)eQueue;
+    memset(psStats, 0, sizeof(*psStats));
+}
+
+PUBLIC void APP_vResetQueueStats(void)
+{
+}
+
+PUBLIC void APP_vGetStackStats(APP_tsStackStats *psStats)
+{
+    memset(psStats, 0, sizeof(*psStats));
+}
+
+PUBLIC void APP_vResetStackStats(void)
+{
+}
+
+PUBLIC void APP_vGetCpuStats(APP_tsCpuStats *psStats)
+{
+    memset(psStats, 0, sizeof(*psStats));
+}
+
+PUBLIC void APP_vResetCpuStats(void)
+{
+}
+
+/****************************************************************************/
+/***        Local Functions                                               ***/
+/****************************************************************************/
+
+/* Move what fits from the TX ring into the FIFO, which the model puts
+ * straight on the wire */
+PRIVATE void vFillTxFifo(void)
+{
+    uint16 u16Length;
+
+    u16Length = RB_u16PopN(&APP_rbSerialTx, &au8Wire[u32WireWrite], UART_TX_FIFO_SIZE - u16TxFifoLevel);
+    u32WireWrite += u16Length;
+    u16TxFifoLevel += u16Length;
+
+    if (u32WireWrite > (HOST_WIRE_SIZE - UART_TX_FIFO_SIZE)) {
+        printf("host_serial: wire buffer full\n");
+        exit(2);
+    }
+}
+
+PRIVATE bool_t bSerialIdle(void)
+{
+    uint8 i;
+
+    for (i = 0; i < E_SERIAL_CHANNEL_COUNT; i++) {
+        if (!RB_bIsEmpty(&APP_rbSerialChannel[i])) {
+            return FALSE;
+        }
+    }
+
+    return !bPtReady && !APP_bSerialHasWork() && UART_bTxIdle();
+}
+
+/* Version 1 check: XOR of every byte */
+PRIVATE uint16 u16Check(const uint8 *pu8Data, uint16 u16Length)
+{
+    uint8 u8Check = 0;
+
+    while (u16Length--) {
+        u8Check ^= *pu8Data++;
+    }
+
+    return u8Check;
+}
+
+PRIVATE uint8 *pu8PutEscaped(uint8 *pu8Out, uint8 u8Byte)
+{
+    if ((u8Byte >= SL_START_CHAR) && (u8Byte <= SL_END_CHAR)) {
+        *pu8Out++ = SL_ESC_CHAR;
+        u8Byte ^= 0x10;
+    }
+    *pu8Out++ = u8Byte;
+
+    return pu8Out;
+}
+
+/****************************************************************************/
+/***        END OF FILE                                                   ***/
+/****************************************************************************/
@@ -0,0 +1,107 @@
+/****************************************************************************
+ *
+ * MODULE:              Lumi Router
+ *
+ * COMPONENT:           host_serial.h
+ *
+ * DESCRIPTION:         Host harness for the serial link
+ *
+ ****************************************************************************
+ *
+ * This software is owned by NXP B.V. and/or its supplier and is protected
+ * under applicable copyright laws. All rights are reserved. We grant You,
+ * and any third parties, a license to use this software solely and
+ * exclusively on NXP products [NXP Microcontrollers such as JN5168, JN5179].
+ * You, and any third parties must reproduce the copyright and warranty notice
+ * and any other legend of ownership on each copy or partial copy of the
+ * software.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+ * AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+ * IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE
+ * ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE
+ * LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR
+ * CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF
+ * SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS
+ * INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN
+ * CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE)
+ * ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+ * POSSIBILITY OF SUCH DAMAGE.
+ *
+ * Copyright NXP B.V. 2016. All rights reserved
+ *
+ ****************************************************************************/
+
+#ifndef HOST_SERIAL_H
+#define HOST_SERIAL_H
+
+/****************************************************************************/
+/***        Include Files                                                 ***/
+/****************************************************************************/
+
+#include <jendefs.h>
+
+/* Application */
+#include "app_serial_commands.h"
+
+/****************************************************************************/
+/***        Macro Definitions                                             ***/
+/****************************************************************************/
+
+/* Bytes the UART model can have sent before the test reads them */
+#define HOST_WIRE_SIZE (1024 * 1024)
+
+/****************************************************************************/
+/***        Type Definitions                                              ***/
+/****************************************************************************/
+
+/* Frame decoded from the bytes the firmware sent */
+typedef struct {
+    uint16 u16Type;
+    uint16 u16Length;
+    bool_t bCheckOk;
+    uint8 au8Data[MAX_PACKET_SIZE];
+} HOST_tsFrame;
+
+/* What the firmware asked of its surroundings */
+typedef struct {
+    uint32 u32CriticalSections; /* interrupts masked, by UART_vStartTx or a model */
+    uint64 u64CriticalNsec;     /* time spent masked, when timing is on */
+    uint32 u32TxInterrupts;     /* TX FIFO refills by the interrupt model */
+    uint32 u32RestartsStarted;  /* restart timer starts */
+    uint32 u32PdmErases;
+    uint32 u32BaudRateChanges;
+} HOST_tsStats;
+
+/****************************************************************************/
+/***        Exported Variables                                            ***/
+/****************************************************************************/
+
+extern HOST_tsStats HOST_sStats;
+extern uint32 HOST_u32Msec;
+
+/****************************************************************************/
+/***        Exported Functions                                            ***/
+/****************************************************************************/
+
+PUBLIC void HOST_vSerialInit(void);
+PUBLIC void HOST_vSetVersion(uint8 u8Version);
+PUBLIC uint16 HOST_u16Encode(uint8 *pu8Out, uint16 u16Type, const uint8 *pu8Data, uint16 u16Length);
+PUBLIC void HOST_vSendFrame(uint16 u16Type, const uint8 *pu8Data, uint16 u16Length);
+PUBLIC void HOST_vSendRequest(uint16 u16Type, uint8 u8Seq, const uint8 *pu8Data, uint16 u16Length);
+PUBLIC void HOST_vRunSerial(void);
+PUBLIC void HOST_vUartTxInterrupt(void);
+PUBLIC void HOST_vUartDrain(void);
+PUBLIC void HOST_vHoldTx(bool_t bHold);
+PUBLIC void HOST_vEnterCritical(void);
+PUBLIC void HOST_vExitCritical(void);
+PUBLIC void HOST_vTimeCritical(bool_t bEnable);
+PUBLIC bool_t HOST_bReadFrame(HOST_tsFrame *psFrame);
+PUBLIC uint32 HOST_u32WireRead(uint8 *pu8Out, uint32 u32Size);
+PUBLIC void HOST_vWireReset(void);
+
+/****************************************************************************/
+/***        END OF FILE                                                   ***/
+/****************************************************************************/
+
+#endif /* HOST_SERIAL_H */
@@ -0,0 +1,421 @@
+/****************************************************************************
+ *
+ * MODULE:              Lumi Router
+ *
+ * COMPONENT:           test_capture.c
+ *
+ * DESCRIPTION:         Host tests of the capture stream
+ *
+ ****************************************************************************
+ *
+ * This software is owned by NXP B.V. and/or its supplier and is protected
+ * under applicable copyright laws. All rights are reserved. We grant You,
+ * and any third parties, a license to use this software solely and
+ * exclusively on NXP products [NXP Microcontrollers such as JN5168, JN5179].
+ * You, and any third parties must reproduce the copyright and warranty notice
+ * and any other legend of ownership on each copy or partial copy of the
+ * software.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+ * AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+ * IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE
+ * ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE
+ * LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR
+ * CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF
+ * SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS
+ * INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN
+ * CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE)
+ * ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+ * POSSIBILITY OF SUCH DAMAGE.
+ *
+ * Copyright NXP B.V. 2016. All rights reserved
+ *
+ ****************************************************************************/
+
+/****************************************************************************/
+/***        Include Files                                                 ***/
+/****************************************************************************/
+
+#include <jendefs.h>
+#include <string.h>
+
+/* Application */
+#include "app_capture.h"
+#include "app_clock.h"
+#include "app_serial_commands.h"
+#include "test.h"
+
+/* SDK JN-SW-4170 */
+#include "pdum_apl.h"
+#include "zps_apl_af.h"
+
+/****************************************************************************/
+/***        Macro Definitions                                             ***/
+/****************************************************************************/
+
+/* Capture command type on the telemetry channel */
+#define TEST_CAPTURE_TYPE SERIAL_CHANNEL_TYPE(E_SERIAL_CHANNEL_TELEMETRY, 0x1B)
+
+#define TEST_PCAP_HEADER_SIZE   16
+#define TEST_PSEUDO_HEADER_SIZE 14
+
+/****************************************************************************/
+/***        Type Definitions                                              ***/
+/****************************************************************************/
+
+/* The APDU stand-in behind a PDUM_thAPduInstance */
+struct pdum_tsAPduInstance_tag {
+    uint16 u16Size;
+    uint8 au8Payload[200];
+};
+
+/****************************************************************************/
+/***        Local Function Prototypes                                     ***/
+/****************************************************************************/
+
+PRIVATE void vTestDataIndication(void);
+PRIVATE void vTestOtherEvents(void);
+PRIVATE void vTestSnapLength(void);
+PRIVATE void vTestTokenBucket(void);
+PRIVATE void vTestQueueFull(void);
+
+PRIVATE bool_t bCapture(ZPS_tsAfEvent *psEvent);
+PRIVATE uint32 u32Get(const uint8 *pu8);
+PRIVATE uint16 u16Get(const uint8 *pu8);
+
+/****************************************************************************/
+/***        Local Variables                                               ***/
+/****************************************************************************/
+
+/* Value of the clock stand-in */
+PRIVATE uint32 u32Msec;
+
+/* Last frame written, and whether the serial queue has room */
+PRIVATE uint16 u16FrameType;
+PRIVATE uint16 u16FrameLength;
+PRIVATE uint8 au8Frame[512];
+PRIVATE uint32 u32Frames;
+PRIVATE bool_t bQueueFull;
+
+PRIVATE struct pdum_tsAPduInstance_tag sApdu;
+
+/****************************************************************************/
+/***        Exported Functions                                            ***/
+/****************************************************************************/
+
+int main(void)
+{
+    uint16 i;
+
+    for (i = 0; i < sizeof(sApdu.au8Payload); i++) {
+        sApdu.au8Payload[i] = (uint8)i;
+    }
+
+    vTestDataIndication();
+    vTestOtherEvents();
+    vTestSnapLength();
+    vTestTokenBucket();
+    vTestQueueFull();
+
+    return TEST_RESULT();
+}
+
+PUBLIC uint32 APP_u32ClockMsec(void)
+{
+    return u32Msec;
+}
+
+PUBLIC bool_t APP_bWriteFrameToSerial(uint16 u16Type, const APP_tsSerialIoVec *psPayload, uint8 u8Count)
+{
+    uint8 i;
+
+    if (bQueueFull) {
+        return FALSE;
+    }
+
+    u16FrameType = u16Type;
+    u16FrameLength = 0;
+    for (i = 0; i < u8Count; i++) {
+        memcpy(&au8Frame[u16FrameLength], psPayload[i].pu8Data, psPayload[i].u16Length);
+        u16FrameLength += psPayload[i].u16Length;
+    }
+    u32Frames++;
+    return TRUE;
+}
+
+PUBLIC uint16 PDUM_u16APduInstanceGetPayloadSize(PDUM_thAPduInstance hAPduInst)
+{
+    return hAPduInst->u16Size;
+}
+
+PUBLIC void *PDUM_pvAPduInstanceGetPayload(PDUM_thAPduInstance hAPduInst)
+{
+    return hAPduInst->au8Payload;
+}
+
+/****************************************************************************/
+/***        Local Functions                                               ***/
+/****************************************************************************/
+
+/* A data indication is the pcap record header, the pseudo header and the
+ * payload up to the snap length, all big endian */
+PRIVATE void vTestDataIndication(void)
+{
+    ZPS_tsAfEvent sEvent;
+    const uint8 *pu8Pseudo = &au8Frame[TEST_PCAP_HEADER_SIZE];
+    APP_tsCaptureStats sStats;
+
+    memset(&sEvent, 0, sizeof(sEvent));
+    sEvent.eType = ZPS_EVENT_APS_DATA_INDICATION;
+    sEvent.uEvent.sApsDataIndEvent.eStatus = 0xA5;
+    sEvent.uEvent.sApsDataIndEvent.u8LinkQuality = 200;
+    sEvent.uEvent.sApsDataIndEvent.u8SrcEndpoint = 3;
+    sEvent.uEvent.sApsDataIndEvent.u8DstEndpoint = 1;
+    sEvent.uEvent.sApsDataIndEvent.u8SrcAddrMode = ZPS_E_ADDR_MODE_SHORT;
+    sEvent.uEvent.sApsDataIndEvent.uSrcAddress.u16Addr = 0x1234;
+    sEvent.uEvent.sApsDataIndEvent.u8DstAddrMode = ZPS_E_ADDR_MODE_IEEE;
+    sEvent.uEvent.sApsDataIndEvent.uDstAddress.u64Addr = 0x00158D0001020304ULL;
+    sEvent.uEvent.sApsDataIndEvent.u16ProfileId = 0x0104;
+    sEvent.uEvent.sApsDataIndEvent.u16ClusterId = 0x0402;
+    sEvent.uEvent.sApsDataIndEvent.hAPduInst = &sApdu;
+    sApdu.u16Size = 100;
+
+    /* Nothing while capture is off */
+    u32Msec = 12345;
+    APP_vCaptureConfigure(FALSE, 0, 0);
+    TEST_CHECK(!bCapture(&sEvent));
+
+    APP_vCaptureConfigure(TRUE, 0, 0);
+    TEST_CHECK(bCapture(&sEvent));
+    TEST_CHECK(u16FrameType == TEST_CAPTURE_TYPE);
+    TEST_CHECK(u16FrameLength == TEST_PCAP_HEADER_SIZE + TEST_PSEUDO_HEADER_SIZE + APP_CAPTURE_DEFAULT_SNAP_LENGTH);
+
+    /* Seconds, microseconds, captured and original length */
+    TEST_CHECK(u32Get(&au8Frame[0]) == 12);
+    TEST_CHECK(u32Get(&au8Frame[4]) == 345000);
+    TEST_CHECK(u32Get(&au8Frame[8]) == TEST_PSEUDO_HEADER_SIZE + APP_CAPTURE_DEFAULT_SNAP_LENGTH);
+    TEST_CHECK(u32Get(&au8Frame[12]) == TEST_PSEUDO_HEADER_SIZE + 100);
+
+    TEST_CHECK(pu8Pseudo[0] == ZPS_EVENT_APS_DATA_INDICATION);
+    TEST_CHECK(pu8Pseudo[1] == 0xA5);
+    TEST_CHECK(pu8Pseudo[2] == 0);
+    TEST_CHECK(pu8Pseudo[3] == 200);
+    TEST_CHECK(pu8Pseudo[4] == 3);
+    TEST_CHECK(pu8Pseudo[5] == 1);
+    TEST_CHECK(u16Get(&pu8Pseudo[6]) == 0x1234);
+    TEST_CHECK(u16Get(&pu8Pseudo[8]) == 0xFFFE);
+    TEST_CHECK(u16Get(&pu8Pseudo[10]) == 0x0104);
+    TEST_CHECK(u16Get(&pu8Pseudo[12]) == 0x0402);
+    TEST_CHECK(memcmp(&pu8Pseudo[TEST_PSEUDO_HEADER_SIZE], sApdu.au8Payload, APP_CAPTURE_DEFAULT_SNAP_LENGTH) == 0);
+
+    /* A payload shorter than the snap length is kept whole */
+    sApdu.u16Size = 5;
+    TEST_CHECK(bCapture(&sEvent));
+    TEST_CHECK(u32Get(&au8Frame[8]) == TEST_PSEUDO_HEADER_SIZE + 5);
+    TEST_CHECK(u32Get(&au8Frame[12]) == TEST_PSEUDO_HEADER_SIZE + 5);
+    TEST_CHECK(u16FrameLength == TEST_PCAP_HEADER_SIZE + TEST_PSEUDO_HEADER_SIZE + 5);
+
+    APP_vGetCaptureStats(&sStats);
+    TEST_CHECK(sStats.u32Captured == 2);
+    TEST_CHECK((sStats.u32RateLimited == 0) && (sStats.u32QueueFull == 0));
+}
+
+/* Confirms, acks and NWK status fill their own fields and leave the rest
+ * zero; other events are not captured */
+PRIVATE void vTestOtherEvents(void)
+{
+    static const uint8 au8Confirm[] = {ZPS_EVENT_APS_DATA_CONFIRM, 0x11, 42, 0, 3, 1, 0, 0, 0xAB, 0xCD, 0, 0, 0, 0};
+    static const uint8 au8Ack[] = {ZPS_EVENT_APS_DATA_ACK, 0, 43, 0, 3, 1, 0, 0, 0x56, 0x78, 0x01, 0x04, 0x00, 0x06};
+    static const uint8 au8Status[] = {ZPS_EVENT_NWK_STATUS_INDICATION, 0x0C, 0, 0, 0, 0, 0x9A, 0xBC, 0, 0, 0, 0, 0, 0};
+    ZPS_tsAfEvent sEvent;
+    const uint8 *pu8Pseudo = &au8Frame[TEST_PCAP_HEADER_SIZE];
+
+    APP_vCaptureConfigure(TRUE, 0, 0);
+
+    memset(&sEvent, 0, sizeof(sEvent));
+    sEvent.eType = ZPS_EVENT_APS_DATA_CONFIRM;
+    sEvent.uEvent.sApsDataConfirmEvent.u8Status = 0x11;
+    sEvent.uEvent.sApsDataConfirmEvent.u8SequenceNum = 42;
+    sEvent.uEvent.sApsDataConfirmEvent.u8SrcEndpoint = 3;
+    sEvent.uEvent.sApsDataConfirmEvent.u8DstEndpoint = 1;
+    sEvent.uEvent.sApsDataConfirmEvent.u8DstAddrMode = ZPS_E_ADDR_MODE_SHORT;
+    sEvent.uEvent.sApsDataConfirmEvent.uDstAddr.u16Addr = 0xABCD;
+    TEST_CHECK(bCapture(&sEvent));
+    TEST_CHECK(u16FrameLength == TEST_PCAP_HEADER_SIZE + TEST_PSEUDO_HEADER_SIZE);
+    TEST_CHECK(memcmp(pu8Pseudo, au8Confirm, sizeof(au8Confirm)) == 0);
+
+    memset(&sEvent, 0, sizeof(sEvent));
+    sEvent.eType = ZPS_EVENT_APS_DATA_ACK;
+    sEvent.uEvent.sApsDataAckEvent.u8SequenceNum = 43;
+    sEvent.uEvent.sApsDataAckEvent.u8SrcEndpoint = 3;
+    sEvent.uEvent.sApsDataAckEvent.u8DstEndpoint = 1;
+    sEvent.uEvent.sApsDataAckEvent.u16DstAddr = 0x5678;
+    sEvent.uEvent.sApsDataAckEvent.u16ProfileId = 0x0104;
+    sEvent.uEvent.sApsDataAckEvent.u16ClusterId = 0x0006;
+    TEST_CHECK(bCapture(&sEvent));
+    TEST_CHECK(memcmp(pu8Pseudo, au8Ack, sizeof(au8Ack)) == 0);
+
+    memset(&sEvent, 0, sizeof(sEvent));
+    sEvent.eType = ZPS_EVENT_NWK_STATUS_INDICATION;
+    sEvent.uEvent.sNwkStatusIndicationEvent.u8Status = 0x0C;
+    sEvent.uEvent.sNwkStatusIndicationEvent.u16NwkAddr = 0x9ABC;
+    TEST_CHECK(bCapture(&sEvent));
+    TEST_CHECK(memcmp(pu8Pseudo, au8Status, sizeof(au8Status)) == 0);
+
+    memset(&sEvent, 0, sizeof(sEvent));
+    sEvent.eType = ZPS_EVENT_NWK_STARTED;
+    TEST_CHECK(!bCapture(&sEvent));
+}
+
+/* The snap length is capped, and 0 means the default */
+PRIVATE void vTestSnapLength(void)
+{
+    ZPS_tsAfEvent sEvent;
+
+    memset(&sEvent, 0, sizeof(sEvent));
+    sEvent.eType = ZPS_EVENT_APS_DATA_INDICATION;
+    sEvent.uEvent.sApsDataIndEvent.hAPduInst = &sApdu;
+    sApdu.u16Size = sizeof(sApdu.au8Payload);
+
+    APP_vCaptureConfigure(TRUE, 0, 10);
+    TEST_CHECK(bCapture(&sEvent) && (u32Get(&au8Frame[8]) == TEST_PSEUDO_HEADER_SIZE + 10));
+
+    APP_vCaptureConfigure(TRUE, 0, 255);
+    TEST_CHECK(bCapture(&sEvent) && (u32Get(&au8Frame[8]) == TEST_PSEUDO_HEADER_SIZE + APP_CAPTURE_MAX_SNAP_LENGTH));
+    TEST_CHECK(u32Get(&au8Frame[12]) == TEST_PSEUDO_HEADER_SIZE + sizeof(sApdu.au8Payload));
+}
+
+/* Credit builds up at the configured rate to at most one second of
+ * records. Starting allows a full second straight away. */
+PRIVATE void vTestTokenBucket(void)
+{
+    ZPS_tsAfEvent sEvent;
+    APP_tsCaptureStats sStats;
+    uint32 u32Taken;
+    uint8 i;
+
+    memset(&sEvent, 0, sizeof(sEvent));
+    sEvent.eType = ZPS_EVENT_NWK_STATUS_INDICATION;
+
+    u32Msec = 1000;
+    APP_vCaptureConfigure(TRUE, 5, 0);
+    for (i = 0; i < 5; i++) {
+        TEST_CHECK(bCapture(&sEvent));
+    }
+    TEST_CHECK(!bCapture(&sEvent));
+
+    /* One record per 200 ms, with the part credit of each call kept */
+    u32Msec += 199;
+    TEST_CHECK(!bCapture(&sEvent));
+    u32Msec += 1;
+    TEST_CHECK(bCapture(&sEvent));
+    for (i = 0; i < 200; i++) {
+        u32Msec++;
+        TEST_CHECK(bCapture(&sEvent) == (i == 199));
+    }
+
+    /* Just under a second refills all but one token */
+    u32Msec += 999;
+    for (i = 0; i < 4; i++) {
+        TEST_CHECK(bCapture(&sEvent));
+    }
+    TEST_CHECK(!bCapture(&sEvent));
+
+    /* A second or more fills the bucket, and no further */
+    u32Msec += 1000;
+    for (i = 0; i < 5; i++) {
+        TEST_CHECK(bCapture(&sEvent));
+    }
+    TEST_CHECK(!bCapture(&sEvent));
+    u32Msec += 3600000;
+    for (i = 0; i < 5; i++) {
+        TEST_CHECK(bCapture(&sEvent));
+    }
+    TEST_CHECK(!bCapture(&sEvent));
+
+    /* Credit added up under a second at a time stops at the cap */
+    u32Msec += 600;
+    TEST_CHECK(bCapture(&sEvent));
+    u32Msec += 900;
+    for (i = 0; i < 5; i++) {
+        TEST_CHECK(bCapture(&sEvent));
+    }
+    TEST_CHECK(!bCapture(&sEvent));
+
+    APP_vGetCaptureStats(&sStats);
+    TEST_CHECK(sStats.u32Captured == 5 + 1 + 1 + 4 + 5 + 5 + 1 + 5);
+    TEST_CHECK(sStats.u32RateLimited == 1 + 1 + 199 + 1 + 1 + 1 + 1);
+
+    /* The clock wrapping is only elapsed time */
+    u32Msec = 0xFFFFFF00;
+    APP_vCaptureConfigure(TRUE, 5, 0);
+    for (i = 0; i < 5; i++) {
+        TEST_CHECK(bCapture(&sEvent));
+    }
+    u32Msec = 0x00000010;
+    TEST_CHECK(bCapture(&sEvent));
+    TEST_CHECK(!bCapture(&sEvent));
+
+    /* At the fastest rate a long gap would overflow the credit sum, here
+     * to 65 tokens, if it were not taken as a full bucket */
+    u32Msec = 0;
+    APP_vCaptureConfigure(TRUE, 0xFFFF, 0);
+    for (u32Taken = 0; (u32Taken <= 0xFFFF) && bCapture(&sEvent); u32Taken++) {
+    }
+    TEST_CHECK(u32Taken == 0xFFFF);
+    u32Msec += 65538;
+    for (u32Taken = 0; (u32Taken <= 0xFFFF) && bCapture(&sEvent); u32Taken++) {
+    }
+    TEST_CHECK(u32Taken == 0xFFFF);
+
+    /* Starting again clears the counters */
+    APP_vCaptureConfigure(TRUE, 5, 0);
+    APP_vGetCaptureStats(&sStats);
+    TEST_CHECK((sStats.u32Captured == 0) && (sStats.u32RateLimited == 0) && (sStats.u32QueueFull == 0));
+}
+
+/* A record the serial queue has no room for is counted, and still takes
+ * its token */
+PRIVATE void vTestQueueFull(void)
+{
+    ZPS_tsAfEvent sEvent;
+    APP_tsCaptureStats sStats;
+
+    memset(&sEvent, 0, sizeof(sEvent));
+    sEvent.eType = ZPS_EVENT_NWK_STATUS_INDICATION;
+
+    u32Msec = 0;
+    APP_vCaptureConfigure(TRUE, 1, 0);
+    bQueueFull = TRUE;
+    TEST_CHECK(!bCapture(&sEvent));
+    bQueueFull = FALSE;
+    TEST_CHECK(!bCapture(&sEvent));
+
+    APP_vGetCaptureStats(&sStats);
+    TEST_CHECK(sStats.u32Captured == 0);
+    TEST_CHECK(sStats.u32QueueFull == 1);
+    TEST_CHECK(sStats.u32RateLimited == 1);
+}
+
+/* Whether the event was written to the serial queue */
+PRIVATE bool_t bCapture(ZPS_tsAfEvent *psEvent)
+{
+    uint32 u32Before = u32Frames;
+
+    APP_vCaptureEvent(psEvent);
+    return u32Frames != u32Before;
+}
+
+PRIVATE uint32 u32Get(const uint8 *pu8)
+{
+    return ((uint32)pu8[0] << 24) | ((uint32)pu8[1] << 16) | ((uint32)pu8[2] << 8) | pu8[3];
+}
+
+PRIVATE uint16 u16Get(const uint8 *pu8)
+{
+    return (uint16)((pu8[0] << 8) | pu8[1]);
+}
+
+/****************************************************************************/
+/***        END OF FILE                                                   ***/
+/****************************************************************************/
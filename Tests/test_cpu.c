@@ -0,0 +1,309 @@
+/****************************************************************************
+ *
+ * MODULE:              Lumi Router
+ *
+ * COMPONENT:           test_cpu.c
+ *
+ * DESCRIPTION:         Host tests of the CPU utilisation accounting
+ *
+ ****************************************************************************
+ *
+ * This software is owned by NXP B.V. and/or its supplier and is protected
+ * under applicable copyright laws. All rights are reserved. We grant You,
+ * and any third parties, a license to use this software solely and
+ * exclusively on NXP products [NXP Microcontrollers such as JN5168, JN5179].
+ * You, and any third parties must reproduce the copyright and warranty notice
+ * and any other legend of ownership on each copy or partial copy of the
+ * software.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+ * AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+ * IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE
+ * ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE
+ * LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR
+ * CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF
+ * SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS
+ * INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN
+ * CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE)
+ * ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+ * POSSIBILITY OF SUCH DAMAGE.
+ *
+ * Copyright NXP B.V. 2016. All rights reserved
+ *
+ ****************************************************************************/
+
+/****************************************************************************/
+/***        Include Files                                                 ***/
+/****************************************************************************/
+
+#include <jendefs.h>
+#include <math.h>
+
+/* Application */
+#include "app_clock.h"
+#include "app_cpu.h"
+#include "test.h"
+
+/****************************************************************************/
+/***        Macro Definitions                                             ***/
+/****************************************************************************/
+
+/* Samples in each moving average, as in app_cpu.c */
+#define CPU_LOAD_1MIN_SAMPLES 60
+#define CPU_LOAD_15MIN_SAMPLES 900
+
+/****************************************************************************/
+/***        Type Definitions                                              ***/
+/****************************************************************************/
+
+/* The averages worked out in floating point */
+typedef struct {
+    bool_t bSeeded;
+    double d1Min;
+    double d15Min;
+} tsModel;
+
+/****************************************************************************/
+/***        Local Function Prototypes                                     ***/
+/****************************************************************************/
+
+PRIVATE void vTestSeed(void);
+PRIVATE void vTestSplit(void);
+PRIVATE void vTestLongDoze(void);
+PRIVATE void vTestAverages(void);
+PRIVATE void vTestWrap(void);
+PRIVATE void vTestPeakBusy(void);
+PRIVATE void vInit(uint32 u32Start);
+PRIVATE void vBusy(uint32 u32Ticks);
+PRIVATE void vDoze(uint32 u32Ticks);
+PRIVATE void vModelSample(tsModel *psModel, uint16 u16Sample);
+PRIVATE void vCheckStats(const tsModel *psModel, uint16 u16Utilisation);
+
+/****************************************************************************/
+/***        Local Variables                                               ***/
+/****************************************************************************/
+
+PRIVATE uint32 u32Ticks;
+
+/****************************************************************************/
+/***        Exported Functions                                            ***/
+/****************************************************************************/
+
+int main(void)
+{
+    vTestSeed();
+    vTestSplit();
+    vTestLongDoze();
+    vTestAverages();
+    vTestWrap();
+    vTestPeakBusy();
+
+    return TEST_RESULT();
+}
+
+PUBLIC uint32 APP_u32ClockTicks(void)
+{
+    return u32Ticks;
+}
+
+/* Clusters are never registered on the host */
+PUBLIC void vZCL_InitializeClusterInstance(tsZCL_ClusterInstance *psClusterInstance,
+                                           bool_t bIsServer,
+                                           tsZCL_ClusterDefinition *psClusterDefinition,
+                                           void *pvEndPointSharedStructPtr,
+                                           uint8 *pu8AttributeControlBits,
+                                           void *pvEndPointCustomStructPtr,
+                                           tfpZCL_ZCLCustomcallCallBackFunction fCustomcallCallBackFunction)
+{
+}
+
+/****************************************************************************/
+/***        Local Functions                                               ***/
+/****************************************************************************/
+
+/* The first second seeds both averages rather than being averaged in
+ * from idle */
+PRIVATE void vTestSeed(void)
+{
+    APP_tsCpuStats sStats;
+
+    vInit(0);
+    vBusy(APP_CLOCK_MSEC(300));
+    vDoze(APP_CLOCK_MSEC(700));
+
+    APP_vGetCpuStats(&sStats);
+    TEST_CHECK(sStats.u16Utilisation == 300);
+    TEST_CHECK(sStats.u16Utilisation1Min == 300);
+    TEST_CHECK(sStats.u16Utilisation15Min == 300);
+}
+
+/* A doze across a second boundary counts in each second it covers, and a
+ * second is only sampled once it is over */
+PRIVATE void vTestSplit(void)
+{
+    APP_tsCpuStats sStats;
+    tsModel sModel = {FALSE, 0, 0};
+
+    vInit(0);
+    vModelSample(&sModel, 300);
+    vBusy(APP_CLOCK_MSEC(300));
+    vDoze(APP_CLOCK_MSEC(700));
+
+    /* 100 ms busy, then 900 ms of doze in this second and 400 ms in the next */
+    vBusy(APP_CLOCK_MSEC(100));
+    vDoze(APP_CLOCK_MSEC(1300));
+    vModelSample(&sModel, 100);
+    vCheckStats(&sModel, 100);
+
+    /* The rest of the second is busy, with the clock read part way through */
+    vBusy(APP_CLOCK_MSEC(300));
+    APP_vGetCpuStats(&sStats);
+    TEST_CHECK(sStats.u16Utilisation == 100);
+    vBusy(APP_CLOCK_MSEC(300) - 1);
+    APP_vGetCpuStats(&sStats);
+    TEST_CHECK(sStats.u16Utilisation == 100);
+    vBusy(1);
+    vModelSample(&sModel, 600);
+    vCheckStats(&sModel, 600);
+}
+
+/* A doze of several seconds samples each of them */
+PRIVATE void vTestLongDoze(void)
+{
+    tsModel sModel = {FALSE, 0, 0};
+
+    vInit(0);
+    vBusy(APP_CLOCK_MSEC(1000));
+    vModelSample(&sModel, 1000);
+
+    vBusy(APP_CLOCK_MSEC(200));
+    vDoze(APP_CLOCK_MSEC(3300));
+    vModelSample(&sModel, 200);
+    vModelSample(&sModel, 0);
+    vModelSample(&sModel, 0);
+    vCheckStats(&sModel, 0);
+
+    /* The 500 ms dozed so far in this second count when it ends */
+    vBusy(APP_CLOCK_MSEC(500));
+    vModelSample(&sModel, 500);
+    vCheckStats(&sModel, 500);
+}
+
+/* Over twenty minutes the averages follow an exponential moving average
+ * of the samples, including doze times that are not whole milliseconds */
+PRIVATE void vTestAverages(void)
+{
+    tsModel sModel = {FALSE, 0, 0};
+    uint32 u32Busy;
+    uint16 u16Sample;
+    uint32 i;
+
+    vInit(0);
+    for (i = 0; i < 1200; i++) {
+        /* Mostly light load with a burst every few minutes */
+        u32Busy = ((i % 240) < 30) ? APP_CLOCK_MSEC(900) : APP_CLOCK_USEC(50000 + (i * 7919) % 100000);
+        vBusy(u32Busy);
+        vDoze(APP_CLOCK_MSEC(1000) - u32Busy);
+
+        /* Dozing part of a millisecond counts as busy */
+        u16Sample = (uint16)(1000 - (APP_CLOCK_MSEC(1000) - u32Busy) / APP_CLOCK_TICKS_PER_MSEC);
+        vModelSample(&sModel, u16Sample);
+        vCheckStats(&sModel, u16Sample);
+    }
+}
+
+/* Seconds are split the same way when the tick count wraps */
+PRIVATE void vTestWrap(void)
+{
+    tsModel sModel = {FALSE, 0, 0};
+
+    vInit(0 - APP_CLOCK_MSEC(1500));
+    vBusy(APP_CLOCK_MSEC(250));
+    vDoze(APP_CLOCK_MSEC(750));
+    vModelSample(&sModel, 250);
+
+    /* The boundary falls 500 ms after the wrap */
+    vBusy(APP_CLOCK_MSEC(100));
+    vDoze(APP_CLOCK_MSEC(1000));
+    vModelSample(&sModel, 100);
+    vCheckStats(&sModel, 100);
+
+    vBusy(APP_CLOCK_MSEC(900));
+    vModelSample(&sModel, 900);
+    vCheckStats(&sModel, 900);
+}
+
+/* The peak is the longest run between dozes, counting the run in progress,
+ * until it is reset */
+PRIVATE void vTestPeakBusy(void)
+{
+    APP_tsCpuStats sStats;
+
+    vInit(0);
+    vBusy(APP_CLOCK_USEC(1500));
+    vDoze(APP_CLOCK_USEC(100));
+    vBusy(APP_CLOCK_USEC(700));
+    vDoze(APP_CLOCK_USEC(100));
+    APP_vGetCpuStats(&sStats);
+    TEST_CHECK(sStats.u32PeakBusyUsec == 1500);
+
+    vBusy(APP_CLOCK_USEC(2000));
+    APP_vGetCpuStats(&sStats);
+    TEST_CHECK(sStats.u32PeakBusyUsec == 2000);
+    vDoze(APP_CLOCK_USEC(100));
+
+    APP_vResetCpuStats();
+    vBusy(APP_CLOCK_USEC(300));
+    vDoze(APP_CLOCK_USEC(100));
+    APP_vGetCpuStats(&sStats);
+    TEST_CHECK(sStats.u32PeakBusyUsec == 300);
+}
+
+/* Start measuring at the given tick count, busy */
+PRIVATE void vInit(uint32 u32Start)
+{
+    u32Ticks = u32Start;
+    APP_vCpuInit();
+}
+
+PRIVATE void vBusy(uint32 u32For)
+{
+    u32Ticks += u32For;
+}
+
+/* Doze through the power manager, as the main loop does */
+PRIVATE void vDoze(uint32 u32For)
+{
+    APP_vCpuDozeStart();
+    u32Ticks += u32For;
+    APP_vCpuDozeEnd();
+}
+
+PRIVATE void vModelSample(tsModel *psModel, uint16 u16Sample)
+{
+    if (!psModel->bSeeded) {
+        psModel->d1Min = u16Sample;
+        psModel->d15Min = u16Sample;
+        psModel->bSeeded = TRUE;
+        return;
+    }
+
+    psModel->d1Min += (u16Sample - psModel->d1Min) / CPU_LOAD_1MIN_SAMPLES;
+    psModel->d15Min += (u16Sample - psModel->d15Min) / CPU_LOAD_15MIN_SAMPLES;
+}
+
+/* The averages may differ from the model by the rounding of the last
+ * tenth of a percent */
+PRIVATE void vCheckStats(const tsModel *psModel, uint16 u16Utilisation)
+{
+    APP_tsCpuStats sStats;
+
+    APP_vGetCpuStats(&sStats);
+    TEST_CHECK(sStats.u16Utilisation == u16Utilisation);
+    TEST_CHECK(fabs(sStats.u16Utilisation1Min - psModel->d1Min) <= 1.0);
+    TEST_CHECK(fabs(sStats.u16Utilisation15Min - psModel->d15Min) <= 1.0);
+}
+
+/****************************************************************************/
+/***        END OF FILE                                                   ***/
+/****************************************************************************/
@@ -0,0 +1,296 @@
+/****************************************************************************
+ *
+ * MODULE:              Lumi Router
+ *
+ * COMPONENT:           test_log.c
+ *
+ * DESCRIPTION:         Host tests of the tokenized log
+ *
+ ****************************************************************************
+ *
+ * This software is owned by NXP B.V. and/or its supplier and is protected
+ * under applicable copyright laws. All rights are reserved. We grant You,
+ * and any third parties, a license to use this software solely and
+ * exclusively on NXP products [NXP Microcontrollers such as JN5168, JN5179].
+ * You, and any third parties must reproduce the copyright and warranty notice
+ * and any other legend of ownership on each copy or partial copy of the
+ * software.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+ * AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+ * IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE
+ * ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE
+ * LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR
+ * CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF
+ * SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS
+ * INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN
+ * CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE)
+ * ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+ * POSSIBILITY OF SUCH DAMAGE.
+ *
+ * Copyright NXP B.V. 2016. All rights reserved
+ *
+ ****************************************************************************/
+
+/****************************************************************************/
+/***        Include Files                                                 ***/
+/****************************************************************************/
+
+#include <jendefs.h>
+
+/* Application */
+#include "app_clock.h"
+#include "app_log.h"
+#include "test.h"
+
+/* SDK JN-SW-4170 */
+#include "portmacro.h"
+
+/****************************************************************************/
+/***        Macro Definitions                                             ***/
+/****************************************************************************/
+
+/* Size of the log ring in app_log.c */
+#define LOG_RING_SIZE 512
+
+/****************************************************************************/
+/***        Local Function Prototypes                                     ***/
+/****************************************************************************/
+
+PRIVATE void vTestDefaultLevel(void);
+PRIVATE void vTestRecordEncoding(void);
+PRIVATE void vTestLevelFilter(void);
+PRIVATE void vTestOverflow(void);
+
+PRIVATE uint32 u32Get(const uint8 *pu8);
+PRIVATE void vDrain(void);
+
+/****************************************************************************/
+/***        Local Variables                                               ***/
+/****************************************************************************/
+
+/* Value of the clock stand-in */
+PRIVATE uint32 u32Ticks;
+
+/* Depth of the critical section stand-in */
+PRIVATE uint32 u32CriticalDepth;
+PRIVATE uint32 u32CriticalSections;
+
+/****************************************************************************/
+/***        Exported Functions                                            ***/
+/****************************************************************************/
+
+int main(void)
+{
+    APP_vLogInit();
+
+    vTestDefaultLevel();
+    vTestRecordEncoding();
+    vTestLevelFilter();
+    vTestOverflow();
+
+    return TEST_RESULT();
+}
+
+PUBLIC uint32 APP_u32ClockTicks(void)
+{
+    return u32Ticks;
+}
+
+PUBLIC uint8 ZPS_eEnterCriticalSection(void *hMutex, uint32 *psIntStore)
+{
+    u32CriticalDepth++;
+    u32CriticalSections++;
+    return 0;
+}
+
+PUBLIC uint8 ZPS_eExitCriticalSection(void *hMutex, uint32 *psIntStore)
+{
+    TEST_CHECK(u32CriticalDepth > 0);
+    u32CriticalDepth--;
+    return 0;
+}
+
+/****************************************************************************/
+/***        Local Functions                                               ***/
+/****************************************************************************/
+
+/* This test is built with LOG_LEVEL=WARN, so every module starts there */
+PRIVATE void vTestDefaultLevel(void)
+{
+    uint8 i;
+
+    for (i = 0; i < E_LOG_MODULE_COUNT; i++) {
+        TEST_CHECK(au8LogModuleLevel[i] == E_LOG_LEVEL_WARN);
+    }
+
+    TEST_CHECK(APP_LOG_ENABLED(E_LOG_ZDO_AF_ERROR));
+    TEST_CHECK(APP_LOG_ENABLED(E_LOG_SERIAL_RX_CRC_BAD));
+    TEST_CHECK(!APP_LOG_ENABLED(E_LOG_SERIAL_BENCHMARK));
+    TEST_CHECK(!APP_LOG_ENABLED(E_LOG_ZDO_DATA_INDICATION));
+}
+
+/* A record is its length, the id, the ticks and the arguments, big endian */
+PRIVATE void vTestRecordEncoding(void)
+{
+    APP_tsLogStats sStats;
+    uint8 au8Buffer[64];
+    uint16 u16Read;
+    uint8 i;
+
+    u32Ticks = 0x12345678;
+    u32CriticalSections = 0;
+    APP_LOG(E_LOG_SERIAL_RX_CRC_BAD, 0x0040, 0xBEEF, 0xCAFE);
+    TEST_CHECK(u32CriticalSections == 1);
+    TEST_CHECK(u32CriticalDepth == 0);
+    TEST_CHECK(!APP_bLogIsEmpty());
+
+    u16Read = APP_u16LogRead(au8Buffer, sizeof(au8Buffer));
+    TEST_CHECK(u16Read == 7 + 3 * 4);
+    TEST_CHECK(au8Buffer[0] == u16Read);
+    TEST_CHECK(au8Buffer[1] == (E_LOG_SERIAL_RX_CRC_BAD >> 8));
+    TEST_CHECK(au8Buffer[2] == (E_LOG_SERIAL_RX_CRC_BAD & 0xFF));
+    TEST_CHECK(au8Buffer[3] == 0x12 && au8Buffer[4] == 0x34 && au8Buffer[5] == 0x56 && au8Buffer[6] == 0x78);
+    TEST_CHECK(u32Get(&au8Buffer[7]) == 0x0040);
+    TEST_CHECK(u32Get(&au8Buffer[11]) == 0xBEEF);
+    TEST_CHECK(u32Get(&au8Buffer[15]) == 0xCAFE);
+    TEST_CHECK(APP_bLogIsEmpty());
+
+    /* No arguments */
+    APP_LOG(E_LOG_SERIAL_RX_NO_BUFFER);
+    TEST_CHECK(APP_u16LogRead(au8Buffer, sizeof(au8Buffer)) == 7);
+    TEST_CHECK(au8Buffer[0] == 7);
+
+    /* Negative values go as their 32-bit two's complement */
+    APP_LOG(E_LOG_ZDO_AF_ERROR, -2);
+    TEST_CHECK(APP_u16LogRead(au8Buffer, sizeof(au8Buffer)) == 11);
+    TEST_CHECK(u32Get(&au8Buffer[7]) == 0xFFFFFFFE);
+
+    /* At most six arguments are kept */
+    APP_vLog(E_LOG_ZDO_DATA_INDICATION, 7, 1, 2, 3, 4, 5, 6, 7);
+    u16Read = APP_u16LogRead(au8Buffer, sizeof(au8Buffer));
+    TEST_CHECK(u16Read == APP_LOG_MAX_RECORD_SIZE);
+    TEST_CHECK(au8Buffer[0] == APP_LOG_MAX_RECORD_SIZE);
+    for (i = 0; i < APP_LOG_MAX_ARGS; i++) {
+        TEST_CHECK(u32Get(&au8Buffer[7 + 4 * i]) == i + 1U);
+    }
+
+    /* A read takes whole records only */
+    APP_LOG(E_LOG_ZDO_AF_ERROR, 1);
+    APP_LOG(E_LOG_ZDO_AF_ERROR, 2);
+    TEST_CHECK(APP_u16LogRead(au8Buffer, 21) == 11);
+    TEST_CHECK(u32Get(&au8Buffer[7]) == 1);
+    TEST_CHECK(APP_u16LogRead(au8Buffer, 10) == 0);
+    TEST_CHECK(APP_u16LogRead(au8Buffer, 11) == 11);
+    TEST_CHECK(u32Get(&au8Buffer[7]) == 2);
+
+    APP_vLogGetStats(&sStats);
+    TEST_CHECK(sStats.u32Records == 6);
+    TEST_CHECK(sStats.u32Dropped == 0);
+}
+
+/* A message is only recorded at or below the level of its module, and its
+ * arguments are only evaluated then */
+PRIVATE void vTestLevelFilter(void)
+{
+    APP_tsLogStats sBefore;
+    APP_tsLogStats sAfter;
+    uint32 u32Evaluated = 0;
+
+    APP_vLogGetStats(&sBefore);
+    APP_LOG(E_LOG_SERIAL_BENCHMARK, u32Evaluated++, 0);
+    APP_LOG(E_LOG_REPORT_SAVE, u32Evaluated++);
+    TEST_CHECK(u32Evaluated == 0);
+    TEST_CHECK(APP_bLogIsEmpty());
+
+    /* Raising one module leaves the others where they were */
+    APP_vLogSetLevel(E_LOG_MODULE_SERIAL, E_LOG_LEVEL_DEBUG);
+    APP_LOG(E_LOG_SERIAL_BENCHMARK, u32Evaluated++, 0);
+    APP_LOG(E_LOG_REPORT_SAVE, u32Evaluated++);
+    TEST_CHECK(u32Evaluated == 1);
+    APP_vLogGetStats(&sAfter);
+    TEST_CHECK(sAfter.u32Records == sBefore.u32Records + 1);
+    vDrain();
+
+    /* Off drops even errors */
+    APP_vLogSetLevel(E_LOG_MODULE_APP, E_LOG_LEVEL_OFF);
+    APP_LOG(E_LOG_ZDO_AF_ERROR, u32Evaluated++);
+    TEST_CHECK(u32Evaluated == 1);
+    TEST_CHECK(APP_bLogIsEmpty());
+
+    /* An unknown module is ignored */
+    APP_vLogSetLevel(E_LOG_MODULE_COUNT, E_LOG_LEVEL_DEBUG);
+    TEST_CHECK(au8LogModuleLevel[E_LOG_MODULE_APP] == E_LOG_LEVEL_OFF);
+
+    APP_vLogSetLevel(E_LOG_MODULE_APP, E_LOG_LEVEL_WARN);
+    APP_vLogSetLevel(E_LOG_MODULE_SERIAL, E_LOG_LEVEL_WARN);
+}
+
+/* A record that does not fit is counted as dropped, never cut short, and
+ * the ring takes records again once read */
+PRIVATE void vTestOverflow(void)
+{
+    APP_tsLogStats sBefore;
+    APP_tsLogStats sAfter;
+    uint8 au8Buffer[LOG_RING_SIZE];
+    uint16 u16Read;
+    uint16 u16Offset;
+    uint32 u32Logged = 0;
+    uint32 u32Next = 0;
+
+    APP_vLogGetStats(&sBefore);
+    do {
+        APP_LOG(E_LOG_ZDO_AF_ERROR, u32Logged);
+        u32Logged++;
+        APP_vLogGetStats(&sAfter);
+    } while (sAfter.u32Dropped == sBefore.u32Dropped);
+
+    /* Everything up to the first drop was kept */
+    TEST_CHECK(sAfter.u32Records - sBefore.u32Records == u32Logged - 1);
+    TEST_CHECK((u32Logged - 1) * 11 <= LOG_RING_SIZE);
+    TEST_CHECK(u32Logged * 11 > LOG_RING_SIZE);
+
+    /* A smaller record may still fit in what is left */
+    APP_LOG(E_LOG_SERIAL_RX_NO_BUFFER);
+    APP_LOG(E_LOG_SERIAL_RX_NO_BUFFER);
+    APP_vLogGetStats(&sAfter);
+    TEST_CHECK(sAfter.u32Records + sAfter.u32Dropped == sBefore.u32Records + sBefore.u32Dropped + u32Logged + 2);
+
+    /* The records read back in order, each one whole */
+    u16Read = APP_u16LogRead(au8Buffer, sizeof(au8Buffer));
+    TEST_CHECK(APP_bLogIsEmpty());
+    for (u16Offset = 0; u16Offset < u16Read; u16Offset += au8Buffer[u16Offset]) {
+        if (au8Buffer[u16Offset] == 11) {
+            TEST_CHECK(u32Get(&au8Buffer[u16Offset + 7]) == u32Next);
+            u32Next++;
+        }
+        else {
+            TEST_CHECK(au8Buffer[u16Offset] == 7);
+        }
+    }
+    TEST_CHECK(u16Offset == u16Read);
+    TEST_CHECK(u32Next == u32Logged - 1);
+
+    APP_LOG(E_LOG_ZDO_AF_ERROR, 0);
+    APP_vLogGetStats(&sBefore);
+    TEST_CHECK(sBefore.u32Dropped == sAfter.u32Dropped);
+    TEST_CHECK(sBefore.u32Records == sAfter.u32Records + 1);
+    vDrain();
+}
+
+PRIVATE uint32 u32Get(const uint8 *pu8)
+{
+    return ((uint32)pu8[0] << 24) | ((uint32)pu8[1] << 16) | ((uint32)pu8[2] << 8) | pu8[3];
+}
+
+PRIVATE void vDrain(void)
+{
+    uint8 au8Buffer[LOG_RING_SIZE];
+
+    while (APP_u16LogRead(au8Buffer, sizeof(au8Buffer)) > 0) {
+    }
+}
+
+/****************************************************************************/
+/***        END OF FILE                                                   ***/
+/****************************************************************************/
@@ -0,0 +1,254 @@
+/****************************************************************************
+ *
+ * MODULE:              Lumi Router
+ *
+ * COMPONENT:           test_pt.c
+ *
+ * DESCRIPTION:         Host tests of the application protothreads
+ *
+ ****************************************************************************
+ *
+ * This software is owned by NXP B.V. and/or its supplier and is protected
+ * under applicable copyright laws. All rights are reserved. We grant You,
+ * and any third parties, a license to use this software solely and
+ * exclusively on NXP products [NXP Microcontrollers such as JN5168, JN5179].
+ * You, and any third parties must reproduce the copyright and warranty notice
+ * and any other legend of ownership on each copy or partial copy of the
+ * software.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+ * AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+ * IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE
+ * ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE
+ * LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR
+ * CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF
+ * SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS
+ * INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN
+ * CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE)
+ * ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+ * POSSIBILITY OF SUCH DAMAGE.
+ *
+ * Copyright NXP B.V. 2016. All rights reserved
+ *
+ ****************************************************************************/
+
+/****************************************************************************/
+/***        Include Files                                                 ***/
+/****************************************************************************/
+
+#include <jendefs.h>
+
+/* Application */
+#include "app_pt.h"
+#include "app_scheduler.h"
+#include "test.h"
+
+/****************************************************************************/
+/***        Local Function Prototypes                                     ***/
+/****************************************************************************/
+
+PRIVATE void vTestStepPerPass(void);
+PRIVATE void vTestWaitUntil(void);
+PRIVATE void vTestStartWhileRunning(void);
+PRIVATE void vTestRestartWhenDone(void);
+PRIVATE void vTestSlotsFull(void);
+PRIVATE void vTestStartFromThread(void);
+
+PRIVATE bool_t bPass(void);
+
+PRIVATE APP_tePtState ptSteps(APP_tsPt *psPt);
+PRIVATE APP_tePtState ptWait(APP_tsPt *psPt);
+PRIVATE APP_tePtState ptStarter(APP_tsPt *psPt);
+
+/****************************************************************************/
+/***        Local Variables                                               ***/
+/****************************************************************************/
+
+/* Ready state of the application thread task, kept by the stand-in for
+ * the scheduler */
+PRIVATE bool_t bPtReady;
+
+PRIVATE uint32 u32Step;
+PRIVATE bool_t bCondition;
+PRIVATE uint32 u32Checks;
+
+PRIVATE APP_tsPtTask sSteps;
+PRIVATE APP_tsPtTask sWait;
+PRIVATE APP_tsPtTask sStarter;
+PRIVATE APP_tsPtTask asFill[APP_PT_MAX_THREADS];
+
+/****************************************************************************/
+/***        Exported Functions                                            ***/
+/****************************************************************************/
+
+int main(void)
+{
+    APP_vPtCreate(&sSteps, ptSteps);
+    APP_vPtCreate(&sWait, ptWait);
+    APP_vPtCreate(&sStarter, ptStarter);
+
+    vTestStepPerPass();
+    vTestWaitUntil();
+    vTestStartWhileRunning();
+    vTestRestartWhenDone();
+    vTestSlotsFull();
+    vTestStartFromThread();
+
+    return TEST_RESULT();
+}
+
+/* app_pt.c only needs the scheduler to make its task ready */
+PUBLIC void APP_vSetTaskReady(APP_teTask eTask)
+{
+    TEST_CHECK(eTask == E_APP_TASK_PT);
+    bPtReady = TRUE;
+}
+
+/****************************************************************************/
+/***        Local Functions                                               ***/
+/****************************************************************************/
+
+/* A started thread takes one step per pass of its task, which stays ready
+ * until the thread is done */
+PRIVATE void vTestStepPerPass(void)
+{
+    TEST_CHECK(!APP_bPtRunning(&sSteps));
+    TEST_CHECK(APP_bPtStart(&sSteps));
+    TEST_CHECK(APP_bPtRunning(&sSteps));
+    TEST_CHECK(bPtReady);
+    TEST_CHECK(u32Step == 0);
+
+    TEST_CHECK(bPass() && u32Step == 1);
+    TEST_CHECK(bPass() && u32Step == 2);
+    TEST_CHECK(!bPass() && u32Step == 3);
+    TEST_CHECK(!APP_bPtRunning(&sSteps));
+
+    /* Nothing left to run */
+    TEST_CHECK(!bPass() && u32Step == 3);
+}
+
+/* A wait checks its condition once per pass until it holds */
+PRIVATE void vTestWaitUntil(void)
+{
+    uint8 i;
+
+    u32Checks = 0;
+    bCondition = FALSE;
+    APP_bPtStart(&sWait);
+    for (i = 0; i < 5; i++) {
+        TEST_CHECK(bPass());
+    }
+    TEST_CHECK(u32Checks == 5);
+
+    bCondition = TRUE;
+    TEST_CHECK(!bPass());
+    TEST_CHECK(u32Checks == 6);
+    TEST_CHECK(!APP_bPtRunning(&sWait));
+}
+
+/* Starting a running thread leaves it where it is */
+PRIVATE void vTestStartWhileRunning(void)
+{
+    u32Step = 0;
+    APP_bPtStart(&sSteps);
+    bPass();
+    TEST_CHECK(APP_bPtStart(&sSteps));
+    TEST_CHECK(bPass() && u32Step == 2);
+    TEST_CHECK(!bPass() && u32Step == 3);
+}
+
+/* A finished thread starts again from the beginning */
+PRIVATE void vTestRestartWhenDone(void)
+{
+    u32Step = 0;
+    TEST_CHECK(APP_bPtStart(&sSteps));
+    TEST_CHECK(bPass() && u32Step == 1);
+    while (bPass()) {
+    }
+    TEST_CHECK(u32Step == 3);
+}
+
+/* With every slot taken a start fails, until a thread finishes */
+PRIVATE void vTestSlotsFull(void)
+{
+    uint8 i;
+
+    bCondition = FALSE;
+    for (i = 0; i < APP_PT_MAX_THREADS; i++) {
+        APP_vPtCreate(&asFill[i], ptWait);
+        TEST_CHECK(APP_bPtStart(&asFill[i]));
+    }
+
+    u32Step = 0;
+    TEST_CHECK(!APP_bPtStart(&sSteps));
+    TEST_CHECK(!APP_bPtRunning(&sSteps));
+    bPass();
+    TEST_CHECK(u32Step == 0);
+
+    bCondition = TRUE;
+    TEST_CHECK(!bPass());
+    TEST_CHECK(APP_bPtStart(&sSteps));
+    while (bPass()) {
+    }
+    TEST_CHECK(u32Step == 3);
+}
+
+/* A thread may start another while the task runs */
+PRIVATE void vTestStartFromThread(void)
+{
+    u32Step = 0;
+    APP_bPtStart(&sStarter);
+    TEST_CHECK(bPass());
+    TEST_CHECK(APP_bPtRunning(&sSteps));
+    while (bPass()) {
+    }
+    TEST_CHECK(u32Step == 3);
+    TEST_CHECK(!APP_bPtRunning(&sStarter));
+}
+
+/* One run of the task, as the main loop does while it is ready. Returns
+ * whether it made itself ready again. */
+PRIVATE bool_t bPass(void)
+{
+    if (bPtReady) {
+        bPtReady = FALSE;
+        APP_taskPt();
+    }
+
+    return bPtReady;
+}
+
+PRIVATE APP_tePtState ptSteps(APP_tsPt *psPt)
+{
+    APP_PT_BEGIN(psPt);
+
+    u32Step = 1;
+    APP_PT_YIELD(psPt);
+    u32Step = 2;
+    APP_PT_YIELD(psPt);
+    u32Step = 3;
+
+    APP_PT_END(psPt);
+}
+
+PRIVATE APP_tePtState ptWait(APP_tsPt *psPt)
+{
+    APP_PT_BEGIN(psPt);
+
+    APP_PT_WAIT_UNTIL(psPt, (u32Checks++, bCondition));
+
+    APP_PT_END(psPt);
+}
+
+PRIVATE APP_tePtState ptStarter(APP_tsPt *psPt)
+{
+    APP_PT_BEGIN(psPt);
+
+    TEST_CHECK(APP_bPtStart(&sSteps));
+
+    APP_PT_END(psPt);
+}
+
+/****************************************************************************/
+/***        END OF FILE                                                   ***/
+/****************************************************************************/
@@ -0,0 +1,220 @@
+/****************************************************************************
+ *
+ * MODULE:              Lumi Router
+ *
+ * COMPONENT:           test_queue.c
+ *
+ * DESCRIPTION:         Host tests of the queue usage counters
+ *
+ ****************************************************************************
+ *
+ * This software is owned by NXP B.V. and/or its supplier and is protected
+ * under applicable copyright laws. All rights are reserved. We grant You,
+ * and any third parties, a license to use this software solely and
+ * exclusively on NXP products [NXP Microcontrollers such as JN5168, JN5179].
+ * You, and any third parties must reproduce the copyright and warranty notice
+ * and any other legend of ownership on each copy or partial copy of the
+ * software.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+ * AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+ * IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE
+ * ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE
+ * LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR
+ * CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF
+ * SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS
+ * INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN
+ * CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE)
+ * ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+ * POSSIBILITY OF SUCH DAMAGE.
+ *
+ * Copyright NXP B.V. 2016. All rights reserved
+ *
+ ****************************************************************************/
+
+/****************************************************************************/
+/***        Include Files                                                 ***/
+/****************************************************************************/
+
+#include <jendefs.h>
+
+/* Application */
+#include "app_queue.h"
+#include "test.h"
+
+/* SDK JN-SW-4170 */
+#include "ZQueue.h"
+#include "portmacro.h"
+
+/****************************************************************************/
+/***        Macro Definitions                                             ***/
+/****************************************************************************/
+
+#define QUEUE_LENGTH 4
+
+/****************************************************************************/
+/***        Local Function Prototypes                                     ***/
+/****************************************************************************/
+
+PRIVATE void vTestPeak(void);
+PRIVATE void vTestRefused(void);
+PRIVATE void vTestUntracked(void);
+PRIVATE void vTestReset(void);
+
+/****************************************************************************/
+/***        Local Variables                                               ***/
+/****************************************************************************/
+
+PRIVATE tszQueue sTracked;
+PRIVATE tszQueue sOther;
+PRIVATE tszQueue sUntracked;
+PRIVATE uint32 au32Tracked[QUEUE_LENGTH];
+PRIVATE uint32 au32Other[QUEUE_LENGTH];
+PRIVATE uint32 au32Untracked[QUEUE_LENGTH];
+
+/* Depth of the critical section stand-in */
+PRIVATE uint32 u32CriticalDepth;
+
+/****************************************************************************/
+/***        Exported Functions                                            ***/
+/****************************************************************************/
+
+int main(void)
+{
+    APP_vQueueCreate(E_APP_QUEUE_TIME_EVENTS, &sTracked, QUEUE_LENGTH, sizeof(uint32), (uint8 *)au32Tracked);
+    APP_vQueueCreate(E_APP_QUEUE_SERIAL_FRAMES, &sOther, QUEUE_LENGTH, sizeof(uint32), (uint8 *)au32Other);
+    ZQ_vQueueCreate(&sUntracked, QUEUE_LENGTH, sizeof(uint32), (uint8 *)au32Untracked);
+
+    vTestPeak();
+    vTestRefused();
+    vTestUntracked();
+    vTestReset();
+
+    return TEST_RESULT();
+}
+
+PUBLIC uint8 ZPS_eEnterCriticalSection(void *hMutex, uint32 *psIntStore)
+{
+    u32CriticalDepth++;
+    return 0;
+}
+
+PUBLIC uint8 ZPS_eExitCriticalSection(void *hMutex, uint32 *psIntStore)
+{
+    TEST_CHECK(u32CriticalDepth > 0);
+    u32CriticalDepth--;
+    return 0;
+}
+
+/****************************************************************************/
+/***        Local Functions                                               ***/
+/****************************************************************************/
+
+/* The peak is the most messages waiting at once, not the number sent */
+PRIVATE void vTestPeak(void)
+{
+    APP_tsQueueStats sStats;
+    uint32 u32Item = 0;
+    uint8 i;
+
+    APP_vGetQueueStats(E_APP_QUEUE_TIME_EVENTS, &sStats);
+    TEST_CHECK(sStats.u16Size == QUEUE_LENGTH);
+    TEST_CHECK((sStats.u16Peak == 0) && (sStats.u32Failed == 0));
+
+    for (i = 0; i < 10; i++) {
+        TEST_CHECK(ZQ_bQueueSend(&sTracked, &u32Item));
+        TEST_CHECK(ZQ_bQueueReceive(&sTracked, &u32Item));
+    }
+    APP_vGetQueueStats(E_APP_QUEUE_TIME_EVENTS, &sStats);
+    TEST_CHECK(sStats.u16Peak == 1);
+
+    TEST_CHECK(ZQ_bQueueSend(&sTracked, &u32Item));
+    TEST_CHECK(ZQ_bQueueSend(&sTracked, &u32Item));
+    TEST_CHECK(ZQ_bQueueSend(&sTracked, &u32Item));
+    TEST_CHECK(ZQ_bQueueReceive(&sTracked, &u32Item));
+    TEST_CHECK(ZQ_bQueueReceive(&sTracked, &u32Item));
+    TEST_CHECK(ZQ_bQueueSend(&sTracked, &u32Item));
+    APP_vGetQueueStats(E_APP_QUEUE_TIME_EVENTS, &sStats);
+    TEST_CHECK(sStats.u16Peak == 3);
+    TEST_CHECK(sStats.u32Failed == 0);
+    TEST_CHECK(u32CriticalDepth == 0);
+
+    /* Sends to one queue leave the others alone */
+    APP_vGetQueueStats(E_APP_QUEUE_SERIAL_FRAMES, &sStats);
+    TEST_CHECK((sStats.u16Peak == 0) && (sStats.u32Failed == 0));
+
+    while (ZQ_bQueueReceive(&sTracked, &u32Item)) {
+    }
+}
+
+/* A send to a full queue is refused and counted, and the peak stops at
+ * the queue length */
+PRIVATE void vTestRefused(void)
+{
+    APP_tsQueueStats sStats;
+    uint32 u32Item = 0;
+    uint8 i;
+
+    for (i = 0; i < QUEUE_LENGTH; i++) {
+        TEST_CHECK(ZQ_bQueueSend(&sOther, &u32Item));
+    }
+    TEST_CHECK(!ZQ_bQueueSend(&sOther, &u32Item));
+    TEST_CHECK(!ZQ_bQueueSend(&sOther, &u32Item));
+
+    APP_vGetQueueStats(E_APP_QUEUE_SERIAL_FRAMES, &sStats);
+    TEST_CHECK(sStats.u16Size == QUEUE_LENGTH);
+    TEST_CHECK(sStats.u16Peak == QUEUE_LENGTH);
+    TEST_CHECK(sStats.u32Failed == 2);
+
+    APP_vGetQueueStats(E_APP_QUEUE_TIME_EVENTS, &sStats);
+    TEST_CHECK(sStats.u32Failed == 0);
+}
+
+/* Queues not created through APP_vQueueCreate still work but are not
+ * counted */
+PRIVATE void vTestUntracked(void)
+{
+    APP_tsQueueStats sBefore[E_APP_QUEUE_COUNT];
+    APP_tsQueueStats sAfter;
+    uint32 u32Item = 42;
+    uint8 i;
+
+    for (i = 0; i < E_APP_QUEUE_COUNT; i++) {
+        APP_vGetQueueStats((APP_teQueue)i, &sBefore[i]);
+    }
+
+    for (i = 0; i <= QUEUE_LENGTH; i++) {
+        TEST_CHECK(ZQ_bQueueSend(&sUntracked, &u32Item) == (i < QUEUE_LENGTH));
+    }
+    TEST_CHECK(ZQ_bQueueReceive(&sUntracked, &u32Item) && (u32Item == 42));
+
+    for (i = 0; i < E_APP_QUEUE_COUNT; i++) {
+        APP_vGetQueueStats((APP_teQueue)i, &sAfter);
+        TEST_CHECK((sAfter.u16Peak == sBefore[i].u16Peak) && (sAfter.u32Failed == sBefore[i].u32Failed));
+    }
+}
+
+/* A reset clears the counters of every queue but keeps their sizes */
+PRIVATE void vTestReset(void)
+{
+    APP_tsQueueStats sStats;
+    uint32 u32Item = 0;
+
+    APP_vResetQueueStats();
+    APP_vGetQueueStats(E_APP_QUEUE_SERIAL_FRAMES, &sStats);
+    TEST_CHECK(sStats.u16Size == QUEUE_LENGTH);
+    TEST_CHECK((sStats.u16Peak == 0) && (sStats.u32Failed == 0));
+    APP_vGetQueueStats(E_APP_QUEUE_TIME_EVENTS, &sStats);
+    TEST_CHECK((sStats.u16Peak == 0) && (sStats.u32Failed == 0));
+
+    /* The next send counts from what is waiting now */
+    TEST_CHECK(ZQ_bQueueReceive(&sOther, &u32Item));
+    TEST_CHECK(ZQ_bQueueSend(&sOther, &u32Item));
+    APP_vGetQueueStats(E_APP_QUEUE_SERIAL_FRAMES, &sStats);
+    TEST_CHECK(sStats.u16Peak == QUEUE_LENGTH);
+    TEST_CHECK(u32CriticalDepth == 0);
+}
+
+/****************************************************************************/
+/***        END OF FILE                                                   ***/
+/****************************************************************************/
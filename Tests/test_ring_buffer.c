@@ -0,0 +1,264 @@
+/****************************************************************************
+ *
+ * MODULE:              Lumi Router
+ *
+ * COMPONENT:           test_ring_buffer.c
+ *
+ * DESCRIPTION:         Host test of the SPSC byte ring
+ *
+ ****************************************************************************
+ *
+ * This software is owned by NXP B.V. and/or its supplier and is protected
+ * under applicable copyright laws. All rights are reserved. We grant You,
+ * and any third parties, a license to use this software solely and
+ * exclusively on NXP products [NXP Microcontrollers such as JN5168, JN5179].
+ * You, and any third parties must reproduce the copyright and warranty notice
+ * and any other legend of ownership on each copy or partial copy of the
+ * software.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+ * AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+ * IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE
+ * ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE
+ * LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR
+ * CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF
+ * SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS
+ * INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN
+ * CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE)
+ * ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+ * POSSIBILITY OF SUCH DAMAGE.
+ *
+ * Copyright NXP B.V. 2016. All rights reserved
+ *
+ ****************************************************************************/
+
+/****************************************************************************/
+/***        Include Files                                                 ***/
+/****************************************************************************/
+
+#include <jendefs.h>
+#include <pthread.h>
+#include <sched.h>
+#include <string.h>
+
+/* Application */
+#include "app_ring_buffer.h"
+#include "test.h"
+
+/****************************************************************************/
+/***        Macro Definitions                                             ***/
+/****************************************************************************/
+
+#define RING_SIZE 64
+
+/* Bytes passed between the threads, enough to wrap the uint16 indices */
+#define THREAD_BYTES 4000000UL
+
+/****************************************************************************/
+/***        Local Function Prototypes                                     ***/
+/****************************************************************************/
+
+PRIVATE void vTestEmpty(void);
+PRIVATE void vTestFull(void);
+PRIVATE void vTestIndexWrap(void);
+PRIVATE void vTestBulk(void);
+PRIVATE void vTestThreads(void);
+PRIVATE void *pvProducer(void *pvArg);
+
+/****************************************************************************/
+/***        Local Variables                                               ***/
+/****************************************************************************/
+
+PRIVATE uint8 au8Storage[RING_SIZE];
+PRIVATE RB_tsRingBuffer sRing;
+
+/****************************************************************************/
+/***        Exported Functions                                            ***/
+/****************************************************************************/
+
+int main(void)
+{
+    vTestEmpty();
+    vTestFull();
+    vTestIndexWrap();
+    vTestBulk();
+    vTestThreads();
+
+    return TEST_RESULT();
+}
+
+/****************************************************************************/
+/***        Local Functions                                               ***/
+/****************************************************************************/
+
+/* A new ring holds nothing and has room for its whole size */
+PRIVATE void vTestEmpty(void)
+{
+    uint8 u8Byte;
+    uint8 au8Data[4];
+
+    RB_vInit(&sRing, au8Storage, RING_SIZE);
+
+    TEST_CHECK(RB_bIsEmpty(&sRing));
+    TEST_CHECK(RB_u16Count(&sRing) == 0);
+    TEST_CHECK(RB_u16Free(&sRing) == RING_SIZE);
+    TEST_CHECK(!RB_bPop(&sRing, &u8Byte));
+    TEST_CHECK(!RB_bPeek(&sRing, &u8Byte));
+    TEST_CHECK(RB_u16PopN(&sRing, au8Data, sizeof(au8Data)) == 0);
+}
+
+/* Every slot is usable, a full ring refuses more and gives the bytes back
+ * in order */
+PRIVATE void vTestFull(void)
+{
+    uint8 u8Byte;
+    uint16 i;
+
+    RB_vInit(&sRing, au8Storage, RING_SIZE);
+
+    for (i = 0; i < RING_SIZE; i++) {
+        TEST_CHECK(RB_bPush(&sRing, (uint8)i));
+    }
+    TEST_CHECK(!RB_bPush(&sRing, 0xFF));
+    TEST_CHECK(RB_u16PushN(&sRing, &u8Byte, 1) == 0);
+    TEST_CHECK(RB_u16Count(&sRing) == RING_SIZE);
+    TEST_CHECK(RB_u16Free(&sRing) == 0);
+
+    TEST_CHECK(RB_bPeek(&sRing, &u8Byte) && (u8Byte == 0));
+    TEST_CHECK(RB_u16Count(&sRing) == RING_SIZE);
+
+    for (i = 0; i < RING_SIZE; i++) {
+        TEST_CHECK(RB_bPop(&sRing, &u8Byte) && (u8Byte == (uint8)i));
+    }
+    TEST_CHECK(RB_bIsEmpty(&sRing));
+}
+
+/* The free running indices wrap at 65536 without losing count */
+PRIVATE void vTestIndexWrap(void)
+{
+    uint32 u32In = 0;
+    uint32 u32Out = 0;
+    uint32 i;
+    uint16 u16Burst;
+    uint8 u8Byte;
+    bool_t bInOrder = TRUE;
+
+    RB_vInit(&sRing, au8Storage, RING_SIZE);
+
+    for (i = 0; u32Out < 200000; i++) {
+        /* Vary the burst sizes so the fill level moves between empty and full */
+        for (u16Burst = (uint16)(i % RING_SIZE) + 1; (u16Burst > 0) && RB_bPush(&sRing, (uint8)u32In); u16Burst--) {
+            u32In++;
+        }
+        for (u16Burst = (uint16)((i * 7) % RING_SIZE) + 1; (u16Burst > 0) && RB_bPop(&sRing, &u8Byte); u16Burst--) {
+            bInOrder &= (u8Byte == (uint8)u32Out);
+            u32Out++;
+        }
+        bInOrder &= (RB_u16Count(&sRing) == (uint16)(u32In - u32Out));
+        bInOrder &= (RB_u16Count(&sRing) + RB_u16Free(&sRing) == RING_SIZE);
+    }
+
+    TEST_CHECK(bInOrder);
+}
+
+/* Bulk copies split at the end of the storage and stop at full or empty */
+PRIVATE void vTestBulk(void)
+{
+    uint8 au8In[RING_SIZE * 2];
+    uint8 au8Out[RING_SIZE * 2];
+    uint16 u16Offset;
+    uint16 i;
+
+    for (i = 0; i < sizeof(au8In); i++) {
+        au8In[i] = (uint8)(i * 7 + 3);
+    }
+
+    /* Start at every offset, so that each copy wraps at a different place */
+    for (u16Offset = 0; u16Offset < RING_SIZE; u16Offset++) {
+        RB_vInit(&sRing, au8Storage, RING_SIZE);
+        for (i = 0; i < u16Offset; i++) {
+            RB_bPush(&sRing, 0);
+        }
+        TEST_CHECK(RB_u16PopN(&sRing, au8Out, u16Offset) == u16Offset);
+
+        TEST_CHECK(RB_u16PushN(&sRing, au8In, 10) == 10);
+        TEST_CHECK(RB_u16PushN(&sRing, &au8In[10], sizeof(au8In) - 10) == RING_SIZE - 10);
+        TEST_CHECK(RB_u16Free(&sRing) == 0);
+
+        memset(au8Out, 0, sizeof(au8Out));
+        TEST_CHECK(RB_u16PopN(&sRing, au8Out, 5) == 5);
+        TEST_CHECK(RB_u16PopN(&sRing, &au8Out[5], sizeof(au8Out) - 5) == RING_SIZE - 5);
+        TEST_CHECK(memcmp(au8In, au8Out, RING_SIZE) == 0);
+        TEST_CHECK(RB_bIsEmpty(&sRing));
+    }
+}
+
+/* One producer thread and one consumer thread, as the UART ISR and the
+ * serial task, with no locking between them. Each side yields when it can
+ * make no progress, so the test also finishes on a single core. */
+PRIVATE void vTestThreads(void)
+{
+    pthread_t sThread;
+    uint8 au8Out[48];
+    uint32 u32Out = 0;
+    uint32 u32Errors = 0;
+    uint16 u16Length;
+    uint16 i;
+
+    RB_vInit(&sRing, au8Storage, RING_SIZE);
+    pthread_create(&sThread, NULL, pvProducer, NULL);
+
+    while (u32Out < THREAD_BYTES) {
+        if (u32Out & 1) {
+            u16Length = RB_u16PopN(&sRing, au8Out, (uint16)(1 + (u32Out % sizeof(au8Out))));
+        }
+        else {
+            u16Length = RB_bPop(&sRing, au8Out) ? 1 : 0;
+        }
+        if (u16Length == 0) {
+            sched_yield();
+        }
+        for (i = 0; i < u16Length; i++) {
+            if (au8Out[i] != (uint8)(u32Out * 13)) {
+                u32Errors++;
+            }
+            u32Out++;
+        }
+    }
+
+    pthread_join(sThread, NULL);
+
+    TEST_CHECK(u32Errors == 0);
+    TEST_CHECK(RB_bIsEmpty(&sRing));
+}
+
+PRIVATE void *pvProducer(void *pvArg)
+{
+    uint8 au8In[32];
+    uint32 u32In = 0;
+    uint16 u16Length;
+    uint16 i;
+
+    (void)pvArg;
+
+    while (u32In < THREAD_BYTES) {
+        u16Length = (uint16)(1 + (u32In % sizeof(au8In)));
+        if (u16Length > THREAD_BYTES - u32In) {
+            u16Length = (uint16)(THREAD_BYTES - u32In);
+        }
+        for (i = 0; i < u16Length; i++) {
+            au8In[i] = (uint8)((u32In + i) * 13);
+        }
+        u16Length = RB_u16PushN(&sRing, au8In, u16Length);
+        if (u16Length == 0) {
+            sched_yield();
+        }
+        u32In += u16Length;
+    }
+
+    return NULL;
+}
+
+/****************************************************************************/
+/***        END OF FILE                                                   ***/
+/****************************************************************************/
@@ -0,0 +1,456 @@
+/****************************************************************************
+ *
+ * MODULE:              Lumi Router
+ *
+ * COMPONENT:           test_scheduler.c
+ *
+ * DESCRIPTION:         Tests of the main loop scheduler and ZTimer wakeups
+ *
+ ****************************************************************************
+ *
+ * This software is owned by NXP B.V. and/or its supplier and is protected
+ * under applicable copyright laws. All rights are reserved. We grant You,
+ * and any third parties, a license to use this software solely and
+ * exclusively on NXP products [NXP Microcontrollers such as JN5168, JN5179].
+ * You, and any third parties must reproduce the copyright and warranty notice
+ * and any other legend of ownership on each copy or partial copy of the
+ * software.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+ * AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+ * IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE
+ * ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE
+ * LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR
+ * CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF
+ * SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS
+ * INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN
+ * CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE)
+ * ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+ * POSSIBILITY OF SUCH DAMAGE.
+ *
+ * Copyright NXP B.V. 2016. All rights reserved
+ *
+ ****************************************************************************/
+
+/****************************************************************************/
+/***        Include Files                                                 ***/
+/****************************************************************************/
+
+#include <jendefs.h>
+#include <string.h>
+
+/* Application */
+#include "app_clock.h"
+#include "app_scheduler.h"
+#include "app_ztimer.h"
+#include "host_clock.h"
+#include "test.h"
+
+/* SDK JN-SW-4170 */
+#include "ZTimer.h"
+
+/****************************************************************************/
+/***        Macro Definitions                                             ***/
+/****************************************************************************/
+
+#define ZTIMER_STORAGE 8
+
+/* The first timer crosses the wrap of the millisecond clock */
+#define CLOCK_START 0xFFFFFFFAUL
+
+/****************************************************************************/
+/***        Type Definitions                                              ***/
+/****************************************************************************/
+
+/* Expiries of a test timer */
+typedef struct {
+    uint8 u8Index;
+    uint32 u32Fired;
+    uint32 u32LastFiredMsec;
+    uint32 u32Restart; /* restart from the callback with this time, if not 0 */
+} tsTestTimer;
+
+/****************************************************************************/
+/***        Local Function Prototypes                                     ***/
+/****************************************************************************/
+
+PRIVATE void vTestBootRunsAll(void);
+PRIVATE void vTestReadyDuringPass(void);
+PRIVATE void vTestDozeMasked(void);
+PRIVATE void vTestZTimerDue(void);
+PRIVATE void vTestNoStackWithoutExpiry(void);
+PRIVATE void vTestStartAfterIdle(void);
+PRIVATE void vTestStop(void);
+PRIVATE void vTestRestartFromCallback(void);
+PRIVATE void vTestRunHistogram(void);
+PRIVATE void vTestLoopTiming(void);
+
+PRIVATE void vOpenTimer(tsTestTimer *psTimer);
+PRIVATE uint32 u32RunPasses(void);
+PRIVATE uint32 u32Ticks(uint32 u32Count);
+PRIVATE void vTimerExpired(void *pvParam);
+PRIVATE void vRecordRun(APP_teTask eTask);
+
+PRIVATE void vTaskZps(void);
+PRIVATE void vTaskBdb(void);
+PRIVATE void vTaskZTimer(void);
+PRIVATE void vTaskSerial(void);
+PRIVATE void vTaskPt(void);
+PRIVATE void vDoze(void);
+
+/****************************************************************************/
+/***        Local Variables                                               ***/
+/****************************************************************************/
+
+PRIVATE const APP_tpfTask apfTasks[E_APP_TASK_COUNT] = {vTaskZps, vTaskBdb, vTaskZTimer, vTaskSerial, vTaskPt};
+
+/* Tasks in the order they ran */
+PRIVATE uint8 au8Order[16];
+PRIVATE uint8 u8Ran;
+
+PRIVATE uint32 au32Runs[E_APP_TASK_COUNT];
+PRIVATE bool_t bSerialSetsReady;
+
+/* Clock ticks the BDB task takes to run */
+PRIVATE uint32 u32BdbTicks;
+
+PRIVATE uint32 u32Dozes;
+PRIVATE bool_t bDozeMasked;
+
+PRIVATE ZTIMER_tsTimer asTimers[ZTIMER_STORAGE];
+
+/****************************************************************************/
+/***        Exported Functions                                            ***/
+/****************************************************************************/
+
+int main(void)
+{
+    HOST_vClockInit(CLOCK_START);
+
+    vTestBootRunsAll();
+    vTestReadyDuringPass();
+    vTestDozeMasked();
+    vTestZTimerDue();
+    vTestNoStackWithoutExpiry();
+    vTestStartAfterIdle();
+    vTestStop();
+    vTestRestartFromCallback();
+    vTestRunHistogram();
+    vTestLoopTiming();
+
+    return TEST_RESULT();
+}
+
+/****************************************************************************/
+/***        Local Functions                                               ***/
+/****************************************************************************/
+
+/* Every task runs once after boot, in task order */
+PRIVATE void vTestBootRunsAll(void)
+{
+    uint8 i;
+
+    TEST_CHECK(APP_bTasksReady());
+    TEST_CHECK(APP_u32RunReadyTasks(apfTasks) == APP_TASK_MASK(E_APP_TASK_COUNT) - 1);
+    TEST_CHECK(u8Ran == E_APP_TASK_COUNT);
+    for (i = 0; i < E_APP_TASK_COUNT; i++) {
+        TEST_CHECK(au8Order[i] == i);
+    }
+    TEST_CHECK(!APP_bTasksReady());
+}
+
+/* A task made ready during a pass runs in the next one, even one earlier
+ * in task order */
+PRIVATE void vTestReadyDuringPass(void)
+{
+    u8Ran = 0;
+    bSerialSetsReady = TRUE;
+    APP_vSetTaskReady(E_APP_TASK_SERIAL);
+
+    TEST_CHECK(APP_u32RunReadyTasks(apfTasks) == APP_TASK_MASK(E_APP_TASK_SERIAL));
+    TEST_CHECK(APP_bTasksReady());
+    TEST_CHECK(APP_u32RunReadyTasks(apfTasks) ==
+               (APP_TASK_MASK(E_APP_TASK_BDB) | APP_TASK_MASK(E_APP_TASK_SERIAL)));
+    TEST_CHECK(u8Ran == 3);
+    TEST_CHECK(au8Order[1] == E_APP_TASK_BDB && au8Order[2] == E_APP_TASK_SERIAL);
+    TEST_CHECK(!APP_bTasksReady());
+}
+
+/* The doze is only entered with no task ready, and with interrupts masked
+ * from the check until after it */
+PRIVATE void vTestDozeMasked(void)
+{
+    APP_vSetTaskReady(E_APP_TASK_PT);
+    TEST_CHECK(!APP_bDozeIfIdle(vDoze));
+    TEST_CHECK(u32Dozes == 0);
+
+    u32RunPasses();
+    TEST_CHECK(APP_bDozeIfIdle(vDoze));
+    TEST_CHECK(u32Dozes == 1);
+    TEST_CHECK(bDozeMasked);
+    TEST_CHECK(!HOST_bMasked);
+}
+
+/* The ZTimer task is made ready on the tick a timer is due and not before,
+ * and the stack runs after the expiry */
+PRIVATE void vTestZTimerDue(void)
+{
+    tsTestTimer sTimer = {0};
+    uint32 u32Start;
+    uint32 u32Ran;
+
+    APP_vZTimerInit(asTimers, ZTIMER_STORAGE);
+    vOpenTimer(&sTimer);
+
+    u32Start = HOST_u32ClockMsec;
+    TEST_CHECK(ZTIMER_eStart(sTimer.u8Index, ZTIMER_TIME_MSEC(10)) == E_ZTIMER_OK);
+    TEST_CHECK(u32Ticks(9) == 0);
+    TEST_CHECK(sTimer.u32Fired == 0);
+
+    u32Ran = u32Ticks(1);
+    TEST_CHECK(u32Ran == (APP_TASK_MASK(E_APP_TASK_ZTIMER) | APP_TASK_MASK(E_APP_TASK_ZPS)));
+    TEST_CHECK(sTimer.u32Fired == 1);
+    TEST_CHECK(sTimer.u32LastFiredMsec == u32Start + 10);
+    TEST_CHECK(HOST_u32ClockMsec < CLOCK_START);
+
+    /* Nothing running, so nothing wakes */
+    TEST_CHECK(u32Ticks(1000) == 0);
+}
+
+/* A run of the ZTimer task that expires nothing leaves the stack alone */
+PRIVATE void vTestNoStackWithoutExpiry(void)
+{
+    tsTestTimer sTimer = {0};
+
+    vOpenTimer(&sTimer);
+    ZTIMER_eStart(sTimer.u8Index, ZTIMER_TIME_MSEC(50));
+
+    APP_vSetTaskReady(E_APP_TASK_ZTIMER);
+    TEST_CHECK(u32RunPasses() == APP_TASK_MASK(E_APP_TASK_ZTIMER));
+    TEST_CHECK(sTimer.u32Fired == 0);
+
+    u32Ticks(50);
+    TEST_CHECK(sTimer.u32Fired == 1);
+    ZTIMER_eStop(sTimer.u8Index);
+}
+
+/* ZTIMER_vTask takes all the ticks since its last run off every timer. A
+ * timer started after a long idle spell must still run its full time, not
+ * expire on the next run for another timer. */
+PRIVATE void vTestStartAfterIdle(void)
+{
+    tsTestTimer sLong = {0};
+    tsTestTimer sShort = {0};
+    uint32 u32ZTimerRuns;
+    uint32 u32Start;
+
+    vOpenTimer(&sLong);
+    vOpenTimer(&sShort);
+    TEST_CHECK(u32Ticks(5000) == 0);
+
+    u32Start = HOST_u32ClockMsec;
+    u32ZTimerRuns = au32Runs[E_APP_TASK_ZTIMER];
+    ZTIMER_eStart(sLong.u8Index, ZTIMER_TIME_MSEC(100));
+    u32Ticks(5);
+    ZTIMER_eStart(sShort.u8Index, ZTIMER_TIME_MSEC(5));
+
+    u32Ticks(5);
+    TEST_CHECK(sShort.u32Fired == 1 && sShort.u32LastFiredMsec == u32Start + 10);
+    TEST_CHECK(sLong.u32Fired == 0);
+
+    u32Ticks(90);
+    TEST_CHECK(sLong.u32Fired == 1 && sLong.u32LastFiredMsec == u32Start + 100);
+    TEST_CHECK(au32Runs[E_APP_TASK_ZTIMER] - u32ZTimerRuns == 2);
+}
+
+/* A stopped timer no longer wakes the loop */
+PRIVATE void vTestStop(void)
+{
+    tsTestTimer sTimer = {0};
+
+    vOpenTimer(&sTimer);
+    ZTIMER_eStart(sTimer.u8Index, ZTIMER_TIME_MSEC(10));
+    TEST_CHECK(u32Ticks(3) == 0);
+    ZTIMER_eStop(sTimer.u8Index);
+    TEST_CHECK(u32Ticks(50) == 0);
+    TEST_CHECK(sTimer.u32Fired == 0);
+}
+
+/* A timer restarted from its callback, as the timer wheel does, wakes the
+ * loop once per period */
+PRIVATE void vTestRestartFromCallback(void)
+{
+    tsTestTimer sTimer = {0};
+    uint32 u32ZTimerRuns = au32Runs[E_APP_TASK_ZTIMER];
+    uint32 u32Start = HOST_u32ClockMsec;
+
+    vOpenTimer(&sTimer);
+    sTimer.u32Restart = 50;
+    ZTIMER_eStart(sTimer.u8Index, ZTIMER_TIME_MSEC(50));
+
+    u32Ticks(1000);
+    TEST_CHECK(sTimer.u32Fired == 20);
+    TEST_CHECK(sTimer.u32LastFiredMsec == u32Start + 1000);
+    TEST_CHECK(au32Runs[E_APP_TASK_ZTIMER] - u32ZTimerRuns == 20);
+    ZTIMER_eStop(sTimer.u8Index);
+}
+
+PRIVATE void vOpenTimer(tsTestTimer *psTimer)
+{
+    TEST_CHECK(ZTIMER_eOpen(&psTimer->u8Index, vTimerExpired, psTimer, ZTIMER_FLAG_PREVENT_SLEEP) == E_ZTIMER_OK);
+}
+
+/* A run of 2^n to 2^(n+1) - 1 us lands in bin n. Shorter runs go to bin
+ * 0 and longer ones to the last bin. */
+PRIVATE void vTestRunHistogram(void)
+{
+    static const struct {
+        uint32 u32Ticks;
+        uint8 u8Bin;
+    } asRuns[] = {
+        {0, 0},
+        {APP_CLOCK_TICKS_PER_USEC - 1, 0},
+        {APP_CLOCK_USEC(1), 0},
+        {APP_CLOCK_USEC(2), 1},
+        {APP_CLOCK_USEC(3) + APP_CLOCK_TICKS_PER_USEC - 1, 1},
+        {APP_CLOCK_USEC(4), 2},
+        {APP_CLOCK_USEC(1023), 9},
+        {APP_CLOCK_USEC(1024), 10},
+        {APP_CLOCK_USEC(32767), 14},
+        {APP_CLOCK_USEC(32768), 15},
+        {APP_CLOCK_USEC(65536), 15},
+        {APP_CLOCK_USEC(10000000), 15},
+    };
+    APP_tsTaskStats sStats;
+    uint32 au32Bins[APP_TASK_HISTOGRAM_BINS] = {0};
+    uint64 u64Sum = 0;
+    uint8 i;
+
+    APP_vResetTaskStats();
+    for (i = 0; i < sizeof(asRuns) / sizeof(asRuns[0]); i++) {
+        u32BdbTicks = asRuns[i].u32Ticks;
+        APP_vSetTaskReady(E_APP_TASK_BDB);
+        TEST_CHECK(APP_u32RunReadyTasks(apfTasks) == APP_TASK_MASK(E_APP_TASK_BDB));
+
+        au32Bins[asRuns[i].u8Bin]++;
+        u64Sum += asRuns[i].u32Ticks;
+        APP_vGetTaskStats(E_APP_TASK_BDB, &sStats);
+        TEST_CHECK(memcmp(sStats.au32Histogram, au32Bins, sizeof(au32Bins)) == 0);
+    }
+    u32BdbTicks = 0;
+
+    TEST_CHECK(sStats.u32Runs == (uint32)i);
+    TEST_CHECK(sStats.u32MinTicks == 0);
+    TEST_CHECK(sStats.u32MaxTicks == APP_CLOCK_USEC(10000000));
+    TEST_CHECK(sStats.u64SumTicks == u64Sum);
+
+    /* Only the task that ran is timed */
+    APP_vGetTaskStats(E_APP_TASK_ZPS, &sStats);
+    TEST_CHECK(sStats.u32Runs == 0);
+}
+
+/* The loop slot times from one watchdog restart to the next, starting
+ * with the second */
+PRIVATE void vTestLoopTiming(void)
+{
+    APP_tsTaskStats sStats;
+
+    APP_vResetTaskStats();
+    APP_vLoopPassDone();
+    HOST_u32ClockExtraTicks += APP_CLOCK_USEC(300);
+    APP_vLoopPassDone();
+    HOST_u32ClockExtraTicks += APP_CLOCK_USEC(5000);
+    APP_vLoopPassDone();
+
+    APP_vGetTaskStats(APP_TASK_STATS_LOOP, &sStats);
+    TEST_CHECK(sStats.u32Runs == 2);
+    TEST_CHECK(sStats.u32MinTicks == APP_CLOCK_USEC(300));
+    TEST_CHECK(sStats.u32MaxTicks == APP_CLOCK_USEC(5000));
+    TEST_CHECK((sStats.au32Histogram[8] == 1) && (sStats.au32Histogram[12] == 1));
+}
+
+/* Main loop passes until no task is ready */
+PRIVATE uint32 u32RunPasses(void)
+{
+    uint32 u32Ran = 0;
+
+    while (APP_bTasksReady()) {
+        u32Ran |= APP_u32RunReadyTasks(apfTasks);
+    }
+
+    return u32Ran;
+}
+
+/* Tick interrupts, each followed by the passes it causes */
+PRIVATE uint32 u32Ticks(uint32 u32Count)
+{
+    uint32 u32Ran = 0;
+
+    while (u32Count-- > 0) {
+        HOST_vTick();
+        u32Ran |= u32RunPasses();
+    }
+
+    return u32Ran;
+}
+
+PRIVATE void vTimerExpired(void *pvParam)
+{
+    tsTestTimer *psTimer = (tsTestTimer *)pvParam;
+
+    psTimer->u32Fired++;
+    psTimer->u32LastFiredMsec = HOST_u32ClockMsec;
+    if (psTimer->u32Restart != 0) {
+        ZTIMER_eStart(psTimer->u8Index, ZTIMER_TIME_MSEC(psTimer->u32Restart));
+    }
+}
+
+PRIVATE void vRecordRun(APP_teTask eTask)
+{
+    if (u8Ran < sizeof(au8Order)) {
+        au8Order[u8Ran++] = (uint8)eTask;
+    }
+    au32Runs[eTask]++;
+}
+
+PRIVATE void vTaskZps(void)
+{
+    vRecordRun(E_APP_TASK_ZPS);
+}
+
+PRIVATE void vTaskBdb(void)
+{
+    vRecordRun(E_APP_TASK_BDB);
+    HOST_u32ClockExtraTicks += u32BdbTicks;
+}
+
+PRIVATE void vTaskZTimer(void)
+{
+    vRecordRun(E_APP_TASK_ZTIMER);
+    APP_vZTimerTask();
+}
+
+PRIVATE void vTaskSerial(void)
+{
+    vRecordRun(E_APP_TASK_SERIAL);
+    if (bSerialSetsReady) {
+        bSerialSetsReady = FALSE;
+        APP_vSetTaskReady(E_APP_TASK_BDB);
+        APP_vSetTaskReady(E_APP_TASK_SERIAL);
+    }
+}
+
+PRIVATE void vTaskPt(void)
+{
+    vRecordRun(E_APP_TASK_PT);
+}
+
+PRIVATE void vDoze(void)
+{
+    u32Dozes++;
+    bDozeMasked = HOST_bMasked;
+}
+
+/****************************************************************************/
+/***        END OF FILE                                                   ***/
+/****************************************************************************/
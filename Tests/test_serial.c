@@ -0,0 +1,673 @@
+/****************************************************************************
+ *
+ * MODULE:              Lumi Router
+ *
+ * COMPONENT:           test_serial.c
+ *
+ * DESCRIPTION:         Host tests for the serial link
+ *
+ ****************************************************************************
+ *
+ * This software is owned by NXP B.V. and/or its supplier and is protected
+ * under applicable copyright laws. All rights are reserved. We grant You,
+ * and any third parties, a license to use this software solely and
+ * exclusively on NXP products [NXP Microcontrollers such as JN5168, JN5179].
+ * You, and any third parties must reproduce the copyright and warranty notice
+ * and any other legend of ownership on each copy or partial copy of the
+ * software.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+ * AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+ * IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE
+ * ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE
+ * LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR
+ * CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF
+ * SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS
+ * INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN
+ * CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE)
+ * ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+ * POSSIBILITY OF SUCH DAMAGE.
+ *
+ * Copyright NXP B.V. 2016. All rights reserved
+ *
+ ****************************************************************************/
+
+/****************************************************************************/
+/***        Include Files                                                 ***/
+/****************************************************************************/
+
+#include <jendefs.h>
+#include <string.h>
+
+/* Application */
+#include "app_crc16.h"
+#include "app_main.h"
+#include "app_ring_buffer.h"
+#include "app_scheduler.h"
+#include "app_serial_commands.h"
+#include "host_serial.h"
+#include "test.h"
+
+/****************************************************************************/
+/***        Macro Definitions                                             ***/
+/****************************************************************************/
+
+/* Message types not known to the command handler */
+#define TEST_EVENT_TYPE     SERIAL_CHANNEL_TYPE(E_SERIAL_CHANNEL_EVENT, 0x40)
+#define TEST_TELEMETRY_TYPE SERIAL_CHANNEL_TYPE(E_SERIAL_CHANNEL_TELEMETRY, 0x40)
+#define TEST_RESPONSE_TYPE  SERIAL_CHANNEL_TYPE(E_SERIAL_CHANNEL_RESPONSE, 0x40)
+#define TEST_LOG_TYPE       SERIAL_CHANNEL_TYPE(E_SERIAL_CHANNEL_LOG, 0x40)
+
+/* Commands, from app_serial_commands.c */
+#define TEST_MSG_SET_PROTOCOL_VERSION 0x0014
+#define TEST_MSG_BENCHMARK            0x0016
+#define TEST_MSG_BENCHMARK_DATA       0x0017
+#define TEST_MSG_GET_LINK_STATS       0x0018
+#define TEST_MSG_SET_LOG_LEVEL        0x0019
+#define TEST_MSG_GET_TASK_STATS       0x001C
+
+#define TEST_RESPONSE_FLAG 0x8000
+
+/* Benchmark data sent by the firmware */
+#define TEST_BENCHMARK_TELEMETRY_TYPE SERIAL_CHANNEL_TYPE(E_SERIAL_CHANNEL_TELEMETRY, 0x17)
+
+/* Task stats reply: five uint32s and the histogram bins */
+#define TEST_TASK_STATS_SIZE (5 * 4 + 4 * APP_TASK_HISTOGRAM_BINS)
+
+/****************************************************************************/
+/***        Type Definitions                                              ***/
+/****************************************************************************/
+
+/* Serial link counters the tests read */
+typedef enum {
+    E_TEST_STAT_TX_DROPPED,
+    E_TEST_STAT_CRC_ERRORS
+} teTestStat;
+
+/****************************************************************************/
+/***        Local Function Prototypes                                     ***/
+/****************************************************************************/
+
+PRIVATE void vTestCrc(void);
+PRIVATE void vTestRawWrite(void);
+PRIVATE void vTestFrameEscaping(void);
+PRIVATE void vTestGatheredWrite(void);
+PRIVATE void vTestOneKickPerMessage(void);
+PRIVATE void vTestAllOrNothing(void);
+PRIVATE void vTestStrictPriority(void);
+PRIVATE void vTestWholeFrames(void);
+PRIVATE void vTestFrameAcrossVersionChange(void);
+PRIVATE void vTestResponses(void);
+PRIVATE void vTestFullWindow(void);
+PRIVATE void vTestBenchmarkEcho(void);
+PRIVATE void vTestLargestEcho(void);
+PRIVATE void vTestEscapedReceive(void);
+PRIVATE void vSetVersion(uint8 u8Version);
+PRIVATE uint32 u32LinkStat(teTestStat eStat);
+
+/****************************************************************************/
+/***        Local Variables                                               ***/
+/****************************************************************************/
+
+/* Protocol version of the link, which starts in version 1 */
+PRIVATE uint8 u8LinkVersion = 1;
+
+/* Requests the firmware accepts outstanding, from its version 3 reply */
+PRIVATE uint8 u8LinkWindow;
+
+/* Sequence numbers for requests the tests do not check the cache of */
+PRIVATE uint8 u8NextSeq = 100;
+
+/****************************************************************************/
+/***        Exported Functions                                            ***/
+/****************************************************************************/
+
+int main(void)
+{
+    HOST_vSerialInit();
+    HOST_vSetVersion(u8LinkVersion);
+
+    vTestCrc();
+    vTestRawWrite();
+    vTestFrameEscaping();
+    vTestGatheredWrite();
+    vTestOneKickPerMessage();
+    vTestAllOrNothing();
+    vTestStrictPriority();
+    vTestWholeFrames();
+
+    vTestFrameAcrossVersionChange();
+    vSetVersion(3);
+    vTestResponses();
+    vTestFullWindow();
+    vTestBenchmarkEcho();
+    vTestLargestEcho();
+    vTestEscapedReceive();
+
+    return TEST_RESULT();
+}
+
+/****************************************************************************/
+/***        Local Functions                                               ***/
+/****************************************************************************/
+
+/* The CRC-16 matches the published check value */
+PRIVATE void vTestCrc(void)
+{
+    TEST_CHECK(CRC16_u16UpdateBlock(CRC16_INIT, (const uint8 *)"123456789", 9) == 0x29B1);
+}
+
+/* A raw write reaches the wire unchanged */
+PRIVATE void vTestRawWrite(void)
+{
+    uint8 au8Wire[32];
+
+    HOST_vSerialInit();
+    APP_WriteMessageToSerial("Reset...........");
+    HOST_vRunSerial();
+
+    TEST_CHECK(HOST_u32WireRead(au8Wire, sizeof(au8Wire)) == 16);
+    TEST_CHECK(memcmp(au8Wire, "Reset...........", 16) == 0);
+}
+
+/* Every byte value, framing characters included, survives a frame */
+PRIVATE void vTestFrameEscaping(void)
+{
+    APP_tsSerialIoVec sPayload;
+    HOST_tsFrame sFrame;
+    uint8 au8Data[128];
+    uint16 u16Base;
+    uint16 i;
+
+    HOST_vSerialInit();
+    for (u16Base = 0; u16Base < 256; u16Base += sizeof(au8Data)) {
+        for (i = 0; i < sizeof(au8Data); i++) {
+            au8Data[i] = (uint8)(u16Base + i);
+        }
+
+        sPayload.pu8Data = au8Data;
+        sPayload.u16Length = sizeof(au8Data);
+        TEST_CHECK(APP_bWriteFrameToSerial(TEST_TELEMETRY_TYPE, &sPayload, 1));
+        HOST_vRunSerial();
+
+        TEST_CHECK(HOST_bReadFrame(&sFrame));
+        TEST_CHECK(sFrame.bCheckOk);
+        TEST_CHECK(sFrame.u16Type == TEST_TELEMETRY_TYPE);
+        TEST_CHECK(sFrame.u16Length == sizeof(au8Data));
+        TEST_CHECK(memcmp(sFrame.au8Data, au8Data, sizeof(au8Data)) == 0);
+        TEST_CHECK(!HOST_bReadFrame(&sFrame));
+    }
+}
+
+/* A frame gathered from segments is byte for byte the frame written from
+ * one buffer, at every split point */
+PRIVATE void vTestGatheredWrite(void)
+{
+    APP_tsSerialIoVec asPayload[3];
+    uint8 au8Data[40];
+    uint8 au8Whole[128];
+    uint8 au8Gathered[128];
+    uint32 u32Whole;
+    uint8 i;
+    uint8 j;
+
+    for (i = 0; i < sizeof(au8Data); i++) {
+        au8Data[i] = (uint8)(i % 5);
+    }
+
+    HOST_vSerialInit();
+    asPayload[0].pu8Data = au8Data;
+    asPayload[0].u16Length = sizeof(au8Data);
+    TEST_CHECK(APP_bWriteFrameToSerial(TEST_TELEMETRY_TYPE, asPayload, 1));
+    HOST_vRunSerial();
+    u32Whole = HOST_u32WireRead(au8Whole, sizeof(au8Whole));
+
+    for (i = 0; i <= sizeof(au8Data); i += 7) {
+        for (j = i; j <= sizeof(au8Data); j += 5) {
+            asPayload[0].pu8Data = au8Data;
+            asPayload[0].u16Length = i;
+            asPayload[1].pu8Data = &au8Data[i];
+            asPayload[1].u16Length = j - i;
+            asPayload[2].pu8Data = &au8Data[j];
+            asPayload[2].u16Length = sizeof(au8Data) - j;
+
+            HOST_vWireReset();
+            TEST_CHECK(APP_bWriteFrameToSerial(TEST_TELEMETRY_TYPE, asPayload, 3));
+            HOST_vRunSerial();
+            TEST_CHECK(HOST_u32WireRead(au8Gathered, sizeof(au8Gathered)) == u32Whole);
+            TEST_CHECK(memcmp(au8Gathered, au8Whole, u32Whole) == 0);
+        }
+    }
+}
+
+/* Writing to an idle UART masks interrupts once per message, not once per
+ * byte, and draining it takes none */
+PRIVATE void vTestOneKickPerMessage(void)
+{
+    APP_tsSerialIoVec sPayload;
+    uint8 au8Data[100];
+
+    memset(au8Data, 0x55, sizeof(au8Data));
+
+    HOST_vSerialInit();
+    sPayload.pu8Data = au8Data;
+    sPayload.u16Length = sizeof(au8Data);
+    TEST_CHECK(APP_bWriteFrameToSerial(TEST_TELEMETRY_TYPE, &sPayload, 1));
+    TEST_CHECK(HOST_sStats.u32CriticalSections == 1);
+
+    HOST_vRunSerial();
+    TEST_CHECK(HOST_sStats.u32CriticalSections == 1);
+
+    TEST_CHECK(APP_bWriteToSerial(E_SERIAL_CHANNEL_EVENT, au8Data, 20));
+    HOST_vRunSerial();
+    TEST_CHECK(HOST_sStats.u32CriticalSections == 2);
+}
+
+/* A message that does not fit its channel queue is dropped whole and
+ * counted; the queue is left as it was */
+PRIVATE void vTestAllOrNothing(void)
+{
+    APP_tsSerialIoVec sPayload;
+    HOST_tsFrame sFrame;
+    uint8 au8Data[20];
+    uint8 au8Wire[256];
+    uint32 u32Dropped;
+    uint16 u16Free;
+    uint8 i;
+
+    HOST_vSerialInit();
+    HOST_vHoldTx(TRUE);
+
+    /* The first message goes to the TX ring; later ones wait in the event
+     * queue, 64 bytes of which take two 20-byte messages and their lengths */
+    for (i = 0; i < 3; i++) {
+        memset(au8Data, 'a' + i, sizeof(au8Data));
+        TEST_CHECK(APP_bWriteToSerial(E_SERIAL_CHANNEL_EVENT, au8Data, sizeof(au8Data)));
+    }
+
+    u16Free = RB_u16Free(&APP_rbSerialChannel[E_SERIAL_CHANNEL_EVENT]);
+    u32Dropped = u32LinkStat(E_TEST_STAT_TX_DROPPED);
+    memset(au8Data, 'x', sizeof(au8Data));
+    TEST_CHECK(!APP_bWriteToSerial(E_SERIAL_CHANNEL_EVENT, au8Data, sizeof(au8Data)));
+    TEST_CHECK(RB_u16Free(&APP_rbSerialChannel[E_SERIAL_CHANNEL_EVENT]) == u16Free);
+    TEST_CHECK(u32LinkStat(E_TEST_STAT_TX_DROPPED) == u32Dropped + 1);
+
+    sPayload.pu8Data = au8Data;
+    sPayload.u16Length = sizeof(au8Data);
+    TEST_CHECK(!APP_bWriteFrameToSerial(TEST_EVENT_TYPE, &sPayload, 1));
+    TEST_CHECK(RB_u16Free(&APP_rbSerialChannel[E_SERIAL_CHANNEL_EVENT]) == u16Free);
+    TEST_CHECK(u32LinkStat(E_TEST_STAT_TX_DROPPED) == u32Dropped + 2);
+
+    /* A short frame still fits */
+    sPayload.u16Length = 4;
+    TEST_CHECK(APP_bWriteFrameToSerial(TEST_EVENT_TYPE, &sPayload, 1));
+
+    HOST_vHoldTx(FALSE);
+    HOST_vRunSerial();
+
+    TEST_CHECK(HOST_u32WireRead(au8Wire, 60) == 60);
+    for (i = 0; i < 60; i++) {
+        TEST_CHECK(au8Wire[i] == 'a' + i / 20);
+    }
+    TEST_CHECK(HOST_bReadFrame(&sFrame));
+    TEST_CHECK(sFrame.bCheckOk && (sFrame.u16Length == 4) && (memcmp(sFrame.au8Data, "xxxx", 4) == 0));
+    TEST_CHECK(HOST_u32WireRead(au8Wire, sizeof(au8Wire)) == 0);
+}
+
+/* Queued frames go out response first, then events, telemetry and log.
+ * The frame already in the TX ring is not overtaken. */
+PRIVATE void vTestStrictPriority(void)
+{
+    static const uint16 au16Queued[] = {TEST_LOG_TYPE, TEST_TELEMETRY_TYPE, TEST_EVENT_TYPE, TEST_EVENT_TYPE,
+                                        TEST_RESPONSE_TYPE};
+    /* Positions in au16Queued, in the order they are sent */
+    static const uint8 au8Sent[] = {0, 4, 2, 3, 1};
+    APP_tsSerialIoVec sPayload;
+    HOST_tsFrame sFrame;
+    uint8 au8Data[8];
+    uint8 i;
+
+    HOST_vSerialInit();
+    HOST_vHoldTx(TRUE);
+
+    sPayload.pu8Data = au8Data;
+    sPayload.u16Length = sizeof(au8Data);
+    for (i = 0; i < sizeof(au16Queued) / sizeof(au16Queued[0]); i++) {
+        memset(au8Data, '0' + i, sizeof(au8Data));
+        TEST_CHECK(APP_bWriteFrameToSerial(au16Queued[i], &sPayload, 1));
+    }
+
+    HOST_vHoldTx(FALSE);
+    HOST_vRunSerial();
+
+    for (i = 0; i < sizeof(au8Sent); i++) {
+        TEST_CHECK(HOST_bReadFrame(&sFrame));
+        TEST_CHECK(sFrame.bCheckOk && (sFrame.u16Type == au16Queued[au8Sent[i]]));
+        TEST_CHECK(sFrame.au8Data[0] == '0' + au8Sent[i]);
+    }
+    TEST_CHECK(!HOST_bReadFrame(&sFrame));
+}
+
+/* A frame longer than the free TX ring goes out in pieces, and a response
+ * queued meanwhile waits for its end rather than splitting it */
+PRIVATE void vTestWholeFrames(void)
+{
+    APP_tsSerialIoVec sPayload;
+    HOST_tsFrame sFrame;
+    uint8 au8Data[200];
+    uint16 i;
+
+    HOST_vSerialInit();
+    HOST_vHoldTx(TRUE);
+
+    for (i = 0; i < sizeof(au8Data); i++) {
+        au8Data[i] = (uint8)(0x40 + i % 32);
+    }
+    sPayload.pu8Data = au8Data;
+    sPayload.u16Length = sizeof(au8Data);
+    TEST_CHECK(APP_bWriteFrameToSerial(TEST_TELEMETRY_TYPE, &sPayload, 1));
+    TEST_CHECK(!RB_bIsEmpty(&APP_rbSerialChannel[E_SERIAL_CHANNEL_TELEMETRY]));
+
+    sPayload.u16Length = 4;
+    TEST_CHECK(APP_bWriteFrameToSerial(TEST_RESPONSE_TYPE, &sPayload, 1));
+
+    HOST_vHoldTx(FALSE);
+    HOST_vRunSerial();
+
+    TEST_CHECK(HOST_bReadFrame(&sFrame));
+    TEST_CHECK(sFrame.bCheckOk && (sFrame.u16Type == TEST_TELEMETRY_TYPE));
+    TEST_CHECK((sFrame.u16Length == sizeof(au8Data)) && (memcmp(sFrame.au8Data, au8Data, sizeof(au8Data)) == 0));
+    TEST_CHECK(HOST_bReadFrame(&sFrame));
+    TEST_CHECK(sFrame.bCheckOk && (sFrame.u16Type == TEST_RESPONSE_TYPE) && (sFrame.u16Length == 4));
+}
+
+/* A frame whose start arrived before a version change is decoded whole
+ * with the old version. Hosts must not send it, but the firmware must not
+ * mix the two checks in one frame either. */
+PRIVATE void vTestFrameAcrossVersionChange(void)
+{
+    HOST_tsFrame sFrame;
+    uint8 au8Encoded[32];
+    uint16 u16Length;
+    uint8 u8Version = 2;
+    uint32 u32CrcErrors;
+
+    TEST_CHECK(u8LinkVersion == 1);
+
+    HOST_vSerialInit();
+    HOST_vSendFrame(TEST_MSG_SET_PROTOCOL_VERSION, &u8Version, 1);
+    u16Length = HOST_u16Encode(au8Encoded, TEST_MSG_GET_LINK_STATS, NULL, 0);
+    u32CrcErrors = u32LinkStat(E_TEST_STAT_CRC_ERRORS);
+
+    /* The start and half of the header of a link stats request arrive in
+     * the pass that switches versions, the rest after it */
+    RB_u16PushN(&APP_rbSerialRx, au8Encoded, 3);
+    HOST_vRunSerial();
+    RB_u16PushN(&APP_rbSerialRx, &au8Encoded[3], u16Length - 3);
+    HOST_vRunSerial();
+
+    TEST_CHECK(HOST_bReadFrame(&sFrame));
+    TEST_CHECK(sFrame.bCheckOk && (sFrame.u16Type == TEST_MSG_SET_PROTOCOL_VERSION));
+    TEST_CHECK((sFrame.u16Length == 2) && (sFrame.au8Data[0] == 2));
+    HOST_vSetVersion(2);
+    u8LinkVersion = 2;
+
+    TEST_CHECK(HOST_bReadFrame(&sFrame));
+    TEST_CHECK(sFrame.bCheckOk && (sFrame.u16Type == TEST_MSG_GET_LINK_STATS) && (sFrame.u16Length == 32));
+    TEST_CHECK(u32LinkStat(E_TEST_STAT_CRC_ERRORS) == u32CrcErrors);
+}
+
+/* A version 3 response is the sequence number, the status and the data,
+ * and a retransmitted request gets the same bytes back, even for the
+ * largest reply */
+PRIVATE void vTestResponses(void)
+{
+    HOST_tsFrame sFrame;
+    uint8 au8Request[2];
+    uint8 au8First[512];
+    uint8 au8Again[512];
+    uint32 u32First;
+
+    HOST_vSerialInit();
+
+    au8Request[0] = 0;
+    HOST_vSendRequest(TEST_MSG_GET_TASK_STATS, 7, au8Request, 1);
+    HOST_vRunSerial();
+    u32First = HOST_u32WireRead(au8First, sizeof(au8First));
+
+    HOST_vSendRequest(TEST_MSG_GET_TASK_STATS, 7, au8Request, 1);
+    HOST_vRunSerial();
+    TEST_CHECK(HOST_u32WireRead(au8Again, sizeof(au8Again)) == u32First);
+    TEST_CHECK(memcmp(au8Again, au8First, u32First) == 0);
+
+    HOST_vWireReset();
+    HOST_vSendRequest(TEST_MSG_GET_TASK_STATS, 7, au8Request, 1);
+    HOST_vRunSerial();
+    TEST_CHECK(HOST_bReadFrame(&sFrame));
+    TEST_CHECK(sFrame.bCheckOk);
+    TEST_CHECK(sFrame.u16Type == (TEST_MSG_GET_TASK_STATS | TEST_RESPONSE_FLAG));
+    TEST_CHECK(sFrame.u16Length == 2 + TEST_TASK_STATS_SIZE);
+    TEST_CHECK((sFrame.au8Data[0] == 7) && (sFrame.au8Data[1] == 0));
+    /* Runs first, the last histogram bin last, as filled in by host_serial.c */
+    TEST_CHECK(memcmp(&sFrame.au8Data[2], "\x01\x00\x00\x00", 4) == 0);
+    TEST_CHECK(memcmp(&sFrame.au8Data[2 + TEST_TASK_STATS_SIZE - 4], "\x10\x00\x0F\x00", 4) == 0);
+
+    /* A status only response */
+    au8Request[0] = 0xFF;
+    au8Request[1] = 9;
+    HOST_vSendRequest(TEST_MSG_SET_LOG_LEVEL, 8, au8Request, 2);
+    HOST_vRunSerial();
+    TEST_CHECK(HOST_bReadFrame(&sFrame));
+    TEST_CHECK(sFrame.bCheckOk);
+    TEST_CHECK(sFrame.u16Type == (TEST_MSG_SET_LOG_LEVEL | TEST_RESPONSE_FLAG));
+    TEST_CHECK((sFrame.u16Length == 2) && (sFrame.au8Data[0] == 8) && (sFrame.au8Data[1] != 0));
+}
+
+/* The host may send as many requests as the advertised window before the
+ * first response, and gets a response to every one of them */
+PRIVATE void vTestFullWindow(void)
+{
+    APP_tsSerialPoolStats sPoolStats;
+    HOST_tsFrame sFrame;
+    uint8 au8Request[2];
+    uint8 au8Responses[256];
+    uint32 u32Exhausted;
+    uint8 i;
+
+    HOST_vSerialInit();
+    APP_vGetSerialPoolStats(&sPoolStats);
+    u32Exhausted = sPoolStats.u32Exhausted;
+
+    TEST_CHECK(u8LinkWindow != 0);
+    memset(au8Responses, 0, sizeof(au8Responses));
+    au8Request[0] = 0xFF;
+    au8Request[1] = 9;
+    for (i = 0; i < u8LinkWindow; i++) {
+        HOST_vSendRequest(TEST_MSG_SET_LOG_LEVEL, (uint8)(40 + i), au8Request, 2);
+    }
+    HOST_vRunSerial();
+
+    while (HOST_bReadFrame(&sFrame)) {
+        TEST_CHECK(sFrame.bCheckOk && (sFrame.u16Type == (TEST_MSG_SET_LOG_LEVEL | TEST_RESPONSE_FLAG)));
+        au8Responses[sFrame.au8Data[0]]++;
+    }
+    for (i = 0; i < u8LinkWindow; i++) {
+        TEST_CHECK(au8Responses[40 + i] == 1);
+    }
+
+    APP_vGetSerialPoolStats(&sPoolStats);
+    TEST_CHECK(sPoolStats.u32Exhausted == u32Exhausted);
+}
+
+/* Benchmark echoes go out on the telemetry channel, so a command response
+ * queued after an echo is still sent first */
+PRIVATE void vTestBenchmarkEcho(void)
+{
+    HOST_tsFrame sFrame;
+    uint8 au8Data[16];
+    uint8 i;
+
+    HOST_vSerialInit();
+    HOST_vHoldTx(TRUE);
+
+    au8Data[0] = 1;
+    HOST_vSendRequest(TEST_MSG_BENCHMARK, 20, au8Data, 1);
+    HOST_vRunSerial();
+
+    memset(au8Data, 0x5A, sizeof(au8Data));
+    HOST_vSendFrame(TEST_MSG_BENCHMARK_DATA, au8Data, sizeof(au8Data));
+    HOST_vRunSerial();
+
+    au8Data[0] = 0xFF;
+    au8Data[1] = 9;
+    HOST_vSendRequest(TEST_MSG_SET_LOG_LEVEL, 21, au8Data, 2);
+    HOST_vRunSerial();
+
+    HOST_vHoldTx(FALSE);
+    HOST_vRunSerial();
+
+    TEST_CHECK(HOST_bReadFrame(&sFrame) && (sFrame.u16Type == (TEST_MSG_BENCHMARK | TEST_RESPONSE_FLAG)));
+    TEST_CHECK(HOST_bReadFrame(&sFrame) && (sFrame.u16Type == (TEST_MSG_SET_LOG_LEVEL | TEST_RESPONSE_FLAG)));
+    TEST_CHECK(HOST_bReadFrame(&sFrame));
+    TEST_CHECK(sFrame.bCheckOk && (sFrame.u16Type == TEST_BENCHMARK_TELEMETRY_TYPE));
+    TEST_CHECK(sFrame.u16Length == sizeof(au8Data));
+    for (i = 0; i < sFrame.u16Length; i++) {
+        TEST_CHECK(sFrame.au8Data[i] == 0x5A);
+    }
+
+    au8Data[0] = 0;
+    HOST_vSendRequest(TEST_MSG_BENCHMARK, 22, au8Data, 1);
+    HOST_vRunSerial();
+    TEST_CHECK(HOST_bReadFrame(&sFrame) && (sFrame.u16Type == (TEST_MSG_BENCHMARK | TEST_RESPONSE_FLAG)));
+    /* Status, then elapsed time, bytes received and bytes sent */
+    TEST_CHECK((sFrame.u16Length == 2 + 28) && (sFrame.au8Data[1] == 0));
+    TEST_CHECK(memcmp(&sFrame.au8Data[2 + 4], "\x00\x00\x00\x10\x00\x00\x00\x10", 8) == 0);
+}
+
+/* A data frame of the largest size is echoed whole rather than dropped for
+ * want of telemetry queue space */
+PRIVATE void vTestLargestEcho(void)
+{
+    HOST_tsFrame sFrame;
+    uint8 au8Data[MAX_PACKET_SIZE];
+    uint8 au8Encoded[2 * (MAX_PACKET_SIZE + 8)];
+    uint16 u16Length;
+    uint16 u16Pushed;
+    uint16 u16Chunk;
+    uint32 u32Dropped;
+    uint16 i;
+
+    for (i = 0; i < sizeof(au8Data); i++) {
+        au8Data[i] = (uint8)i;
+    }
+    u16Length = HOST_u16Encode(au8Encoded, TEST_MSG_BENCHMARK_DATA, au8Data, sizeof(au8Data));
+
+    HOST_vSerialInit();
+    au8Data[0] = 1;
+    HOST_vSendRequest(TEST_MSG_BENCHMARK, 25, au8Data, 1);
+    HOST_vRunSerial();
+    TEST_CHECK(HOST_bReadFrame(&sFrame) && (sFrame.u16Type == (TEST_MSG_BENCHMARK | TEST_RESPONSE_FLAG)));
+    u32Dropped = u32LinkStat(E_TEST_STAT_TX_DROPPED);
+
+    /* Longer than the RX ring, so fed in as the UART would while the task
+     * drains it */
+    for (u16Pushed = 0; u16Pushed < u16Length; u16Pushed += u16Chunk) {
+        u16Chunk = ((u16Length - u16Pushed) < 128) ? (u16Length - u16Pushed) : 128;
+        RB_u16PushN(&APP_rbSerialRx, &au8Encoded[u16Pushed], u16Chunk);
+        HOST_vRunSerial();
+    }
+
+    TEST_CHECK(HOST_bReadFrame(&sFrame));
+    TEST_CHECK(sFrame.bCheckOk && (sFrame.u16Type == TEST_BENCHMARK_TELEMETRY_TYPE));
+    TEST_CHECK(sFrame.u16Length == MAX_PACKET_SIZE);
+    for (i = 0; i < sFrame.u16Length; i++) {
+        TEST_CHECK(sFrame.au8Data[i] == (uint8)i);
+    }
+    TEST_CHECK(u32LinkStat(E_TEST_STAT_TX_DROPPED) == u32Dropped);
+
+    au8Data[0] = 0;
+    HOST_vSendRequest(TEST_MSG_BENCHMARK, 26, au8Data, 1);
+    HOST_vRunSerial();
+    TEST_CHECK(HOST_bReadFrame(&sFrame) && (sFrame.u16Type == (TEST_MSG_BENCHMARK | TEST_RESPONSE_FLAG)));
+}
+
+/* Escaped bytes are decoded whatever chunk they arrive in, including an
+ * escape and the byte it escapes arriving in different task passes */
+PRIVATE void vTestEscapedReceive(void)
+{
+    HOST_tsFrame sFrame;
+    uint8 au8Data[60];
+    uint8 au8Encoded[2 * (sizeof(au8Data) + 8)];
+    uint16 u16Length;
+    uint16 u16Split;
+    uint8 i;
+
+    for (i = 0; i < sizeof(au8Data); i++) {
+        au8Data[i] = (uint8)(i % 5);
+    }
+    u16Length = HOST_u16Encode(au8Encoded, TEST_MSG_BENCHMARK_DATA, au8Data, sizeof(au8Data));
+
+    HOST_vSerialInit();
+    au8Data[0] = 1;
+    HOST_vSendRequest(TEST_MSG_BENCHMARK, 23, au8Data, 1);
+    HOST_vRunSerial();
+    TEST_CHECK(HOST_bReadFrame(&sFrame) && (sFrame.u16Type == (TEST_MSG_BENCHMARK | TEST_RESPONSE_FLAG)));
+    au8Data[0] = 0;
+
+    for (u16Split = 1; u16Split < u16Length; u16Split++) {
+        RB_u16PushN(&APP_rbSerialRx, au8Encoded, u16Split);
+        APP_taskAtSerial();
+        RB_u16PushN(&APP_rbSerialRx, &au8Encoded[u16Split], u16Length - u16Split);
+        HOST_vRunSerial();
+
+        TEST_CHECK(HOST_bReadFrame(&sFrame));
+        TEST_CHECK(sFrame.bCheckOk && (sFrame.u16Type == TEST_BENCHMARK_TELEMETRY_TYPE));
+        TEST_CHECK(sFrame.u16Length == sizeof(au8Data));
+        for (i = 0; i < sizeof(au8Data); i++) {
+            TEST_CHECK(sFrame.au8Data[i] == (uint8)(i % 5));
+        }
+    }
+
+    HOST_vSendRequest(TEST_MSG_BENCHMARK, 24, au8Data, 1);
+    HOST_vRunSerial();
+    TEST_CHECK(HOST_bReadFrame(&sFrame) && (sFrame.u16Type == (TEST_MSG_BENCHMARK | TEST_RESPONSE_FLAG)));
+}
+
+/* Switch the link to another protocol version. The response comes in the
+ * old framing, after the sequence number and status from version 3 on. */
+PRIVATE void vSetVersion(uint8 u8Version)
+{
+    HOST_tsFrame sFrame;
+    uint8 u8Offset = (u8LinkVersion >= 3) ? 2 : 0;
+
+    HOST_vSerialInit();
+    if (u8LinkVersion >= 3) {
+        HOST_vSendRequest(TEST_MSG_SET_PROTOCOL_VERSION, u8NextSeq++, &u8Version, 1);
+    }
+    else {
+        HOST_vSendFrame(TEST_MSG_SET_PROTOCOL_VERSION, &u8Version, 1);
+    }
+    HOST_vRunSerial();
+
+    TEST_CHECK(HOST_bReadFrame(&sFrame));
+    TEST_CHECK(sFrame.bCheckOk);
+    TEST_CHECK((sFrame.u16Length == u8Offset + 2) && (sFrame.au8Data[u8Offset] == u8Version));
+    if (u8Version >= 3) {
+        u8LinkWindow = sFrame.au8Data[u8Offset + 1];
+    }
+
+    HOST_vSetVersion(u8Version);
+    u8LinkVersion = u8Version;
+}
+
+PRIVATE uint32 u32LinkStat(teTestStat eStat)
+{
+    APP_tsSerialLinkStats sStats;
+
+    APP_vGetSerialLinkStats(&sStats);
+    return (eStat == E_TEST_STAT_CRC_ERRORS) ? sStats.u32CrcErrors : sStats.u32TxDropped;
+}
+
+/****************************************************************************/
+/***        END OF FILE                                                   ***/
+/****************************************************************************/
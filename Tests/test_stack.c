@@ -0,0 +1,246 @@
+/****************************************************************************
+ *
+ * MODULE:              Lumi Router
+ *
+ * COMPONENT:           test_stack.c
+ *
+ * DESCRIPTION:         Host tests of the stack paint and scan
+ *
+ ****************************************************************************
+ *
+ * This software is owned by NXP B.V. and/or its supplier and is protected
+ * under applicable copyright laws. All rights are reserved. We grant You,
+ * and any third parties, a license to use this software solely and
+ * exclusively on NXP products [NXP Microcontrollers such as JN5168, JN5179].
+ * You, and any third parties must reproduce the copyright and warranty notice
+ * and any other legend of ownership on each copy or partial copy of the
+ * software.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+ * AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+ * IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE
+ * ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE
+ * LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR
+ * CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF
+ * SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS
+ * INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN
+ * CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE)
+ * ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+ * POSSIBILITY OF SUCH DAMAGE.
+ *
+ * Copyright NXP B.V. 2016. All rights reserved
+ *
+ ****************************************************************************/
+
+/****************************************************************************/
+/***        Include Files                                                 ***/
+/****************************************************************************/
+
+#include <jendefs.h>
+#include <string.h>
+#include <ucontext.h>
+
+/* Application */
+#include "app_stack.h"
+#include "test.h"
+
+/****************************************************************************/
+/***        Macro Definitions                                             ***/
+/****************************************************************************/
+
+/* As in app_stack.c */
+#define STACK_PAINT_PATTERN 0xA5A5A5A5UL
+#define STACK_PAINT_MARGIN  64
+#define STACK_SCAN_WORDS    32
+
+#define STACK_WORDS (APP_STACK_SIZE / sizeof(uint32))
+
+/* Peak use in bytes when the deepest word overwritten is word u32Word */
+#define STACK_USED(u32Word) (APP_STACK_SIZE - (u32Word) * sizeof(uint32))
+
+/****************************************************************************/
+/***        Local Function Prototypes                                     ***/
+/****************************************************************************/
+
+PRIVATE void vBoot(void);
+PRIVATE void vTestPaint(void);
+PRIVATE void vTestScanIdle(void);
+PRIVATE void vTestScanBound(void);
+PRIVATE void vTestRetained(void);
+PRIVATE uint32 u32PaintedWords(void);
+PRIVATE uint32 u32ScanUntilChange(uint32 u32MaxCalls);
+
+/****************************************************************************/
+/***        Exported Variables                                            ***/
+/****************************************************************************/
+
+/* Stands in for the stack the linker reserves. Boots run on it through
+ * ucontext, and the link is not position independent so its addresses
+ * fit the 32-bit arithmetic of app_stack.c. */
+PUBLIC uint32 _stack_low_water_mark[STACK_WORDS] __attribute__((aligned(16)));
+
+/****************************************************************************/
+/***        Local Variables                                               ***/
+/****************************************************************************/
+
+PRIVATE ucontext_t sMainContext;
+PRIVATE ucontext_t sBootContext;
+
+/* Words painted at the first boot */
+PRIVATE uint32 u32Painted;
+
+/****************************************************************************/
+/***        Exported Functions                                            ***/
+/****************************************************************************/
+
+int main(void)
+{
+    vTestPaint();
+    vTestScanIdle();
+    vTestScanBound();
+    vTestRetained();
+
+    return TEST_RESULT();
+}
+
+/****************************************************************************/
+/***        Local Functions                                               ***/
+/****************************************************************************/
+
+/* Run APP_vStackPaint at the top of the stand-in stack, as at boot */
+PRIVATE void vBoot(void)
+{
+    getcontext(&sBootContext);
+    sBootContext.uc_stack.ss_sp = _stack_low_water_mark;
+    sBootContext.uc_stack.ss_size = sizeof(_stack_low_water_mark);
+    sBootContext.uc_link = &sMainContext;
+    makecontext(&sBootContext, APP_vStackPaint, 0);
+    swapcontext(&sMainContext, &sBootContext);
+}
+
+/* The paint fills from the low water mark to the margin below the caller,
+ * and the peak of this boot is what lies above it */
+PRIVATE void vTestPaint(void)
+{
+    APP_tsStackStats sStats;
+
+    vBoot();
+    u32Painted = u32PaintedWords();
+
+    APP_vGetStackStats(&sStats);
+    TEST_CHECK(sStats.u32Size == APP_STACK_SIZE);
+    TEST_CHECK(sStats.u32PeakUsed == STACK_USED(u32Painted));
+    TEST_CHECK(sStats.u32PeakUsed > STACK_PAINT_MARGIN);
+    TEST_CHECK(sStats.u32PeakUsed < 1024);
+
+    /* Nothing retained at power on */
+    TEST_CHECK(sStats.u32PeakUsedRetained == sStats.u32PeakUsed);
+}
+
+/* Scans of an untouched stack never move the peak */
+PRIVATE void vTestScanIdle(void)
+{
+    APP_tsStackStats sStats;
+
+    TEST_CHECK(u32ScanUntilChange(4 * (u32Painted / STACK_SCAN_WORDS + 1)) == 0);
+    APP_vGetStackStats(&sStats);
+    TEST_CHECK(sStats.u32PeakUsed == STACK_USED(u32Painted));
+}
+
+/* A pass checks at most STACK_SCAN_WORDS words, and a sweep covers every
+ * painted word below the deepest point and nothing above it */
+PRIVATE void vTestScanBound(void)
+{
+    APP_tsStackStats sStats;
+    uint32 u32Deep = u32Painted - 10;
+
+    /* Found within one sweep, wherever the scan was; the scan then starts
+     * again from the low water mark */
+    _stack_low_water_mark[u32Deep] = 0;
+    TEST_CHECK(u32ScanUntilChange(u32Painted / STACK_SCAN_WORDS + 2) != 0);
+    APP_vGetStackStats(&sStats);
+    TEST_CHECK(sStats.u32PeakUsed == STACK_USED(u32Deep));
+    TEST_CHECK(sStats.u32PeakUsedRetained == STACK_USED(u32Deep));
+
+    /* Word 96 starts the fourth pass of 32 words */
+    _stack_low_water_mark[96] = 0;
+    TEST_CHECK(u32ScanUntilChange(10) == 4);
+    APP_vGetStackStats(&sStats);
+    TEST_CHECK(sStats.u32PeakUsed == STACK_USED(96));
+
+    /* The word just below the deepest point ends the third pass */
+    _stack_low_water_mark[95] = 0;
+    TEST_CHECK(u32ScanUntilChange(10) == 3);
+    APP_vGetStackStats(&sStats);
+    TEST_CHECK(sStats.u32PeakUsed == STACK_USED(95));
+
+    /* Words above the deepest point are never read again */
+    _stack_low_water_mark[150] = STACK_PAINT_PATTERN;
+    _stack_low_water_mark[120] = 0;
+    TEST_CHECK(u32ScanUntilChange(40) == 0);
+    APP_vGetStackStats(&sStats);
+    TEST_CHECK(sStats.u32PeakUsed == STACK_USED(95));
+    TEST_CHECK(sStats.u32PeakUsedRetained == STACK_USED(95));
+}
+
+/* The retained peak outlives a reboot until it is reset, and the peak of
+ * the new boot starts again from the paint */
+PRIVATE void vTestRetained(void)
+{
+    APP_tsStackStats sStats;
+
+    vBoot();
+
+    APP_vGetStackStats(&sStats);
+    TEST_CHECK(sStats.u32PeakUsed == STACK_USED(u32PaintedWords()));
+    TEST_CHECK(sStats.u32PeakUsed < STACK_USED(95));
+    TEST_CHECK(sStats.u32PeakUsedRetained == STACK_USED(95));
+
+    APP_vResetStackStats();
+    APP_vGetStackStats(&sStats);
+    TEST_CHECK(sStats.u32PeakUsedRetained == sStats.u32PeakUsed);
+
+    /* A deeper stack in this boot raises both */
+    _stack_low_water_mark[200] = 0;
+    TEST_CHECK(u32ScanUntilChange(u32Painted / STACK_SCAN_WORDS + 2) != 0);
+    APP_vGetStackStats(&sStats);
+    TEST_CHECK(sStats.u32PeakUsed == STACK_USED(200));
+    TEST_CHECK(sStats.u32PeakUsedRetained == STACK_USED(200));
+}
+
+/* Painted words from the low water mark up */
+PRIVATE uint32 u32PaintedWords(void)
+{
+    uint32 i;
+
+    for (i = 0; i < STACK_WORDS; i++) {
+        if (_stack_low_water_mark[i] != STACK_PAINT_PATTERN) {
+            break;
+        }
+    }
+    return i;
+}
+
+/* Scan passes until the peak moves, or 0 if it did not within the limit */
+PRIVATE uint32 u32ScanUntilChange(uint32 u32MaxCalls)
+{
+    APP_tsStackStats sStats;
+    uint32 u32Before;
+    uint32 i;
+
+    APP_vGetStackStats(&sStats);
+    u32Before = sStats.u32PeakUsed;
+
+    for (i = 1; i <= u32MaxCalls; i++) {
+        APP_vStackScan();
+        APP_vGetStackStats(&sStats);
+        if (sStats.u32PeakUsed != u32Before) {
+            return i;
+        }
+    }
+    return 0;
+}
+
+/****************************************************************************/
+/***        END OF FILE                                                   ***/
+/****************************************************************************/
@@ -0,0 +1,427 @@
+/****************************************************************************
+ *
+ * MODULE:              Lumi Router
+ *
+ * COMPONENT:           test_timer.c
+ *
+ * DESCRIPTION:         Host tests of the application timer wheel
+ *
+ ****************************************************************************
+ *
+ * This software is owned by NXP B.V. and/or its supplier and is protected
+ * under applicable copyright laws. All rights are reserved. We grant You,
+ * and any third parties, a license to use this software solely and
+ * exclusively on NXP products [NXP Microcontrollers such as JN5168, JN5179].
+ * You, and any third parties must reproduce the copyright and warranty notice
+ * and any other legend of ownership on each copy or partial copy of the
+ * software.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+ * AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+ * IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE
+ * ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE
+ * LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR
+ * CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF
+ * SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS
+ * INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN
+ * CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE)
+ * ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+ * POSSIBILITY OF SUCH DAMAGE.
+ *
+ * Copyright NXP B.V. 2016. All rights reserved
+ *
+ ****************************************************************************/
+
+/****************************************************************************/
+/***        Include Files                                                 ***/
+/****************************************************************************/
+
+#include <jendefs.h>
+
+/* Application */
+#include "app_scheduler.h"
+#include "app_timer.h"
+#include "app_ztimer.h"
+#include "host_clock.h"
+#include "test.h"
+
+/* SDK JN-SW-4170 */
+#include "ZTimer.h"
+
+/****************************************************************************/
+/***        Macro Definitions                                             ***/
+/****************************************************************************/
+
+#define ZTIMER_STORAGE 2
+
+/* The wheel crosses the wrap of the millisecond clock early on */
+#define CLOCK_START 0xFFFFF000UL
+
+/* Past the reach of the wheel, about 5 minutes */
+#define LONG_MSEC (10UL * 60 * 1000)
+
+#define RANDOM_TIMERS 2000
+
+/****************************************************************************/
+/***        Type Definitions                                              ***/
+/****************************************************************************/
+
+/* Expiries of a test timer */
+typedef struct tsTestTimer {
+    APP_tsTimer sTimer;
+    uint32 u32StartMsec;
+    uint32 u32Msec;
+    uint32 u32Fired;
+    uint32 u32FirstFiredMsec;
+    uint32 u32LastFiredMsec;
+    struct tsTestTimer *psStop; /* stopped from the callback, if not NULL */
+    bool_t bRestart;            /* restarted from the callback */
+} tsTestTimer;
+
+/****************************************************************************/
+/***        Local Function Prototypes                                     ***/
+/****************************************************************************/
+
+PRIVATE void vTestOneShot(void);
+PRIVATE void vTestPeriodicNoDrift(void);
+PRIVATE void vTestStop(void);
+PRIVATE void vTestStopFromCallback(void);
+PRIVATE void vTestRestartFromCallback(void);
+PRIVATE void vTestSameTick(void);
+PRIVATE void vTestBeyondReach(void);
+PRIVATE void vTestIdle(void);
+PRIVATE void vTestRandom(void);
+
+PRIVATE void vStart(tsTestTimer *psTimer, uint32 u32Msec, bool_t bPeriodic);
+PRIVATE bool_t bFiredOnTime(const tsTestTimer *psTimer);
+PRIVATE uint32 u32Ticks(uint32 u32Count);
+PRIVATE uint32 u32Random(void);
+PRIVATE void vTimerExpired(void *pvParam);
+
+PRIVATE void vTaskZTimer(void);
+PRIVATE void vTaskIdle(void);
+
+/****************************************************************************/
+/***        Local Variables                                               ***/
+/****************************************************************************/
+
+PRIVATE const APP_tpfTask apfTasks[E_APP_TASK_COUNT] = {vTaskIdle, vTaskIdle, vTaskZTimer, vTaskIdle, vTaskIdle};
+
+PRIVATE uint32 u32ZTimerRuns;
+PRIVATE uint32 u32Seed = 1;
+
+PRIVATE ZTIMER_tsTimer asTimers[ZTIMER_STORAGE];
+PRIVATE tsTestTimer asRandom[RANDOM_TIMERS];
+
+/****************************************************************************/
+/***        Exported Functions                                            ***/
+/****************************************************************************/
+
+int main(void)
+{
+    HOST_vClockInit(CLOCK_START);
+    APP_vZTimerInit(asTimers, ZTIMER_STORAGE);
+    APP_vTimerInit();
+    u32Ticks(1);
+
+    vTestOneShot();
+    vTestPeriodicNoDrift();
+    vTestStop();
+    vTestStopFromCallback();
+    vTestRestartFromCallback();
+    vTestSameTick();
+    vTestBeyondReach();
+    vTestIdle();
+    vTestRandom();
+
+    return TEST_RESULT();
+}
+
+/****************************************************************************/
+/***        Local Functions                                               ***/
+/****************************************************************************/
+
+/* A one-shot timer fires once, not before its time and within a tick of
+ * it, wherever within a wheel tick it was started */
+PRIVATE void vTestOneShot(void)
+{
+    tsTestTimer sTimer = {0};
+    uint32 u32Offset;
+
+    for (u32Offset = 0; u32Offset < 2 * APP_TIMER_TICK_MSEC; u32Offset++) {
+        sTimer.u32Fired = 0;
+        vStart(&sTimer, 30, FALSE);
+        TEST_CHECK(APP_bTimerIsRunning(&sTimer.sTimer));
+        u32Ticks(30 + APP_TIMER_TICK_MSEC);
+        TEST_CHECK(bFiredOnTime(&sTimer));
+        TEST_CHECK(!APP_bTimerIsRunning(&sTimer.sTimer));
+        u32Ticks(u32Offset);
+    }
+}
+
+/* Each expiry of a periodic timer is counted from the previous one, so a
+ * main loop held up for a while does not shift the later ones */
+PRIVATE void vTestPeriodicNoDrift(void)
+{
+    tsTestTimer sTimer = {0};
+    uint32 u32First;
+    uint32 i;
+
+    vStart(&sTimer, 250, TRUE);
+    u32Ticks(250 + APP_TIMER_TICK_MSEC);
+    TEST_CHECK(bFiredOnTime(&sTimer));
+    u32First = sTimer.u32FirstFiredMsec;
+
+    /* Ticks while the main loop is busy elsewhere */
+    for (i = 0; i < 100; i++) {
+        HOST_vTick();
+    }
+    u32Ticks(u32First + 250 * 39 + APP_TIMER_TICK_MSEC - HOST_u32ClockMsec);
+
+    TEST_CHECK(sTimer.u32Fired == 40);
+    TEST_CHECK(sTimer.u32LastFiredMsec - u32First == 250 * 39);
+    TEST_CHECK(APP_bTimerIsRunning(&sTimer.sTimer));
+
+    APP_vTimerStop(&sTimer.sTimer);
+    TEST_CHECK(!APP_bTimerIsRunning(&sTimer.sTimer));
+    u32Ticks(1000);
+    TEST_CHECK(sTimer.u32Fired == 40);
+}
+
+/* A stopped timer does not fire, and stopping it twice does nothing */
+PRIVATE void vTestStop(void)
+{
+    tsTestTimer sTimer = {0};
+    tsTestTimer sOther = {0};
+
+    vStart(&sTimer, 100, FALSE);
+    vStart(&sOther, 100, FALSE);
+    u32Ticks(50);
+    APP_vTimerStop(&sTimer.sTimer);
+    APP_vTimerStop(&sTimer.sTimer);
+    u32Ticks(100);
+    TEST_CHECK(sTimer.u32Fired == 0);
+    TEST_CHECK(bFiredOnTime(&sOther));
+}
+
+/* A callback may stop a timer due on the same tick, which then does not
+ * fire, and may stop itself */
+PRIVATE void vTestStopFromCallback(void)
+{
+    tsTestTimer sFirst = {0};
+    tsTestTimer sSecond = {0};
+    tsTestTimer sSelf = {0};
+
+    sFirst.psStop = &sSecond;
+    sSecond.psStop = &sFirst;
+    sSelf.psStop = &sSelf;
+    vStart(&sFirst, 100, FALSE);
+    vStart(&sSecond, 100, FALSE);
+    vStart(&sSelf, 70, TRUE);
+
+    u32Ticks(1000);
+    TEST_CHECK(sFirst.u32Fired + sSecond.u32Fired == 1);
+    TEST_CHECK(!APP_bTimerIsRunning(&sFirst.sTimer) && !APP_bTimerIsRunning(&sSecond.sTimer));
+    TEST_CHECK(sSelf.u32Fired == 1);
+    TEST_CHECK(!APP_bTimerIsRunning(&sSelf.sTimer));
+}
+
+/* A one-shot timer restarted from its callback fires once per time */
+PRIVATE void vTestRestartFromCallback(void)
+{
+    tsTestTimer sTimer = {0};
+
+    sTimer.bRestart = TRUE;
+    vStart(&sTimer, 100, FALSE);
+    u32Ticks(1000 + APP_TIMER_TICK_MSEC);
+    TEST_CHECK(sTimer.u32Fired == 10);
+    sTimer.bRestart = FALSE;
+    APP_vTimerStop(&sTimer.sTimer);
+}
+
+/* Timers due on the same tick run together. Besides that run the ZTimer
+ * task only runs for the cascades on the way. */
+PRIVATE void vTestSameTick(void)
+{
+    uint32 u32Runs;
+    uint32 i;
+
+    for (i = 0; i < 100; i++) {
+        asRandom[i].u32Fired = 0;
+        vStart(&asRandom[i], 500, FALSE);
+    }
+    u32Runs = u32ZTimerRuns;
+    u32Ticks(500 + APP_TIMER_TICK_MSEC);
+
+    for (i = 0; i < 100; i++) {
+        TEST_CHECK(bFiredOnTime(&asRandom[i]));
+    }
+    TEST_CHECK(asRandom[0].u32LastFiredMsec == asRandom[99].u32LastFiredMsec);
+    TEST_CHECK(u32ZTimerRuns - u32Runs <= 3);
+}
+
+/* A timer past the reach of the wheel waits in its top level and still
+ * fires on time. Between cascades the wheel sleeps. */
+PRIVATE void vTestBeyondReach(void)
+{
+    tsTestTimer sTimer = {0};
+    uint32 u32Runs = u32ZTimerRuns;
+
+    vStart(&sTimer, LONG_MSEC, FALSE);
+    u32Ticks(LONG_MSEC + APP_TIMER_TICK_MSEC);
+    TEST_CHECK(bFiredOnTime(&sTimer));
+
+    /* One cascade every 32 ticks at most */
+    TEST_CHECK(u32ZTimerRuns - u32Runs <= LONG_MSEC / (32 * APP_TIMER_TICK_MSEC) + 2);
+}
+
+/* With no timer running the wheel stops its ZTimer */
+PRIVATE void vTestIdle(void)
+{
+    TEST_CHECK(u32Ticks(10000) == 0);
+}
+
+/* Thousands of one-shot and periodic timers of up to 20 minutes, started
+ * at random moments, some stopped or restarted on the way */
+PRIVATE void vTestRandom(void)
+{
+    tsTestTimer *psTimer;
+    uint32 u32Late = 0;
+    uint32 u32Elapsed;
+    uint32 u32Step;
+    uint32 u32Expected;
+    uint32 i;
+
+    for (i = 0; i < RANDOM_TIMERS; i++) {
+        psTimer = &asRandom[i];
+        *psTimer = (tsTestTimer){0};
+        switch (u32Random() % 4) {
+        case 0:
+            vStart(psTimer, 1 + u32Random() % 1000, FALSE);
+            break;
+        case 1:
+            vStart(psTimer, 1 + u32Random() % (20UL * 60 * 1000), FALSE);
+            break;
+        default:
+            vStart(psTimer, 100 + u32Random() % (60UL * 1000), TRUE);
+            break;
+        }
+        u32Ticks(u32Random() % 3);
+    }
+
+    /* Stop or restart some on the way, then let the last ones expire */
+    for (u32Elapsed = 0; u32Elapsed < 20UL * 60 * 1000; u32Elapsed += u32Step) {
+        u32Step = 1 + u32Random() % 5000;
+        u32Ticks(u32Step);
+        psTimer = &asRandom[u32Random() % RANDOM_TIMERS];
+        if (APP_bTimerIsRunning(&psTimer->sTimer) && (psTimer->sTimer.u32Period == 0)) {
+            if (u32Random() & 1) {
+                APP_vTimerStop(&psTimer->sTimer);
+                psTimer->u32Msec = 0;
+            }
+            else {
+                vStart(psTimer, psTimer->u32Msec, FALSE);
+            }
+        }
+    }
+    u32Ticks(20UL * 60 * 1000 + APP_TIMER_TICK_MSEC);
+
+    for (i = 0; i < RANDOM_TIMERS; i++) {
+        psTimer = &asRandom[i];
+        if (psTimer->u32Msec == 0) {
+            u32Late += (psTimer->u32Fired != 0);
+        }
+        else if (psTimer->sTimer.u32Period == 0) {
+            u32Late += !bFiredOnTime(psTimer);
+        }
+        else {
+            /* Every expiry a whole number of periods after the first */
+            u32Expected = (HOST_u32ClockMsec - psTimer->u32FirstFiredMsec) /
+                          (psTimer->sTimer.u32Period * APP_TIMER_TICK_MSEC);
+            u32Late += (psTimer->u32FirstFiredMsec - psTimer->u32StartMsec < psTimer->u32Msec);
+            u32Late += (psTimer->u32Fired != u32Expected + 1);
+            APP_vTimerStop(&psTimer->sTimer);
+        }
+    }
+    TEST_CHECK(u32Late == 0);
+    TEST_CHECK(u32Ticks(10000) == 0);
+}
+
+/* Start, or restart, a test timer */
+PRIVATE void vStart(tsTestTimer *psTimer, uint32 u32Msec, bool_t bPeriodic)
+{
+    if (!APP_bTimerIsRunning(&psTimer->sTimer)) {
+        APP_vTimerCreate(&psTimer->sTimer, vTimerExpired, psTimer);
+    }
+    psTimer->u32StartMsec = HOST_u32ClockMsec;
+    psTimer->u32Msec = u32Msec;
+    psTimer->u32Fired = 0;
+    if (bPeriodic) {
+        APP_vTimerStartPeriodic(&psTimer->sTimer, u32Msec);
+    }
+    else {
+        APP_vTimerStart(&psTimer->sTimer, u32Msec);
+    }
+}
+
+/* Fired once, not early and no more than a tick late */
+PRIVATE bool_t bFiredOnTime(const tsTestTimer *psTimer)
+{
+    uint32 u32Took = psTimer->u32FirstFiredMsec - psTimer->u32StartMsec;
+
+    return (psTimer->u32Fired == 1) && (u32Took >= psTimer->u32Msec) &&
+           (u32Took < psTimer->u32Msec + APP_TIMER_TICK_MSEC);
+}
+
+/* Tick interrupts, each followed by the main loop passes it causes */
+PRIVATE uint32 u32Ticks(uint32 u32Count)
+{
+    uint32 u32Ran = 0;
+
+    while (u32Count-- > 0) {
+        HOST_vTick();
+        while (APP_bTasksReady()) {
+            u32Ran |= APP_u32RunReadyTasks(apfTasks);
+        }
+    }
+
+    return u32Ran & APP_TASK_MASK(E_APP_TASK_ZTIMER);
+}
+
+/* Park-Miller minimal standard generator, so runs are repeatable */
+PRIVATE uint32 u32Random(void)
+{
+    u32Seed = (uint32)(((uint64)u32Seed * 48271) % 0x7FFFFFFF);
+    return u32Seed;
+}
+
+PRIVATE void vTimerExpired(void *pvParam)
+{
+    tsTestTimer *psTimer = (tsTestTimer *)pvParam;
+
+    if (psTimer->u32Fired++ == 0) {
+        psTimer->u32FirstFiredMsec = HOST_u32ClockMsec;
+    }
+    psTimer->u32LastFiredMsec = HOST_u32ClockMsec;
+
+    if (psTimer->psStop != NULL) {
+        APP_vTimerStop(&psTimer->psStop->sTimer);
+    }
+    if (psTimer->bRestart) {
+        APP_vTimerStart(&psTimer->sTimer, psTimer->u32Msec);
+    }
+}
+
+PRIVATE void vTaskZTimer(void)
+{
+    u32ZTimerRuns++;
+    APP_vZTimerTask();
+}
+
+PRIVATE void vTaskIdle(void)
+{
+}
+
+/****************************************************************************/
+/***        END OF FILE                                                   ***/
+/****************************************************************************/